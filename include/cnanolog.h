@@ -3,6 +3,7 @@
 #include <stdint.h>
 #include <stdarg.h>
 #include <stddef.h>  /* For NULL */
+#include "cnanolog_format.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -18,6 +19,8 @@ extern "C" {
 typedef enum {
     CNANOLOG_OUTPUT_BINARY = 0,  /* Binary format (default) - requires decompressor */
     CNANOLOG_OUTPUT_TEXT = 1,    /* Human-readable text format - no decompressor needed */
+    CNANOLOG_OUTPUT_JSON = 2,    /* One JSON object per line, arguments as typed fields */
+    CNANOLOG_OUTPUT_LOGFMT = 3,  /* logfmt key=value lines, arguments as typed fields */
 } cnanolog_output_format_t;
 
 /**
@@ -35,11 +38,18 @@ typedef struct {
     cnanolog_rotation_policy_t policy;  /* Rotation policy */
     const char* base_path;               /* Base path for log files (e.g., "app.clog") */
                                          /* Dated files: "app-2025-11-02.clog" */
-    cnanolog_output_format_t format;     /* Output format (binary or text) */
+    cnanolog_output_format_t format;     /* Output format (binary, text, JSON or logfmt) */
                                          /* Default: CNANOLOG_OUTPUT_BINARY */
     const char* text_pattern;            /* Text format pattern (NULL = use default) */
                                          /* Only applies when format == CNANOLOG_OUTPUT_TEXT */
                                          /* Default: "[%t] [%l] [%f:%n] %m" */
+    uint32_t formatter_threads;          /* Text formatting threads (0 = format on the */
+                                         /* writer thread). Lines keep their order. */
+                                         /* Applies to TEXT, JSON and LOGFMT output */
+    uint32_t reorder_window_us;          /* Timestamp-ordered output (0 = off, the */
+                                         /* default). Entries are held this long so */
+                                         /* all threads can be merged by timestamp. */
+                                         /* Max 1000000 (1s); needs timestamps */
 } cnanolog_rotation_config_t;
 
 /**
@@ -110,15 +120,19 @@ int cnanolog_init(const char* log_file_path);
  *   };
  *   cnanolog_init_ex(&config);
  *
- * Example (JSON format):
+ * Example (JSON lines, arguments as typed fields):
  *   cnanolog_rotation_config_t config = {
  *       .policy = CNANOLOG_ROTATE_NONE,
- *       .base_path = "logs/app.log",
- *       .format = CNANOLOG_OUTPUT_TEXT,
- *       .text_pattern = "{\"time\":\"%t\",\"level\":\"%l\",\"msg\":\"%m\"}"
+ *       .base_path = "logs/app.jsonl",
+ *       .format = CNANOLOG_OUTPUT_JSON
  *   };
  *   cnanolog_init_ex(&config);
  *
+ *   LOG_INFO("order id=%d user=%s", 7, "bob") writes
+ *   {"time":"2025-11-02T10:30:45.123456789","level":"INFO","file":"main.c",
+ *    "line":42,"msg":"order id=7 user=bob","id":7,"user":"bob"}
+ *   Fields are named from "name=%x" / "name: %x" in the format, else arg0, arg1...
+ *
  */
 int cnanolog_init_ex(const cnanolog_rotation_config_t* config);
 
@@ -153,10 +167,105 @@ void cnanolog_get_stats(cnanolog_stats_t* stats);
 
 /**
  * Reset statistics counters to zero.
- * Does not affect operational state, only counters.
+ * Does not affect operational state, only counters (and the latency
+ * histograms, if compiled in).
  */
 void cnanolog_reset_stats(void);
 
+/**
+ * Distribution of one measured latency, in timestamp ticks (TSC cycles;
+ * nanoseconds when timestamps come from CLOCK_MONOTONIC). Percentiles are
+ * accurate to ~3% (log-linear buckets); max is exact.
+ */
+typedef struct {
+    uint64_t count;   /* Samples recorded */
+    uint64_t p50;
+    uint64_t p99;
+    uint64_t p999;    /* 99.9th percentile */
+    uint64_t max;
+} cnanolog_latency_t;
+
+/**
+ * Latency distributions, merged over all threads.
+ */
+typedef struct {
+    cnanolog_latency_t call_cost;      /* Log call, start to commit (entries staged) */
+    cnanolog_latency_t staging_delay;  /* Entry timestamp to the writer taking it */
+    uint64_t ticks_per_second;         /* To convert: ns = ticks * 1e9 / ticks_per_second */
+} cnanolog_latency_stats_t;
+
+/**
+ * Get the latency histograms' percentiles.
+ * Needs the library built with -DCNANOLOG_ENABLE_LATENCY_HISTOGRAMS=ON
+ * (and timestamps); otherwise nothing is measured and this fails. A
+ * rising staging_delay p99.9 shows the writer falling behind before
+ * entries start to drop. In shared mode (cnanolog_init_shared) entries are
+ * taken by the agent, so only call_cost is recorded here.
+ *
+ * @param stats Structure to fill (zeroed on failure)
+ * @return 0 on success, -1 if not compiled in
+ *
+ * Example:
+ *   cnanolog_latency_stats_t lat;
+ *   if (cnanolog_get_latency_stats(&lat) == 0) {
+ *       printf("call p99 %llu cycles, delay p99.9 %.1f us\n",
+ *              (unsigned long long)lat.call_cost.p99,
+ *              lat.staging_delay.p999 * 1e6 / lat.ticks_per_second);
+ *   }
+ */
+int cnanolog_get_latency_stats(cnanolog_latency_stats_t* stats);
+
+/**
+ * Health of one thread's staging buffer.
+ */
+typedef struct {
+    uint32_t thread_id;       /* Logging thread id (as in span records) */
+    char name[32];            /* cnanolog_set_thread_name(), else the OS name ("" if none) */
+    uint64_t capacity;        /* Buffer size in bytes */
+    uint64_t used;            /* Bytes staged, not yet taken by the writer */
+    uint32_t fill_percent;    /* used * 100 / capacity */
+    uint64_t high_water;      /* Largest fill seen (bytes) */
+    uint64_t drops;           /* Entries this thread lost (buffer full or too large) */
+    uint64_t bytes_produced;  /* Bytes staged since the buffer was created */
+    uint64_t ns_since_drain;  /* Since the writer last took entries (UINT64_MAX = never) */
+} cnanolog_buffer_info_t;
+
+/**
+ * Describe every staging buffer (one per thread that has logged), to find
+ * the thread that floods the logger and to size buffers from high_water
+ * and drops. Counters are read without stopping the threads, so each is
+ * current but they are not one consistent snapshot. A buffer that is
+ * filling while ns_since_drain grows means the writer is not keeping up.
+ * In shared mode (cnanolog_init_shared) this describes the segment's
+ * buffers, drained by the agent.
+ *
+ * @param info Array to fill (may be NULL if max_buffers is 0)
+ * @param max_buffers Entries in info
+ * @return Number of buffers, which may exceed max_buffers (only that many
+ *         are filled); 0 if not initialized
+ *
+ * Example:
+ *   cnanolog_buffer_info_t buffers[64];
+ *   int n = cnanolog_get_buffer_info(buffers, 64);
+ *   for (int i = 0; i < n && i < 64; i++) {
+ *       printf("%u %s: %u%% (peak %llu bytes), %llu dropped\n",
+ *              buffers[i].thread_id, buffers[i].name, buffers[i].fill_percent,
+ *              (unsigned long long)buffers[i].high_water,
+ *              (unsigned long long)buffers[i].drops);
+ *   }
+ */
+int cnanolog_get_buffer_info(cnanolog_buffer_info_t* info, size_t max_buffers);
+
+/**
+ * Name the calling thread in cnanolog_get_buffer_info() (truncated to 31
+ * characters). Threads otherwise report the OS thread name they had when
+ * they first logged. Creates the thread's staging buffer if needed.
+ *
+ * @param name Thread name
+ * @return 0 on success, -1 if not initialized or no buffer is available
+ */
+int cnanolog_set_thread_name(const char* name);
+
 /**
  * Preallocate thread-local buffer for the calling thread.
  * Call this before any logging to avoid first-log allocation overhead.
@@ -200,10 +309,12 @@ typedef enum {
     LOG_LEVEL_INFO  = 0,
     LOG_LEVEL_WARN  = 1,
     LOG_LEVEL_ERROR = 2,
-    LOG_LEVEL_DEBUG = 3
+    LOG_LEVEL_DEBUG = 3,
+    LOG_LEVEL_SPAN_BEGIN = CNANOLOG_LEVEL_SPAN_BEGIN,  /* Span records */
+    LOG_LEVEL_SPAN_END   = CNANOLOG_LEVEL_SPAN_END     /* (see CNANOLOG_SPAN_BEGIN) */
 } cnanolog_level_t;
 
-/* Custom log levels can use any uint8_t value (4-255) */
+/* Custom log levels can use any other uint8_t value (4-252, 255) */
 #define CNANOLOG_MAX_CUSTOM_LEVELS 64
 
 /**
@@ -211,7 +322,8 @@ typedef enum {
  * Must be called before cnanolog_init() or cnanolog_init_ex().
  *
  * @param name Level name (e.g., "METRIC", "AUDIT", "TRACE")
- * @param level Level value (4-255, 0-3 are reserved for INFO/WARN/ERROR/DEBUG)
+ * @param level Level value (4-255, 0-3 are reserved for INFO/WARN/ERROR/DEBUG,
+ *              253-254 for spans)
  * @return 0 on success, -1 on failure
  *
  * Example:
@@ -224,13 +336,220 @@ typedef enum {
  */
 int cnanolog_register_level(const char* name, uint8_t level);
 
+/* ============================================================================
+ * Flight Recorder
+ * ============================================================================ */
+
+/**
+ * Flight recorder configuration.
+ * Entries at the recorded levels are not written to the log: the writer
+ * thread keeps them in a bounded in-memory ring (oldest dropped first)
+ * and writes them out only when a dump is triggered. A dump is a binary
+ * .clog with its own dictionary, whatever the main output format.
+ */
+typedef struct {
+    const uint8_t* levels;   /* Levels to record (NULL = LOG_LEVEL_DEBUG only) */
+    uint32_t num_levels;     /* Number of entries in levels */
+    size_t capacity;         /* Ring size in bytes (0 = 16MB) */
+    const char* dump_path;   /* Base path of triggered dumps (NULL = */
+                             /* "flight_recorder.clog"); dump N of the */
+                             /* process is written to "<base>-N.clog" */
+    int dump_on_error;       /* Dump when an ERROR entry is written and the */
+                             /* ring is not empty (the ERROR is included) */
+    int dump_signal;         /* Signal that triggers a dump (0 = none), */
+                             /* e.g. SIGUSR1. POSIX only */
+} cnanolog_flight_recorder_config_t;
+
+/**
+ * Enable the flight recorder.
+ * Must be called before cnanolog_init() or cnanolog_init_ex(); the
+ * setting persists across shutdown/init cycles.
+ *
+ * @param config Configuration (copied), or NULL to disable the recorder
+ * @return 0 on success, -1 on failure
+ *
+ * Example (full DEBUG history of the last 64MB, dumped on errors):
+ *   cnanolog_flight_recorder_config_t recorder = {
+ *       .capacity = 64 * 1024 * 1024,
+ *       .dump_path = "logs/debug.clog",
+ *       .dump_on_error = 1,
+ *       .dump_signal = SIGUSR1
+ *   };
+ *   cnanolog_enable_flight_recorder(&recorder);
+ *   cnanolog_init("logs/app.clog");
+ */
+int cnanolog_enable_flight_recorder(const cnanolog_flight_recorder_config_t* config);
+
+/**
+ * Write the recorded entries to a .clog file and empty the ring.
+ * Everything logged before the call is included. Blocks until the
+ * writer thread has written the file.
+ *
+ * @param path Output path, or NULL for the next "<base>-N.clog" name
+ * @return 0 on success, -1 if the recorder is not running or the write failed
+ */
+int cnanolog_dump_flight_recorder(const char* path);
+
+/* ============================================================================
+ * Additional Sinks
+ * ============================================================================ */
+
+#define CNANOLOG_MAX_SINKS 8
+
+/**
+ * An extra output next to the main log file. The writer thread looks up
+ * each entry's site once and hands the entry to every sink whose filters
+ * accept it. Each sink has its own writer, buffers and flush policy.
+ */
+typedef struct {
+    const char* path;                  /* Output file (binary files are truncated, */
+                                       /* text files appended to), or a collector: */
+                                       /* "unix:/path" or "tcp:host:port" (binary) */
+    cnanolog_output_format_t format;   /* Binary, text, JSON or logfmt */
+    const char* text_pattern;          /* TEXT pattern (NULL = default) */
+    const uint8_t* levels;             /* Levels written (NULL = all levels) */
+    uint32_t num_levels;               /* Number of entries in levels */
+    const char* file_filter;           /* Only sites whose file path contains */
+                                       /* this (NULL = all sites) */
+    uint32_t flush_interval_ms;        /* 0 = flushed with the main output; */
+                                       /* else at most this often */
+    const char* spool_path;            /* Collector sinks: backlog file while the */
+                                       /* collector is away (NULL = */
+                                       /* cnanolog-<pid>-<n>.spool) */
+} cnanolog_sink_config_t;
+
+/**
+ * Add a sink. Must be called before cnanolog_init() or cnanolog_init_ex();
+ * sinks persist across shutdown/init cycles and are opened by each init.
+ * Sinks do not rotate, and entries at flight recorder levels still reach
+ * sinks whose levels include them.
+ *
+ * A collector sink streams the binary format to a socket with non-blocking
+ * batched sends (see tools/cnanolog-receiver). While the collector is down
+ * or slow, batches spool to disk and are replayed after a reconnect; a
+ * batch cut off by a disconnect is sent again in full. Shutdown waits up
+ * to 3 seconds for the rest. Needs timestamps.
+ *
+ * @param config Configuration (copied), or NULL to remove all sinks
+ * @return Sink index on success, -1 on failure (too many sinks,
+ *         missing path, or logger already initialized)
+ *
+ * Example (everything to binary, ERROR to a text file for on-call):
+ *   static const uint8_t errors[] = {LOG_LEVEL_ERROR};
+ *   cnanolog_sink_config_t oncall = {
+ *       .path = "logs/errors.log",
+ *       .format = CNANOLOG_OUTPUT_TEXT,
+ *       .levels = errors,
+ *       .num_levels = 1
+ *   };
+ *   cnanolog_add_sink(&oncall);
+ *   cnanolog_sink_config_t collector = {
+ *       .path = "unix:/run/cnanolog.sock",
+ *       .format = CNANOLOG_OUTPUT_BINARY
+ *   };
+ *   cnanolog_add_sink(&collector);
+ *   cnanolog_init("logs/app.clog");
+ */
+int cnanolog_add_sink(const cnanolog_sink_config_t* config);
+
+/* ============================================================================
+ * Crash Flush
+ * ============================================================================ */
+
+/**
+ * Install handlers for SIGSEGV, SIGBUS, SIGILL, SIGFPE and SIGABRT that
+ * save the log before the process dies. The handler stops the writer
+ * thread, writes entries already committed to the staging buffers (binary
+ * output; text output writes the lines already formatted), appends the
+ * dictionary and then re-raises the signal under the previous handler,
+ * so core dumps and exit statuses are unchanged.
+ *
+ * Only async-signal-safe calls are used (no malloc, no locks, no stdio).
+ * Entries still being written by the crashing thread are lost, and a
+ * crash on a stack overflow may not run the handler at all.
+ * Active between init and shutdown; may be called before or after init.
+ *
+ * @param budget_ms Time the handler may spend before giving up and
+ *                  re-raising (0 = 1000ms)
+ * @return 0 on success, -1 if unsupported on this platform
+ */
+int cnanolog_install_crash_handler(uint32_t budget_ms);
+
+/* ============================================================================
+ * Out-of-Process Writer
+ * ============================================================================ */
+
+/**
+ * Initialize with the writer in a separate process. Staging buffers are
+ * placed in a POSIX shared memory object; the cnanolog-agent tool attaches
+ * to it, compresses the entries and writes the binary log:
+ *
+ *   cnanolog-agent /myapp-log logs/app.clog
+ *
+ * The application only reserves and commits, and no writer thread runs
+ * in it. Entries committed before the application exits (or crashes) are
+ * written as long as the agent runs. The agent may be started before or
+ * after this call, and can be niced or pinned on its own.
+ *
+ * Binary output only; no rotation, ordered output or flight recorder.
+ * Once per process: after cnanolog_shutdown() the segment stays mapped
+ * (threads keep their buffers in it) and cannot be re-initialized.
+ *
+ * @param shm_name Shared memory name, e.g. "/myapp-log" (a stale segment
+ *                 of the same name is replaced)
+ * @param max_threads Logging threads that get a staging buffer
+ *                    (0 = 16; each reserves 128MB of address space,
+ *                    allocated as it fills)
+ * @return 0 on success, -1 on failure (or on platforms without POSIX
+ *         shared memory)
+ */
+int cnanolog_init_shared(const char* shm_name, uint32_t max_threads);
+
+/* ============================================================================
+ * Interned Strings
+ * ============================================================================ */
+
+/**
+ * Intern a string for logging by handle.
+ * A handle is logged with "%s" like a char*, but the log call copies only
+ * the pointer: no strlen, no copy of the text. May be called from any
+ * thread, before or after init; interning the same text again returns the
+ * same handle. Handles stay valid for the life of the process.
+ *
+ * @param str Text to intern (at most CNANOLOG_INTERN_MAX_LEN bytes)
+ * @return Handle, or NULL if str is NULL, too long, or allocation failed
+ *         (a NULL handle logs as an empty string)
+ *
+ * Example:
+ *   static const cnanolog_string_t* venue;
+ *   venue = cnanolog_intern("XNAS");
+ *   LOG_INFO("fill on %s qty %d", venue, qty);
+ */
+const cnanolog_string_t* cnanolog_intern(const char* str);
+
 /* ============================================================================
  * Internal API (do not call directly)
  * ============================================================================ */
 
+/**
+ * Static description of one log call site, emitted by the log macros.
+ * On ELF platforms these live in the "cnanolog_sites" linker section and
+ * cnanolog_init() assigns every id in one pass before the first log call.
+ */
+typedef struct {
+    uint32_t log_id;             /* Assigned at init (UINT32_MAX = not yet) */
+    uint32_t line_number;
+    uint8_t level;
+    uint8_t num_args;
+    const char* filename;
+    const char* format;
+    const uint8_t* arg_types;
+    const char* text_pattern;    /* Per-log text pattern (NULL = global) */
+} cnanolog_site_t;
+
 /**
  * Register a log site and return its unique ID.
- * Called automatically by log macros on first use.
+ * Kept for callers that do not use the log macros.
  */
 uint32_t _cnanolog_register_site(cnanolog_level_t level,
                                   const char* filename,
@@ -240,6 +559,18 @@ uint32_t _cnanolog_register_site(cnanolog_level_t level,
                                   const uint8_t* arg_types,
                                   const char* text_pattern);
 
+/**
+ * Register a site that is not in a linker section yet and store its id.
+ * Used by the log macros where linker sections are unavailable.
+ */
+uint32_t _cnanolog_resolve_site(cnanolog_site_t* site);
+
+/**
+ * Add one module's "cnanolog_sites" section (called from a constructor
+ * in every translation unit; duplicates are ignored).
+ */
+void _cnanolog_add_site_section(cnanolog_site_t* start, cnanolog_site_t* stop);
+
 /**
  * Write a binary log entry.
  * Called by log macros after registration.
@@ -249,6 +580,68 @@ void _cnanolog_log_binary(uint32_t log_id,
                           const uint8_t* arg_types,
                           ...);
 
+/**
+ * Per-site, per-thread state of the rate-limited and sampled log macros.
+ * Only ever touched by its own thread: no atomics.
+ */
+typedef struct {
+    uint64_t state;        /* EVERY_N: 1 once primed; RATE: earliest admit */
+                           /* time (timestamp ticks); SAMPLED: RNG state */
+    uint64_t suppressed;   /* Calls not logged since the last logged one */
+} cnanolog_limiter_t;
+
+/**
+ * RATE: admit at most per_sec entries per second (bursts of up to
+ * per_sec), measured with the entry timestamp counter.
+ */
+int _cnanolog_admit_rate(cnanolog_limiter_t* limiter, uint32_t per_sec);
+
+/**
+ * EVERY_N: admit the first call and then every n-th.
+ */
+static inline int _cnanolog_admit_every_n(cnanolog_limiter_t* limiter, uint64_t n) {
+    if (limiter->state == 0 || limiter->suppressed + 1 >= n) {
+        limiter->state = 1;
+        return 1;
+    }
+    limiter->suppressed++;
+    return 0;
+}
+
+/**
+ * SAMPLED: admit with probability p (xorshift64, seeded per thread and site).
+ */
+static inline int _cnanolog_admit_sampled(cnanolog_limiter_t* limiter, double p) {
+    uint64_t x = limiter->state;
+    if (x == 0) {
+        x = ((uint64_t)(uintptr_t)limiter * 0x9E3779B97F4A7C15ULL) | 1;
+    }
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+    limiter->state = x;
+    if ((double)(x >> 11) * (1.0 / 9007199254740992.0) < p) {
+        return 1;
+    }
+    limiter->suppressed++;
+    return 0;
+}
+
+/**
+ * Count of calls suppressed before an admitted one (and reset it).
+ */
+static inline unsigned long long _cnanolog_take_suppressed(cnanolog_limiter_t* limiter) {
+    unsigned long long suppressed = limiter->suppressed;
+    limiter->suppressed = 0;
+    return suppressed;
+}
+
+/**
+ * Write a span begin or end record (the site's only argument, the thread
+ * id, is filled in here).
+ */
+void _cnanolog_span(uint32_t log_id);
+
 /* ============================================================================
  * User-Facing Logging Macros
  * ============================================================================ */
@@ -256,50 +649,65 @@ void _cnanolog_log_binary(uint32_t log_id,
 /* Include type detection for automatic argument type inference */
 #include "cnanolog_types.h"
 
+/*
+ * Site descriptors. With GCC/Clang on ELF targets every site is placed in
+ * the "cnanolog_sites" section, so ids are assigned at init and the log
+ * call reads a plain static. Elsewhere the first call registers the site.
+ * Define CNANOLOG_NO_SITE_SECTION to force the lazy path.
+ */
+#if defined(__ELF__) && (defined(__GNUC__) || defined(__clang__)) && \
+    !defined(CNANOLOG_NO_SITE_SECTION)
+    #define CNANOLOG_STATIC_SITES 1
+#else
+    #define CNANOLOG_STATIC_SITES 0
+#endif
+
+#if CNANOLOG_STATIC_SITES
+/* aligned(8) stops the compiler padding sites apart inside the section */
+#define CNANOLOG_SITE_ATTR __attribute__((used, section("cnanolog_sites"), aligned(8)))
+#define CNANOLOG_SITE_ID(site) ((site).log_id)
+
+/* Section bounds of the module (executable or shared library) */
+extern cnanolog_site_t __start_cnanolog_sites[] __attribute__((weak, visibility("hidden")));
+extern cnanolog_site_t __stop_cnanolog_sites[] __attribute__((weak, visibility("hidden")));
+
+__attribute__((constructor, used))
+static void __cnanolog_add_module_sites(void) {
+    _cnanolog_add_site_section(__start_cnanolog_sites, __stop_cnanolog_sites);
+}
+#else
+#define CNANOLOG_SITE_ATTR
+#define CNANOLOG_SITE_ID(site) \
+    ((site).log_id != UINT32_MAX ? (site).log_id : _cnanolog_resolve_site(&(site)))
+#endif
+
+#define CNANOLOG_DEFINE_SITE(level, format, num_args, arg_types, text_pattern) \
+    static cnanolog_site_t __cnanolog_site CNANOLOG_SITE_ATTR = { \
+        UINT32_MAX, __LINE__, (uint8_t)(level), (uint8_t)(num_args), \
+        __FILE__, format, arg_types, text_pattern \
+    }
+
 /* Base macro for logs WITH NO arguments */
 #define CNANOLOG_LOG0(level, format) \
     do { \
-        static uint32_t __cnanolog_cached_id = UINT32_MAX; \
         static const uint8_t __cnanolog_empty_types[] = {0}; \
-        if (__cnanolog_cached_id == UINT32_MAX) { \
-            __cnanolog_cached_id = _cnanolog_register_site( \
-                level, __FILE__, __LINE__, format, 0, __cnanolog_empty_types, NULL); \
-        } \
-        _cnanolog_log_binary(__cnanolog_cached_id, 0, __cnanolog_empty_types); \
+        CNANOLOG_DEFINE_SITE(level, format, 0, __cnanolog_empty_types, NULL); \
+        _cnanolog_log_binary(CNANOLOG_SITE_ID(__cnanolog_site), 0, __cnanolog_empty_types); \
     } while(0)
 
 /* Base macro for logs WITH arguments */
 #define CNANOLOG_LOG_ARGS(level, format, ...) \
-    do { \
-        static uint32_t __cnanolog_cached_id = UINT32_MAX; \
-        static uint8_t __cnanolog_arg_types[] = CNANOLOG_ARG_TYPES(__VA_ARGS__); \
-        static const uint8_t __cnanolog_num_args = CNANOLOG_COUNT_ARGS(__VA_ARGS__); \
-        if (__cnanolog_cached_id == UINT32_MAX) { \
-            __cnanolog_cached_id = _cnanolog_register_site( \
-                level, __FILE__, __LINE__, format, \
-                __cnanolog_num_args, \
-                __cnanolog_arg_types, NULL); \
-        } \
-        _cnanolog_log_binary(__cnanolog_cached_id, \
-                            __cnanolog_num_args, \
-                            __cnanolog_arg_types, \
-                            ##__VA_ARGS__); \
-    } while(0)
+    CNANOLOG_LOG_ARGS_FMT(level, NULL, format, ##__VA_ARGS__)
 
-/* Base macro for logs WITH arguments AND custom text pattern */
+/* Base macro for logs WITH arguments AND custom text pattern
+ * (text_pattern must be a string literal or NULL) */
 #define CNANOLOG_LOG_ARGS_FMT(level, text_pattern, format, ...) \
     do { \
-        static uint32_t __cnanolog_cached_id = UINT32_MAX; \
-        static uint8_t __cnanolog_arg_types[] = CNANOLOG_ARG_TYPES(__VA_ARGS__); \
-        static const uint8_t __cnanolog_num_args = CNANOLOG_COUNT_ARGS(__VA_ARGS__); \
-        if (__cnanolog_cached_id == UINT32_MAX) { \
-            __cnanolog_cached_id = _cnanolog_register_site( \
-                level, __FILE__, __LINE__, format, \
-                __cnanolog_num_args, \
-                __cnanolog_arg_types, text_pattern); \
-        } \
-        _cnanolog_log_binary(__cnanolog_cached_id, \
-                            __cnanolog_num_args, \
+        static const uint8_t __cnanolog_arg_types[] = CNANOLOG_ARG_TYPES(__VA_ARGS__); \
+        CNANOLOG_DEFINE_SITE(level, format, CNANOLOG_COUNT_ARGS(__VA_ARGS__), \
+                             __cnanolog_arg_types, text_pattern); \
+        _cnanolog_log_binary(CNANOLOG_SITE_ID(__cnanolog_site), \
+                            CNANOLOG_COUNT_ARGS(__VA_ARGS__), \
                             __cnanolog_arg_types, \
                             ##__VA_ARGS__); \
     } while(0)
@@ -370,6 +778,126 @@ void _cnanolog_log_binary(uint32_t log_id,
 #define LOG_DEBUG_FMT(text_pattern, format, ...) \
     CNANOLOG_LOG_ARGS_FMT(LOG_LEVEL_DEBUG, text_pattern, format, ##__VA_ARGS__)
 
+/* ============================================================================
+ * Rate-Limited and Sampled Logging Macros
+ *
+ * Keep a hot loop that starts failing from flooding the staging buffer.
+ * The state lives in a per-site, per-thread variable, so limits apply to
+ * each thread separately and cost no shared cache lines. Calls that are
+ * not logged evaluate no arguments. The next logged entry reports how
+ * many were skipped, as a second site with the format plus
+ * " (suppressed N)" (the format must be a string literal).
+ *
+ * Usage:
+ *   LOG_WARN_EVERY_N(1000, "retry %d failed", attempt);  // 1st, 1001st, ...
+ *   LOG_ERROR_RATE(10, "bad packet from %s", peer);      // <= 10/s per thread
+ *   LOG_DEBUG_SAMPLED(0.01, "queue depth %d", depth);    // ~1% of calls
+ *
+ * Output:
+ *   retry 1001 failed (suppressed 999)
+ * ============================================================================ */
+#if defined(__cplusplus)
+    #define CNANOLOG_THREAD_LOCAL thread_local
+#elif defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+    #define CNANOLOG_THREAD_LOCAL _Thread_local
+#elif defined(_MSC_VER)
+    #define CNANOLOG_THREAD_LOCAL __declspec(thread)
+#else
+    #define CNANOLOG_THREAD_LOCAL __thread
+#endif
+
+/* admit: expression using __cnanolog_limiter, nonzero = log this call */
+#define CNANOLOG_LOG_LIMITED(level, admit, format, ...) \
+    do { \
+        static CNANOLOG_THREAD_LOCAL cnanolog_limiter_t __cnanolog_limiter; \
+        if (admit) { \
+            unsigned long long __cnanolog_suppressed = \
+                _cnanolog_take_suppressed(&__cnanolog_limiter); \
+            if (__cnanolog_suppressed == 0) { \
+                CNANOLOG_LOG_ARGS(level, format, ##__VA_ARGS__); \
+            } else { \
+                CNANOLOG_LOG_ARGS(level, format " (suppressed %llu)", ##__VA_ARGS__, \
+                                  __cnanolog_suppressed); \
+            } \
+        } \
+    } while(0)
+
+#define CNANOLOG_LOG_EVERY_N(level, n, format, ...) \
+    CNANOLOG_LOG_LIMITED(level, _cnanolog_admit_every_n(&__cnanolog_limiter, (n)), \
+                         format, ##__VA_ARGS__)
+
+#define CNANOLOG_LOG_RATE(level, per_sec, format, ...) \
+    CNANOLOG_LOG_LIMITED(level, _cnanolog_admit_rate(&__cnanolog_limiter, (per_sec)), \
+                         format, ##__VA_ARGS__)
+
+#define CNANOLOG_LOG_SAMPLED(level, p, format, ...) \
+    CNANOLOG_LOG_LIMITED(level, _cnanolog_admit_sampled(&__cnanolog_limiter, (p)), \
+                         format, ##__VA_ARGS__)
+
+#define LOG_INFO_EVERY_N(n, format, ...) \
+    CNANOLOG_LOG_EVERY_N(LOG_LEVEL_INFO, n, format, ##__VA_ARGS__)
+#define LOG_WARN_EVERY_N(n, format, ...) \
+    CNANOLOG_LOG_EVERY_N(LOG_LEVEL_WARN, n, format, ##__VA_ARGS__)
+#define LOG_ERROR_EVERY_N(n, format, ...) \
+    CNANOLOG_LOG_EVERY_N(LOG_LEVEL_ERROR, n, format, ##__VA_ARGS__)
+#define LOG_DEBUG_EVERY_N(n, format, ...) \
+    CNANOLOG_LOG_EVERY_N(LOG_LEVEL_DEBUG, n, format, ##__VA_ARGS__)
+
+#define LOG_INFO_RATE(per_sec, format, ...) \
+    CNANOLOG_LOG_RATE(LOG_LEVEL_INFO, per_sec, format, ##__VA_ARGS__)
+#define LOG_WARN_RATE(per_sec, format, ...) \
+    CNANOLOG_LOG_RATE(LOG_LEVEL_WARN, per_sec, format, ##__VA_ARGS__)
+#define LOG_ERROR_RATE(per_sec, format, ...) \
+    CNANOLOG_LOG_RATE(LOG_LEVEL_ERROR, per_sec, format, ##__VA_ARGS__)
+#define LOG_DEBUG_RATE(per_sec, format, ...) \
+    CNANOLOG_LOG_RATE(LOG_LEVEL_DEBUG, per_sec, format, ##__VA_ARGS__)
+
+#define LOG_INFO_SAMPLED(p, format, ...) \
+    CNANOLOG_LOG_SAMPLED(LOG_LEVEL_INFO, p, format, ##__VA_ARGS__)
+#define LOG_WARN_SAMPLED(p, format, ...) \
+    CNANOLOG_LOG_SAMPLED(LOG_LEVEL_WARN, p, format, ##__VA_ARGS__)
+#define LOG_ERROR_SAMPLED(p, format, ...) \
+    CNANOLOG_LOG_SAMPLED(LOG_LEVEL_ERROR, p, format, ##__VA_ARGS__)
+#define LOG_DEBUG_SAMPLED(p, format, ...) \
+    CNANOLOG_LOG_SAMPLED(LOG_LEVEL_DEBUG, p, format, ##__VA_ARGS__)
+
+/* ============================================================================
+ * Timing Spans
+ *
+ * Measure a section of code: begin and end are entries through the normal
+ * staging path (timestamp from the entry header, the thread id as the one
+ * argument), about the cost of a one-argument log call each. Decode with
+ * "decompressor --trace" for Chrome / Perfetto trace JSON. Spans nest per
+ * thread; end every span on the thread that began it.
+ *
+ * Usage:
+ *   CNANOLOG_SPAN_BEGIN(parse, "parse order");
+ *   parse_order(msg);
+ *   CNANOLOG_SPAN_END(parse);
+ *
+ * C++: CNANOLOG_SPAN("parse order"); ends the span when the scope exits.
+ * ============================================================================ */
+
+static const uint8_t __cnanolog_span_arg_types[] = {ARG_TYPE_UINT32};
+
+/* Declares span (a handle for CNANOLOG_SPAN_END) and records the begin.
+ * name must be a string literal; span must be unique in its scope. */
+#define CNANOLOG_SPAN_BEGIN(span, name) \
+    static cnanolog_site_t __cnanolog_span_begin_##span CNANOLOG_SITE_ATTR = { \
+        UINT32_MAX, __LINE__, LOG_LEVEL_SPAN_BEGIN, 1, \
+        __FILE__, name, __cnanolog_span_arg_types, NULL \
+    }; \
+    static cnanolog_site_t __cnanolog_span_end_##span CNANOLOG_SITE_ATTR = { \
+        UINT32_MAX, __LINE__, LOG_LEVEL_SPAN_END, 1, \
+        __FILE__, name, __cnanolog_span_arg_types, NULL \
+    }; \
+    cnanolog_site_t* const span = \
+        (_cnanolog_span(CNANOLOG_SITE_ID(__cnanolog_span_begin_##span)), \
+         &__cnanolog_span_end_##span)
+
+#define CNANOLOG_SPAN_END(span) \
+    _cnanolog_span(CNANOLOG_SITE_ID(*(span)))
+
 /* ============================================================================
  * Statistics and Monitoring
  * ============================================================================ */
@@ -377,3 +905,29 @@ void _cnanolog_log_binary(uint32_t log_id,
 #ifdef __cplusplus
 }
 #endif
+
+#ifdef __cplusplus
+namespace cnanolog {
+
+/* Ends a span when it goes out of scope (see CNANOLOG_SPAN) */
+class ScopedSpan {
+public:
+    explicit ScopedSpan(cnanolog_site_t* end_site) : end_site_(end_site) {}
+    ~ScopedSpan() { CNANOLOG_SPAN_END(end_site_); }
+
+    ScopedSpan(const ScopedSpan&) = delete;
+    ScopedSpan& operator=(const ScopedSpan&) = delete;
+
+private:
+    cnanolog_site_t* end_site_;
+};
+
+}  /* namespace cnanolog */
+
+/* Span from here to the end of the enclosing scope (one per line) */
+#define CNANOLOG_SPAN(name) CNANOLOG_SPAN_AT_(__LINE__, name)
+#define CNANOLOG_SPAN_AT_(line, name) CNANOLOG_SPAN_AT__(line, name)
+#define CNANOLOG_SPAN_AT__(line, name) \
+    CNANOLOG_SPAN_BEGIN(__cnanolog_span_##line, name); \
+    cnanolog::ScopedSpan __cnanolog_span_guard_##line(__cnanolog_span_##line)
+#endif
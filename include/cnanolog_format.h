@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <stddef.h>
 #include <stdint.h>
 
 #ifdef __cplusplus
@@ -28,14 +29,27 @@ extern "C" {
 #define CNANOLOG_DICT_MAGIC 0x44494354  /* "DICT" in ASCII */
 
 #define CNANOLOG_VERSION_MAJOR 1
-#define CNANOLOG_VERSION_MINOR 0
+#define CNANOLOG_VERSION_MINOR 5
 
 /* ============================================================================
  * Limits
  * ============================================================================ */
 
 #define CNANOLOG_MAX_ARGS       50      /* Maximum arguments per log statement */
-#define CNANOLOG_MAX_ENTRY_SIZE 65535   /* Maximum size of entry data (uint16_t) */
+#define CNANOLOG_MAX_ENTRY_SIZE (1u << 20) /* Maximum size of entry data (1MB) */
+
+#define CNANOLOG_INTERN_MAX_LEN 64        /* Longest string kept in the intern table */
+
+/* Compressed argument data can exceed the packed size by its metadata
+ * (a nibble, window byte or string tag per argument) and by pre-interned
+ * strings, which are staged as a handle but written as text */
+#define CNANOLOG_MAX_COMPRESSED_SIZE \
+    (CNANOLOG_MAX_ENTRY_SIZE + CNANOLOG_MAX_ARGS * CNANOLOG_INTERN_MAX_LEN)
+
+/* data_length value meaning "varint length follows the entry header" */
+#define CNANOLOG_LENGTH_EXTENDED 0xFFFF
+#define CNANOLOG_MAX_INLINE_LENGTH 0xFFFE  /* Longest data_length stored inline */
+#define CNANOLOG_VARINT_MAX_BYTES 5         /* LEB128 encoding of a uint32_t */
 
 /* ============================================================================
  * Argument Type Codes
@@ -51,13 +65,27 @@ typedef enum {
     ARG_TYPE_STRING  = 6,   /* char*, const char* */
     ARG_TYPE_POINTER = 7,   /* void*, any pointer type */
     ARG_TYPE_CHAR    = 8,   /* char (for %c format specifier) */
+    ARG_TYPE_INTERNED = 9,  /* const cnanolog_string_t* (staged only; STRING in files) */
 } cnanolog_arg_type_t;
 
+/**
+ * Pre-interned string, returned by cnanolog_intern(). Logging a handle
+ * stages only the pointer; the writer thread reads the text.
+ */
+typedef struct cnanolog_string {
+    const char* str;
+    uint32_t len;
+} cnanolog_string_t;
+
 /* ============================================================================
  * File Header Flags
  * ============================================================================ */
 
 #define CNANOLOG_FLAG_HAS_TIMESTAMPS  0x00000001  /* Entries include timestamps */
+#define CNANOLOG_FLAG_HAS_SYNC_RECORDS 0x00000002 /* Entry stream contains clock sync records */
+#define CNANOLOG_FLAG_DOUBLE_XOR      0x00000004  /* Doubles XOR-encoded against the site's previous value */
+#define CNANOLOG_FLAG_INT_DELTA       0x00000008  /* Integers delta-encoded; history resets at sync records */
+#define CNANOLOG_FLAG_STRING_INTERN   0x00000010  /* Repeated strings written as intern table ids */
 
 /* ============================================================================
  * File Header (64 bytes)
@@ -69,17 +97,18 @@ typedef enum {
  */
 typedef struct {
     uint32_t magic;              /* Magic number: 0x4E414E4F ("NANO") */
-    uint16_t version_major;      /* Format version major (currently 1) */
-    uint16_t version_minor;      /* Format version minor (currently 0) */
+    uint16_t version_major;      /* Format version major (CNANOLOG_VERSION_MAJOR) */
+    uint16_t version_minor;      /* Format version minor (CNANOLOG_VERSION_MINOR) */
     uint64_t timestamp_frequency; /* CPU ticks per second (rdtsc frequency, 0 if timestamps disabled) */
     uint64_t start_timestamp;    /* rdtsc() value when logging started (0 if timestamps disabled) */
     int64_t  start_time_sec;     /* Unix epoch seconds when logging started */
     int32_t  start_time_nsec;    /* Nanoseconds component (0-999999999) */
     uint32_t endianness;         /* Always 0x01020304 for endian detection */
     uint64_t dictionary_offset;  /* Byte offset to dictionary (0 = end of file) */
-    uint32_t entry_count;        /* Total number of log entries written */
+    uint32_t entry_count;        /* Log entries written (low 32 bits) */
     uint32_t flags;              /* Feature flags (see CNANOLOG_FLAG_*) */
-    uint8_t  reserved[8];        /* Reserved for future use (must be 0) */
+    uint32_t frequency_uncertainty_ppb; /* Error of timestamp_frequency (0 = nominal/unknown) */
+    uint32_t entry_count_high;   /* Log entries written (high 32 bits, v1.2+) */
 } __attribute__((packed)) cnanolog_file_header_t;
 
 /* Compile-time size check */
@@ -92,7 +121,9 @@ CNANOLOG_STATIC_ASSERT(sizeof(cnanolog_file_header_t) == 64,
 
 /**
  * Header for each log entry in the file.
- * Followed by data_length bytes of argument data.
+ * Followed by data_length bytes of argument data. Data longer than
+ * CNANOLOG_MAX_INLINE_LENGTH sets data_length to CNANOLOG_LENGTH_EXTENDED
+ * and puts the real length in a LEB128 varint between header and data.
  *
  * Size depends on CNANOLOG_NO_TIMESTAMPS:
  * - With timestamps (default): 14 bytes (log_id + timestamp + data_length)
@@ -119,6 +150,73 @@ CNANOLOG_STATIC_ASSERT(sizeof(cnanolog_file_header_t) == 64,
                            "Entry header (with timestamps) must be exactly 14 bytes");
 #endif
 
+/* ============================================================================
+ * Clock Sync Record (24 bytes)
+ * ============================================================================ */
+
+/**
+ * log_id of clock sync records. They share the entry header (timestamp =
+ * counter value at the sync point) but are not counted in entry_count and
+ * have no dictionary entry.
+ */
+#define CNANOLOG_SYNC_LOG_ID 0xFFFFFFFE
+
+/**
+ * Data of a clock sync record: the system clocks read at the entry's
+ * timestamp. Decoders map timestamps by interpolating between sync points.
+ */
+typedef struct {
+    int64_t  real_sec;          /* CLOCK_REALTIME seconds */
+    int32_t  real_nsec;         /* CLOCK_REALTIME nanoseconds */
+    uint32_t reserved;          /* Reserved for future use (must be 0) */
+    uint64_t mono_ns;           /* CLOCK_MONOTONIC (nanoseconds) */
+} __attribute__((packed)) cnanolog_sync_record_t;
+
+/* Compile-time size check */
+CNANOLOG_STATIC_ASSERT(sizeof(cnanolog_sync_record_t) == 24,
+                       "Sync record must be exactly 24 bytes");
+
+/* ============================================================================
+ * Stream Records (network sinks)
+ * ============================================================================ */
+
+/**
+ * A network sink sends a file header followed by the entry stream of a
+ * file. The dictionaries cannot be appended on a socket, so sites and
+ * levels travel in-band as records with these log_ids, each ahead of the
+ * first entry that needs it. Receivers turn them back into dictionaries;
+ * they never appear in files.
+ */
+#define CNANOLOG_STREAM_SITE_LOG_ID  0xFFFFFFFD  /* cnanolog_dict_entry_t, filename, format */
+#define CNANOLOG_STREAM_LEVEL_LOG_ID 0xFFFFFFFC  /* cnanolog_level_dict_entry_t, name */
+#define CNANOLOG_STREAM_END_LOG_ID   0xFFFFFFFB  /* cnanolog_stream_end_t */
+
+/**
+ * Data of the last record of a stream: header fields known only at close.
+ */
+typedef struct {
+    uint64_t timestamp_frequency;       /* Final (refined) frequency */
+    uint32_t frequency_uncertainty_ppb; /* Its error */
+    uint32_t reserved;                  /* Reserved for future use (must be 0) */
+} __attribute__((packed)) cnanolog_stream_end_t;
+
+/* Compile-time size check */
+CNANOLOG_STATIC_ASSERT(sizeof(cnanolog_stream_end_t) == 16,
+                       "Stream end record must be exactly 16 bytes");
+
+/* ============================================================================
+ * Span Sites
+ * ============================================================================ */
+
+/**
+ * Begin and end records of timing spans are ordinary entries of sites at
+ * these reserved levels. The site format is the span name; the single
+ * ARG_TYPE_UINT32 argument is the id of the logging thread, so decoders
+ * pair each end with the latest open begin of the same thread.
+ */
+#define CNANOLOG_LEVEL_SPAN_BEGIN 253
+#define CNANOLOG_LEVEL_SPAN_END   254
+
 /* ============================================================================
  * Dictionary Header (16 bytes)
  * ============================================================================ */
@@ -212,6 +310,53 @@ CNANOLOG_STATIC_ASSERT(sizeof(cnanolog_level_dict_entry_t) == 4,
 #define CNANOLOG_DICT_ENTRY_TOTAL_SIZE(filename_len, format_len) \
     (sizeof(cnanolog_dict_entry_t) + (filename_len) + (format_len))
 
+/* ============================================================================
+ * Entry Count and Length Helpers
+ * ============================================================================ */
+
+/**
+ * Full 64-bit entry count (entry_count_high is 0 in files before v1.2).
+ */
+static inline uint64_t cnanolog_header_entry_count(const cnanolog_file_header_t* header) {
+    return ((uint64_t)header->entry_count_high << 32) | header->entry_count;
+}
+
+static inline void cnanolog_header_set_entry_count(cnanolog_file_header_t* header,
+                                                   uint64_t count) {
+    header->entry_count = (uint32_t)count;
+    header->entry_count_high = (uint32_t)(count >> 32);
+}
+
+/**
+ * LEB128-encode an extended data length.
+ * Returns the number of bytes written (at most CNANOLOG_VARINT_MAX_BYTES).
+ */
+static inline size_t cnanolog_varint_encode(uint32_t value, uint8_t* out) {
+    size_t n = 0;
+    while (value >= 0x80) {
+        out[n++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[n++] = (uint8_t)value;
+    return n;
+}
+
+/**
+ * Decode a LEB128 length.
+ * Returns the number of bytes consumed, or 0 if truncated or too long.
+ */
+static inline size_t cnanolog_varint_decode(const uint8_t* in, size_t avail, uint32_t* value) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < avail && i < CNANOLOG_VARINT_MAX_BYTES; i++) {
+        result |= (uint32_t)(in[i] & 0x7F) << (7 * i);
+        if ((in[i] & 0x80) == 0) {
+            *value = result;
+            return i + 1;
+        }
+    }
+    return 0;
+}
+
 /* ============================================================================
  * Validation Functions
  * ============================================================================ */
@@ -60,6 +60,12 @@
                     return sizeof(U) <= 4 ? ARG_TYPE_UINT32 : ARG_TYPE_UINT64;
                 }
 
+                // Pre-interned strings
+                if (std::is_same<U, cnanolog_string_t*>::value ||
+                    std::is_same<U, const cnanolog_string_t*>::value) {
+                    return ARG_TYPE_INTERNED;
+                }
+
                 // Pointers
                 if (std::is_pointer<U>::value) {
                     return ARG_TYPE_POINTER;
@@ -116,6 +122,9 @@ extern "C" {  /* Re-open extern "C" for remaining content */
             char*:              ARG_TYPE_STRING, \
             const char*:        ARG_TYPE_STRING, \
             \
+            cnanolog_string_t*:       ARG_TYPE_INTERNED, \
+            const cnanolog_string_t*: ARG_TYPE_INTERNED, \
+            \
             default:            ARG_TYPE_POINTER)
     #else
         #define CNANOLOG_HAS_GENERIC 0
@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""
+CNanoLog Benchmark Comparison
+
+Compares two JSON result files of benchmark_suite (e.g. the parent commit
+and this one) scenario by scenario and flags regressions.
+
+Usage:
+    ./scripts/compare_benchmarks.py base.json new.json [--threshold PCT]
+                                    [--metrics p50,p99,...] [--all]
+
+A scenario regresses when a latency percentile or the writer CPU grows,
+or the throughput falls, by more than the threshold (default 10%), or
+its drop rate rises. Exits 1 if any scenario regressed, so it can gate CI.
+Latencies under --floor ns (default 20) are ignored: a few ns of noise
+on a 60ns call is not a regression.
+"""
+
+import argparse
+import json
+import sys
+
+# Metric name -> (getter, higher is better)
+METRICS = {
+    "p50": (lambda r: r["latency_ns"]["p50"], False),
+    "p90": (lambda r: r["latency_ns"]["p90"], False),
+    "p99": (lambda r: r["latency_ns"]["p99"], False),
+    "p99.9": (lambda r: r["latency_ns"]["p99.9"], False),
+    "p99.99": (lambda r: r["latency_ns"]["p99.99"], False),
+    "max": (lambda r: r["latency_ns"]["max"], False),
+    "throughput": (lambda r: r["throughput_per_sec"], True),
+    "writer_cpu": (lambda r: r["writer_cpu"], False),
+}
+
+LATENCY_METRICS = {"p50", "p90", "p99", "p99.9", "p99.99", "max"}
+DEFAULT_METRICS = "p50,p99,p99.9,throughput"
+
+
+def load(path):
+    with open(path) as f:
+        data = json.load(f)
+    return data, {r["name"]: r for r in data["results"]}
+
+
+def change(old, new):
+    if old == 0:
+        return 0.0 if new == 0 else float("inf")
+    return (new - old) * 100.0 / old
+
+
+def fmt(value):
+    if isinstance(value, float) and value < 10:
+        return "%.3f" % value
+    return "{:,.0f}".format(value)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare benchmark_suite JSON results")
+    parser.add_argument("base")
+    parser.add_argument("new")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="percent change that counts as a regression (default 10)")
+    parser.add_argument("--metrics", default=DEFAULT_METRICS,
+                        help="metrics to compare (default %s; also p90, p99.99, max, writer_cpu)"
+                        % DEFAULT_METRICS)
+    parser.add_argument("--floor", type=float, default=20.0,
+                        help="ignore latency changes below this many ns (default 20)")
+    parser.add_argument("--all", action="store_true",
+                        help="list every scenario, not only the changed ones")
+    args = parser.parse_args()
+
+    metrics = [m.strip() for m in args.metrics.split(",") if m.strip()]
+    for m in metrics:
+        if m not in METRICS:
+            parser.error("unknown metric %s" % m)
+
+    base_data, base = load(args.base)
+    new_data, new = load(args.new)
+    print("base: %s (%s CPUs)   new: %s (%s CPUs)   threshold %.1f%%" % (
+        base_data.get("label") or args.base, base_data.get("cpus", "?"),
+        new_data.get("label") or args.new, new_data.get("cpus", "?"), args.threshold))
+    if base_data.get("cpus") != new_data.get("cpus"):
+        print("warning: different CPU counts, results are not comparable")
+    print()
+
+    header = "%-32s %-11s %14s %14s %9s" % ("scenario", "metric", "base", "new", "change")
+    print(header)
+    print("-" * len(header))
+
+    regressions = 0
+    improvements = 0
+    for name in sorted(set(base) & set(new)):
+        b, n = base[name], new[name]
+        lines = []
+        regressed = False
+        for m in metrics:
+            get, higher_better = METRICS[m]
+            old_value, new_value = get(b), get(n)
+            pct = change(old_value, new_value)
+            worse = -pct if higher_better else pct
+            if m in LATENCY_METRICS and abs(new_value - old_value) < args.floor:
+                worse = 0.0
+            mark = ""
+            if worse > args.threshold:
+                mark = "  REGRESSED"
+                regressed = True
+            elif worse < -args.threshold:
+                mark = "  improved"
+                improvements += 1
+            if mark or args.all:
+                lines.append("%-32s %-11s %14s %14s %+8.1f%%%s" % (
+                    name, m, fmt(old_value), fmt(new_value), pct, mark))
+
+        if n["drop_rate"] > b["drop_rate"]:
+            lines.append("%-32s %-11s %14.6f %14.6f %9s  REGRESSED" % (
+                name, "drop_rate", b["drop_rate"], n["drop_rate"], ""))
+            regressed = True
+
+        for line in lines:
+            print(line)
+        if regressed:
+            regressions += 1
+
+    only_base = sorted(set(base) - set(new))
+    only_new = sorted(set(new) - set(base))
+    if only_base:
+        print("\nonly in base: %s" % ", ".join(only_base))
+    if only_new:
+        print("\nonly in new: %s" % ", ".join(only_new))
+
+    print("\n%d scenario(s) regressed, %d metric(s) improved, %d compared" % (
+        regressions, improvements, len(set(base) & set(new))))
+    return 1 if regressions > 0 else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
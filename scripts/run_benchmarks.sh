@@ -11,6 +11,8 @@
 #   extreme     - Run extreme scale benchmark (10GB+, takes hours)
 #   multithreaded - Include multi-threaded tests
 #   specific <scale> - Run specific scale only
+#   suite       - Run benchmark_suite (HDR percentiles, JSON results);
+#                 compare runs with scripts/compare_benchmarks.py
 #
 
 set -e
@@ -51,6 +53,10 @@ while [[ $# -gt 0 ]]; do
             MODE="extreme"
             shift
             ;;
+        suite)
+            MODE="suite"
+            shift
+            ;;
         multithreaded)
             MT_FLAG="--multithreaded"
             shift
@@ -72,6 +78,7 @@ while [[ $# -gt 0 ]]; do
             echo "  quick         - Small to Large scales (default)"
             echo "  full          - Small to Huge scales"
             echo "  extreme       - All scales including Extreme (10GB+)"
+            echo "  suite         - Benchmark suite, 1-64 threads, JSON results"
             echo ""
             echo "Options:"
             echo "  multithreaded - Include multi-threaded tests"
@@ -85,6 +92,7 @@ while [[ $# -gt 0 ]]; do
             echo "  $0 full multithreaded       # Full with MT tests"
             echo "  $0 specific Medium          # Just medium scale"
             echo "  $0 extreme --threads 8      # Extreme with 8 threads"
+            echo "  $0 suite                    # Suite, compare with compare_benchmarks.py"
             exit 0
             ;;
         *)
@@ -116,6 +124,10 @@ case $MODE in
         sleep 5
         CMD="$CMD --extreme"
         ;;
+    suite)
+        echo -e "${GREEN}Running benchmark SUITE${NC}"
+        echo -e "${BLUE}Threads 1-64, all workloads, binary and text, max and fixed rate${NC}"
+        ;;
 esac
 
 if [ -n "$MT_FLAG" ]; then
@@ -136,6 +148,16 @@ mkdir -p benchmark_results
 TIMESTAMP=$(date +%Y%m%d_%H%M%S)
 RESULT_FILE="benchmark_results/results_${TIMESTAMP}.txt"
 
+if [ "$MODE" = "suite" ]; then
+    JSON_FILE="benchmark_results/suite_${TIMESTAMP}.json"
+    LABEL=$(git rev-parse --short HEAD 2>/dev/null || echo "")
+    ./build/tests/benchmark_suite --full --json "$JSON_FILE" --label "$LABEL" 2>&1 | tee "$RESULT_FILE"
+    echo ""
+    echo -e "JSON results: ${BLUE}$JSON_FILE${NC}"
+    echo "Compare with: ./scripts/compare_benchmarks.py <older>.json $JSON_FILE"
+    exit 0
+fi
+
 # Run benchmark and save results
 $CMD 2>&1 | tee "$RESULT_FILE"
 
@@ -102,6 +102,15 @@ static inline size_t arg_pack_write_fast(char* buffer, size_t buffer_size,
                 write_ptr += sizeof(val);
                 break;
             }
+            case ARG_TYPE_INTERNED: {
+                /* Only the handle: the writer thread reads the text */
+                const cnanolog_string_t* handle = va_arg(args, const cnanolog_string_t*);
+                uint64_t val = (uint64_t)(uintptr_t)handle;
+                if (write_ptr + sizeof(val) > buffer_end) return 0;
+                memcpy(write_ptr, &val, sizeof(val));
+                write_ptr += sizeof(val);
+                break;
+            }
             default:
                 break;
         }
@@ -110,6 +119,61 @@ static inline size_t arg_pack_write_fast(char* buffer, size_t buffer_size,
     return (size_t)(write_ptr - buffer);
 }
 
+/**
+ * Exact number of bytes arg_pack_write_fast() writes for these arguments.
+ * Used to stage entries too large for the pessimistic string reservation.
+ */
+static inline size_t arg_pack_size(uint8_t num_args, const uint8_t* arg_types,
+                                   va_list args) {
+    size_t size = 0;
+
+    for (uint8_t i = 0; i < num_args; i++) {
+        switch (arg_types[i]) {
+            case ARG_TYPE_CHAR:
+                (void)va_arg(args, int);
+                size += 1;
+                break;
+            case ARG_TYPE_INT32:
+                (void)va_arg(args, int32_t);
+                size += 4;
+                break;
+            case ARG_TYPE_UINT32:
+                (void)va_arg(args, uint32_t);
+                size += 4;
+                break;
+            case ARG_TYPE_INT64:
+                (void)va_arg(args, int64_t);
+                size += 8;
+                break;
+            case ARG_TYPE_UINT64:
+                (void)va_arg(args, uint64_t);
+                size += 8;
+                break;
+            case ARG_TYPE_DOUBLE:
+                (void)va_arg(args, double);
+                size += 8;
+                break;
+            case ARG_TYPE_STRING: {
+                const char* str = va_arg(args, const char*);
+                size += sizeof(uint32_t) + (str ? strlen(str) : 0);
+                break;
+            }
+            case ARG_TYPE_POINTER:
+                (void)va_arg(args, void*);
+                size += 8;
+                break;
+            case ARG_TYPE_INTERNED:
+                (void)va_arg(args, const cnanolog_string_t*);
+                size += 8;
+                break;
+            default:
+                break;
+        }
+    }
+
+    return size;
+}
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,292 @@
+/* Copyright (c) 2025
+ * CNanoLog Async File Writer Implementation
+ *
+ * Uses POSIX AIO (Asynchronous I/O) to eliminate blocking:
+ * - aio_write() returns immediately (non-blocking)
+ * - Kernel handles I/O in background
+ * - Background thread never blocks on I/O
+ * - No cache coherency delays → consistent low latency
+ */
+
+#include "async_writer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#ifndef _WIN32
+#include <unistd.h>  /* For pwrite() */
+#endif
+
+/* ============================================================================
+ * Internal Helper Functions
+ * ============================================================================ */
+
+/**
+ * Write all bytes at an explicit offset (synchronous, async-signal-safe).
+ * Explicit offsets keep direct writes consistent with AIO writes, which never
+ * move the descriptor's file position.
+ */
+static int write_all_at(int fd, const char* data, size_t len, uint64_t offset) {
+#ifndef _WIN32
+    while (len > 0) {
+        ssize_t written = pwrite(fd, data, len, (off_t)offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        len -= (size_t)written;
+        offset += (uint64_t)written;
+    }
+    return 0;
+#else
+    (void)fd; (void)data; (void)len; (void)offset;
+    return -1;
+#endif
+}
+
+static int write_at(int fd, const char* data, size_t len, uint64_t offset) {
+    if (write_all_at(fd, data, len, offset) != 0) {
+        fprintf(stderr, "async_writer: write failed: %s\n", strerror(errno));
+        return -1;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * Lifecycle
+ * ============================================================================ */
+
+int async_writer_init(async_writer_t* writer, size_t buffer_size) {
+    memset(writer, 0, sizeof(*writer));
+    writer->fd = -1;
+
+    writer->buffers[0] = (char*)malloc(buffer_size);
+    writer->buffers[1] = (char*)malloc(buffer_size);
+    if (writer->buffers[0] == NULL || writer->buffers[1] == NULL) {
+        fprintf(stderr, "async_writer: buffer malloc failed\n");
+        free(writer->buffers[0]);
+        free(writer->buffers[1]);
+        writer->buffers[0] = NULL;
+        writer->buffers[1] = NULL;
+        return -1;
+    }
+
+    writer->buffer_size = buffer_size;
+    return 0;
+}
+
+void async_writer_attach(async_writer_t* writer, int fd, uint64_t offset) {
+    writer->fd = fd;
+    writer->offset = offset;
+    writer->used = 0;
+    writer->active_idx = 0;
+    writer->has_outstanding_aio = 0;
+}
+
+void async_writer_destroy(async_writer_t* writer) {
+    if (writer == NULL) {
+        return;
+    }
+    async_writer_wait(writer);
+    free(writer->buffers[0]);
+    free(writer->buffers[1]);
+    writer->buffers[0] = NULL;
+    writer->buffers[1] = NULL;
+}
+
+/* ============================================================================
+ * Writing
+ * ============================================================================ */
+
+int async_writer_wait(async_writer_t* writer) {
+#ifdef _WIN32
+    (void)writer;
+    return 0;  /* Windows doesn't support POSIX AIO */
+#else
+    if (!writer->has_outstanding_aio) {
+        return 0;  /* No outstanding operation */
+    }
+
+    /* Check if still in progress */
+    int err = aio_error(&writer->aiocb);
+    while (err == EINPROGRESS) {
+        /* Wait for completion */
+        const struct aiocb* aiocb_list[] = {&writer->aiocb};
+        if (aio_suspend(aiocb_list, 1, NULL) != 0 && errno != EINTR) {
+            perror("async_writer: aio_suspend failed");
+            return -1;
+        }
+        err = aio_error(&writer->aiocb);
+    }
+
+    /* Get result */
+    ssize_t ret = aio_return(&writer->aiocb);
+    writer->has_outstanding_aio = 0;
+    if (err != 0) {
+        fprintf(stderr, "async_writer: POSIX AIO failed with %d: %s\n",
+                err, strerror(err));
+        return -1;
+    }
+    if (ret < 0) {
+        perror("async_writer: AIO write operation failed");
+        return -1;
+    }
+
+    /* Short write: finish the remainder synchronously */
+    if ((size_t)ret < writer->aiocb.aio_nbytes) {
+        return write_at(writer->fd,
+                        (const char*)writer->aiocb.aio_buf + ret,
+                        writer->aiocb.aio_nbytes - (size_t)ret,
+                        (uint64_t)writer->aiocb.aio_offset + (uint64_t)ret);
+    }
+
+    return 0;
+#endif
+}
+
+int async_writer_flush(async_writer_t* writer) {
+    if (writer->used == 0) {
+        return 0;  /* Nothing to flush */
+    }
+
+    if (writer->sync_only) {
+        /* Crash flush: no AIO, no stdio */
+        if (write_all_at(writer->fd, writer->buffers[writer->active_idx],
+                         writer->used, writer->offset) != 0) {
+            return -1;
+        }
+        writer->offset += writer->used;
+        writer->used = 0;
+        return 0;
+    }
+
+#if defined(__linux__)
+    /* Wait for any previous AIO to complete before starting new write */
+    if (async_writer_wait(writer) != 0) {
+        return -1;
+    }
+
+    /* Start async write of current buffer */
+    memset(&writer->aiocb, 0, sizeof(writer->aiocb));
+    writer->aiocb.aio_fildes = writer->fd;
+    writer->aiocb.aio_buf = writer->buffers[writer->active_idx];
+    writer->aiocb.aio_nbytes = writer->used;
+    writer->aiocb.aio_offset = (off_t)writer->offset;
+
+    if (aio_write(&writer->aiocb) == -1) {
+        fprintf(stderr, "async_writer: aio_write failed: %s\n", strerror(errno));
+        return -1;
+    }
+
+    writer->has_outstanding_aio = 1;
+    writer->offset += writer->used;
+
+    /* Swap to other buffer */
+    writer->active_idx = 1 - writer->active_idx;
+    writer->used = 0;
+
+    return 0;
+
+#else
+    /* macOS/Windows: Fallback to synchronous write */
+    if (write_at(writer->fd, writer->buffers[writer->active_idx],
+                 writer->used, writer->offset) != 0) {
+        return -1;
+    }
+
+    writer->offset += writer->used;
+    writer->used = 0;
+    return 0;
+#endif
+}
+
+int async_writer_crash_flush(async_writer_t* writer, uint64_t deadline_ns) {
+    int result = 0;
+
+#ifndef _WIN32
+    if (writer->has_outstanding_aio) {
+        struct timespec now;
+        int err = aio_error(&writer->aiocb);
+        while (err == EINPROGRESS) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if ((uint64_t)now.tv_sec * 1000000000ULL + (uint64_t)now.tv_nsec >= deadline_ns) {
+                break;
+            }
+            struct timespec pause = {0, 100000};  /* 100us */
+            nanosleep(&pause, NULL);
+            err = aio_error(&writer->aiocb);
+        }
+
+        /* Short write: only the rest is missing. Unfinished or failed: write
+         * the whole buffer at its offset (the same bytes at the same place,
+         * so harmless if the AIO still lands later) */
+        ssize_t done = 0;
+        if (err == 0) {
+            done = aio_return(&writer->aiocb);
+            if (done < 0) {
+                done = 0;
+            }
+        }
+        if ((size_t)done < writer->aiocb.aio_nbytes) {
+            if (write_all_at(writer->fd, (const char*)writer->aiocb.aio_buf + done,
+                             writer->aiocb.aio_nbytes - (size_t)done,
+                             (uint64_t)writer->aiocb.aio_offset + (uint64_t)done) != 0) {
+                result = -1;
+            }
+        }
+        writer->has_outstanding_aio = 0;
+    }
+#else
+    (void)deadline_ns;
+#endif
+
+    writer->sync_only = 1;
+    if (async_writer_flush(writer) != 0) {
+        result = -1;
+    }
+    return result;
+}
+
+int async_writer_sync(async_writer_t* writer) {
+    if (async_writer_flush(writer) != 0) {
+        return -1;
+    }
+    return async_writer_wait(writer);
+}
+
+int async_writer_write_direct(async_writer_t* writer, const void* data, size_t len) {
+    /* Everything buffered so far must land first */
+    if (async_writer_sync(writer) != 0) {
+        return -1;
+    }
+
+    if (write_at(writer->fd, (const char*)data, len, writer->offset) != 0) {
+        return -1;
+    }
+
+    writer->offset += len;
+    return 0;
+}
+
+int async_writer_write(async_writer_t* writer, const void* data, size_t len) {
+    if (data == NULL) {
+        return -1;
+    }
+
+    /* If data is larger than buffer, write directly */
+    if (len > writer->buffer_size) {
+        return async_writer_write_direct(writer, data, len);
+    }
+
+    char* dst = async_writer_reserve(writer, len);
+    if (dst == NULL) {
+        return -1;
+    }
+    memcpy(dst, data, len);
+    async_writer_commit(writer, len);
+    return 0;
+}
@@ -0,0 +1,170 @@
+/* Copyright (c) 2025
+ * CNanoLog Async File Writer
+ *
+ * Double-buffered file output shared by the binary and text writers.
+ * Callers fill the active buffer (copy or reserve/commit in place); a full
+ * buffer is handed to POSIX AIO and the other buffer becomes active, so the
+ * writer thread never blocks on the disk unless both buffers are in flight.
+ * Platforms without POSIX AIO fall back to synchronous writes.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#ifndef _WIN32
+#include <aio.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Types
+ * ============================================================================ */
+
+/**
+ * Async writer state. Embedded by value in the writers that use it so the
+ * reserve/commit fast path stays inline.
+ */
+typedef struct {
+    int fd;                     /* Target file descriptor (-1 = none) */
+
+    /* Double buffering */
+    char* buffers[2];           /* Buffer A and Buffer B */
+    int active_idx;             /* Index of the buffer being filled */
+    size_t used;                /* Bytes used in the active buffer */
+    size_t buffer_size;         /* Size of each buffer */
+
+#ifndef _WIN32
+    struct aiocb aiocb;         /* AIO control block for the in-flight buffer */
+#endif
+    int has_outstanding_aio;    /* Flag: AIO operation in progress */
+    int sync_only;              /* Write synchronously (after a crash flush) */
+
+    uint64_t offset;            /* File offset of the active buffer's first byte */
+} async_writer_t;
+
+/* ============================================================================
+ * Lifecycle
+ * ============================================================================ */
+
+/**
+ * Allocate both buffers. The writer has no file until async_writer_attach().
+ *
+ * @param writer Writer to initialize
+ * @param buffer_size Size of each of the two buffers
+ * @return 0 on success, -1 on allocation failure
+ */
+int async_writer_init(async_writer_t* writer, size_t buffer_size);
+
+/**
+ * Start writing to a file descriptor at the given offset.
+ * Any previous file must have been drained with async_writer_sync().
+ *
+ * @param writer Writer
+ * @param fd Open file descriptor (ownership stays with the caller)
+ * @param offset File offset for the next byte written
+ */
+void async_writer_attach(async_writer_t* writer, int fd, uint64_t offset);
+
+/**
+ * Wait for in-flight I/O and release the buffers. Does not close the fd.
+ */
+void async_writer_destroy(async_writer_t* writer);
+
+/* ============================================================================
+ * Writing
+ * ============================================================================ */
+
+/**
+ * Copy data into the active buffer, submitting it first if it is full.
+ * Data larger than a buffer is written synchronously.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int async_writer_write(async_writer_t* writer, const void* data, size_t len);
+
+/**
+ * Write data synchronously at the current position, after everything
+ * buffered so far. Used for headers and oversized records.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int async_writer_write_direct(async_writer_t* writer, const void* data, size_t len);
+
+/**
+ * Submit the active buffer (non-blocking) and swap to the other buffer.
+ * Waits only if the other buffer is still in flight.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int async_writer_flush(async_writer_t* writer);
+
+/**
+ * Wait for the in-flight buffer (if any) to reach the kernel.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int async_writer_wait(async_writer_t* writer);
+
+/**
+ * Flush and wait: on return every byte written so far is in the file.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int async_writer_sync(async_writer_t* writer);
+
+/**
+ * Async-signal-safe flush for crash handlers (no malloc, no stdio).
+ * Waits for the in-flight buffer until the deadline, then rewrites it
+ * synchronously (same bytes at the same offset), writes the active
+ * buffer, and makes every later flush synchronous.
+ *
+ * @param deadline_ns CLOCK_MONOTONIC deadline in nanoseconds
+ * @return 0 on success, -1 on failure
+ */
+int async_writer_crash_flush(async_writer_t* writer, uint64_t deadline_ns);
+
+/**
+ * Reserve space for up to max_len bytes in the active buffer, submitting
+ * the buffer first if it cannot fit. Follow with async_writer_commit().
+ *
+ * @param max_len Upper bound on bytes that will be committed
+ *                (must not exceed buffer_size)
+ * @return Pointer to write into, or NULL on failure
+ */
+static inline char* async_writer_reserve(async_writer_t* writer, size_t max_len) {
+    if (writer->used + max_len > writer->buffer_size) {
+        if (max_len > writer->buffer_size || async_writer_flush(writer) != 0) {
+            return NULL;
+        }
+    }
+    return writer->buffers[writer->active_idx] + writer->used;
+}
+
+/**
+ * Commit bytes written into the space returned by async_writer_reserve().
+ */
+static inline void async_writer_commit(async_writer_t* writer, size_t len) {
+    writer->used += len;
+}
+
+/* ============================================================================
+ * Queries
+ * ============================================================================ */
+
+/** Bytes handed to the kernel (submitted or written) so far. */
+static inline uint64_t async_writer_submitted(const async_writer_t* writer) {
+    return writer->offset;
+}
+
+/** Bytes waiting in the active buffer. */
+static inline size_t async_writer_buffered(const async_writer_t* writer) {
+    return writer->used;
+}
+
+#ifdef __cplusplus
+}
+#endif
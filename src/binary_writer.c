@@ -1,15 +1,15 @@
 /* Copyright (c) 2025
  * CNanoLog Binary Writer Implementation
  *
- * Uses POSIX AIO (Asynchronous I/O) to eliminate blocking:
- * - aio_write() returns immediately (non-blocking)
- * - Kernel handles I/O in background
- * - Background thread never blocks on I/O
- * - No cache coherency delays → consistent low latency
+ * Entries are appended to an async_writer double buffer (POSIX AIO), so the
+ * background thread does not block on disk I/O. The header is patched and
+ * the dictionary appended at close/rotation.
  */
 
 #include "binary_writer.h"
+#include "async_writer.h"
 #include "log_registry.h"
+#include "platform.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -17,7 +17,6 @@
 #ifndef _WIN32
 #include <unistd.h>  /* For fsync(), close() */
 #include <fcntl.h>   /* For open() */
-#include <aio.h>     /* For POSIX AIO */
 #endif
 
 /* ============================================================================
@@ -28,162 +27,31 @@ struct binary_writer {
     int fd;                     /* File descriptor (for AIO) */
     FILE* fp;                   /* File handle (for header/dictionary updates) */
 
-    /* Double buffering for async I/O */
-    char* buffers[2];           /* Buffer A and Buffer B */
-    int active_buffer_idx;      /* Index of currently active buffer (0 or 1) */
-    size_t buffer_used;         /* Bytes used in active buffer */
-    size_t buffer_size;         /* Size of each buffer */
+    async_writer_t io;          /* Double-buffered async output */
 
-    /* POSIX AIO state */
-    struct aiocb aiocb;         /* AIO control block */
-    int has_outstanding_aio;    /* Flag: AIO operation in progress */
-
-    uint32_t entries_written;   /* Number of log entries written */
-    uint64_t bytes_written;     /* Total bytes written to disk */
+    uint64_t entries_written;   /* Number of log entries written */
     uint64_t header_offset;     /* File offset of header (always 0) */
+
+    uint64_t timestamp_frequency;       /* Written into the header on close */
+    uint32_t frequency_uncertainty_ppb;
+    uint32_t extra_flags;               /* Header flags learned while writing */
+
+    cnanolog_file_header_t header;      /* As written (patched by crash close) */
 };
 
 /* ============================================================================
  * Internal Helper Functions
  * ============================================================================ */
 
-/**
- * Check and wait for any outstanding AIO operation to complete.
- * Returns 0 on success, -1 on failure.
- */
-static int wait_for_aio(binary_writer_t* writer) {
-#ifdef _WIN32
-    return 0;  /* Windows doesn't support POSIX AIO */
-#else
-    if (!writer->has_outstanding_aio) {
-        return 0;  /* No outstanding operation */
-    }
-
-    /* Check if still in progress */
-    int err = aio_error(&writer->aiocb);
-    if (err == EINPROGRESS) {
-        /* Wait for completion */
-        const struct aiocb* aiocb_list[] = {&writer->aiocb};
-        if (aio_suspend(aiocb_list, 1, NULL) != 0) {
-            perror("binwriter: aio_suspend failed");
-            return -1;
-        }
-        err = aio_error(&writer->aiocb);
-    }
-
-    /* Get result */
-    ssize_t ret = aio_return(&writer->aiocb);
-    if (err != 0) {
-        fprintf(stderr, "binwriter: POSIX AIO failed with %d: %s\n",
-                err, strerror(err));
-        return -1;
-    }
-    if (ret < 0) {
-        perror("binwriter: AIO write operation failed");
-        return -1;
-    }
-
-    writer->has_outstanding_aio = 0;
-    return 0;
-#endif
-}
-
-/**
- * Initiate async write of active buffer.
- * Returns 0 on success, -1 on failure.
- */
-static int async_flush_buffer(binary_writer_t* writer) {
-    if (writer->buffer_used == 0) {
-        return 0;  /* Nothing to flush */
-    }
-
-#if defined(__linux__)
-    /* Wait for any previous AIO to complete before starting new write */
-    if (wait_for_aio(writer) != 0) {
-        return -1;
-    }
-
-    /* Start async write of current buffer */
-    memset(&writer->aiocb, 0, sizeof(writer->aiocb));
-    writer->aiocb.aio_fildes = writer->fd;
-    writer->aiocb.aio_buf = writer->buffers[writer->active_buffer_idx];
-    writer->aiocb.aio_nbytes = writer->buffer_used;
-    writer->aiocb.aio_offset = writer->bytes_written;
-
-    if (aio_write(&writer->aiocb) == -1) {
-        fprintf(stderr, "binwriter: aio_write failed: %s\n", strerror(errno));
-        return -1;
-    }
-
-    writer->has_outstanding_aio = 1;
-    writer->bytes_written += writer->buffer_used;
-
-    /* Swap to other buffer */
-    writer->active_buffer_idx = 1 - writer->active_buffer_idx;
-    writer->buffer_used = 0;
-
-    return 0;
-
-#else
-    /* macOS/Windows: Fallback to synchronous write() */
-    ssize_t written = write(writer->fd, writer->buffers[writer->active_buffer_idx],
-                           writer->buffer_used);
-    if (written != (ssize_t)writer->buffer_used) {
-        fprintf(stderr, "binwriter: write failed: %s\n", strerror(errno));
-        return -1;
-    }
-
-    writer->bytes_written += written;
-    writer->buffer_used = 0;
-    return 0;
-#endif
-}
-
 /**
  * Write data to the buffer, flushing if necessary.
  * Returns 0 on success, -1 on failure.
  */
-static int buffer_write(binary_writer_t* writer, const void* data, size_t len) {
+static inline int buffer_write(binary_writer_t* writer, const void* data, size_t len) {
     if (writer == NULL || data == NULL) {
         return -1;
     }
-
-    /* If data is larger than buffer, flush and write directly */
-    if (len > writer->buffer_size) {
-        /* Flush existing buffer first */
-        if (writer->buffer_used > 0) {
-            if (async_flush_buffer(writer) != 0) {
-                return -1;
-            }
-        }
-
-        /* Wait for AIO to complete, then write large data synchronously */
-        if (wait_for_aio(writer) != 0) {
-            return -1;
-        }
-
-        ssize_t written = write(writer->fd, data, len);
-        if (written != (ssize_t)len) {
-            fprintf(stderr, "binwriter: write failed: %s\n", strerror(errno));
-            return -1;
-        }
-        writer->bytes_written += written;
-        return 0;
-    }
-
-    /* If data doesn't fit in buffer, flush first */
-    if (writer->buffer_used + len > writer->buffer_size) {
-        if (async_flush_buffer(writer) != 0) {
-            return -1;
-        }
-    }
-
-    /* Copy to active buffer */
-    memcpy(writer->buffers[writer->active_buffer_idx] + writer->buffer_used,
-           data, len);
-    writer->buffer_used += len;
-
-    return 0;
+    return async_writer_write(&writer->io, data, len);
 }
 
 /**
@@ -201,10 +69,12 @@ static int write_dict_entry(binary_writer_t* writer, const log_site_t* site) {
     entry.format_length = (uint16_t)strlen(site->format);
     entry.line_number = site->line_number;
 
-    /* Copy argument types */
+    /* Copy argument types (pre-interned strings are written as strings) */
     memset(entry.arg_types, 0, sizeof(entry.arg_types));
     for (int i = 0; i < site->num_args && i < CNANOLOG_MAX_ARGS; i++) {
-        entry.arg_types[i] = (uint8_t)site->arg_types[i];
+        entry.arg_types[i] = (site->arg_types[i] == ARG_TYPE_INTERNED)
+                                 ? (uint8_t)ARG_TYPE_STRING
+                                 : (uint8_t)site->arg_types[i];
     }
 
     /* Write fixed part */
@@ -275,6 +145,68 @@ static int write_level_dict(binary_writer_t* writer,
     return 0;
 }
 
+/**
+ * Write the level and log site dictionaries at the current position and
+ * flush them. Stores the dictionary's file offset in *dict_offset.
+ * Uses no stdio or malloc (shared with the crash path).
+ * Returns 0 on success, -1 on failure.
+ */
+static int write_dictionaries(binary_writer_t* writer,
+                              const log_site_t* sites,
+                              uint32_t num_sites,
+                              const custom_level_entry_t* custom_levels,
+                              uint32_t num_custom_levels,
+                              uint64_t* dict_offset) {
+    /* Dictionary starts at current write position */
+    *dict_offset = async_writer_submitted(&writer->io) + async_writer_buffered(&writer->io);
+
+    /* Write level dictionary first (if custom levels exist) */
+    if (write_level_dict(writer, custom_levels, num_custom_levels) != 0) {
+        return -1;
+    }
+
+    /* Write log site dictionary header */
+    cnanolog_dict_header_t dict_header;
+    dict_header.magic = CNANOLOG_DICT_MAGIC;
+    dict_header.num_entries = num_sites;
+    dict_header.total_size = sizeof(dict_header);
+    dict_header.reserved = 0;
+
+    /* Calculate total dictionary size */
+    for (uint32_t i = 0; i < num_sites; i++) {
+        dict_header.total_size += sizeof(cnanolog_dict_entry_t);
+        dict_header.total_size += (uint32_t)strlen(sites[i].filename);
+        dict_header.total_size += (uint32_t)strlen(sites[i].format);
+    }
+
+    if (buffer_write(writer, &dict_header, sizeof(dict_header)) != 0) {
+        return -1;
+    }
+
+    /* Write each dictionary entry */
+    for (uint32_t i = 0; i < num_sites; i++) {
+        if (write_dict_entry(writer, &sites[i]) != 0) {
+            return -1;
+        }
+    }
+
+    return binwriter_flush(writer);
+}
+
+/**
+ * Fill in the header fields known only at close
+ * (frequency may have been refined since the header was written).
+ */
+static void finish_header(const binary_writer_t* writer,
+                          cnanolog_file_header_t* header,
+                          uint64_t dict_offset) {
+    header->dictionary_offset = dict_offset;
+    cnanolog_header_set_entry_count(header, writer->entries_written);
+    header->timestamp_frequency = writer->timestamp_frequency;
+    header->frequency_uncertainty_ppb = writer->frequency_uncertainty_ppb;
+    header->flags |= writer->extra_flags;
+}
+
 /* ============================================================================
  * Public API Implementation
  * ============================================================================ */
@@ -294,12 +226,8 @@ binary_writer_t* binwriter_create(const char* path) {
     memset(writer, 0, sizeof(binary_writer_t));
 
     /* Allocate double buffers for async I/O */
-    writer->buffers[0] = (char*)malloc(BINARY_WRITER_BUFFER_SIZE);
-    writer->buffers[1] = (char*)malloc(BINARY_WRITER_BUFFER_SIZE);
-    if (writer->buffers[0] == NULL || writer->buffers[1] == NULL) {
+    if (async_writer_init(&writer->io, BINARY_WRITER_BUFFER_SIZE) != 0) {
         fprintf(stderr, "binwriter_create: buffer malloc failed\n");
-        free(writer->buffers[0]);
-        free(writer->buffers[1]);
         free(writer);
         return NULL;
     }
@@ -309,8 +237,7 @@ binary_writer_t* binwriter_create(const char* path) {
     writer->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
     if (writer->fd == -1) {
         fprintf(stderr, "binwriter_create: open failed: %s\n", strerror(errno));
-        free(writer->buffers[0]);
-        free(writer->buffers[1]);
+        async_writer_destroy(&writer->io);
         free(writer);
         return NULL;
     }
@@ -323,19 +250,14 @@ binary_writer_t* binwriter_create(const char* path) {
 #ifndef _WIN32
         close(writer->fd);
 #endif
-        free(writer->buffers[0]);
-        free(writer->buffers[1]);
+        async_writer_destroy(&writer->io);
         free(writer);
         return NULL;
     }
 
     /* Initialize state */
-    writer->buffer_size = BINARY_WRITER_BUFFER_SIZE;
-    writer->buffer_used = 0;
-    writer->active_buffer_idx = 0;
-    writer->has_outstanding_aio = 0;
+    async_writer_attach(&writer->io, writer->fd, 0);
     writer->entries_written = 0;
-    writer->bytes_written = 0;
     writer->header_offset = 0;
 
     return writer;
@@ -364,21 +286,25 @@ int binwriter_write_header(binary_writer_t* writer,
     header.endianness = CNANOLOG_ENDIAN_MAGIC;
     header.dictionary_offset = 0;  /* Will be updated in close */
     header.entry_count = 0;        /* Will be updated in close */
+    header.frequency_uncertainty_ppb = writer->frequency_uncertainty_ppb;
+    writer->timestamp_frequency = timestamp_frequency;
 
     /* Set flags based on compile-time configuration */
-    header.flags = 0;
+    /* Argument data from compress_entry_args() */
+    header.flags = CNANOLOG_FLAG_DOUBLE_XOR | CNANOLOG_FLAG_INT_DELTA |
+                   CNANOLOG_FLAG_STRING_INTERN;
 #ifndef CNANOLOG_NO_TIMESTAMPS
     header.flags |= CNANOLOG_FLAG_HAS_TIMESTAMPS;
 #endif
 
-    /* Write header directly using fd (must be consistent with entry writes) */
-    ssize_t written = write(writer->fd, &header, sizeof(header));
-    if (written != sizeof(header)) {
-        fprintf(stderr, "binwriter_write_header: write failed: %s\n", strerror(errno));
+    writer->header = header;
+
+    /* Write header directly (lands in the file before any buffered entry) */
+    if (async_writer_write_direct(&writer->io, &header, sizeof(header)) != 0) {
+        fprintf(stderr, "binwriter_write_header: write failed\n");
         return -1;
     }
 
-    writer->bytes_written += written;
     return 0;
 }
 
@@ -386,14 +312,14 @@ int binwriter_write_entry(binary_writer_t* writer,
                            uint32_t log_id,
                            uint64_t timestamp,
                            const void* arg_data,
-                           uint16_t data_len) {
+                           size_t data_len) {
     if (writer == NULL) {
         return -1;
     }
 
     /* Validate data length */
-    if (data_len > CNANOLOG_MAX_ENTRY_SIZE) {
-        fprintf(stderr, "binwriter_write_entry: data too large (%u bytes)\n", data_len);
+    if (data_len > CNANOLOG_MAX_COMPRESSED_SIZE) {
+        fprintf(stderr, "binwriter_write_entry: data too large (%zu bytes)\n", data_len);
         return -1;
     }
 
@@ -405,30 +331,84 @@ int binwriter_write_entry(binary_writer_t* writer,
 #else
     (void)timestamp;  /* Suppress unused parameter warning */
 #endif
-    entry_header.data_length = data_len;
 
-    /* Write entry header */
-    if (buffer_write(writer, &entry_header, sizeof(entry_header)) != 0) {
+    /* Reserve the whole entry at once, so the buffer always ends on an
+     * entry boundary (a crash flush never writes half an entry) */
+    char* dst = async_writer_reserve(&writer->io, sizeof(entry_header) +
+                                     CNANOLOG_VARINT_MAX_BYTES + data_len);
+    if (dst == NULL) {
         return -1;
     }
+    size_t len = sizeof(entry_header);
 
-    /* Write argument data if present */
+    /* Entry header (long data: escape + varint length) */
+    if (likely(data_len <= CNANOLOG_MAX_INLINE_LENGTH)) {
+        entry_header.data_length = (uint16_t)data_len;
+        memcpy(dst, &entry_header, sizeof(entry_header));
+    } else {
+        entry_header.data_length = CNANOLOG_LENGTH_EXTENDED;
+        memcpy(dst, &entry_header, sizeof(entry_header));
+        len += cnanolog_varint_encode((uint32_t)data_len, (uint8_t*)dst + len);
+    }
+
+    /* Argument data if present */
     if (data_len > 0 && arg_data != NULL) {
-        if (buffer_write(writer, arg_data, data_len) != 0) {
-            return -1;
-        }
+        memcpy(dst + len, arg_data, data_len);
+        len += data_len;
     }
 
+    async_writer_commit(&writer->io, len);
     writer->entries_written++;
     return 0;
 }
 
+int binwriter_write_sync(binary_writer_t* writer,
+                         uint64_t timestamp,
+                         int64_t real_sec,
+                         int32_t real_nsec,
+                         uint64_t mono_ns) {
+    if (writer == NULL) {
+        return -1;
+    }
+
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    cnanolog_entry_header_t entry_header;
+    entry_header.log_id = CNANOLOG_SYNC_LOG_ID;
+    entry_header.timestamp = timestamp;
+    entry_header.data_length = sizeof(cnanolog_sync_record_t);
+
+    cnanolog_sync_record_t record;
+    record.real_sec = real_sec;
+    record.real_nsec = real_nsec;
+    record.reserved = 0;
+    record.mono_ns = mono_ns;
+
+    char* dst = async_writer_reserve(&writer->io, sizeof(entry_header) + sizeof(record));
+    if (dst == NULL) {
+        return -1;
+    }
+    memcpy(dst, &entry_header, sizeof(entry_header));
+    memcpy(dst + sizeof(entry_header), &record, sizeof(record));
+    async_writer_commit(&writer->io, sizeof(entry_header) + sizeof(record));
+
+    /* Not a log entry: entry_count stays the number of log statements */
+    writer->extra_flags |= CNANOLOG_FLAG_HAS_SYNC_RECORDS;
+    return 0;
+#else
+    (void)timestamp;
+    (void)real_sec;
+    (void)real_nsec;
+    (void)mono_ns;
+    return -1;  /* Sync records need entry timestamps */
+#endif
+}
+
 int binwriter_flush(binary_writer_t* writer) {
     if (writer == NULL) {
         return -1;
     }
 
-    return async_flush_buffer(writer);
+    return async_writer_flush(&writer->io);
 }
 
 int binwriter_close(binary_writer_t* writer,
@@ -446,50 +426,18 @@ int binwriter_close(binary_writer_t* writer,
     }
 
     /* Wait for all outstanding AIO to complete before dictionary */
-    if (wait_for_aio(writer) != 0) {
+    if (async_writer_wait(&writer->io) != 0) {
         goto cleanup_error;
     }
 
-    /* Dictionary starts at current write position */
-    uint64_t dict_offset = writer->bytes_written;
-
-    /* Write level dictionary first (if custom levels exist) */
-    if (write_level_dict(writer, custom_levels, num_custom_levels) != 0) {
-        goto cleanup_error;
-    }
-
-    /* Write log site dictionary header */
-    cnanolog_dict_header_t dict_header;
-    dict_header.magic = CNANOLOG_DICT_MAGIC;
-    dict_header.num_entries = num_sites;
-    dict_header.total_size = sizeof(dict_header);
-    dict_header.reserved = 0;
-
-    /* Calculate total dictionary size */
-    for (uint32_t i = 0; i < num_sites; i++) {
-        dict_header.total_size += sizeof(cnanolog_dict_entry_t);
-        dict_header.total_size += (uint32_t)strlen(sites[i].filename);
-        dict_header.total_size += (uint32_t)strlen(sites[i].format);
-    }
-
-    if (buffer_write(writer, &dict_header, sizeof(dict_header)) != 0) {
-        goto cleanup_error;
-    }
-
-    /* Write each dictionary entry */
-    for (uint32_t i = 0; i < num_sites; i++) {
-        if (write_dict_entry(writer, &sites[i]) != 0) {
-            goto cleanup_error;
-        }
-    }
-
-    /* Flush dictionary */
-    if (binwriter_flush(writer) != 0) {
+    uint64_t dict_offset;
+    if (write_dictionaries(writer, sites, num_sites, custom_levels, num_custom_levels,
+                           &dict_offset) != 0) {
         goto cleanup_error;
     }
 
     /* Wait for final AIO to complete */
-    if (wait_for_aio(writer) != 0) {
+    if (async_writer_wait(&writer->io) != 0) {
         goto cleanup_error;
     }
 
@@ -507,9 +455,7 @@ int binwriter_close(binary_writer_t* writer,
         goto cleanup_error;
     }
 
-    /* Update fields */
-    header.dictionary_offset = (uint64_t)dict_offset;
-    header.entry_count = writer->entries_written;
+    finish_header(writer, &header, dict_offset);
 
     /* Seek back to beginning and write updated header */
     if (fseek(writer->fp, 0, SEEK_SET) != 0) {
@@ -530,8 +476,7 @@ int binwriter_close(binary_writer_t* writer,
     close(writer->fd);
 #endif
     fclose(writer->fp);
-    free(writer->buffers[0]);
-    free(writer->buffers[1]);
+    async_writer_destroy(&writer->io);
     free(writer);
 
     return 0;
@@ -546,8 +491,7 @@ cleanup_error:
     if (writer->fp != NULL) {
         fclose(writer->fp);
     }
-    free(writer->buffers[0]);
-    free(writer->buffers[1]);
+    async_writer_destroy(&writer->io);
     free(writer);
     return -1;
 }
@@ -572,51 +516,20 @@ int binwriter_rotate(binary_writer_t* writer,
         return -1;
     }
 
-    if (wait_for_aio(writer) != 0) {
+    if (async_writer_wait(&writer->io) != 0) {
         fprintf(stderr, "binwriter_rotate: wait for AIO failed\n");
         return -1;
     }
 
     /* Write dictionaries to current file */
-    uint64_t dict_offset = writer->bytes_written;
-
-    /* Write level dictionary first (if custom levels exist) */
-    if (write_level_dict(writer, custom_levels, num_custom_levels) != 0) {
-        fprintf(stderr, "binwriter_rotate: write level dict failed\n");
+    uint64_t dict_offset;
+    if (write_dictionaries(writer, sites, num_sites, custom_levels, num_custom_levels,
+                           &dict_offset) != 0) {
+        fprintf(stderr, "binwriter_rotate: write dictionaries failed\n");
         return -1;
     }
 
-    /* Write log site dictionary */
-    cnanolog_dict_header_t dict_header;
-    dict_header.magic = CNANOLOG_DICT_MAGIC;
-    dict_header.num_entries = num_sites;
-    dict_header.total_size = sizeof(dict_header);
-    dict_header.reserved = 0;
-
-    for (uint32_t i = 0; i < num_sites; i++) {
-        dict_header.total_size += sizeof(cnanolog_dict_entry_t);
-        dict_header.total_size += (uint32_t)strlen(sites[i].filename);
-        dict_header.total_size += (uint32_t)strlen(sites[i].format);
-    }
-
-    if (buffer_write(writer, &dict_header, sizeof(dict_header)) != 0) {
-        fprintf(stderr, "binwriter_rotate: write dict header failed\n");
-        return -1;
-    }
-
-    for (uint32_t i = 0; i < num_sites; i++) {
-        if (write_dict_entry(writer, &sites[i]) != 0) {
-            fprintf(stderr, "binwriter_rotate: write dict entry failed\n");
-            return -1;
-        }
-    }
-
-    if (binwriter_flush(writer) != 0) {
-        fprintf(stderr, "binwriter_rotate: flush dict failed\n");
-        return -1;
-    }
-
-    if (wait_for_aio(writer) != 0) {
+    if (async_writer_wait(&writer->io) != 0) {
         fprintf(stderr, "binwriter_rotate: wait for dict AIO failed\n");
         return -1;
     }
@@ -633,8 +546,7 @@ int binwriter_rotate(binary_writer_t* writer,
         return -1;
     }
 
-    header.dictionary_offset = dict_offset;
-    header.entry_count = writer->entries_written;
+    finish_header(writer, &header, dict_offset);
 
     if (fseek(writer->fp, 0, SEEK_SET) != 0) {
         fprintf(stderr, "binwriter_rotate: fseek to start failed\n");
@@ -672,11 +584,9 @@ int binwriter_rotate(binary_writer_t* writer,
     }
 
     /* Reset writer state for new file */
-    writer->buffer_used = 0;
-    writer->active_buffer_idx = 0;
-    writer->has_outstanding_aio = 0;
+    async_writer_attach(&writer->io, writer->fd, 0);
     writer->entries_written = 0;
-    writer->bytes_written = 0;
+    writer->extra_flags = 0;
 
     /* Step 3: Write new file header */
     cnanolog_file_header_t new_header;
@@ -692,27 +602,88 @@ int binwriter_rotate(binary_writer_t* writer,
     new_header.endianness = CNANOLOG_ENDIAN_MAGIC;
     new_header.dictionary_offset = 0;
     new_header.entry_count = 0;
+    new_header.frequency_uncertainty_ppb = writer->frequency_uncertainty_ppb;
+    writer->timestamp_frequency = timestamp_frequency;
 
-    new_header.flags = 0;
+    new_header.flags = CNANOLOG_FLAG_DOUBLE_XOR | CNANOLOG_FLAG_INT_DELTA |
+                       CNANOLOG_FLAG_STRING_INTERN;
 #ifndef CNANOLOG_NO_TIMESTAMPS
     new_header.flags |= CNANOLOG_FLAG_HAS_TIMESTAMPS;
 #endif
 
-    ssize_t written = write(writer->fd, &new_header, sizeof(new_header));
-    if (written != sizeof(new_header)) {
+    writer->header = new_header;
+
+    if (async_writer_write_direct(&writer->io, &new_header, sizeof(new_header)) != 0) {
         fprintf(stderr, "binwriter_rotate: write new header failed\n");
         return -1;
     }
 
-    writer->bytes_written += written;
     return 0;
 }
 
+int binwriter_crash_close(binary_writer_t* writer,
+                          const log_site_t* sites,
+                          uint32_t num_sites,
+                          const custom_level_entry_t* custom_levels,
+                          uint32_t num_custom_levels,
+                          uint64_t deadline_ns) {
+#ifndef _WIN32
+    if (writer == NULL) {
+        return -1;
+    }
+
+    /* Entries: in-flight AIO buffer and the active buffer */
+    int result = async_writer_crash_flush(&writer->io, deadline_ns);
+
+    /* Dictionaries and header (sync_only is set: plain pwrite from here on) */
+    uint64_t dict_offset;
+    if (write_dictionaries(writer, sites, num_sites, custom_levels, num_custom_levels,
+                           &dict_offset) != 0) {
+        return -1;
+    }
+
+    cnanolog_file_header_t header = writer->header;
+    finish_header(writer, &header, dict_offset);
+    const char* data = (const char*)&header;
+    size_t remaining = sizeof(header);
+    off_t pos = 0;
+    while (remaining > 0) {
+        ssize_t written = pwrite(writer->fd, data, remaining, pos);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        remaining -= (size_t)written;
+        pos += written;
+    }
+
+    fsync(writer->fd);
+    return result;
+#else
+    (void)writer; (void)sites; (void)num_sites;
+    (void)custom_levels; (void)num_custom_levels; (void)deadline_ns;
+    return -1;
+#endif
+}
+
+void binwriter_set_timestamp_frequency(binary_writer_t* writer,
+                                      uint64_t timestamp_frequency,
+                                      uint32_t uncertainty_ppb) {
+    if (writer == NULL) {
+        return;
+    }
+    writer->timestamp_frequency = timestamp_frequency;
+    writer->frequency_uncertainty_ppb = uncertainty_ppb;
+}
+
 /* ============================================================================
  * Statistics Functions
  * ============================================================================ */
 
-uint32_t binwriter_get_entry_count(const binary_writer_t* writer) {
+uint64_t binwriter_get_entry_count(const binary_writer_t* writer) {
     if (writer == NULL) {
         return 0;
     }
@@ -723,12 +694,12 @@ uint64_t binwriter_get_bytes_written(const binary_writer_t* writer) {
     if (writer == NULL) {
         return 0;
     }
-    return writer->bytes_written;
+    return async_writer_submitted(&writer->io);
 }
 
 size_t binwriter_get_buffered_bytes(const binary_writer_t* writer) {
     if (writer == NULL) {
         return 0;
     }
-    return writer->buffer_used;
+    return async_writer_buffered(&writer->io);
 }
@@ -93,6 +93,19 @@ int binwriter_write_header(binary_writer_t* writer,
                             time_t start_time_sec,
                             int32_t start_time_nsec);
 
+/**
+ * Replace the timestamp frequency recorded in the header (e.g. after the
+ * writer thread refined the startup calibration). Applied when the file
+ * is closed or rotated; entries already written decode with the new value.
+ *
+ * @param writer Binary writer handle
+ * @param timestamp_frequency CPU ticks per second
+ * @param uncertainty_ppb Frequency error in parts per billion (0 = nominal)
+ */
+void binwriter_set_timestamp_frequency(binary_writer_t* writer,
+                                      uint64_t timestamp_frequency,
+                                      uint32_t uncertainty_ppb);
+
 /**
  * Write a log entry to the file.
  * Entries are buffered and written in batches for efficiency.
@@ -101,7 +114,8 @@ int binwriter_write_header(binary_writer_t* writer,
  * @param log_id Log site identifier
  * @param timestamp rdtsc() timestamp when log was created
  * @param arg_data Pointer to argument data (raw binary)
- * @param data_len Length of argument data in bytes
+ * @param data_len Length of argument data in bytes (up to CNANOLOG_MAX_COMPRESSED_SIZE;
+ *                 over CNANOLOG_MAX_INLINE_LENGTH uses a varint length)
  * @return 0 on success, -1 on failure
  *
  * Note: The caller is responsible for formatting arg_data according to
@@ -111,7 +125,24 @@ int binwriter_write_entry(binary_writer_t* writer,
                            uint32_t log_id,
                            uint64_t timestamp,
                            const void* arg_data,
-                           uint16_t data_len);
+                           size_t data_len);
+
+/**
+ * Write a clock sync record (CNANOLOG_SYNC_LOG_ID) pairing a counter value
+ * with the system clocks. Not counted in the header's entry_count.
+ *
+ * @param writer Binary writer handle
+ * @param timestamp Counter value at the sync point
+ * @param real_sec CLOCK_REALTIME seconds
+ * @param real_nsec CLOCK_REALTIME nanoseconds
+ * @param mono_ns CLOCK_MONOTONIC nanoseconds
+ * @return 0 on success, -1 on failure (or without timestamps)
+ */
+int binwriter_write_sync(binary_writer_t* writer,
+                         uint64_t timestamp,
+                         int64_t real_sec,
+                         int32_t real_nsec,
+                         uint64_t mono_ns);
 
 /**
  * Flush the internal buffer to disk.
@@ -180,6 +211,26 @@ int binwriter_rotate(binary_writer_t* writer,
                      time_t start_time_sec,
                      int32_t start_time_nsec);
 
+/**
+ * Finish the file from a crash handler: write out buffered entries, the
+ * dictionaries and the final header using only async-signal-safe calls
+ * (no malloc, no stdio). The writer is left open and must not be used
+ * for anything but process termination afterwards.
+ * @param writer Binary writer handle
+ * @param sites Array of log site information (for dictionary)
+ * @param num_sites Number of log sites
+ * @param custom_levels Array of custom level definitions (can be NULL)
+ * @param num_custom_levels Number of custom levels
+ * @param deadline_ns CLOCK_MONOTONIC deadline for in-flight AIO
+ * @return 0 on success, -1 on failure
+ */
+int binwriter_crash_close(binary_writer_t* writer,
+                          const log_site_t* sites,
+                          uint32_t num_sites,
+                          const custom_level_entry_t* custom_levels,
+                          uint32_t num_custom_levels,
+                          uint64_t deadline_ns);
+
 /* ============================================================================
  * Statistics
  * ============================================================================ */
@@ -190,7 +241,7 @@ int binwriter_rotate(binary_writer_t* writer,
  * @param writer Binary writer handle
  * @return Number of log entries written so far
  */
-uint32_t binwriter_get_entry_count(const binary_writer_t* writer);
+uint64_t binwriter_get_entry_count(const binary_writer_t* writer);
 
 /**
  * Get the total number of bytes written to the file (excluding buffer).
@@ -9,19 +9,32 @@
 #include "log_registry.h"
 #include "binary_writer.h"
 #include "text_formatter.h"
+#include "format_pool.h"
 #include "arg_packing.h"
 #include "platform.h"
 #include "staging_buffer.h"
 #include "compressor.h"
+#include "flight_recorder.h"
+#include "latency_histogram.h"
+#include "shm_segment.h"
+#include "sink.h"
 #include "cycles.h"
+#include "tsc_calibration.h"
 
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
-#define MAX_LOG_ENTRY_SIZE 16384
+/**
+ * Staging reservation for entries with string arguments (sizes unknown
+ * until packed). Larger entries, up to CNANOLOG_MAX_ENTRY_SIZE of argument
+ * data, are re-staged at their exact size.
+ */
+#define STRING_RESERVE_SIZE 16384
 #define MAX_STAGING_BUFFERS 256  /* Maximum number of concurrent threads */
+#define MAX_SITE_SECTIONS 64     /* Executables + shared libraries with log sites */
 
 /**
  * Batch processing configuration for background writer.
@@ -39,6 +52,22 @@
  */
 #define BATCH_PROCESS_SIZE 1000        /* Max entries to process per buffer per iteration */
 
+/**
+ * Upper bound for the ordered-output reordering window.
+ * Entries wait this long in staging buffers, so large windows need large buffers.
+ */
+#define MAX_REORDER_WINDOW_US 1000000
+
+/**
+ * Clock sync: every SYNC_INTERVAL_SEC the writer thread pairs a timestamp
+ * with CLOCK_REALTIME/CLOCK_MONOTONIC and re-measures the frequency (once
+ * the run is at least MIN_REFINE_MS long). Text output slews offsets up to
+ * SYNC_STEP_NS and steps to the wall clock beyond that.
+ */
+#define SYNC_INTERVAL_SEC 1
+#define MIN_REFINE_MS 100
+#define SYNC_STEP_NS 1000000LL
+
 /* ============================================================================
  * Global State
  * ============================================================================ */
@@ -47,18 +76,38 @@ static log_registry_t g_registry;
 static cnanolog_output_format_t g_output_format = CNANOLOG_OUTPUT_BINARY;
 static binary_writer_t* g_binary_writer = NULL;
 static text_writer_t* g_text_writer = NULL;
+static format_pool_t* g_format_pool = NULL;  /* Text formatter threads (NULL = inline) */
 static volatile int g_should_exit = 0;
 static int g_is_initialized = 0;
 
 /* Background writer thread */
 static cnanolog_thread_t g_writer_thread;
 
+/* Writer-side entry buffers (writer thread, then shutdown after the join).
+ * Too large for a thread stack; only the touched pages become resident. */
+static char g_entry_buf[STAGING_MAX_ENTRY_SIZE];
+static char g_compressed_buf[CNANOLOG_MAX_COMPRESSED_SIZE];
+static compress_history_t g_compress_history;  /* Previous arguments per site (writer thread) */
+
 /* Timing for binary logs */
 #ifndef CNANOLOG_NO_TIMESTAMPS
 static uint64_t g_start_timestamp = 0;
 static time_t g_start_time_sec = 0;
 static int32_t g_start_time_nsec = 0;
 static uint64_t g_timestamp_frequency = 0;  /* CPU frequency (Hz) for rdtsc() */
+static uint64_t g_reorder_window_ticks = 0; /* Ordered output window (0 = round-robin) */
+static tsc_sample_t g_calibration_start;     /* Anchor for the refined frequency */
+static uint32_t g_frequency_uncertainty_ppb = 0;
+static uint64_t g_last_sync_timestamp = 0;
+static tsc_source_t g_clock_source = TSC_SOURCE_CYCLES;
+
+/* Mapping currently used by the text writer (moves with every sync) */
+static struct {
+    uint64_t frequency;
+    uint64_t timestamp;
+    int64_t sec;
+    int32_t nsec;
+} g_text_clock;
 #endif
 
 /* Rotation state */
@@ -66,6 +115,74 @@ static cnanolog_rotation_policy_t g_rotation_policy = CNANOLOG_ROTATE_NONE;
 static char g_base_path[512] = {0};  /* Base path for rotated files */
 static int g_current_day = -1;       /* Current day of year (for rotation check) */
 
+/* Flight recorder configuration (set before init, persists like custom levels) */
+static struct {
+    int enabled;
+    uint8_t levels[256];        /* Nonzero = entries at this level are recorded */
+    size_t capacity;
+    char base_path[512];
+    int dump_on_error;
+    int dump_signal;
+} g_recorder_config;
+
+/* Flight recorder ring and dumps (writer thread, then shutdown after the join) */
+static flight_recorder_t g_recorder;
+static int g_recorder_active = 0;           /* Ring allocated (init to shutdown) */
+static uint32_t g_recorder_dump_seq = 0;     /* Auto-named dumps of this process */
+static char g_recorder_entry_buf[STAGING_MAX_ENTRY_SIZE];
+static compress_history_t g_recorder_history;
+
+/* Dump requests from cnanolog_dump_flight_recorder() and the signal handler */
+static cnanolog_mutex_t g_recorder_lock;
+static cnanolog_cond_t g_recorder_done;
+static int g_recorder_lock_ready = 0;
+static volatile uint64_t g_recorder_requested = 0;
+static uint64_t g_recorder_completed = 0;
+static int g_recorder_result = 0;
+static char g_recorder_request_path[512];   /* Empty = next auto-named dump */
+static volatile sig_atomic_t g_recorder_signalled = 0;
+#ifdef PLATFORM_POSIX
+static struct sigaction g_recorder_prev_action;
+#endif
+
+/* Additional sinks (configured before init, opened by each init) */
+typedef struct {
+    cnanolog_sink_config_t config;  /* Strings and levels point into this entry */
+    char path[512];
+    char text_pattern[256];
+    char file_filter[256];
+    char spool_path[512];
+    uint8_t levels[256];
+} sink_config_t;
+
+static sink_config_t g_sink_configs[CNANOLOG_MAX_SINKS];
+static uint32_t g_num_sink_configs = 0;
+static log_sink_t g_sinks[CNANOLOG_MAX_SINKS];  /* Writer thread, then shutdown */
+static uint32_t g_num_sinks = 0;                 /* Open sinks (init to shutdown) */
+
+/* Out-of-process writer (cnanolog_init_shared): buffers live in the segment */
+static shm_header_t* g_shm = NULL;          /* Active segment (init to shutdown) */
+static int g_shm_used = 0;                   /* Segment stays mapped until exit */
+static cnanolog_mutex_t g_shm_lock;          /* Serializes publishing to the segment */
+
+/* Crash flush (cnanolog_install_crash_handler) */
+#define CRASH_DEFAULT_BUDGET_MS 1000
+#define CRASH_MAX_SITES 4096        /* Sites first written during a crash flush */
+#define CRASH_SLOT_POOL 8192        /* Their argument slots (no malloc in the handler) */
+static int g_crash_installed = 0;
+static uint64_t g_crash_budget_ns = 0;
+static volatile int g_crash_state = 0;      /* 0 = none, 1 = flushing, 2 = done */
+static volatile int g_writer_busy = 0;      /* Writer thread inside a loop iteration */
+static int g_crash_flushing = 0;            /* write_binary_entry must not allocate */
+static arg_slot_t* g_crash_sites[CRASH_MAX_SITES];
+static arg_slot_t g_crash_slots[CRASH_SLOT_POOL];
+static uint32_t g_crash_slots_used = 0;
+#ifdef PLATFORM_POSIX
+static const int g_crash_signals[] = {SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT};
+#define CRASH_SIGNAL_COUNT (sizeof(g_crash_signals) / sizeof(g_crash_signals[0]))
+static struct sigaction g_crash_prev_actions[CRASH_SIGNAL_COUNT];
+#endif
+
 /* Custom level registry */
 typedef struct {
     uint8_t level;
@@ -75,6 +192,15 @@ typedef struct {
 static custom_level_t g_custom_levels[CNANOLOG_MAX_CUSTOM_LEVELS];
 static volatile uint32_t g_custom_level_count = 0;
 
+/* "cnanolog_sites" sections reported by module constructors */
+typedef struct {
+    cnanolog_site_t* start;
+    cnanolog_site_t* stop;
+} site_section_t;
+
+static site_section_t g_site_sections[MAX_SITE_SECTIONS];
+static uint32_t g_site_section_count = 0;
+
 /* ============================================================================
  * Global Statistics Tracking
  * ============================================================================ */
@@ -115,9 +241,13 @@ static buffer_registry_t g_buffer_registry;
 #if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
     /* C11 standard */
     static _Thread_local staging_buffer_t* tls_staging_buffer = NULL;
+    static _Thread_local uint32_t tls_thread_id = 0;  /* Its thread_id (spans) */
+    static _Thread_local int tls_is_writer_thread = 0;
 #elif defined(__GNUC__) || defined(__clang__)
     /* GCC/Clang extension */
     static __thread staging_buffer_t* tls_staging_buffer = NULL;
+    static __thread uint32_t tls_thread_id = 0;  /* Its thread_id (spans) */
+    static __thread int tls_is_writer_thread = 0;
 #else
     #error "Thread-local storage not supported on this compiler"
 #endif
@@ -125,17 +255,48 @@ static buffer_registry_t g_buffer_registry;
 /* Thread ID counter for debugging */
 static volatile uint32_t g_next_thread_id = 1;
 
+#if LATENCY_TRACKING
+/* Call cost histogram of one producer thread. Kept (and counted) after the
+ * thread exits; the list only grows, by lock-free push. */
+typedef struct thread_latency {
+    latency_histogram_t call_cost;
+    struct thread_latency* next;
+} thread_latency_t;
+
+static thread_latency_t* g_thread_latencies = NULL;
+static latency_histogram_t g_staging_delay;  /* Written by the writer thread only */
+
+#if defined(__STDC_VERSION__) && __STDC_VERSION__ >= 201112L
+    static _Thread_local thread_latency_t* tls_latency = NULL;
+#else
+    static __thread thread_latency_t* tls_latency = NULL;
+#endif
+#endif
+
 /* ============================================================================
  * Forward Declarations
  * ============================================================================ */
 
 static void* writer_thread_main(void* arg);
+static int process_next_entry(staging_buffer_t* sb, char* temp_buf, char* compressed_buf);
+#ifndef CNANOLOG_NO_TIMESTAMPS
+static size_t merge_staged_entries(uint64_t watermark, size_t max_entries,
+                                   char* temp_buf, char* compressed_buf);
+#endif
 static uint64_t get_timestamp(void);
 static void buffer_registry_init(buffer_registry_t* registry);
 static int buffer_registry_add(buffer_registry_t* registry, staging_buffer_t* buffer);
 static staging_buffer_t* get_or_create_staging_buffer(void);
 static void generate_dated_filename(const char* base_path, char* output, size_t output_size);
 static int check_and_rotate_if_needed(void);
+static void register_static_sites(void);
+static void drain_staged_entries(char* temp_buf, char* compressed_buf);
+static int recorder_start(void);
+static void recorder_stop(char* temp_buf, char* compressed_buf);
+static arg_slot_t* crash_history_get(const compress_history_t* histories, const log_site_t* site);
+static void shm_publish_sites(void);
+static int sinks_open(void);
+static void sinks_close(void);
 
 /* ============================================================================
  * Timestamp Calibration (Phase 5)
@@ -143,35 +304,107 @@ static int check_and_rotate_if_needed(void);
 
 #ifndef CNANOLOG_NO_TIMESTAMPS
 /**
- * Calibrate rdtsc() frequency by measuring against wall-clock time.
- * This is called once at initialization to determine CPU frequency.
+ * Fast startup calibration: the frequency comes from the CPU or a short
+ * spin (see tsc_calibration.h) and is refined later by the writer thread.
+ * A counter that is not invariant is replaced by CLOCK_MONOTONIC.
  */
 static void calibrate_timestamp(void) {
-    struct timespec ts1, ts2;
-    uint64_t ticks1, ticks2;
+    g_clock_source = tsc_select_source();
+    if (g_clock_source == TSC_SOURCE_MONOTONIC && !tsc_is_invariant()) {
+        fprintf(stderr, "cnanolog: TSC is not invariant, using CLOCK_MONOTONIC timestamps\n");
+    }
 
-    /* Measure CPU frequency over 100ms */
-    clock_gettime(CLOCK_REALTIME, &ts1);
-    ticks1 = rdtsc();
+    g_timestamp_frequency = tsc_calibrate_quick(&g_calibration_start,
+                                                &g_frequency_uncertainty_ppb);
 
-    /* Sleep for 100 milliseconds */
-    struct timespec sleep_time = {0, 100000000};  /* 100ms = 0.1s */
-    nanosleep(&sleep_time, NULL);
+    /* Record start time and timestamp */
+    g_start_time_sec = (time_t)g_calibration_start.real_sec;
+    g_start_time_nsec = g_calibration_start.real_nsec;
+    g_start_timestamp = g_calibration_start.tsc;
+    g_last_sync_timestamp = g_start_timestamp;
+
+    g_text_clock.frequency = g_timestamp_frequency;
+    g_text_clock.timestamp = g_start_timestamp;
+    g_text_clock.sec = (int64_t)g_start_time_sec;
+    g_text_clock.nsec = g_start_time_nsec;
+}
 
-    clock_gettime(CLOCK_REALTIME, &ts2);
-    ticks2 = rdtsc();
+/**
+ * Text is rendered live, so it cannot interpolate between sync points.
+ * Re-anchor at "now" on the current mapping (no jump) and pick the rate
+ * that absorbs the offset to the wall clock by the next sync.
+ */
+static void resync_text_clock(const tsc_sample_t* now) {
+    int64_t wall_sec;
+    uint32_t wall_nsec;
+    fmt_ticks_to_wall(now->tsc, g_text_clock.frequency, g_text_clock.timestamp,
+                      g_text_clock.sec, g_text_clock.nsec, &wall_sec, &wall_nsec);
+
+    int64_t offset_ns = (now->real_sec - wall_sec) * 1000000000LL +
+                        ((int64_t)now->real_nsec - (int64_t)wall_nsec);
+
+    if (offset_ns > SYNC_STEP_NS || offset_ns < -SYNC_STEP_NS) {
+        /* Wall clock was stepped: follow it */
+        g_text_clock.frequency = g_timestamp_frequency;
+        g_text_clock.sec = now->real_sec;
+        g_text_clock.nsec = now->real_nsec;
+    } else {
+        double interval_ns = (double)SYNC_INTERVAL_SEC * 1e9;
+        g_text_clock.frequency = (uint64_t)((double)g_timestamp_frequency * interval_ns /
+                                            (interval_ns + (double)offset_ns) + 0.5);
+        g_text_clock.sec = wall_sec;
+        g_text_clock.nsec = (int32_t)wall_nsec;
+    }
+    g_text_clock.timestamp = now->tsc;
 
-    /* Calculate elapsed time in seconds */
-    double elapsed_sec = (ts2.tv_sec - ts1.tv_sec) +
-                         (ts2.tv_nsec - ts1.tv_nsec) / 1e9;
+    if (g_text_writer != NULL) {
+        text_writer_set_timestamp_info(g_text_writer, g_text_clock.frequency,
+                                       g_text_clock.timestamp,
+                                       (time_t)g_text_clock.sec, g_text_clock.nsec);
+    }
+    for (uint32_t i = 0; i < g_num_sinks; i++) {
+        sink_set_text_clock(&g_sinks[i], g_text_clock.frequency, g_text_clock.timestamp,
+                            (time_t)g_text_clock.sec, g_text_clock.nsec);
+    }
+}
 
-    /* Calculate ticks per second (CPU frequency) */
-    g_timestamp_frequency = (uint64_t)((ticks2 - ticks1) / elapsed_sec);
+/**
+ * Pair a timestamp with the system clocks (writer thread, shutdown and
+ * after rotation). Binary output gets a sync record that decoders
+ * interpolate between; the frequency is re-measured over everything
+ * since init and patched into the header.
+ */
+static void clock_sync(void) {
+    tsc_sample_t now;
+    tsc_sample(&now);
+    g_last_sync_timestamp = now.tsc;
+
+    /* Very short runs keep the startup frequency (a measurement would be noisier) */
+    if (g_clock_source == TSC_SOURCE_CYCLES &&
+        now.mono_ns - g_calibration_start.mono_ns >= MIN_REFINE_MS * 1000000ULL) {
+        uint32_t uncertainty_ppb;
+        uint64_t frequency = tsc_measure_frequency(&g_calibration_start, &now,
+                                                   &uncertainty_ppb);
+        if (frequency != 0) {
+            g_timestamp_frequency = frequency;
+            g_frequency_uncertainty_ppb = uncertainty_ppb;
+        }
+    }
 
-    /* Record start time and timestamp */
-    g_start_time_sec = ts1.tv_sec;
-    g_start_time_nsec = ts1.tv_nsec;
-    g_start_timestamp = ticks1;
+    /* Text sinks follow the text clock whatever the main output is */
+    resync_text_clock(&now);
+    if (g_output_format == CNANOLOG_OUTPUT_BINARY) {
+        binwriter_set_timestamp_frequency(g_binary_writer, g_timestamp_frequency,
+                                          g_frequency_uncertainty_ppb);
+        if (binwriter_write_sync(g_binary_writer, now.tsc, now.real_sec, now.real_nsec,
+                                 now.mono_ns) == 0) {
+            /* Decoders reset here too, so reading can start at any sync record */
+            compress_history_reset(&g_compress_history);
+        }
+    }
+    for (uint32_t i = 0; i < g_num_sinks; i++) {
+        sink_sync(&g_sinks[i], &now, g_timestamp_frequency, g_frequency_uncertainty_ppb);
+    }
 }
 #endif
 
@@ -195,6 +428,11 @@ int cnanolog_register_level(const char* name, uint8_t level) {
         return -1;
     }
 
+    if (level == LOG_LEVEL_SPAN_BEGIN || level == LOG_LEVEL_SPAN_END) {
+        fprintf(stderr, "cnanolog_register_level: Level %u is reserved for spans\n", level);
+        return -1;
+    }
+
     if (g_custom_level_count >= CNANOLOG_MAX_CUSTOM_LEVELS) {
         fprintf(stderr, "cnanolog_register_level: Maximum custom levels reached (%d)\n",
                 CNANOLOG_MAX_CUSTOM_LEVELS);
@@ -230,6 +468,78 @@ const custom_level_t* _cnanolog_get_custom_levels(uint32_t* count) {
     return g_custom_levels;
 }
 
+/* ============================================================================
+ * Interned Strings
+ * ============================================================================ */
+
+typedef struct interned_node {
+    cnanolog_string_t handle;
+    struct interned_node* next;
+    char text[];
+} interned_node_t;
+
+/* Push-only list: nodes are never freed, so lookups need no lock */
+static interned_node_t* g_interned_strings = NULL;
+
+static interned_node_t* find_interned(interned_node_t* from, const interned_node_t* to,
+                                      const char* str, size_t len) {
+    for (interned_node_t* node = from; node != to; node = node->next) {
+        if (node->handle.len == len && memcmp(node->text, str, len) == 0) {
+            return node;
+        }
+    }
+    return NULL;
+}
+
+const cnanolog_string_t* cnanolog_intern(const char* str) {
+    if (str == NULL) {
+        return NULL;
+    }
+    size_t len = strlen(str);
+    if (len > CNANOLOG_INTERN_MAX_LEN) {
+        return NULL;
+    }
+
+    interned_node_t* head = __atomic_load_n(&g_interned_strings, __ATOMIC_ACQUIRE);
+    interned_node_t* found = find_interned(head, NULL, str, len);
+    if (found != NULL) {
+        return &found->handle;
+    }
+
+    interned_node_t* node = (interned_node_t*)malloc(sizeof(interned_node_t) + len + 1);
+    if (node == NULL) {
+        return NULL;
+    }
+    memcpy(node->text, str, len + 1);
+    node->handle.str = node->text;
+    node->handle.len = (uint32_t)len;
+    node->next = head;
+
+    /* SEQ_CST: either this push is seen by cnanolog_init_shared() or g_shm is seen below */
+    while (!__atomic_compare_exchange_n(&g_interned_strings, &node->next, node, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_ACQUIRE)) {
+        /* Lost the race: another thread may have pushed the same text */
+        found = find_interned(node->next, head, str, len);
+        if (found != NULL) {
+            free(node);
+            return &found->handle;
+        }
+        head = node->next;
+    }
+
+    /* Out-of-process writer: the agent looks the handle up in the segment */
+    shm_header_t* shm = __atomic_load_n(&g_shm, __ATOMIC_SEQ_CST);
+    if (shm != NULL) {
+        cnanolog_mutex_lock(&g_shm_lock);
+        if (shm_segment_publish_interned(shm, &node->handle) != 0) {
+            fprintf(stderr, "cnanolog_intern: Shared string tables full, \"%s\" logs as empty\n",
+                    str);
+        }
+        cnanolog_mutex_unlock(&g_shm_lock);
+    }
+    return &node->handle;
+}
+
 /* ============================================================================
  * Rotation Helpers
  * ============================================================================ */
@@ -291,8 +601,11 @@ static int check_and_rotate_if_needed(void) {
         fprintf(stderr, "cnanolog: Rotating log file to: %s\n", new_path);
 
         /* Rotate based on output format */
-        if (g_output_format == CNANOLOG_OUTPUT_TEXT) {
-            /* TEXT MODE: Just rotate to new file */
+        if (g_output_format != CNANOLOG_OUTPUT_BINARY) {
+            /* TEXT MODE: Just rotate to new file (pending lines stay in the old one) */
+            if (g_format_pool != NULL) {
+                format_pool_drain(g_format_pool);
+            }
             if (text_writer_rotate(g_text_writer, new_path) != 0) {
                 fprintf(stderr, "cnanolog: Failed to rotate text log file\n");
                 return -1;
@@ -319,7 +632,14 @@ static int check_and_rotate_if_needed(void) {
                 fprintf(stderr, "cnanolog: Failed to rotate binary log file\n");
                 return -1;
             }
+            /* Decoders start every file with empty history */
+            compress_history_reset(&g_compress_history);
         }
+
+#ifndef CNANOLOG_NO_TIMESTAMPS
+        /* First sync point of the new file */
+        clock_sync();
+#endif
     }
 
     return 0;
@@ -333,27 +653,38 @@ int cnanolog_init(const char* log_file_path) {
     if (g_is_initialized) {
         return 0;  /* Already initialized */
     }
+    if (g_shm_used) {
+        fprintf(stderr, "cnanolog_init: Threads still stage into the shared segment\n");
+        return -1;
+    }
 
     /* Initialize with no rotation and binary format (backward compatible) */
     g_rotation_policy = CNANOLOG_ROTATE_NONE;
     g_output_format = CNANOLOG_OUTPUT_BINARY;
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    g_reorder_window_ticks = 0;
+#endif
 
-    /* Initialize registry (only on first init, persists across shutdown/init cycles) */
+    /* Initialize registry (only on first init, persists across shutdown/init cycles
+     * and failed inits: section sites keep the ids assigned below) */
     if (g_registry.sites == NULL) {
         log_registry_init(&g_registry);
     }
+    register_static_sites();
 
     /* Create binary writer */
     g_binary_writer = binwriter_create(log_file_path);
     if (g_binary_writer == NULL) {
         fprintf(stderr, "cnanolog_init: Failed to create binary writer\n");
-        log_registry_destroy(&g_registry);
         return -1;
     }
+    compress_history_init(&g_compress_history);
 
     /* Calibrate timestamp (Phase 5: Measure CPU frequency) */
 #ifndef CNANOLOG_NO_TIMESTAMPS
     calibrate_timestamp();
+    binwriter_set_timestamp_frequency(g_binary_writer, g_timestamp_frequency,
+                                      g_frequency_uncertainty_ppb);
 
     /* Write file header with calibrated frequency */
     if (binwriter_write_header(g_binary_writer,
@@ -373,20 +704,38 @@ int cnanolog_init(const char* log_file_path) {
 #endif
         fprintf(stderr, "cnanolog_init: Failed to write header\n");
         binwriter_close(g_binary_writer, NULL, 0, NULL, 0);
-        log_registry_destroy(&g_registry);
         return -1;
     }
 
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    /* The startup sample is the first sync point */
+    binwriter_write_sync(g_binary_writer, g_calibration_start.tsc,
+                         g_calibration_start.real_sec, g_calibration_start.real_nsec,
+                         g_calibration_start.mono_ns);
+#endif
+
     /* Initialize buffer registry (only on first init, persists across shutdown/init cycles) */
     if (g_buffer_registry.count == 0 && g_buffer_registry.buffers[0] == NULL) {
         buffer_registry_init(&g_buffer_registry);
     }
 
+    if (sinks_open() != 0) {
+        binwriter_close(g_binary_writer, NULL, 0, NULL, 0);
+        return -1;
+    }
+
+    if (recorder_start() != 0) {
+        sinks_close();
+        binwriter_close(g_binary_writer, NULL, 0, NULL, 0);
+        return -1;
+    }
+
     /* Start background writer thread */
     if (cnanolog_thread_create(&g_writer_thread, writer_thread_main, NULL) != 0) {
         fprintf(stderr, "cnanolog_init: Failed to create writer thread\n");
+        recorder_stop(g_entry_buf, g_compressed_buf);
+        sinks_close();
         binwriter_close(g_binary_writer, NULL, 0, NULL, 0);
-        log_registry_destroy(&g_registry);
         return -1;
     }
 
@@ -403,6 +752,22 @@ int cnanolog_init_ex(const cnanolog_rotation_config_t* config) {
     if (g_is_initialized) {
         return 0;  /* Already initialized */
     }
+    if (g_shm_used) {
+        fprintf(stderr, "cnanolog_init_ex: Threads still stage into the shared segment\n");
+        return -1;
+    }
+
+    if (config->reorder_window_us > MAX_REORDER_WINDOW_US) {
+        fprintf(stderr, "cnanolog_init_ex: reorder_window_us %u exceeds %d\n",
+                config->reorder_window_us, MAX_REORDER_WINDOW_US);
+        return -1;
+    }
+#ifdef CNANOLOG_NO_TIMESTAMPS
+    if (config->reorder_window_us > 0) {
+        fprintf(stderr, "cnanolog_init_ex: Ordered output requires timestamps\n");
+        return -1;
+    }
+#endif
 
     /* Store configuration */
     g_rotation_policy = config->policy;
@@ -422,23 +787,25 @@ int cnanolog_init_ex(const cnanolog_rotation_config_t* config) {
         log_file_path[sizeof(log_file_path) - 1] = '\0';
     }
 
-    /* Initialize registry (only on first init, persists across shutdown/init cycles) */
+    /* Initialize registry (only on first init, persists across shutdown/init cycles
+     * and failed inits: section sites keep the ids assigned below) */
     if (g_registry.sites == NULL) {
         log_registry_init(&g_registry);
     }
+    register_static_sites();
 
     /* Calibrate timestamp (before creating writers) */
 #ifndef CNANOLOG_NO_TIMESTAMPS
     calibrate_timestamp();
+    g_reorder_window_ticks = g_timestamp_frequency / 1000000 * config->reorder_window_us;
 #endif
 
     /* Create writer based on output format */
-    if (g_output_format == CNANOLOG_OUTPUT_TEXT) {
-        /* Text mode: Create text writer */
+    if (g_output_format != CNANOLOG_OUTPUT_BINARY) {
+        /* Text, JSON and logfmt modes share the text writer */
         g_text_writer = text_writer_create(log_file_path);
         if (g_text_writer == NULL) {
             fprintf(stderr, "cnanolog_init_ex: Failed to create text writer\n");
-            log_registry_destroy(&g_registry);
             return -1;
         }
 
@@ -453,17 +820,32 @@ int cnanolog_init_ex(const cnanolog_rotation_config_t* config) {
 
         /* Set custom format pattern (NULL = use default) */
         text_writer_set_pattern(g_text_writer, config->text_pattern);
+        text_writer_set_output_format(g_text_writer, g_output_format);
+
+        /* Optional formatter threads (pattern and calibration are set by now) */
+        if (config->formatter_threads > 0) {
+            g_format_pool = format_pool_create(config->formatter_threads,
+                                               g_text_writer, &g_registry);
+            if (g_format_pool == NULL) {
+                fprintf(stderr, "cnanolog_init_ex: Failed to start formatter threads\n");
+                text_writer_close(g_text_writer);
+                g_text_writer = NULL;
+                return -1;
+            }
+        }
     } else {
         /* Binary mode: Create binary writer */
         g_binary_writer = binwriter_create(log_file_path);
         if (g_binary_writer == NULL) {
             fprintf(stderr, "cnanolog_init_ex: Failed to create binary writer\n");
-            log_registry_destroy(&g_registry);
             return -1;
         }
+        compress_history_init(&g_compress_history);
 
         /* Write file header */
 #ifndef CNANOLOG_NO_TIMESTAMPS
+        binwriter_set_timestamp_frequency(g_binary_writer, g_timestamp_frequency,
+                                          g_frequency_uncertainty_ppb);
         if (binwriter_write_header(g_binary_writer,
                                    g_timestamp_frequency,
                                    g_start_timestamp,
@@ -480,9 +862,14 @@ int cnanolog_init_ex(const cnanolog_rotation_config_t* config) {
 #endif
             fprintf(stderr, "cnanolog_init_ex: Failed to write header\n");
             binwriter_close(g_binary_writer, NULL, 0, NULL, 0);
-            log_registry_destroy(&g_registry);
             return -1;
         }
+
+#ifndef CNANOLOG_NO_TIMESTAMPS
+        binwriter_write_sync(g_binary_writer, g_calibration_start.tsc,
+                             g_calibration_start.real_sec, g_calibration_start.real_nsec,
+                             g_calibration_start.mono_ns);
+#endif
     }
 
     /* Initialize buffer registry (only on first init, persists across shutdown/init cycles) */
@@ -497,15 +884,30 @@ int cnanolog_init_ex(const cnanolog_rotation_config_t* config) {
         g_current_day = tm->tm_yday;
     }
 
+    if (sinks_open() != 0 || recorder_start() != 0) {
+        sinks_close();
+        if (g_output_format != CNANOLOG_OUTPUT_BINARY) {
+            format_pool_destroy(g_format_pool);
+            g_format_pool = NULL;
+            text_writer_close(g_text_writer);
+        } else {
+            binwriter_close(g_binary_writer, NULL, 0, NULL, 0);
+        }
+        return -1;
+    }
+
     /* Start background writer thread */
     if (cnanolog_thread_create(&g_writer_thread, writer_thread_main, NULL) != 0) {
         fprintf(stderr, "cnanolog_init_ex: Failed to create writer thread\n");
-        if (g_output_format == CNANOLOG_OUTPUT_TEXT) {
+        recorder_stop(g_entry_buf, g_compressed_buf);
+        sinks_close();
+        if (g_output_format != CNANOLOG_OUTPUT_BINARY) {
+            format_pool_destroy(g_format_pool);
+            g_format_pool = NULL;
             text_writer_close(g_text_writer);
         } else {
             binwriter_close(g_binary_writer, NULL, 0, NULL, 0);
         }
-        log_registry_destroy(&g_registry);
         return -1;
     }
 
@@ -513,6 +915,86 @@ int cnanolog_init_ex(const cnanolog_rotation_config_t* config) {
     return 0;
 }
 
+/**
+ * Publish sites registered since the last call (out-of-process writer).
+ */
+static void shm_publish_sites(void) {
+    if (g_shm != NULL) {
+        cnanolog_mutex_lock(&g_shm_lock);
+        shm_segment_publish_sites(g_shm, &g_registry);
+        cnanolog_mutex_unlock(&g_shm_lock);
+    }
+}
+
+int cnanolog_init_shared(const char* shm_name, uint32_t max_threads) {
+#ifdef PLATFORM_POSIX
+    if (shm_name == NULL) {
+        fprintf(stderr, "cnanolog_init_shared: shm_name is NULL\n");
+        return -1;
+    }
+    if (g_is_initialized) {
+        return 0;  /* Already initialized */
+    }
+    if (g_shm_used) {
+        fprintf(stderr, "cnanolog_init_shared: Only one shared session per process\n");
+        return -1;
+    }
+    if (g_recorder_config.enabled || g_num_sink_configs > 0) {
+        fprintf(stderr, "cnanolog_init_shared: Flight recorder and sinks need the in-process writer\n");
+        return -1;
+    }
+
+    /* Threads stage into the segment; cnanolog-agent compresses and writes */
+    shm_header_t* shm = shm_segment_create(shm_name, max_threads);
+    if (shm == NULL) {
+        return -1;
+    }
+
+    g_rotation_policy = CNANOLOG_ROTATE_NONE;
+    g_output_format = CNANOLOG_OUTPUT_BINARY;
+    if (g_registry.sites == NULL) {
+        log_registry_init(&g_registry);
+    }
+    cnanolog_mutex_init(&g_shm_lock);
+
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    /* The agent writes the header and sync records from this calibration */
+    calibrate_timestamp();
+    g_reorder_window_ticks = 0;
+    shm->clock_source = (uint32_t)g_clock_source;
+    shm->timestamp_frequency = g_timestamp_frequency;
+    shm->frequency_uncertainty_ppb = g_frequency_uncertainty_ppb;
+    shm->start_tsc = g_calibration_start.tsc;
+    shm->start_mono_ns = g_calibration_start.mono_ns;
+    shm->start_real_sec = g_calibration_start.real_sec;
+    shm->start_real_nsec = g_calibration_start.real_nsec;
+#endif
+
+    /* Interned before init: published here; later ones by cnanolog_intern() */
+    __atomic_store_n(&g_shm, shm, __ATOMIC_SEQ_CST);
+    g_shm_used = 1;
+    cnanolog_mutex_lock(&g_shm_lock);
+    for (interned_node_t* node = __atomic_load_n(&g_interned_strings, __ATOMIC_SEQ_CST);
+         node != NULL; node = node->next) {
+        shm_segment_publish_interned(shm, &node->handle);
+    }
+    shm_segment_publish_levels(shm, (const custom_level_entry_t*)g_custom_levels,
+                               g_custom_level_count);
+    cnanolog_mutex_unlock(&g_shm_lock);
+
+    register_static_sites();
+    shm_publish_sites();
+
+    g_is_initialized = 1;
+    return 0;
+#else
+    (void)shm_name;
+    (void)max_threads;
+    fprintf(stderr, "cnanolog_init_shared: Not supported on this platform\n");
+    return -1;
+#endif
+}
+
 /* ============================================================================
  * Shutdown
  * ============================================================================ */
@@ -522,6 +1004,15 @@ void cnanolog_shutdown(void) {
         return;
     }
 
+    if (g_shm != NULL) {
+        /* The agent drains what is staged, then closes the file. The segment
+         * stays mapped: threads keep their buffers in it. */
+        __atomic_store_n(&g_shm->app_state, SHM_APP_CLOSED, __ATOMIC_RELEASE);
+        __atomic_store_n(&g_shm, NULL, __ATOMIC_SEQ_CST);
+        g_is_initialized = 0;
+        return;
+    }
+
     /* Signal writer thread to exit */
     g_should_exit = 1;
     cnanolog_thread_join(g_writer_thread, NULL);
@@ -535,68 +1026,24 @@ void cnanolog_shutdown(void) {
      * would cause undefined behavior on re-initialization when threads try to
      * write to freed memory. The buffers persist across init/shutdown cycles.
      */
-    char temp_buf[MAX_LOG_ENTRY_SIZE];
-    uint32_t num_buffers = g_buffer_registry.count;  /* Read atomic counter */
-
-    for (size_t i = 0; i < num_buffers; i++) {
-        /* Use atomic load with acquire semantics to see all previous writes */
-#if defined(__GNUC__) || defined(__clang__)
-        staging_buffer_t* sb = __atomic_load_n(&g_buffer_registry.buffers[i], __ATOMIC_ACQUIRE);
-#else
-        staging_buffer_t* sb = g_buffer_registry.buffers[i];
-#endif
-        if (sb == NULL) continue;
-
-        /* Drain remaining data from this buffer */
-        while (staging_available(sb) > 0) {
-            size_t nread = staging_read(sb, temp_buf, MAX_LOG_ENTRY_SIZE);
-            if (nread == 0) break;
+    char* temp_buf = g_entry_buf;  /* Writer thread has exited: buffers are free */
+    char* compressed_buf = g_compressed_buf;
+    drain_staged_entries(temp_buf, compressed_buf);
+    /* NOTE: Buffers persist - do NOT destroy them or reset the registry count */
 
-            /* Parse entry header */
-            cnanolog_entry_header_t* header = (cnanolog_entry_header_t*)temp_buf;
-
-            /* Check for wrap marker (circular buffer wrap-around) */
-            if (header->log_id == STAGING_WRAP_MARKER_LOG_ID) {
-                /* This is a wrap marker - skip it and wrap read position */
-                staging_consume(sb, sizeof(cnanolog_entry_header_t));
-                staging_wrap_read_pos(sb);
-                continue;  /* Continue processing from beginning */
-            }
+    /* Requests that arrived while the writer thread was stopping */
+    recorder_stop(temp_buf, compressed_buf);
 
-            /* Write real log entry based on output format */
-            if (g_output_format == CNANOLOG_OUTPUT_TEXT) {
-                text_writer_write_entry(g_text_writer,
-                                       header->log_id,
 #ifndef CNANOLOG_NO_TIMESTAMPS
-                                       header->timestamp,
-#else
-                                       0,  /* No timestamp */
-#endif
-                                       temp_buf + sizeof(cnanolog_entry_header_t),
-                                       header->data_length,
-                                       &g_registry);
-            } else {
-                binwriter_write_entry(g_binary_writer,
-                                    header->log_id,
-#ifndef CNANOLOG_NO_TIMESTAMPS
-                                    header->timestamp,
-#else
-                                    0,  /* No timestamp */
+    /* Closing sync point: entries after the last periodic one interpolate too */
+    clock_sync();
 #endif
-                                    temp_buf + sizeof(cnanolog_entry_header_t),
-                                    header->data_length);
-            }
-
-            staging_consume(sb, nread);
-        }
-
-        /* NOTE: Buffer persists - do NOT destroy */
-    }
-    /* NOTE: Do NOT reset count - buffer registry persists across shutdown/init cycles */
 
     /* Close writer based on output format */
-    if (g_output_format == CNANOLOG_OUTPUT_TEXT) {
-        /* TEXT MODE: Just close the file */
+    if (g_output_format != CNANOLOG_OUTPUT_BINARY) {
+        /* TEXT MODE: Finish formatter threads, then close the file */
+        format_pool_destroy(g_format_pool);
+        g_format_pool = NULL;
         text_writer_close(g_text_writer);
         g_text_writer = NULL;
     } else {
@@ -611,7 +1058,9 @@ void cnanolog_shutdown(void) {
                           (const custom_level_entry_t*)custom_levels, num_custom_levels) != 0) {
             fprintf(stderr, "cnanolog_shutdown: Failed to close binary writer\n");
         }
+        compress_history_destroy(&g_compress_history);
     }
+    sinks_close();
 
     /*
      * NOTE: We do NOT destroy the log registry here.
@@ -641,14 +1090,185 @@ uint32_t _cnanolog_register_site(cnanolog_level_t level,
         return UINT32_MAX;
     }
 
-    return log_registry_register(&g_registry, level, filename, line_number,
-                                format, num_args, arg_types, text_pattern);
+    uint32_t log_id = log_registry_register(&g_registry, level, filename, line_number,
+                                            format, num_args, arg_types, text_pattern);
+    shm_publish_sites();  /* Before the id is used, so the agent knows the site */
+    return log_id;
+}
+
+uint32_t _cnanolog_resolve_site(cnanolog_site_t* site) {
+    uint32_t log_id = _cnanolog_register_site((cnanolog_level_t)site->level,
+                                              site->filename, site->line_number,
+                                              site->format, site->num_args,
+                                              site->arg_types, site->text_pattern);
+    site->log_id = log_id;  /* Stays UINT32_MAX before init, so retried later */
+    return log_id;
+}
+
+/**
+ * Assign ids to every site of one section. Sites keep their id across
+ * shutdown/init cycles, like the registry itself.
+ */
+static void register_section_sites(const site_section_t* section) {
+    for (cnanolog_site_t* site = section->start; site < section->stop; site++) {
+        if (site->log_id != UINT32_MAX) {
+            continue;
+        }
+        site->log_id = log_registry_register(&g_registry,
+                                             (cnanolog_level_t)site->level,
+                                             site->filename, site->line_number,
+                                             site->format, site->num_args,
+                                             site->arg_types, site->text_pattern);
+    }
+}
+
+/**
+ * Register all sites of all known sections (called from init, before the
+ * writer thread starts, so the dictionary is complete from the first entry).
+ */
+static void register_static_sites(void) {
+    for (uint32_t i = 0; i < g_site_section_count; i++) {
+        register_section_sites(&g_site_sections[i]);
+    }
+}
+
+void _cnanolog_add_site_section(cnanolog_site_t* start, cnanolog_site_t* stop) {
+    /* Module constructors run one at a time (the loader serializes them) */
+    if (start == NULL || start >= stop) {
+        return;
+    }
+    for (uint32_t i = 0; i < g_site_section_count; i++) {
+        if (g_site_sections[i].start == start) {
+            return;  /* Another translation unit of the same module */
+        }
+    }
+    if (g_site_section_count >= MAX_SITE_SECTIONS) {
+        fprintf(stderr, "cnanolog: Too many modules with log sites (max %d)\n",
+                MAX_SITE_SECTIONS);
+        return;
+    }
+
+    site_section_t* section = &g_site_sections[g_site_section_count++];
+    section->start = start;
+    section->stop = stop;
+
+    /* Library loaded after init (dlopen): register right away */
+    if (g_is_initialized) {
+        register_section_sites(section);
+        shm_publish_sites();
+    }
 }
 
 /* ============================================================================
  * Binary Logging
  * ============================================================================ */
 
+/**
+ * Slow path of _cnanolog_log_binary() for entries larger than the string
+ * reservation. Data over CNANOLOG_MAX_INLINE_LENGTH gets the extended
+ * length prefix (see staging_buffer.h).
+ *
+ * @return 1 if staged, 0 if too large or the buffer is full
+ */
+static int stage_large_entry(staging_buffer_t* sb, uint32_t log_id, uint64_t timestamp,
+                             size_t data_size, uint8_t num_args, const uint8_t* arg_types,
+                             va_list args) {
+    if (data_size > CNANOLOG_MAX_ENTRY_SIZE) {
+        return 0;
+    }
+
+    size_t prefix_size = (data_size > CNANOLOG_MAX_INLINE_LENGTH)
+                             ? STAGING_EXTENDED_PREFIX_SIZE
+                             : sizeof(cnanolog_entry_header_t);
+    size_t entry_size = prefix_size + data_size;
+
+    char* write_ptr = staging_reserve(sb, entry_size);
+    if (write_ptr == NULL) {
+        return 0;
+    }
+
+    if (arg_pack_write_fast(write_ptr + prefix_size, data_size,
+                            num_args, arg_types, args) != data_size) {
+        staging_adjust_reservation(sb, entry_size, 0);  /* Strings changed under us */
+        return 0;
+    }
+
+    cnanolog_entry_header_t* header = (cnanolog_entry_header_t*)write_ptr;
+    header->log_id = log_id;
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    header->timestamp = timestamp;
+#else
+    (void)timestamp;
+#endif
+    if (prefix_size == STAGING_EXTENDED_PREFIX_SIZE) {
+        uint32_t length = (uint32_t)data_size;
+        header->data_length = CNANOLOG_LENGTH_EXTENDED;
+        memcpy(write_ptr + sizeof(cnanolog_entry_header_t), &length, sizeof(length));
+    } else {
+        header->data_length = (uint16_t)data_size;
+    }
+
+    staging_commit(sb, entry_size);
+    return 1;
+}
+
+/**
+ * Producer: count an entry that could not be staged, for the thread's
+ * buffer and overall.
+ */
+static inline void record_drop(staging_buffer_t* sb) {
+    sb->drops++;
+#if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
+    g_stats.dropped_logs++;
+#endif
+}
+
+#if LATENCY_TRACKING
+/* ============================================================================
+ * Latency Histograms
+ * ============================================================================ */
+
+static thread_latency_t* create_thread_latency(void) {
+    thread_latency_t* latency = (thread_latency_t*)calloc(1, sizeof(thread_latency_t));
+    if (latency == NULL) {
+        return NULL;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    latency->next = __atomic_load_n(&g_thread_latencies, __ATOMIC_RELAXED);
+    while (!__atomic_compare_exchange_n(&g_thread_latencies, &latency->next, latency, 1,
+                                        __ATOMIC_RELEASE, __ATOMIC_RELAXED)) {
+    }
+#else
+    latency->next = g_thread_latencies;
+    g_thread_latencies = latency;
+#endif
+    tls_latency = latency;
+    return latency;
+}
+
+/**
+ * Producer: record the cost of a log call that staged its entry.
+ */
+static inline void record_call_cost(uint64_t call_start) {
+    thread_latency_t* latency = tls_latency;
+    if (unlikely(latency == NULL)) {
+        latency = create_thread_latency();
+        if (latency == NULL) {
+            return;
+        }
+    }
+    latency_record(&latency->call_cost, get_timestamp() - call_start);
+}
+
+static void fill_latency(cnanolog_latency_t* out, const latency_histogram_t* histogram) {
+    out->count = latency_count(histogram);
+    out->p50 = latency_percentile(histogram, 50.0);
+    out->p99 = latency_percentile(histogram, 99.0);
+    out->p999 = latency_percentile(histogram, 99.9);
+    out->max = histogram->max;
+}
+#endif
+
 void _cnanolog_log_binary(uint32_t log_id,
                           uint8_t num_args,
                           const uint8_t* arg_types,
@@ -656,6 +1276,9 @@ void _cnanolog_log_binary(uint32_t log_id,
     if (unlikely(!g_is_initialized || log_id == UINT32_MAX)) {
         return;
     }
+#if LATENCY_TRACKING
+    uint64_t call_start = get_timestamp();
+#endif
 
 #if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
     g_stats.total_logs++;
@@ -674,7 +1297,7 @@ void _cnanolog_log_binary(uint32_t log_id,
 
     for (uint8_t i = 0; i < num_args; i++) {
         if (arg_types[i] == ARG_TYPE_STRING) {
-            reserve_size = MAX_LOG_ENTRY_SIZE;
+            reserve_size = STRING_RESERVE_SIZE;
             break;
         }
 
@@ -690,6 +1313,7 @@ void _cnanolog_log_binary(uint32_t log_id,
             case ARG_TYPE_UINT64:
             case ARG_TYPE_DOUBLE:
             case ARG_TYPE_POINTER:
+            case ARG_TYPE_INTERNED:
                 reserve_size += 8;
                 break;
         }
@@ -697,9 +1321,7 @@ void _cnanolog_log_binary(uint32_t log_id,
 
     char* write_ptr = staging_reserve(sb, reserve_size);
     if (unlikely(write_ptr == NULL)) {
-#if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
-        g_stats.dropped_logs++;
-#endif
+        record_drop(sb);
         return;
     }
 
@@ -721,9 +1343,27 @@ void _cnanolog_log_binary(uint32_t log_id,
 
         if (unlikely(arg_data_size == 0)) {
             staging_adjust_reservation(sb, reserve_size, 0);
-#if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
-            g_stats.dropped_logs++;
+
+            /* Did not fit the string reservation: stage at the exact size */
+            if (reserve_size == STRING_RESERVE_SIZE) {
+                va_start(args, arg_types);
+                size_t exact_size = arg_pack_size(num_args, arg_types, args);
+                va_end(args);
+
+                va_start(args, arg_types);
+                int staged = stage_large_entry(sb, log_id,
+#ifndef CNANOLOG_NO_TIMESTAMPS
+                                               header->timestamp,
+#else
+                                               0,
 #endif
+                                               exact_size, num_args, arg_types, args);
+                va_end(args);
+                if (staged) {
+                    return;
+                }
+            }
+            record_drop(sb);
             return;
         }
     }
@@ -731,21 +1371,940 @@ void _cnanolog_log_binary(uint32_t log_id,
     header->data_length = (uint16_t)arg_data_size;
     size_t actual_entry_size = sizeof(cnanolog_entry_header_t) + arg_data_size;
 
-    /* Only adjust if we reserved pessimistically (MAX_LOG_ENTRY_SIZE) */
-    if (reserve_size == MAX_LOG_ENTRY_SIZE && actual_entry_size != reserve_size) {
+    /* Only adjust if we reserved pessimistically (STRING_RESERVE_SIZE) */
+    if (reserve_size == STRING_RESERVE_SIZE && actual_entry_size != reserve_size) {
         staging_adjust_reservation(sb, reserve_size, actual_entry_size);
     }
     staging_commit(sb, actual_entry_size);
+#if LATENCY_TRACKING
+    record_call_cost(call_start);
+#endif
+}
+
+void _cnanolog_span(uint32_t log_id) {
+    if (unlikely(!g_is_initialized || log_id == UINT32_MAX)) {
+        return;
+    }
+#if LATENCY_TRACKING
+    uint64_t call_start = get_timestamp();
+#endif
+
+#if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
+    g_stats.total_logs++;
+#endif
+
+    staging_buffer_t* sb = get_or_create_staging_buffer();
+    if (unlikely(sb == NULL)) {
+#if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
+        g_stats.dropped_logs++;
+#endif
+        return;
+    }
+    const size_t entry_size = sizeof(cnanolog_entry_header_t) + sizeof(uint32_t);
+    char* write_ptr = staging_reserve(sb, entry_size);
+    if (unlikely(write_ptr == NULL)) {
+        record_drop(sb);
+        return;
+    }
+
+    /* Same layout as a one-argument (ARG_TYPE_UINT32) log entry */
+    cnanolog_entry_header_t* header = (cnanolog_entry_header_t*)write_ptr;
+    header->log_id = log_id;
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    header->timestamp = get_timestamp();
+#endif
+    header->data_length = sizeof(uint32_t);
+    memcpy(write_ptr + sizeof(cnanolog_entry_header_t), &tls_thread_id, sizeof(uint32_t));
+    staging_commit(sb, entry_size);
+#if LATENCY_TRACKING
+    record_call_cost(call_start);
+#endif
+}
+
+/**
+ * Compress one staged entry against a file's argument history and write it.
+ * site is the entry's site (NULL if unknown: written uncompressed).
+ *
+ * @return 0 on success, -1 if the site's history could not be allocated
+ */
+static int write_binary_entry(binary_writer_t* writer, compress_history_t* histories,
+                              const char* entry, const log_site_t* site,
+                              char* compressed_buf) {
+    const cnanolog_entry_header_t* header = (const cnanolog_entry_header_t*)entry;
+    size_t arg_data_len;
+    const char* arg_data = staging_entry_data(entry, &arg_data_len);
+
+    size_t compressed_len = 0;
+    const char* data_to_write = arg_data;
+    size_t data_len_to_write = arg_data_len;
+
+    arg_slot_t* history = NULL;
+    if (site != NULL && site->num_args > 0) {
+        history = likely(!g_crash_flushing) ? compress_history_get(histories, site)
+                                            : crash_history_get(histories, site);
+        if (unlikely(history == NULL)) {
+            /* Without history the decoder would lose track of this site */
+            return -1;
+        }
+    }
+
+    if (history != NULL &&
+        compress_entry_args(arg_data, arg_data_len,
+                            compressed_buf, &compressed_len, site, history,
+                            &histories->strings) == 0) {
+        data_to_write = compressed_buf;
+        data_len_to_write = compressed_len;
+#if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
+        g_stats.bytes_compressed_from += arg_data_len;
+        g_stats.bytes_compressed_to += compressed_len;
+#endif
+    }
+
+    binwriter_write_entry(writer,
+                        header->log_id,
+#ifndef CNANOLOG_NO_TIMESTAMPS
+                        header->timestamp,
+#else
+                        0,  /* No timestamp */
+#endif
+                        data_to_write,
+                        data_len_to_write);
+    return 0;
+}
+
+/* ============================================================================
+ * Rate Limiting
+ * ============================================================================ */
+
+/**
+ * GCRA: the limiter state is the theoretical arrival time of the next
+ * entry; a call is admitted unless that lies more than a second's burst
+ * ahead. Timestamp ticks, so no conversion on the hot path.
+ */
+int _cnanolog_admit_rate(cnanolog_limiter_t* limiter, uint32_t per_sec) {
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    uint64_t frequency = g_timestamp_frequency;
+    if (unlikely(frequency == 0)) {
+        return 1;  /* Not initialized: the entry is dropped anyway */
+    }
+    uint64_t now = get_timestamp();
+#else
+    uint64_t frequency = 1000000000ULL;
+    uint64_t now = tsc_monotonic_ns();
+#endif
+
+    if (per_sec == 0) {
+        limiter->suppressed++;
+        return 0;
+    }
+
+    uint64_t interval = frequency / per_sec;
+    uint64_t tat = limiter->state;
+    if (tat > now + (frequency - interval)) {
+        limiter->suppressed++;
+        return 0;
+    }
+    limiter->state = (tat > now ? tat : now) + interval;
+    return 1;
+}
+
+/* ============================================================================
+ * Flight Recorder
+ * ============================================================================ */
+
+/**
+ * Next auto-named dump path: "<base>-N<ext>" (see generate_dated_filename).
+ */
+static void recorder_dump_path(char* output, size_t output_size) {
+    const char* base_path = g_recorder_config.base_path;
+    uint32_t seq = ++g_recorder_dump_seq;
+
+    const char* ext = strrchr(base_path, '.');
+    if (ext == NULL) {
+        snprintf(output, output_size, "%s-%u", base_path, seq);
+    } else {
+        snprintf(output, output_size, "%.*s-%u%s",
+                 (int)(ext - base_path), base_path, seq, ext);
+    }
+}
+
+/**
+ * Write the ring to its own .clog (header, sync points, entries compressed
+ * from empty history, dictionary) and empty it.
+ *
+ * @param path Output path, or NULL for the next auto-named dump
+ * @return 0 on success, -1 on failure
+ */
+static int recorder_dump(const char* path, char* compressed_buf) {
+    char auto_path[512];
+    if (path == NULL) {
+        recorder_dump_path(auto_path, sizeof(auto_path));
+        path = auto_path;
+    }
+
+    binary_writer_t* writer = binwriter_create(path);
+    if (writer == NULL) {
+        fprintf(stderr, "cnanolog: Failed to create flight recorder dump: %s\n", path);
+        return -1;
+    }
+
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    binwriter_set_timestamp_frequency(writer, g_timestamp_frequency,
+                                      g_frequency_uncertainty_ppb);
+    int result = binwriter_write_header(writer, g_timestamp_frequency, g_start_timestamp,
+                                        g_start_time_sec, g_start_time_nsec);
+
+    /* Recorded entries fall between the startup sample and now */
+    tsc_sample_t now;
+    tsc_sample(&now);
+    binwriter_write_sync(writer, g_calibration_start.tsc,
+                         g_calibration_start.real_sec, g_calibration_start.real_nsec,
+                         g_calibration_start.mono_ns);
+    binwriter_write_sync(writer, now.tsc, now.real_sec, now.real_nsec, now.mono_ns);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    int result = binwriter_write_header(writer, 0, 0, ts.tv_sec, (int32_t)ts.tv_nsec);
+#endif
+
+    compress_history_init(&g_recorder_history);
+    uint64_t pos = g_recorder.head;
+    while (result == 0 && flight_recorder_read(&g_recorder, &pos, g_recorder_entry_buf) > 0) {
+        const cnanolog_entry_header_t* header =
+            (const cnanolog_entry_header_t*)g_recorder_entry_buf;
+        result = write_binary_entry(writer, &g_recorder_history, g_recorder_entry_buf,
+                                    log_registry_get(&g_registry, header->log_id),
+                                    compressed_buf);
+    }
+    compress_history_destroy(&g_recorder_history);
+    flight_recorder_clear(&g_recorder);
+
+    uint32_t num_sites = 0;
+    const log_site_t* sites = log_registry_get_all(&g_registry, &num_sites);
+    uint32_t num_custom_levels = 0;
+    const custom_level_t* custom_levels = _cnanolog_get_custom_levels(&num_custom_levels);
+    if (binwriter_close(writer, sites, num_sites,
+                        (const custom_level_entry_t*)custom_levels, num_custom_levels) != 0) {
+        result = -1;
+    }
+    if (result != 0) {
+        fprintf(stderr, "cnanolog: Failed to write flight recorder dump: %s\n", path);
+    }
+    return result;
+}
+
+/**
+ * Keep an entry of a recorded level in the ring, and dump the ring when
+ * an ERROR arrives. Writer thread only.
+ *
+ * @return 1 if the entry was recorded (and must not be written), 0 otherwise
+ */
+static int recorder_handle_entry(const char* entry, size_t entry_size,
+                                 const log_site_t* site, char* compressed_buf) {
+    if (site == NULL) {
+        return 0;
+    }
+
+    if (g_recorder_config.levels[site->log_level]) {
+        flight_recorder_append(&g_recorder, entry, entry_size);
+        return 1;
+    }
+
+    if (g_recorder_config.dump_on_error && site->log_level == LOG_LEVEL_ERROR &&
+        g_recorder.entries > 0) {
+        flight_recorder_append(&g_recorder, entry, entry_size);
+        recorder_dump(NULL, compressed_buf);
+    }
+    return 0;
+}
+
+/**
+ * Serve dump requests from the signal handler and cnanolog_dump_flight_recorder()
+ * (writer thread each iteration, then once more at shutdown).
+ */
+static void recorder_serve_requests(char* temp_buf, char* compressed_buf) {
+    if (g_recorder_signalled) {
+        g_recorder_signalled = 0;
+        drain_staged_entries(temp_buf, compressed_buf);
+        recorder_dump(NULL, compressed_buf);
+    }
+
+    if (g_recorder_requested == g_recorder_completed) {
+        return;
+    }
+    drain_staged_entries(temp_buf, compressed_buf);
+
+    char path[sizeof(g_recorder_request_path)];
+    cnanolog_mutex_lock(&g_recorder_lock);
+    uint64_t ticket = g_recorder_requested;
+    memcpy(path, g_recorder_request_path, sizeof(path));
+    cnanolog_mutex_unlock(&g_recorder_lock);
+
+    int result = recorder_dump(path[0] != '\0' ? path : NULL, compressed_buf);
+
+    cnanolog_mutex_lock(&g_recorder_lock);
+    g_recorder_completed = ticket;
+    g_recorder_result = result;
+    cnanolog_cond_broadcast(&g_recorder_done);
+    cnanolog_mutex_unlock(&g_recorder_lock);
+}
+
+#ifdef PLATFORM_POSIX
+static void recorder_signal_handler(int sig) {
+    (void)sig;
+    g_recorder_signalled = 1;  /* The writer thread dumps on its next pass */
+}
+#endif
+
+/**
+ * Allocate the ring and install the dump signal (init).
+ */
+static int recorder_start(void) {
+    if (!g_recorder_config.enabled) {
+        return 0;
+    }
+    if (flight_recorder_init(&g_recorder, g_recorder_config.capacity) != 0) {
+        fprintf(stderr, "cnanolog: Failed to allocate flight recorder (%zu bytes)\n",
+                g_recorder_config.capacity);
+        return -1;
+    }
+    if (!g_recorder_lock_ready) {
+        cnanolog_mutex_init(&g_recorder_lock);
+        cnanolog_cond_init(&g_recorder_done);
+        g_recorder_lock_ready = 1;
+    }
+
+#ifdef PLATFORM_POSIX
+    if (g_recorder_config.dump_signal > 0) {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = recorder_signal_handler;
+        sigemptyset(&action.sa_mask);
+        action.sa_flags = SA_RESTART;
+        sigaction(g_recorder_config.dump_signal, &action, &g_recorder_prev_action);
+    }
+#endif
+
+    cnanolog_mutex_lock(&g_recorder_lock);
+    g_recorder_active = 1;
+    cnanolog_mutex_unlock(&g_recorder_lock);
+    return 0;
+}
+
+/**
+ * Serve the last requests, fail later ones and free the ring (shutdown,
+ * after the writer thread has exited and the staging buffers are drained).
+ */
+static void recorder_stop(char* temp_buf, char* compressed_buf) {
+    if (!g_recorder_active) {
+        return;
+    }
+
+#ifdef PLATFORM_POSIX
+    if (g_recorder_config.dump_signal > 0) {
+        sigaction(g_recorder_config.dump_signal, &g_recorder_prev_action, NULL);
+    }
+#endif
+
+    recorder_serve_requests(temp_buf, compressed_buf);
+
+    cnanolog_mutex_lock(&g_recorder_lock);
+    g_recorder_active = 0;
+    cnanolog_cond_broadcast(&g_recorder_done);
+    cnanolog_mutex_unlock(&g_recorder_lock);
+
+    flight_recorder_destroy(&g_recorder);
+    g_recorder_signalled = 0;
+}
+
+int cnanolog_enable_flight_recorder(const cnanolog_flight_recorder_config_t* config) {
+    if (g_is_initialized) {
+        fprintf(stderr, "cnanolog_enable_flight_recorder: Cannot configure after init\n");
+        return -1;
+    }
+
+    if (config == NULL) {
+        g_recorder_config.enabled = 0;
+        return 0;
+    }
+    if (config->num_levels > 0 && config->levels == NULL) {
+        fprintf(stderr, "cnanolog_enable_flight_recorder: levels is NULL\n");
+        return -1;
+    }
+
+    memset(g_recorder_config.levels, 0, sizeof(g_recorder_config.levels));
+    if (config->levels == NULL) {
+        g_recorder_config.levels[LOG_LEVEL_DEBUG] = 1;
+    }
+    for (uint32_t i = 0; i < config->num_levels; i++) {
+        g_recorder_config.levels[config->levels[i]] = 1;
+    }
+
+    const char* base_path = config->dump_path != NULL ? config->dump_path
+                                                      : "flight_recorder.clog";
+    strncpy(g_recorder_config.base_path, base_path, sizeof(g_recorder_config.base_path) - 1);
+    g_recorder_config.base_path[sizeof(g_recorder_config.base_path) - 1] = '\0';
+
+    g_recorder_config.capacity = config->capacity != 0 ? config->capacity
+                                                       : FLIGHT_RECORDER_DEFAULT_CAPACITY;
+    g_recorder_config.dump_on_error = config->dump_on_error;
+    g_recorder_config.dump_signal = config->dump_signal;
+    g_recorder_config.enabled = 1;
+    return 0;
+}
+
+int cnanolog_dump_flight_recorder(const char* path) {
+    if (!g_recorder_lock_ready) {
+        return -1;
+    }
+
+    cnanolog_mutex_lock(&g_recorder_lock);
+
+    /* One request at a time: wait for an earlier caller's dump */
+    while (g_recorder_active && g_recorder_requested != g_recorder_completed) {
+        cnanolog_cond_wait(&g_recorder_done, &g_recorder_lock);
+    }
+    if (!g_recorder_active) {
+        cnanolog_mutex_unlock(&g_recorder_lock);
+        return -1;
+    }
+
+    if (path != NULL) {
+        strncpy(g_recorder_request_path, path, sizeof(g_recorder_request_path) - 1);
+        g_recorder_request_path[sizeof(g_recorder_request_path) - 1] = '\0';
+    } else {
+        g_recorder_request_path[0] = '\0';
+    }
+    uint64_t ticket = ++g_recorder_requested;
+
+    while (g_recorder_active && g_recorder_completed < ticket) {
+        cnanolog_cond_wait(&g_recorder_done, &g_recorder_lock);
+    }
+    int result = (g_recorder_completed >= ticket) ? g_recorder_result : -1;
+
+    cnanolog_mutex_unlock(&g_recorder_lock);
+    return result;
+}
+
+/* ============================================================================
+ * Additional Sinks
+ * ============================================================================ */
+
+/**
+ * Open the configured sinks with the current calibration (init).
+ * On failure the sinks opened so far are closed again.
+ */
+static int sinks_open(void) {
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    const tsc_sample_t* start = &g_calibration_start;
+    uint64_t frequency = g_timestamp_frequency;
+    uint32_t uncertainty_ppb = g_frequency_uncertainty_ppb;
+#else
+    const tsc_sample_t* start = NULL;
+    uint64_t frequency = 0;
+    uint32_t uncertainty_ppb = 0;
+#endif
+
+    for (uint32_t i = 0; i < g_num_sink_configs; i++) {
+        if (sink_open(&g_sinks[i], &g_sink_configs[i].config, frequency,
+                      uncertainty_ppb, start) != 0) {
+            sinks_close();
+            return -1;
+        }
+        g_num_sinks = i + 1;
+    }
+    return 0;
+}
+
+/**
+ * Close the open sinks (shutdown, failed init).
+ */
+static void sinks_close(void) {
+    uint32_t num_sites = 0;
+    const log_site_t* sites = log_registry_get_all(&g_registry, &num_sites);
+    uint32_t num_custom_levels = 0;
+    const custom_level_t* custom_levels = _cnanolog_get_custom_levels(&num_custom_levels);
+
+    for (uint32_t i = 0; i < g_num_sinks; i++) {
+        sink_close(&g_sinks[i], sites, num_sites,
+                   (const custom_level_entry_t*)custom_levels, num_custom_levels);
+    }
+    g_num_sinks = 0;
+}
+
+/**
+ * Flush sinks whose policy says so (writer thread, every iteration).
+ */
+static void sinks_flush_due(int main_flushed) {
+    uint64_t now_ns = tsc_monotonic_ns();
+    for (uint32_t i = 0; i < g_num_sinks; i++) {
+        sink_flush_if_due(&g_sinks[i], now_ns, main_flushed);
+    }
+}
+
+int cnanolog_add_sink(const cnanolog_sink_config_t* config) {
+    if (g_is_initialized) {
+        fprintf(stderr, "cnanolog_add_sink: Cannot configure after init\n");
+        return -1;
+    }
+
+    if (config == NULL) {
+        g_num_sink_configs = 0;
+        return 0;
+    }
+    if (config->path == NULL) {
+        fprintf(stderr, "cnanolog_add_sink: path is NULL\n");
+        return -1;
+    }
+    if (g_num_sink_configs >= CNANOLOG_MAX_SINKS) {
+        fprintf(stderr, "cnanolog_add_sink: At most %d sinks\n", CNANOLOG_MAX_SINKS);
+        return -1;
+    }
+    if (config->format > CNANOLOG_OUTPUT_LOGFMT) {
+        fprintf(stderr, "cnanolog_add_sink: Unknown format %d\n", (int)config->format);
+        return -1;
+    }
+    if ((config->num_levels > 0 && config->levels == NULL) || config->num_levels > 256) {
+        fprintf(stderr, "cnanolog_add_sink: Invalid levels\n");
+        return -1;
+    }
+    if (netwriter_is_address(config->path) && config->format != CNANOLOG_OUTPUT_BINARY) {
+        fprintf(stderr, "cnanolog_add_sink: Collector sinks stream the binary format\n");
+        return -1;
+    }
+
+    sink_config_t* entry = &g_sink_configs[g_num_sink_configs];
+    memset(entry, 0, sizeof(*entry));
+    entry->config = *config;
+
+    strncpy(entry->path, config->path, sizeof(entry->path) - 1);
+    entry->config.path = entry->path;
+    if (config->text_pattern != NULL) {
+        strncpy(entry->text_pattern, config->text_pattern, sizeof(entry->text_pattern) - 1);
+        entry->config.text_pattern = entry->text_pattern;
+    }
+    if (config->file_filter != NULL) {
+        strncpy(entry->file_filter, config->file_filter, sizeof(entry->file_filter) - 1);
+        entry->config.file_filter = entry->file_filter;
+    }
+    if (config->spool_path != NULL) {
+        strncpy(entry->spool_path, config->spool_path, sizeof(entry->spool_path) - 1);
+        entry->config.spool_path = entry->spool_path;
+    }
+    if (config->levels != NULL) {
+        memcpy(entry->levels, config->levels, config->num_levels);
+        entry->config.levels = entry->levels;
+    }
+
+    return (int)g_num_sink_configs++;
 }
 
 /* ============================================================================
  * Background Writer Thread
  * ============================================================================ */
 
+/**
+ * Hand one staged entry (header + argument data) to the sinks that accept
+ * it, then to the main writer: the formatter pool or text writer in text
+ * mode, compressed in binary mode. Entries at flight recorder levels go to
+ * the ring instead of the main writer. The site is looked up once for all.
+ */
+static void write_staged_entry(const char* entry, char* compressed_buf) {
+    const cnanolog_entry_header_t* header = (const cnanolog_entry_header_t*)entry;
+    size_t arg_data_len;
+    const char* arg_data = staging_entry_data(entry, &arg_data_len);
+    const log_site_t* site = log_registry_get(&g_registry, header->log_id);
+
+    if (g_num_sinks > 0 && site != NULL) {
+        for (uint32_t i = 0; i < g_num_sinks; i++) {
+            if (sink_accepts(&g_sinks[i], site)) {
+                sink_write_entry(&g_sinks[i], entry, site, &g_registry, compressed_buf);
+            }
+        }
+    }
+
+    if (g_recorder_active &&
+        recorder_handle_entry(entry, (size_t)(arg_data - entry) + arg_data_len,
+                              site, compressed_buf)) {
+        return;
+    }
+
+    if (g_output_format != CNANOLOG_OUTPUT_BINARY) {
+        if (g_format_pool != NULL) {
+            /* TEXT MODE (pooled): Formatter threads render the line */
+            if (likely(format_pool_submit(g_format_pool, entry,
+                                          (size_t)(arg_data - entry) + arg_data_len) == 0)) {
+                return;
+            }
+            /* Larger than a pool batch: write earlier lines, then render inline */
+            format_pool_drain(g_format_pool);
+        }
+
+        /* TEXT MODE: Format and write human-readable text */
+        text_writer_write_entry(g_text_writer,
+                               header->log_id,
+#ifndef CNANOLOG_NO_TIMESTAMPS
+                               header->timestamp,
+#else
+                               0,  /* No timestamp */
+#endif
+                               arg_data,
+                               arg_data_len,
+                               &g_registry);
+        return;
+    }
+
+    /* BINARY MODE: Compress and write binary data */
+    if (unlikely(write_binary_entry(g_binary_writer, &g_compress_history,
+                                    entry, site, compressed_buf) != 0)) {
+#if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
+        g_stats.dropped_logs++;
+#endif
+    }
+}
+
+/**
+ * Read, write and consume the next complete entry from a staging buffer,
+ * skipping wrap markers.
+ *
+ * @return 1 if an entry was written, 0 if no complete entry is available
+ */
+static int process_next_entry(staging_buffer_t* sb, char* temp_buf, char* compressed_buf) {
+    cnanolog_entry_header_t header;
+    size_t entry_size;
+    if (!staging_peek_entry(sb, &header, &entry_size)) {
+        return 0;
+    }
+
+    if (staging_read(sb, temp_buf, entry_size) < entry_size) {
+        return 0;
+    }
+
+#if LATENCY_TRACKING
+    /* Another core's counter may read a little behind ours */
+    uint64_t now = get_timestamp();
+    latency_record(&g_staging_delay, now > header.timestamp ? now - header.timestamp : 0);
+#endif
+    write_staged_entry(temp_buf, compressed_buf);
+    staging_consume(sb, entry_size);
+    return 1;
+}
+
+#ifndef CNANOLOG_NO_TIMESTAMPS
+/* ============================================================================
+ * Timestamp-Ordered Merge
+ * ============================================================================ */
+
+/**
+ * Head entry of one staging buffer. Each buffer is already in timestamp
+ * order, so a min-heap of heads is enough for a k-way merge.
+ */
+typedef struct {
+    uint64_t timestamp;
+    staging_buffer_t* sb;
+} merge_head_t;
+
+static void merge_heap_sift_down(merge_head_t* heap, size_t n, size_t i) {
+    merge_head_t item = heap[i];
+    for (;;) {
+        size_t child = 2 * i + 1;
+        if (child >= n) {
+            break;
+        }
+        if (child + 1 < n && heap[child + 1].timestamp < heap[child].timestamp) {
+            child++;
+        }
+        if (heap[child].timestamp >= item.timestamp) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = item;
+}
+
+/**
+ * Write staged entries from all buffers in timestamp order, stopping at the
+ * first entry newer than the watermark. Entries younger than the reordering
+ * window stay staged, so a slower thread's older entry can still be merged
+ * in front of them on a later pass.
+ *
+ * @param watermark Newest timestamp that may be written (UINT64_MAX = all)
+ * @param max_entries Maximum entries to write in this call
+ * @return Number of entries written
+ */
+static size_t merge_staged_entries(uint64_t watermark, size_t max_entries,
+                                   char* temp_buf, char* compressed_buf) {
+    merge_head_t heap[MAX_STAGING_BUFFERS];
+    size_t heap_size = 0;
+    uint64_t now_ns = tsc_monotonic_ns();
+
+    uint32_t num_buffers = g_buffer_registry.count;
+    if (num_buffers > MAX_STAGING_BUFFERS) {
+        num_buffers = MAX_STAGING_BUFFERS;
+    }
+
+    for (uint32_t i = 0; i < num_buffers; i++) {
+#if defined(__GNUC__) || defined(__clang__)
+        staging_buffer_t* sb = __atomic_load_n(&g_buffer_registry.buffers[i], __ATOMIC_ACQUIRE);
+#else
+        staging_buffer_t* sb = g_buffer_registry.buffers[i];
+#endif
+        cnanolog_entry_header_t header;
+        if (sb == NULL || !staging_peek_entry(sb, &header, NULL) || header.timestamp > watermark) {
+            continue;
+        }
+        staging_begin_drain(sb, now_ns);
+        heap[heap_size].timestamp = header.timestamp;
+        heap[heap_size].sb = sb;
+        heap_size++;
+    }
+
+    /* Heapify */
+    for (size_t i = heap_size / 2; i-- > 0;) {
+        merge_heap_sift_down(heap, heap_size, i);
+    }
+
+    size_t written = 0;
+    while (heap_size > 0 && written < max_entries) {
+        staging_buffer_t* sb = heap[0].sb;
+        if (!process_next_entry(sb, temp_buf, compressed_buf)) {
+            break;  /* Peeked entry vanished: cannot happen with a single consumer */
+        }
+        written++;
+
+        /* Replace the head with the buffer's next entry, or drop the buffer */
+        cnanolog_entry_header_t header;
+        if (staging_peek_entry(sb, &header, NULL) && header.timestamp <= watermark) {
+            heap[0].timestamp = header.timestamp;
+        } else {
+            heap[0] = heap[--heap_size];
+        }
+        merge_heap_sift_down(heap, heap_size, 0);
+    }
+
+    return written;
+}
+#endif
+
+/**
+ * Write every entry staged so far (shutdown, and before a flight recorder
+ * dump so the dump includes everything logged before the request).
+ * Ordered output merges them, no window needed.
+ */
+static void drain_staged_entries(char* temp_buf, char* compressed_buf) {
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    if (g_reorder_window_ticks > 0) {
+        merge_staged_entries(UINT64_MAX, SIZE_MAX, temp_buf, compressed_buf);
+    }
+#endif
+
+    uint32_t num_buffers = g_buffer_registry.count;  /* Read atomic counter */
+    uint64_t now_ns = tsc_monotonic_ns();
+    for (size_t i = 0; i < num_buffers; i++) {
+        /* Use atomic load with acquire semantics to see all previous writes */
+#if defined(__GNUC__) || defined(__clang__)
+        staging_buffer_t* sb = __atomic_load_n(&g_buffer_registry.buffers[i], __ATOMIC_ACQUIRE);
+#else
+        staging_buffer_t* sb = g_buffer_registry.buffers[i];
+#endif
+        if (sb == NULL || staging_available(sb) == 0) continue;
+        staging_begin_drain(sb, now_ns);
+
+        /* Drain remaining entries one at a time, same path as the writer thread */
+        while (process_next_entry(sb, temp_buf, compressed_buf)) {
+        }
+    }
+}
+
+/* ============================================================================
+ * Crash Flush
+ * ============================================================================ */
+
+/**
+ * Slot array for a site while crash flushing: the writer's own if the site
+ * was written since the last reset, otherwise zeroed slots from a static
+ * pool (the decoder's history for such a site is zero as well).
+ * Never allocates; only the crash handler's thread gets here.
+ *
+ * @return Slot array, or NULL if the pool is exhausted (entry is dropped)
+ */
+static arg_slot_t* crash_history_get(const compress_history_t* histories, const log_site_t* site) {
+    arg_slot_t* slots = compress_history_peek(histories, site->log_id);
+    if (slots != NULL || site->log_id >= CRASH_MAX_SITES) {
+        return slots;
+    }
+    slots = g_crash_sites[site->log_id];
+    if (slots == NULL && g_crash_slots_used + site->num_args <= CRASH_SLOT_POOL) {
+        slots = &g_crash_slots[g_crash_slots_used];
+        g_crash_slots_used += site->num_args;
+        g_crash_sites[site->log_id] = slots;
+    }
+    return slots;
+}
+
+#ifdef PLATFORM_POSIX
+static uint64_t crash_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static void crash_pause(void) {
+    struct timespec ts = {0, 100000};  /* 100us */
+    nanosleep(&ts, NULL);
+}
+
+/**
+ * Writer thread: stop for good once a crash flush has started
+ * (the process is about to die).
+ */
+static void crash_park_writer(void) {
+    __atomic_store_n(&g_writer_busy, 0, __ATOMIC_SEQ_CST);
+    for (;;) {
+        struct timespec ts = {1, 0};
+        nanosleep(&ts, NULL);
+    }
+}
+
+/**
+ * Compress and write entries committed to the staging buffers, buffer by
+ * buffer (not merged in timestamp order), until they are empty or the
+ * deadline passes. Entries at flight recorder levels are skipped.
+ */
+static void crash_drain_staged_entries(uint64_t deadline_ns) {
+    uint32_t num_buffers = g_buffer_registry.count;
+    if (num_buffers > MAX_STAGING_BUFFERS) {
+        num_buffers = MAX_STAGING_BUFFERS;
+    }
+
+    for (uint32_t i = 0; i < num_buffers; i++) {
+        staging_buffer_t* sb = __atomic_load_n(&g_buffer_registry.buffers[i], __ATOMIC_ACQUIRE);
+        if (sb == NULL) {
+            continue;
+        }
+
+        cnanolog_entry_header_t header;
+        size_t entry_size;
+        while (staging_peek_entry(sb, &header, &entry_size) &&
+               staging_read(sb, g_entry_buf, entry_size) == entry_size) {
+            const log_site_t* site = log_registry_get(&g_registry, header.log_id);
+            if (!(g_recorder_active && site != NULL &&
+                  g_recorder_config.levels[(uint8_t)site->log_level])) {
+                write_binary_entry(g_binary_writer, &g_compress_history,
+                                   g_entry_buf, site, g_compressed_buf);
+            }
+            staging_consume(sb, entry_size);
+
+            if (crash_now_ns() >= deadline_ns) {
+                return;
+            }
+        }
+    }
+}
+
+/**
+ * Stop the writer thread and write out everything that can be saved.
+ * Async-signal-safe: memory operations, pwrite(), fsync(), nanosleep().
+ */
+static void crash_flush(uint64_t deadline_ns) {
+    int on_writer_thread = tls_is_writer_thread;
+
+    if (!on_writer_thread) {
+        /* Wait (half the budget) for the writer to park between iterations */
+        uint64_t park_deadline = deadline_ns - g_crash_budget_ns / 2;
+        while (__atomic_load_n(&g_writer_busy, __ATOMIC_SEQ_CST)) {
+            if (crash_now_ns() >= park_deadline) {
+                return;  /* Stuck inside an iteration: its state is not ours to touch */
+            }
+            crash_pause();
+        }
+    }
+
+    uint32_t num_sites = 0;
+    const log_site_t* sites = log_registry_get_all(&g_registry, &num_sites);
+    uint32_t num_custom_levels = 0;
+    const custom_level_t* custom_levels = _cnanolog_get_custom_levels(&num_custom_levels);
+
+    if (g_output_format != CNANOLOG_OUTPUT_BINARY) {
+        /* Formatting is not async-signal-safe: only rendered lines are saved */
+        text_writer_crash_flush(g_text_writer, deadline_ns);
+    } else {
+        g_crash_flushing = 1;
+        if (!on_writer_thread) {
+            /* The writer may have crashed halfway through an entry's history update */
+            crash_drain_staged_entries(deadline_ns);
+        }
+        binwriter_crash_close(g_binary_writer, sites, num_sites,
+                              (const custom_level_entry_t*)custom_levels, num_custom_levels,
+                              deadline_ns);
+    }
+
+    /* Sinks keep what they already received (staged entries go to the main log only) */
+    for (uint32_t i = 0; i < g_num_sinks; i++) {
+        sink_crash_close(&g_sinks[i], sites, num_sites,
+                         (const custom_level_entry_t*)custom_levels, num_custom_levels,
+                         deadline_ns);
+    }
+}
+
+static void crash_signal_handler(int sig) {
+    /* Out-of-process writer: the agent saves the staged entries itself */
+    if (g_is_initialized && !g_should_exit && g_shm == NULL) {
+        uint64_t deadline_ns = crash_now_ns() + g_crash_budget_ns;
+        int idle = 0;
+        if (__atomic_compare_exchange_n(&g_crash_state, &idle, 1, 0,
+                                        __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST)) {
+            crash_flush(deadline_ns);
+            __atomic_store_n(&g_crash_state, 2, __ATOMIC_SEQ_CST);
+        } else {
+            /* Another thread is flushing: do not end the process under it */
+            while (__atomic_load_n(&g_crash_state, __ATOMIC_SEQ_CST) != 2 &&
+                   crash_now_ns() < deadline_ns) {
+                crash_pause();
+            }
+        }
+    }
+
+    /* Previous handlers (or the default action) take it from here */
+    for (size_t i = 0; i < CRASH_SIGNAL_COUNT; i++) {
+        sigaction(g_crash_signals[i], &g_crash_prev_actions[i], NULL);
+    }
+    raise(sig);  /* Delivered once this handler returns */
+}
+#endif
+
+int cnanolog_install_crash_handler(uint32_t budget_ms) {
+#ifdef PLATFORM_POSIX
+    g_crash_budget_ns = (uint64_t)(budget_ms != 0 ? budget_ms : CRASH_DEFAULT_BUDGET_MS) *
+                        1000000ULL;
+    if (g_crash_installed) {
+        return 0;
+    }
+
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = crash_signal_handler;
+    sigemptyset(&action.sa_mask);
+    /* A fault inside the handler then kills the process instead of recursing */
+    for (size_t i = 0; i < CRASH_SIGNAL_COUNT; i++) {
+        sigaddset(&action.sa_mask, g_crash_signals[i]);
+    }
+    for (size_t i = 0; i < CRASH_SIGNAL_COUNT; i++) {
+        sigaction(g_crash_signals[i], &action, &g_crash_prev_actions[i]);
+    }
+    g_crash_installed = 1;
+    return 0;
+#else
+    (void)budget_ms;
+    return -1;
+#endif
+}
+
 static void* writer_thread_main(void* arg) {
     (void)arg;
-    char temp_buf[MAX_LOG_ENTRY_SIZE];
-    char compressed_buf[MAX_LOG_ENTRY_SIZE];
+    char* temp_buf = g_entry_buf;
+    char* compressed_buf = g_compressed_buf;
     size_t last_checked_idx = 0;
 
     /* Batch processing state */
@@ -754,15 +2313,41 @@ static void* writer_thread_main(void* arg) {
     uint64_t last_flush_time = get_timestamp();
 #endif
 
+    tls_is_writer_thread = 1;
+
     while (!g_should_exit) {
         int found_work = 0;
 
+#ifdef PLATFORM_POSIX
+        /* A crash handler owns the writers and staging buffers from here on */
+        if (g_crash_installed) {
+            __atomic_store_n(&g_writer_busy, 1, __ATOMIC_SEQ_CST);
+            if (unlikely(__atomic_load_n(&g_crash_state, __ATOMIC_SEQ_CST) != 0)) {
+                crash_park_writer();
+            }
+        }
+#endif
+
 #if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
         g_stats.background_wakeups++;
 #endif
 
         size_t num_buffers = g_buffer_registry.count;
 
+#ifndef CNANOLOG_NO_TIMESTAMPS
+        /* Ordered output: merge everything older than the reordering window */
+        if (g_reorder_window_ticks > 0) {
+            uint64_t now = get_timestamp();
+            uint64_t watermark = (now > g_reorder_window_ticks) ? now - g_reorder_window_ticks : 0;
+            size_t written = merge_staged_entries(watermark, FLUSH_BATCH_SIZE,
+                                                  temp_buf, compressed_buf);
+            entries_since_flush += written;
+            found_work = (written > 0);
+            num_buffers = 0;  /* Skip round-robin draining */
+        }
+#endif
+
+        uint64_t now_ns = (num_buffers > 0) ? tsc_monotonic_ns() : 0;
         for (size_t i = 0; i < num_buffers; i++) {
             size_t idx = (last_checked_idx + i) % num_buffers;
 
@@ -775,98 +2360,15 @@ static void* writer_thread_main(void* arg) {
                 continue;
             }
 
-            size_t available = staging_available(sb);
-            if (available == 0) {
+            if (staging_available(sb) == 0) {
                 continue;
             }
+            staging_begin_drain(sb, now_ns);
 
             /* Batch processing: process up to BATCH_PROCESS_SIZE entries from this buffer */
             size_t batch_count = 0;
             while (batch_count < BATCH_PROCESS_SIZE &&
-                   staging_available(sb) >= sizeof(cnanolog_entry_header_t)) {
-                size_t nread = staging_read(sb, temp_buf, sizeof(cnanolog_entry_header_t));
-                if (nread < sizeof(cnanolog_entry_header_t)) {
-                    break;
-                }
-
-                cnanolog_entry_header_t* header = (cnanolog_entry_header_t*)temp_buf;
-
-                if (header->log_id == STAGING_WRAP_MARKER_LOG_ID) {
-                    staging_consume(sb, sizeof(cnanolog_entry_header_t));
-                    staging_wrap_read_pos(sb);
-                    continue;
-                }
-
-                size_t entry_size = sizeof(cnanolog_entry_header_t) + header->data_length;
-
-                if (staging_available(sb) < entry_size) {
-                    break;
-                }
-
-                nread = staging_read(sb, temp_buf, entry_size);
-                if (nread < entry_size) {
-                    break;
-                }
-
-                header = (cnanolog_entry_header_t*)temp_buf;
-
-                /* Branch based on output format */
-                if (g_output_format == CNANOLOG_OUTPUT_TEXT) {
-                    /* TEXT MODE: Format and write human-readable text */
-                    text_writer_write_entry(g_text_writer,
-                                           header->log_id,
-#ifndef CNANOLOG_NO_TIMESTAMPS
-                                           header->timestamp,
-#else
-                                           0,  /* No timestamp */
-#endif
-                                           temp_buf + sizeof(cnanolog_entry_header_t),
-                                           header->data_length,
-                                           &g_registry);
-                } else {
-                    /* BINARY MODE: Compress and write binary data */
-                    const log_site_t* site = log_registry_get(&g_registry, header->log_id);
-
-                    size_t compressed_len = 0;
-                    const char* data_to_write;
-                    uint16_t data_len_to_write;
-
-                    if (site != NULL && site->num_args > 0) {
-                        int compress_result = compress_entry_args(
-                            temp_buf + sizeof(cnanolog_entry_header_t),
-                            header->data_length,
-                            compressed_buf,
-                            &compressed_len,
-                            site);
-
-                        if (compress_result == 0) {
-                            data_to_write = compressed_buf;
-                            data_len_to_write = (uint16_t)compressed_len;
-#if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
-                            g_stats.bytes_compressed_from += header->data_length;
-                            g_stats.bytes_compressed_to += compressed_len;
-#endif
-                        } else {
-                            data_to_write = temp_buf + sizeof(cnanolog_entry_header_t);
-                            data_len_to_write = header->data_length;
-                        }
-                    } else {
-                        data_to_write = temp_buf + sizeof(cnanolog_entry_header_t);
-                        data_len_to_write = header->data_length;
-                    }
-
-                    binwriter_write_entry(g_binary_writer,
-                                        header->log_id,
-#ifndef CNANOLOG_NO_TIMESTAMPS
-                                        header->timestamp,
-#else
-                                        0,  /* No timestamp */
-#endif
-                                        data_to_write,
-                                        data_len_to_write);
-                }
-
-                staging_consume(sb, entry_size);
+                   process_next_entry(sb, temp_buf, compressed_buf)) {
                 entries_since_flush++;
                 batch_count++;  /* Increment batch counter */
                 found_work = 1;
@@ -877,35 +2379,64 @@ static void* writer_thread_main(void* arg) {
             last_checked_idx = (last_checked_idx + 1) % num_buffers;
         }
 
+        if (g_recorder_active) {
+            recorder_serve_requests(temp_buf, compressed_buf);
+        }
+
 #ifndef CNANOLOG_NO_TIMESTAMPS
         uint64_t now = get_timestamp();
+
+        /* Periodic clock sync (refines the frequency, bounds drift) */
+        if (unlikely(now - g_last_sync_timestamp >= g_timestamp_frequency * SYNC_INTERVAL_SEC)) {
+            clock_sync();
+        }
+
         uint64_t elapsed_ns = now - last_flush_time;
         uint64_t elapsed_ms = elapsed_ns / 1000000;
+        int main_flushed = 0;
 
         if (entries_since_flush >= FLUSH_BATCH_SIZE ||
             elapsed_ms >= FLUSH_INTERVAL_MS ||
             (entries_since_flush > 0 && !found_work)) {
 #else
+        int main_flushed = 0;
         if (entries_since_flush >= FLUSH_BATCH_SIZE ||
             (entries_since_flush > 0 && !found_work)) {
 #endif
             /* Flush appropriate writer */
-            if (g_output_format == CNANOLOG_OUTPUT_TEXT) {
+            if (g_output_format != CNANOLOG_OUTPUT_BINARY) {
+                if (g_format_pool != NULL) {
+                    /* Busy: take what is rendered; idle/timer: wait for the rest */
+                    if (found_work && entries_since_flush >= FLUSH_BATCH_SIZE) {
+                        format_pool_collect(g_format_pool);
+                    } else {
+                        format_pool_drain(g_format_pool);
+                    }
+                }
                 text_writer_flush(g_text_writer);
             } else {
                 binwriter_flush(g_binary_writer);
             }
             entries_since_flush = 0;
+            main_flushed = 1;
 #ifndef CNANOLOG_NO_TIMESTAMPS
             last_flush_time = now;
 #endif
         }
 
+        if (g_num_sinks > 0) {
+            sinks_flush_due(main_flushed);
+        }
+
         /* Check if rotation is needed (once per loop iteration) */
         if (g_rotation_policy != CNANOLOG_ROTATE_NONE) {
             check_and_rotate_if_needed();
         }
 
+#ifdef PLATFORM_POSIX
+        __atomic_store_n(&g_writer_busy, 0, __ATOMIC_SEQ_CST);
+#endif
+
         if (!found_work) {
             struct timespec ts = {0, 100000};  /* 100us */
             nanosleep(&ts, NULL);
@@ -960,6 +2491,22 @@ static staging_buffer_t* get_or_create_staging_buffer(void) {
     uint32_t thread_id = g_next_thread_id++;
 #endif
 
+    if (g_shm_used) {
+        /* Out-of-process writer: the agent finds the buffer in the segment */
+        staging_buffer_t* sb = (g_shm != NULL) ? shm_segment_claim_buffer(g_shm, thread_id) : NULL;
+        if (sb == NULL) {
+            static int warned = 0;
+            if (!__atomic_exchange_n(&warned, 1, __ATOMIC_RELAXED)) {
+                fprintf(stderr, "cnanolog: No shared staging buffer left for thread %u\n", thread_id);
+            }
+            return NULL;
+        }
+        cnanolog_thread_get_name(sb->name, sizeof(sb->name));
+        tls_staging_buffer = sb;
+        tls_thread_id = thread_id;
+        return sb;
+    }
+
     staging_buffer_t* sb = staging_buffer_create(thread_id);
     if (sb == NULL) {
         fprintf(stderr, "cnanolog: Failed to allocate staging buffer for thread %u\n", thread_id);
@@ -972,7 +2519,9 @@ static staging_buffer_t* get_or_create_staging_buffer(void) {
         return NULL;
     }
 
+    cnanolog_thread_get_name(sb->name, sizeof(sb->name));
     tls_staging_buffer = sb;
+    tls_thread_id = thread_id;
     return sb;
 }
 
@@ -982,7 +2531,10 @@ static staging_buffer_t* get_or_create_staging_buffer(void) {
 
 #ifndef CNANOLOG_NO_TIMESTAMPS
 static uint64_t get_timestamp(void) {
-    return rdtsc();
+    if (likely(g_clock_source == TSC_SOURCE_CYCLES)) {
+        return rdtsc();
+    }
+    return tsc_monotonic_ns();
 }
 #endif
 
@@ -1001,7 +2553,7 @@ void cnanolog_get_stats(cnanolog_stats_t* stats) {
     stats->background_wakeups = g_stats.background_wakeups;
 
     /* Get bytes written from appropriate writer */
-    if (g_output_format == CNANOLOG_OUTPUT_TEXT && g_text_writer != NULL) {
+    if (g_output_format != CNANOLOG_OUTPUT_BINARY && g_text_writer != NULL) {
         stats->total_bytes_written = text_writer_get_bytes_written(g_text_writer);
     } else if (g_binary_writer != NULL) {
         stats->total_bytes_written = binwriter_get_bytes_written(g_binary_writer);
@@ -1032,6 +2584,111 @@ void cnanolog_reset_stats(void) {
     g_stats.bytes_compressed_to = 0;
     g_stats.background_wakeups = 0;
 #endif
+#if LATENCY_TRACKING
+    for (thread_latency_t* latency = g_thread_latencies; latency != NULL; latency = latency->next) {
+        latency_reset(&latency->call_cost);
+    }
+    latency_reset(&g_staging_delay);
+#endif
+}
+
+int cnanolog_get_latency_stats(cnanolog_latency_stats_t* stats) {
+    if (stats == NULL) {
+        return -1;
+    }
+    memset(stats, 0, sizeof(*stats));
+
+#if LATENCY_TRACKING
+    latency_histogram_t merged;
+    latency_reset(&merged);
+#if defined(__GNUC__) || defined(__clang__)
+    thread_latency_t* latency = __atomic_load_n(&g_thread_latencies, __ATOMIC_ACQUIRE);
+#else
+    thread_latency_t* latency = g_thread_latencies;
+#endif
+    for (; latency != NULL; latency = latency->next) {
+        latency_merge(&merged, &latency->call_cost);
+    }
+
+    fill_latency(&stats->call_cost, &merged);
+    fill_latency(&stats->staging_delay, &g_staging_delay);
+    stats->ticks_per_second = g_timestamp_frequency;
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+/**
+ * Staging buffer at an index of the registry (in-process writer) or the
+ * segment (shared mode), NULL past the end.
+ */
+static staging_buffer_t* staging_buffer_at(uint32_t index) {
+    if (g_shm != NULL) {
+        uint32_t count = __atomic_load_n(&g_shm->num_buffers, __ATOMIC_ACQUIRE);
+        return (index < count) ? shm_segment_buffer(g_shm, index) : NULL;
+    }
+    if (index >= g_buffer_registry.count || index >= MAX_STAGING_BUFFERS) {
+        return NULL;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    return __atomic_load_n(&g_buffer_registry.buffers[index], __ATOMIC_ACQUIRE);
+#else
+    return g_buffer_registry.buffers[index];
+#endif
+}
+
+int cnanolog_get_buffer_info(cnanolog_buffer_info_t* info, size_t max_buffers) {
+    if (!g_is_initialized || (info == NULL && max_buffers > 0)) {
+        return 0;
+    }
+
+    uint64_t now_ns = tsc_monotonic_ns();
+    uint32_t count = 0;
+    staging_buffer_t* sb;
+    while ((sb = staging_buffer_at(count)) != NULL) {
+        if (count < max_buffers) {
+            cnanolog_buffer_info_t* out = &info[count];
+            memset(out, 0, sizeof(*out));
+            out->thread_id = sb->thread_id;
+            memcpy(out->name, sb->name, sizeof(out->name) - 1);  /* May be renamed meanwhile */
+            out->capacity = STAGING_BUFFER_SIZE;
+            out->used = staging_used(sb);
+            out->fill_percent = (uint32_t)(out->used * 100 / STAGING_BUFFER_SIZE);
+            out->high_water = sb->high_water;
+            if (out->used > out->high_water) {
+                out->high_water = out->used;  /* Filled further since the last drain */
+            }
+            out->drops = sb->drops;
+            out->bytes_produced = sb->bytes_produced;
+            uint64_t last_drain_ns = sb->last_drain_ns;
+            if (last_drain_ns == 0) {
+                out->ns_since_drain = UINT64_MAX;
+            } else {
+                out->ns_since_drain = (now_ns > last_drain_ns) ? now_ns - last_drain_ns : 0;
+            }
+        }
+        count++;
+    }
+    return (int)count;
+}
+
+int cnanolog_set_thread_name(const char* name) {
+    if (!g_is_initialized || name == NULL) {
+        return -1;
+    }
+    staging_buffer_t* sb = get_or_create_staging_buffer();
+    if (sb == NULL) {
+        return -1;
+    }
+
+    size_t len = strlen(name);
+    if (len >= sizeof(sb->name)) {
+        len = sizeof(sb->name) - 1;
+    }
+    memcpy(sb->name, name, len);
+    sb->name[len] = '\0';
+    return 0;
 }
 
 void cnanolog_preallocate(void) {
@@ -1050,5 +2707,10 @@ int cnanolog_set_writer_affinity(int core_id) {
         return -1;
     }
 
+    if (g_shm != NULL) {
+        fprintf(stderr, "cnanolog_set_writer_affinity: Writer runs in cnanolog-agent\n");
+        return -1;
+    }
+
     return cnanolog_thread_set_affinity(g_writer_thread, core_id);
 }
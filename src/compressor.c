@@ -5,6 +5,7 @@
 #include "compressor.h"
 #include "packer.h"
 #include "../include/cnanolog_format.h"
+#include <stdlib.h>
 #include <string.h>
 
 /* ============================================================================
@@ -14,7 +15,8 @@
 int count_non_string_args(const log_site_t* site) {
     int count = 0;
     for (uint8_t i = 0; i < site->num_args; i++) {
-        if (site->arg_types[i] != ARG_TYPE_STRING) {
+        if (site->arg_types[i] != ARG_TYPE_STRING &&
+            site->arg_types[i] != ARG_TYPE_INTERNED) {
             count++;
         }
     }
@@ -22,10 +24,76 @@ int count_non_string_args(const log_site_t* site) {
 }
 
 size_t compress_max_size(const log_site_t* site, size_t uncompressed_len) {
-    /* Worst case: nibbles + all data unchanged */
+    /* Worst case: nibbles + all data unchanged + a window byte per double
+     * + a varint instead of a 4-byte length per string + interned text */
     int num_int_args = count_non_string_args(site);
-    size_t nibble_size = nibble_bytes(num_int_args);
-    return nibble_size + uncompressed_len;
+    size_t max_size = nibble_bytes(num_int_args) + uncompressed_len;
+    for (uint8_t i = 0; i < site->num_args; i++) {
+        switch (site->arg_types[i]) {
+            case ARG_TYPE_DOUBLE:
+                max_size += XOR_MAX_BYTES - sizeof(double);
+                break;
+            case ARG_TYPE_STRING:
+                max_size += CNANOLOG_VARINT_MAX_BYTES - sizeof(uint32_t);
+                break;
+            case ARG_TYPE_INTERNED:
+                max_size += CNANOLOG_VARINT_MAX_BYTES + CNANOLOG_INTERN_MAX_LEN - sizeof(uint64_t);
+                break;
+            default:
+                break;
+        }
+    }
+    return max_size;
+}
+
+/* ============================================================================
+ * Argument History
+ * ============================================================================ */
+
+void compress_history_init(compress_history_t* history) {
+    history->sites = NULL;
+    history->capacity = 0;
+    string_intern_reset(&history->strings);
+}
+
+arg_slot_t* compress_history_get(compress_history_t* history, const log_site_t* site) {
+    if (site->log_id >= history->capacity) {
+        uint32_t new_capacity = history->capacity ? history->capacity : 64;
+        while (new_capacity <= site->log_id) {
+            new_capacity *= 2;
+        }
+        arg_slot_t** new_sites = (arg_slot_t**)realloc(history->sites,
+                                                        new_capacity * sizeof(arg_slot_t*));
+        if (new_sites == NULL) {
+            return NULL;
+        }
+        memset(new_sites + history->capacity, 0,
+               (new_capacity - history->capacity) * sizeof(arg_slot_t*));
+        history->sites = new_sites;
+        history->capacity = new_capacity;
+    }
+
+    arg_slot_t* slots = history->sites[site->log_id];
+    if (slots == NULL) {
+        slots = (arg_slot_t*)calloc(site->num_args ? site->num_args : 1, sizeof(arg_slot_t));
+        history->sites[site->log_id] = slots;
+    }
+    return slots;
+}
+
+void compress_history_reset(compress_history_t* history) {
+    /* Freed slot arrays come back zeroed on next use */
+    for (uint32_t i = 0; i < history->capacity; i++) {
+        free(history->sites[i]);
+        history->sites[i] = NULL;
+    }
+    string_intern_reset(&history->strings);
+}
+
+void compress_history_destroy(compress_history_t* history) {
+    compress_history_reset(history);
+    free(history->sites);
+    compress_history_init(history);
 }
 
 /* ============================================================================
@@ -36,12 +104,20 @@ int compress_entry_args(const char* uncompressed,
                         size_t uncompressed_len,
                         char* compressed,
                         size_t* compressed_len,
-                        const log_site_t* site) {
+                        const log_site_t* site,
+                        arg_slot_t* history,
+                        string_intern_t* strings) {
 
     if (!uncompressed || !compressed || !compressed_len || !site) {
         return -1;
     }
 
+    arg_slot_t fresh[CNANOLOG_MAX_ARGS];
+    if (history == NULL) {
+        memset(fresh, 0, sizeof(fresh));
+        history = fresh;
+    }
+
     const char* read_ptr = uncompressed;
     char* write_ptr = compressed;
 
@@ -55,7 +131,7 @@ int compress_entry_args(const char* uncompressed,
     int nibble_idx = 0;
 
     /* ==================================================================
-     * PASS 1: Pack integers using variable-byte encoding
+     * PASS 1: Pack integers and doubles against the site's history
      * ================================================================== */
 
     for (uint8_t i = 0; i < site->num_args; i++) {
@@ -76,11 +152,9 @@ int compress_entry_args(const char* uncompressed,
                 memcpy(&val, read_ptr, sizeof(int32_t));
                 read_ptr += sizeof(int32_t);
 
-                int is_negative;
-                uint8_t num_bytes = pack_int32(&write_ptr, val, &is_negative);
-
-                /* Store nibble: high bit = sign, low 4 bits = size */
-                uint8_t nibble = num_bytes | (is_negative ? 0x08 : 0x00);
+                /* Delta against this slot's previous value, or zig-zag absolute */
+                uint8_t nibble = pack_int_delta(&write_ptr, (uint64_t)(int64_t)val, 1,
+                                                &history[i].num);
                 set_nibble(nibbles, nibble_idx++, nibble);
                 break;
             }
@@ -90,10 +164,8 @@ int compress_entry_args(const char* uncompressed,
                 memcpy(&val, read_ptr, sizeof(int64_t));
                 read_ptr += sizeof(int64_t);
 
-                int is_negative;
-                uint8_t num_bytes = pack_int64(&write_ptr, val, &is_negative);
-
-                uint8_t nibble = num_bytes | (is_negative ? 0x08 : 0x00);
+                uint8_t nibble = pack_int_delta(&write_ptr, (uint64_t)val, 1,
+                                                &history[i].num);
                 set_nibble(nibbles, nibble_idx++, nibble);
                 break;
             }
@@ -103,8 +175,8 @@ int compress_entry_args(const char* uncompressed,
                 memcpy(&val, read_ptr, sizeof(uint32_t));
                 read_ptr += sizeof(uint32_t);
 
-                uint8_t num_bytes = pack_uint32(&write_ptr, val);
-                set_nibble(nibbles, nibble_idx++, num_bytes);
+                uint8_t nibble = pack_int_delta(&write_ptr, val, 0, &history[i].num);
+                set_nibble(nibbles, nibble_idx++, nibble);
                 break;
             }
 
@@ -113,30 +185,30 @@ int compress_entry_args(const char* uncompressed,
                 memcpy(&val, read_ptr, sizeof(uint64_t));
                 read_ptr += sizeof(uint64_t);
 
-                uint8_t num_bytes = pack_uint64(&write_ptr, val);
-                set_nibble(nibbles, nibble_idx++, num_bytes);
+                uint8_t nibble = pack_int_delta(&write_ptr, val, 0, &history[i].num);
+                set_nibble(nibbles, nibble_idx++, nibble);
                 break;
             }
 
             case ARG_TYPE_DOUBLE: {
-                /* Doubles: store as-is (no compression) */
-                memcpy(write_ptr, read_ptr, sizeof(double));
+                double val;
+                memcpy(&val, read_ptr, sizeof(double));
                 read_ptr += sizeof(double);
-                write_ptr += sizeof(double);
 
-                /* Nibble = 8 (always 8 bytes for double) */
-                set_nibble(nibbles, nibble_idx++, 8);
+                /* Match or XOR against this slot's recent values */
+                uint8_t nibble = pack_double_xor(&write_ptr, val, &history[i].dbl);
+                set_nibble(nibbles, nibble_idx++, nibble);
                 break;
             }
 
             case ARG_TYPE_POINTER: {
-                /* Pointers: compress as uint64 */
+                /* Pointers: compress as uint64 (nearby allocations delta well) */
                 uint64_t val;
                 memcpy(&val, read_ptr, sizeof(uint64_t));
                 read_ptr += sizeof(uint64_t);
 
-                uint8_t num_bytes = pack_uint64(&write_ptr, val);
-                set_nibble(nibbles, nibble_idx++, num_bytes);
+                uint8_t nibble = pack_int_delta(&write_ptr, val, 0, &history[i].num);
+                set_nibble(nibbles, nibble_idx++, nibble);
                 break;
             }
 
@@ -148,33 +220,41 @@ int compress_entry_args(const char* uncompressed,
                 break;
             }
 
+            case ARG_TYPE_INTERNED:
+                read_ptr += sizeof(uint64_t);
+                break;
+
             default:
                 break;
         }
     }
 
     /* ==================================================================
-     * PASS 2: Copy strings as-is
+     * PASS 2: Write strings as intern ids or text
      * ================================================================== */
 
     read_ptr = uncompressed;  /* Reset read pointer */
 
     for (uint8_t i = 0; i < site->num_args; i++) {
         if (site->arg_types[i] == ARG_TYPE_STRING) {
-            /* Copy length + string data */
             uint32_t len;
             memcpy(&len, read_ptr, sizeof(uint32_t));
             read_ptr += sizeof(uint32_t);
 
-            memcpy(write_ptr, &len, sizeof(uint32_t));
-            write_ptr += sizeof(uint32_t);
-
-            if (len > 0) {
-                memcpy(write_ptr, read_ptr, len);
-                write_ptr += len;
-            }
-
+            pack_string_interned(&write_ptr, read_ptr, len, strings);
             read_ptr += len;
+        } else if (site->arg_types[i] == ARG_TYPE_INTERNED) {
+            /* Handle staged by pointer; the text lives as long as the process */
+            uint64_t bits;
+            memcpy(&bits, read_ptr, sizeof(uint64_t));
+            read_ptr += sizeof(uint64_t);
+            const cnanolog_string_t* handle = (const cnanolog_string_t*)(uintptr_t)bits;
+
+            if (handle != NULL) {
+                pack_string_interned(&write_ptr, handle->str, handle->len, strings);
+            } else {
+                pack_string_interned(&write_ptr, "", 0, strings);
+            }
         } else {
             /* Skip non-strings (already processed in pass 1) */
             switch (site->arg_types[i]) {
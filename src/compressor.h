@@ -2,12 +2,14 @@
  * CNanoLog Entry Compressor
  *
  * Compress log entry arguments using variable-byte integer encoding.
- * Integers are compressed, strings are kept as-is.
+ * Integers are compressed, repeated strings become intern table ids.
  */
 
 #pragma once
 
 #include "log_registry.h"
+#include "packer.h"
+#include "string_intern.h"
 #include <stddef.h>
 #include <stdint.h>
 
@@ -15,6 +17,51 @@
 extern "C" {
 #endif
 
+/* ============================================================================
+ * Argument History
+ * ============================================================================ */
+
+/**
+ * Per-site, per-argument history for delta-encoded integers and
+ * XOR-encoded doubles, plus the string intern table shared by all sites.
+ * Owned by the writer thread; one slot array per log_id, allocated the
+ * first time the site is written. Reset at every clock sync record and new
+ * file, where decoders reset theirs too - so a reader can start at any
+ * sync record.
+ */
+typedef struct {
+    arg_slot_t** sites;  /* Indexed by log_id (NULL = not written yet) */
+    uint32_t capacity;   /* Length of sites */
+    string_intern_t strings;
+} compress_history_t;
+
+void compress_history_init(compress_history_t* history);
+
+/**
+ * Get the slot array (site->num_args entries) for a site, allocating it
+ * on first use.
+ *
+ * @return Slot array, or NULL if out of memory
+ */
+arg_slot_t* compress_history_get(compress_history_t* history, const log_site_t* site);
+
+/**
+ * Get a site's slot array if it has one. Never allocates (crash handlers).
+ *
+ * @return Slot array, or NULL if the site has not been written since reset
+ */
+static inline arg_slot_t* compress_history_peek(const compress_history_t* history,
+                                                uint32_t log_id) {
+    return log_id < history->capacity ? history->sites[log_id] : NULL;
+}
+
+/**
+ * Forget all previous values and strings (sync record or start of a new file).
+ */
+void compress_history_reset(compress_history_t* history);
+
+void compress_history_destroy(compress_history_t* history);
+
 /* ============================================================================
  * Compression API
  * ============================================================================ */
@@ -23,29 +70,38 @@ extern "C" {
  * Compress log entry argument data.
  *
  * Takes uncompressed argument data (as packed by arg_packing.h) and compresses
- * integers using variable-byte encoding. Strings are copied as-is.
+ * integers as variable-byte deltas or absolute values, and doubles as
+ * matches or XORs against recent values in the same slot. Strings are
+ * written as intern table ids once seen, as text before that.
  *
  * Compressed format:
- *   [Nibbles: N/2 bytes]  ← Compression metadata for integers
- *   [Packed Integers]     ← Variable-byte encoded
- *   [Strings]             ← Length + data (uncompressed)
+ *   [Nibbles: N/2 bytes]  ← Compression metadata for integers and doubles
+ *   [Packed Integers]     ← Variable-byte encoded / XOR-encoded doubles
+ *   [Strings]             ← Varint tag: intern id, or length + text
  *
  * @param uncompressed Uncompressed argument data
  * @param uncompressed_len Length of uncompressed data
  * @param compressed Output buffer for compressed data
  * @param compressed_len Output: length of compressed data
  * @param site Log site information (argument types)
+ * @param history Slot array from compress_history_get() (updated), or NULL
+ *                to encode against zeroed history (a self-contained entry)
+ * @param strings Intern table (updated), or NULL to write all strings as text
  * @return 0 on success, -1 on error
  */
 int compress_entry_args(const char* uncompressed,
                         size_t uncompressed_len,
                         char* compressed,
                         size_t* compressed_len,
-                        const log_site_t* site);
+                        const log_site_t* site,
+                        arg_slot_t* history,
+                        string_intern_t* strings);
 
 /**
  * Calculate maximum size needed for compressed data.
- * Worst case: all integers are 8 bytes + nibble overhead + strings unchanged.
+ * Worst case: all integers are 8 bytes + nibble overhead + strings unchanged,
+ * plus one control byte per double, a longer length per string and the
+ * text of each pre-interned string.
  *
  * @param site Log site information
  * @param uncompressed_len Length of uncompressed data
@@ -55,6 +111,7 @@ size_t compress_max_size(const log_site_t* site, size_t uncompressed_len);
 
 /**
  * Count number of non-string arguments (for nibble calculation).
+ * Pre-interned strings count as strings.
  *
  * @param site Log site information
  * @return Number of integer/double/pointer arguments
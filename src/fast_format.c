@@ -0,0 +1,471 @@
+/* Copyright (c) 2025
+ * CNanoLog Fast Number and Timestamp Formatting Implementation
+ */
+
+#include "fast_format.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+/* ============================================================================
+ * Tables
+ * ============================================================================ */
+
+static const char k_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const uint64_t k_pow10[20] = {
+    1ULL,
+    10ULL,
+    100ULL,
+    1000ULL,
+    10000ULL,
+    100000ULL,
+    1000000ULL,
+    10000000ULL,
+    100000000ULL,
+    1000000000ULL,
+    10000000000ULL,
+    100000000000ULL,
+    1000000000000ULL,
+    10000000000000ULL,
+    100000000000000ULL,
+    1000000000000000ULL,
+    10000000000000000ULL,
+    100000000000000000ULL,
+    1000000000000000000ULL,
+    10000000000000000000ULL
+};
+
+/* ============================================================================
+ * Integer Formatting
+ * ============================================================================ */
+
+/**
+ * Number of decimal digits in val (1 for 0).
+ */
+static inline int count_digits(uint64_t val) {
+    int n = 1;
+    while (n < 20 && val >= k_pow10[n]) {
+        n++;
+    }
+    return n;
+}
+
+/**
+ * Write val right-aligned into out[0..n) using digit pairs.
+ */
+static inline void write_digits(char* out, uint64_t val, int n) {
+    char* p = out + n;
+    while (val >= 100) {
+        unsigned idx = (unsigned)(val % 100) * 2;
+        val /= 100;
+        p -= 2;
+        memcpy(p, k_digit_pairs + idx, 2);
+    }
+    if (val >= 10) {
+        p -= 2;
+        memcpy(p, k_digit_pairs + val * 2, 2);
+    } else {
+        *--p = (char)('0' + val);
+    }
+}
+
+size_t fmt_u64(char* out, uint64_t val) {
+    int n = count_digits(val);
+    write_digits(out, val, n);
+    return (size_t)n;
+}
+
+size_t fmt_i64(char* out, int64_t val) {
+    if (val < 0) {
+        out[0] = '-';
+        /* Negate in unsigned space so INT64_MIN is handled */
+        return 1 + fmt_u64(out + 1, 0 - (uint64_t)val);
+    }
+    return fmt_u64(out, (uint64_t)val);
+}
+
+void fmt_u64_padded(char* out, uint64_t val, int width) {
+    char* p = out + width;
+    while (p - out >= 2) {
+        unsigned idx = (unsigned)(val % 100) * 2;
+        val /= 100;
+        p -= 2;
+        memcpy(p, k_digit_pairs + idx, 2);
+    }
+    if (p > out) {
+        *--p = (char)('0' + val % 10);
+    }
+}
+
+size_t fmt_hex(char* out, uint64_t val, int upper) {
+    const char* digits = upper ? "0123456789ABCDEF" : "0123456789abcdef";
+    int n = 1;
+    while (n < 16 && (val >> (n * 4)) != 0) {
+        n++;
+    }
+    for (int i = n - 1; i >= 0; i--) {
+        out[i] = digits[val & 0xF];
+        val >>= 4;
+    }
+    return (size_t)n;
+}
+
+/* ============================================================================
+ * Floating Point Formatting
+ *
+ * All fast paths work on the exact binary value (m * 2^e) with 128-bit
+ * integer arithmetic, so results do not depend on FPU rounding or on
+ * -ffast-math, which the Release build enables.
+ * ============================================================================ */
+
+/**
+ * Write nan/inf if the bit pattern is non-finite.
+ * @return Characters written, or 0 if val is finite
+ */
+static size_t write_non_finite(char* out, uint64_t bits) {
+    if (((bits >> 52) & 0x7FF) != 0x7FF) {
+        return 0;
+    }
+    size_t n = 0;
+    if (bits >> 63) {
+        out[n++] = '-';
+    }
+    if (bits & ((1ULL << 52) - 1)) {
+        memcpy(out + n, "nan", 3);
+    } else {
+        memcpy(out + n, "inf", 3);
+    }
+    return n + 3;
+}
+
+/**
+ * Write r / 10^k in fixed notation with exactly k fractional digits.
+ */
+static size_t write_fixed(char* out, uint64_t r, int k) {
+    uint64_t int_part = (k > 0) ? r / k_pow10[k] : r;
+    size_t n = fmt_u64(out, int_part);
+    if (k > 0) {
+        out[n++] = '.';
+        fmt_u64_padded(out + n, r - int_part * k_pow10[k], k);
+        n += (size_t)k;
+    }
+    return n;
+}
+
+#ifdef __SIZEOF_INT128__
+
+typedef unsigned __int128 u128_t;
+
+/**
+ * Split a finite, positive double into m * 2^e.
+ * @return non-zero if the lower neighbour is closer than the upper one
+ *         (m is an exact power of two with a normal exponent)
+ */
+static int decompose(uint64_t bits, uint64_t* m, int* e) {
+    int exp = (int)((bits >> 52) & 0x7FF);
+    uint64_t frac = bits & ((1ULL << 52) - 1);
+    if (exp == 0) {
+        *m = frac;
+        *e = -1074;
+        return 0;
+    }
+    *m = frac | (1ULL << 52);
+    *e = exp - 1075;
+    return (frac == 0 && exp > 1);
+}
+
+/**
+ * Round N / 2^s to nearest, ties to even (matches glibc printf).
+ */
+static inline u128_t round_shift(u128_t n, int s) {
+    if (s == 0) {
+        return n;
+    }
+    u128_t q = n >> s;
+    u128_t rem = n & ((((u128_t)1) << s) - 1);
+    u128_t half = ((u128_t)1) << (s - 1);
+    if (rem > half || (rem == half && (q & 1))) {
+        q++;
+    }
+    return q;
+}
+
+/**
+ * Find the fewest decimal places k such that round(v * 10^k) / 10^k parses
+ * back to v, where v = m * 2^-s (0 <= s <= 120).
+ * @return 0 on success (r, k filled), -1 if no k <= 19 fits in 64 bits
+ */
+static int shortest_decimal(uint64_t m, int s, int asymmetric,
+                            uint64_t* out_r, int* out_k) {
+    for (int k = 0; k < 20; k++) {
+        u128_t n = (u128_t)m * k_pow10[k];
+        u128_t r = round_shift(n, s);
+        if ((r >> 64) != 0) {
+            return -1;
+        }
+
+        /* Distance to v in units of 2^-s * 10^-k, doubled to avoid halves */
+        u128_t scaled = r << s;
+        int below = scaled < n;
+        u128_t diff2 = (below ? n - scaled : scaled - n) * 2;
+        u128_t limit = k_pow10[k];
+        if (below && asymmetric) {
+            diff2 *= 2;  /* Half-gap below a power of two is half as wide */
+        }
+        if (diff2 < limit) {
+            *out_r = (uint64_t)r;
+            *out_k = k;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+size_t fmt_double_shortest(char* out, double val) {
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+
+    size_t n = write_non_finite(out, bits);
+    if (n > 0) {
+        return n;
+    }
+    if (bits >> 63) {
+        out[n++] = '-';
+        bits &= ~(1ULL << 63);
+    }
+    if (bits == 0) {
+        out[n++] = '0';
+        return n;
+    }
+
+    uint64_t m;
+    int e;
+    int asymmetric = decompose(bits, &m, &e);
+
+    if (e >= 0) {
+        /* Integral value: exact if it fits in 64 bits */
+        if (e < 11) {
+            return n + fmt_u64(out + n, m << e);
+        }
+    } else if (e >= -120) {
+        uint64_t r;
+        int k;
+        if (shortest_decimal(m, -e, asymmetric, &r, &k) == 0) {
+            return n + write_fixed(out + n, r, k);
+        }
+    }
+
+    /* Very large or very small magnitude: 17 digits always round-trip */
+    double abs_val;
+    memcpy(&abs_val, &bits, sizeof(abs_val));
+    int w = snprintf(out + n, FMT_DOUBLE_MAX_CHARS - n, "%.17g", abs_val);
+    return n + (w > 0 ? (size_t)w : 0);
+}
+
+size_t fmt_double_fixed(char* out, double val, int precision) {
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+
+    size_t n = write_non_finite(out, bits);
+    if (n > 0) {
+        return n;
+    }
+
+    if (precision >= 0 && precision <= 9) {
+        uint64_t abs_bits = bits & ~(1ULL << 63);
+        uint64_t m;
+        int e;
+        decompose(abs_bits, &m, &e);
+
+        u128_t r = 0;
+        int ok = 1;
+        if (e >= 0) {
+            ok = (e < 11);
+            if (ok) {
+                r = ((u128_t)(m << e)) * k_pow10[precision];
+            }
+        } else if (e >= -120) {
+            r = round_shift((u128_t)m * k_pow10[precision], -e);
+        }
+        /* else: |val| < 2^-67, rounds to zero at any precision <= 9 */
+
+        if (ok && (r >> 64) == 0) {
+            if (bits >> 63) {
+                out[n++] = '-';
+            }
+            return n + write_fixed(out + n, (uint64_t)r, precision);
+        }
+    }
+
+    int w = snprintf(out, FMT_DOUBLE_MAX_CHARS, "%.*f", precision, val);
+    return (w > 0 && w < FMT_DOUBLE_MAX_CHARS) ? (size_t)w : 0;  /* 0: did not fit */
+}
+
+size_t fmt_double_general(char* out, double val) {
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+
+    size_t n = write_non_finite(out, bits);
+    if (n > 0) {
+        return n;
+    }
+
+    uint64_t abs_bits = bits & ~(1ULL << 63);
+    if (abs_bits == 0) {
+        if (bits >> 63) {
+            out[n++] = '-';
+        }
+        out[n++] = '0';
+        return n;
+    }
+
+    uint64_t m;
+    int e;
+    int asymmetric = decompose(abs_bits, &m, &e);
+
+    /*
+     * If the shortest round-trip form has at most 6 significant digits and
+     * its decimal exponent X satisfies -4 <= X < 6, "%g" prints exactly that
+     * form: rounding v to 6 digits lands on the same decimal because v lies
+     * within half an ulp of it.
+     */
+    uint64_t r;
+    int k;
+    if (e < 0 && e >= -120 &&
+        shortest_decimal(m, -e, asymmetric, &r, &k) == 0) {
+        int digits = count_digits(r);
+        int exp10 = digits - k - 1;
+        if (digits <= 6 && exp10 >= -4 && exp10 < 6) {
+            if (bits >> 63) {
+                out[n++] = '-';
+            }
+            return n + write_fixed(out + n, r, k);
+        }
+    } else if (e >= 0 && e < 11) {
+        uint64_t iv = m << e;
+        if (iv < 1000000ULL) {
+            if (bits >> 63) {
+                out[n++] = '-';
+            }
+            return n + fmt_u64(out + n, iv);
+        }
+    }
+
+    int w = snprintf(out, FMT_DOUBLE_MAX_CHARS, "%g", val);
+    return (w > 0 && w < FMT_DOUBLE_MAX_CHARS) ? (size_t)w : FMT_DOUBLE_MAX_CHARS - 1;
+}
+
+#else /* !__SIZEOF_INT128__ */
+
+/* No 128-bit integers: keep the libc slow path for doubles */
+
+size_t fmt_double_shortest(char* out, double val) {
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    size_t n = write_non_finite(out, bits);
+    if (n > 0) {
+        return n;
+    }
+    int w = snprintf(out, FMT_DOUBLE_MAX_CHARS, "%.17g", val);
+    return (w > 0 && w < FMT_DOUBLE_MAX_CHARS) ? (size_t)w : FMT_DOUBLE_MAX_CHARS - 1;
+}
+
+size_t fmt_double_fixed(char* out, double val, int precision) {
+    int w = snprintf(out, FMT_DOUBLE_MAX_CHARS, "%.*f", precision, val);
+    return (w > 0 && w < FMT_DOUBLE_MAX_CHARS) ? (size_t)w : 0;  /* 0: did not fit */
+}
+
+size_t fmt_double_general(char* out, double val) {
+    int w = snprintf(out, FMT_DOUBLE_MAX_CHARS, "%g", val);
+    return (w > 0 && w < FMT_DOUBLE_MAX_CHARS) ? (size_t)w : FMT_DOUBLE_MAX_CHARS - 1;
+}
+
+#endif /* __SIZEOF_INT128__ */
+
+/* ============================================================================
+ * Timestamp Formatting
+ * ============================================================================ */
+
+size_t fmt_timestamp(fmt_time_cache_t* cache, int64_t sec, uint32_t nsec, char* out) {
+    if (cache->prefix_len == 0 || cache->sec != sec) {
+        /* New second: render "YYYY-MM-DD HH:MM:SS." once */
+        time_t t = (time_t)sec;
+        struct tm tm_buf;
+        if (localtime_r(&t, &tm_buf) == NULL) {
+            memcpy(out, "INVALID_TIME", 12);
+            return 12;
+        }
+
+        char* p = cache->prefix;
+        fmt_u64_padded(p, (uint64_t)(tm_buf.tm_year + 1900), 4);
+        p[4] = '-';
+        fmt_u64_padded(p + 5, (uint64_t)(tm_buf.tm_mon + 1), 2);
+        p[7] = '-';
+        fmt_u64_padded(p + 8, (uint64_t)tm_buf.tm_mday, 2);
+        p[10] = ' ';
+        fmt_u64_padded(p + 11, (uint64_t)tm_buf.tm_hour, 2);
+        p[13] = ':';
+        fmt_u64_padded(p + 14, (uint64_t)tm_buf.tm_min, 2);
+        p[16] = ':';
+        fmt_u64_padded(p + 17, (uint64_t)tm_buf.tm_sec, 2);
+        p[19] = '.';
+
+        cache->sec = sec;
+        cache->prefix_len = 20;
+    }
+
+    memcpy(out, cache->prefix, 20);
+    fmt_u64_padded(out + 20, nsec, 9);
+    return FMT_TIMESTAMP_CHARS;
+}
+
+void fmt_ticks_to_wall(uint64_t timestamp, uint64_t frequency,
+                       uint64_t start_timestamp,
+                       int64_t start_sec, int32_t start_nsec,
+                       int64_t* out_sec, uint32_t* out_nsec) {
+    /* Integer math: no double rounding drift over long runs */
+    int negative = timestamp < start_timestamp;
+    uint64_t elapsed = negative ? start_timestamp - timestamp
+                                : timestamp - start_timestamp;
+
+    uint64_t whole = elapsed / frequency;
+    uint64_t rem = elapsed % frequency;
+#ifdef __SIZEOF_INT128__
+    uint64_t frac_ns = (uint64_t)(((unsigned __int128)rem * 1000000000ULL) / frequency);
+#else
+    uint64_t frac_ns = (uint64_t)((double)rem * 1e9 / (double)frequency);
+#endif
+
+    int64_t sec = start_sec;
+    int64_t nsec = start_nsec;
+    if (negative) {
+        sec -= (int64_t)whole;
+        nsec -= (int64_t)frac_ns;
+    } else {
+        sec += (int64_t)whole;
+        nsec += (int64_t)frac_ns;
+    }
+
+    /* Normalize nanoseconds into [0, 1e9) */
+    if (nsec >= 1000000000LL) {
+        sec += 1;
+        nsec -= 1000000000LL;
+    } else if (nsec < 0) {
+        sec -= 1;
+        nsec += 1000000000LL;
+    }
+
+    *out_sec = sec;
+    *out_nsec = (uint32_t)nsec;
+}
@@ -0,0 +1,161 @@
+/* Copyright (c) 2025
+ * CNanoLog Fast Number and Timestamp Formatting
+ *
+ * Hand-rolled replacements for the snprintf() calls on the text output path.
+ * Integers use a digit-pair table, doubles use an exact shortest-roundtrip
+ * search, and timestamps re-render only the nanosecond suffix while the
+ * "YYYY-MM-DD HH:MM:SS." prefix is cached per second.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Buffer Size Requirements
+ * ============================================================================ */
+
+/** Maximum characters written by fmt_u64() / fmt_i64() (no terminator). */
+#define FMT_INT_MAX_CHARS 20
+
+/** Maximum characters written by the double formatters (no terminator). */
+#define FMT_DOUBLE_MAX_CHARS 32
+
+/** Characters written by fmt_timestamp(): "YYYY-MM-DD HH:MM:SS.nnnnnnnnn" */
+#define FMT_TIMESTAMP_CHARS 29
+
+/* ============================================================================
+ * Integer Formatting
+ * ============================================================================ */
+
+/**
+ * Write the decimal representation of an unsigned integer.
+ *
+ * @param out Output buffer (at least FMT_INT_MAX_CHARS bytes)
+ * @param val Value to format
+ * @return Number of characters written (no null terminator)
+ */
+size_t fmt_u64(char* out, uint64_t val);
+
+/**
+ * Write the decimal representation of a signed integer.
+ *
+ * @param out Output buffer (at least FMT_INT_MAX_CHARS bytes)
+ * @param val Value to format
+ * @return Number of characters written (no null terminator)
+ */
+size_t fmt_i64(char* out, int64_t val);
+
+/**
+ * Write exactly 'width' decimal digits, zero-padded on the left.
+ * Digits beyond 'width' are silently dropped (caller guarantees range).
+ *
+ * @param out Output buffer (at least width bytes)
+ * @param val Value to format
+ * @param width Number of digits to emit
+ */
+void fmt_u64_padded(char* out, uint64_t val, int width);
+
+/**
+ * Write the hexadecimal representation of an unsigned integer
+ * (no "0x" prefix, no padding).
+ *
+ * @param out Output buffer (at least 16 bytes)
+ * @param val Value to format
+ * @param upper Non-zero for A-F, zero for a-f
+ * @return Number of characters written (no null terminator)
+ */
+size_t fmt_hex(char* out, uint64_t val, int upper);
+
+/* ============================================================================
+ * Floating Point Formatting
+ * ============================================================================ */
+
+/**
+ * Shortest decimal representation that parses back to exactly 'val'.
+ * Uses fixed notation when the value allows it, otherwise falls back to
+ * "%.17g". NaN and infinities are written as "nan"/"inf", which are not
+ * valid JSON numbers; callers emitting JSON must handle non-finite values.
+ *
+ * @param out Output buffer (at least FMT_DOUBLE_MAX_CHARS bytes)
+ * @param val Value to format
+ * @return Number of characters written (no null terminator)
+ */
+size_t fmt_double_shortest(char* out, double val);
+
+/**
+ * Equivalent of printf("%.*f", precision, val).
+ * Values with |val| >= 1e15 or precision > 9 take the snprintf() slow path.
+ * Large values can need up to ~320 characters; those do not fit and the
+ * caller must format them itself.
+ *
+ * @param out Output buffer (at least FMT_DOUBLE_MAX_CHARS bytes)
+ * @param val Value to format
+ * @param precision Digits after the decimal point
+ * @return Number of characters written (no null terminator), or 0 if the
+ *         result needs more than FMT_DOUBLE_MAX_CHARS - 1 characters
+ */
+size_t fmt_double_fixed(char* out, double val, int precision);
+
+/**
+ * Equivalent of printf("%g", val) (precision 6).
+ * Fast path when the shortest representation already fits in 6 significant
+ * digits and fixed notation; otherwise snprintf().
+ *
+ * @param out Output buffer (at least FMT_DOUBLE_MAX_CHARS bytes)
+ * @param val Value to format
+ * @return Number of characters written (no null terminator)
+ */
+size_t fmt_double_general(char* out, double val);
+
+/* ============================================================================
+ * Timestamp Formatting
+ * ============================================================================ */
+
+/**
+ * Per-second cache of the rendered date/time prefix.
+ * localtime_r() is only called when the second changes.
+ * Zero-initialize before first use.
+ */
+typedef struct {
+    int64_t sec;          /* Cached wall-clock second (valid if prefix_len > 0) */
+    uint32_t prefix_len;  /* 0 = empty cache */
+    char prefix[24];      /* "YYYY-MM-DD HH:MM:SS." */
+} fmt_time_cache_t;
+
+/**
+ * Write "YYYY-MM-DD HH:MM:SS.nnnnnnnnn" (local time).
+ *
+ * @param cache Per-writer prefix cache
+ * @param sec Unix epoch seconds
+ * @param nsec Nanoseconds (0-999999999)
+ * @param out Output buffer (at least FMT_TIMESTAMP_CHARS bytes)
+ * @return Number of characters written (no null terminator)
+ */
+size_t fmt_timestamp(fmt_time_cache_t* cache, int64_t sec, uint32_t nsec, char* out);
+
+/**
+ * Convert an rdtsc value to wall-clock time using calibration data.
+ * Handles timestamps taken before start_timestamp (cross-core skew).
+ *
+ * @param timestamp rdtsc value to convert
+ * @param frequency Ticks per second (must be non-zero)
+ * @param start_timestamp rdtsc value at start_sec/start_nsec
+ * @param start_sec Wall-clock seconds at start
+ * @param start_nsec Wall-clock nanoseconds at start
+ * @param out_sec Output: wall-clock seconds
+ * @param out_nsec Output: nanoseconds (0-999999999)
+ */
+void fmt_ticks_to_wall(uint64_t timestamp, uint64_t frequency,
+                       uint64_t start_timestamp,
+                       int64_t start_sec, int32_t start_nsec,
+                       int64_t* out_sec, uint32_t* out_nsec);
+
+#ifdef __cplusplus
+}
+#endif
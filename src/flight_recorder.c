@@ -0,0 +1,90 @@
+/* Copyright (c) 2025
+ * CNanoLog Flight Recorder Ring Implementation
+ */
+
+#include "flight_recorder.h"
+#include "staging_buffer.h"
+#include <stdlib.h>
+#include <string.h>
+
+/* Copy out of / into the ring at a logical offset, wrapping at the end */
+static void ring_copy_out(const flight_recorder_t* fr, uint64_t pos, char* out, size_t len) {
+    size_t offset = (size_t)(pos % fr->capacity);
+    size_t first = fr->capacity - offset;
+    if (first >= len) {
+        memcpy(out, fr->data + offset, len);
+    } else {
+        memcpy(out, fr->data + offset, first);
+        memcpy(out + first, fr->data, len - first);
+    }
+}
+
+static void ring_copy_in(flight_recorder_t* fr, uint64_t pos, const char* in, size_t len) {
+    size_t offset = (size_t)(pos % fr->capacity);
+    size_t first = fr->capacity - offset;
+    if (first >= len) {
+        memcpy(fr->data + offset, in, len);
+    } else {
+        memcpy(fr->data + offset, in, first);
+        memcpy(fr->data, in + first, len - first);
+    }
+}
+
+/* Size of the entry at a logical offset (from its header and length prefix) */
+static size_t ring_entry_size(const flight_recorder_t* fr, uint64_t pos) {
+    char prefix[STAGING_EXTENDED_PREFIX_SIZE];
+    size_t avail = (size_t)(fr->tail - pos);
+    ring_copy_out(fr, pos, prefix, avail < sizeof(prefix) ? avail : sizeof(prefix));
+    return staging_entry_size(prefix);
+}
+
+int flight_recorder_init(flight_recorder_t* fr, size_t capacity) {
+    if (capacity == 0) {
+        capacity = FLIGHT_RECORDER_DEFAULT_CAPACITY;
+    }
+    memset(fr, 0, sizeof(*fr));
+    fr->data = (char*)malloc(capacity);
+    if (fr->data == NULL) {
+        return -1;
+    }
+    fr->capacity = capacity;
+    return 0;
+}
+
+void flight_recorder_destroy(flight_recorder_t* fr) {
+    free(fr->data);
+    memset(fr, 0, sizeof(*fr));
+}
+
+int flight_recorder_append(flight_recorder_t* fr, const char* entry, size_t size) {
+    if (size > fr->capacity) {
+        return -1;
+    }
+
+    /* Overwrite oldest */
+    while (fr->tail - fr->head + size > fr->capacity) {
+        fr->head += ring_entry_size(fr, fr->head);
+        fr->entries--;
+        fr->overwritten++;
+    }
+
+    ring_copy_in(fr, fr->tail, entry, size);
+    fr->tail += size;
+    fr->entries++;
+    return 0;
+}
+
+size_t flight_recorder_read(const flight_recorder_t* fr, uint64_t* pos, char* out) {
+    if (*pos >= fr->tail) {
+        return 0;
+    }
+    size_t size = ring_entry_size(fr, *pos);
+    ring_copy_out(fr, *pos, out, size);
+    *pos += size;
+    return size;
+}
+
+void flight_recorder_clear(flight_recorder_t* fr) {
+    fr->head = fr->tail;
+    fr->entries = 0;
+}
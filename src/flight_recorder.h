@@ -0,0 +1,62 @@
+/* Copyright (c) 2025
+ * CNanoLog Flight Recorder Ring
+ *
+ * Bounded in-memory ring of staged entries (header, length prefix and
+ * argument data, exactly as in the staging buffers). Appending to a full
+ * ring drops the oldest entries. Owned by the writer thread.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define FLIGHT_RECORDER_DEFAULT_CAPACITY (16 * 1024 * 1024)
+
+typedef struct {
+    char* data;
+    size_t capacity;
+    uint64_t head;         /* Logical offset of the oldest entry */
+    uint64_t tail;         /* Logical offset one past the newest entry */
+    uint64_t entries;      /* Entries held */
+    uint64_t overwritten;  /* Entries dropped to make room (since creation) */
+} flight_recorder_t;
+
+/**
+ * Allocate the ring.
+ *
+ * @param capacity Ring size in bytes (0 = FLIGHT_RECORDER_DEFAULT_CAPACITY)
+ * @return 0 on success, -1 if allocation failed
+ */
+int flight_recorder_init(flight_recorder_t* fr, size_t capacity);
+
+void flight_recorder_destroy(flight_recorder_t* fr);
+
+/**
+ * Append one staged entry, dropping the oldest entries until it fits.
+ * Entries may wrap around the end of the ring.
+ *
+ * @return 0 on success, -1 if the entry is larger than the ring
+ */
+int flight_recorder_append(flight_recorder_t* fr, const char* entry, size_t size);
+
+/**
+ * Copy the entry at *pos (start at fr->head) into out and advance *pos.
+ *
+ * @param out Buffer of at least STAGING_MAX_ENTRY_SIZE bytes
+ * @return Size of the entry, or 0 at the end of the ring
+ */
+size_t flight_recorder_read(const flight_recorder_t* fr, uint64_t* pos, char* out);
+
+/**
+ * Drop all entries (after a dump).
+ */
+void flight_recorder_clear(flight_recorder_t* fr);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,316 @@
+/* Copyright (c) 2025
+ * CNanoLog Formatter Pool Implementation
+ *
+ * Batches live in a ring indexed by sequence number. The writer thread fills
+ * batch fill_seq, workers take queued batches in sequence order, and the
+ * writer appends rendered batches starting at write_seq. Only the batch
+ * state handoff takes the lock; rendering and appending run unlocked.
+ */
+
+#include "format_pool.h"
+#include "platform.h"
+#include "staging_buffer.h"
+#include "../include/cnanolog_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Initial rendered-output capacity per batch (grows on demand) */
+#define INITIAL_OUTPUT_SIZE (4 * FORMAT_POOL_BATCH_SIZE)
+
+/* ============================================================================
+ * Pool Implementation
+ * ============================================================================ */
+
+typedef enum {
+    BATCH_FREE = 0,     /* Owned by the writer (filling or empty) */
+    BATCH_QUEUED,       /* Waiting for / being rendered by a worker */
+    BATCH_DONE          /* Rendered, waiting to be appended */
+} batch_state_t;
+
+typedef struct {
+    batch_state_t state;
+    char* raw;              /* Raw entries (header + args), back to back */
+    size_t raw_used;
+    char* out;              /* Rendered lines */
+    size_t out_used;
+    size_t out_capacity;
+} batch_t;
+
+typedef struct {
+    format_pool_t* pool;
+    fmt_time_cache_t time_cache;  /* Per-worker timestamp prefix cache */
+} worker_t;
+
+struct format_pool {
+    text_writer_t* writer;
+    const log_registry_t* registry;
+
+    batch_t* batches;
+    uint32_t num_batches;
+
+    /* Writer-owned cursors; fill_seq is published under the lock */
+    uint64_t fill_seq;          /* Batch currently being filled */
+    uint64_t write_seq;         /* Next batch to append to the writer */
+
+    /* Shared state (protected by lock) */
+    uint64_t next_render_seq;   /* Next queued batch for workers */
+    int stop;
+    cnanolog_mutex_t lock;
+    cnanolog_cond_t work_ready;
+    cnanolog_cond_t batch_done;
+
+    uint32_t num_threads;
+    cnanolog_thread_t threads[FORMAT_POOL_MAX_THREADS];
+    worker_t workers[FORMAT_POOL_MAX_THREADS];
+};
+
+/* ============================================================================
+ * Worker
+ * ============================================================================ */
+
+/**
+ * Make room for one more line in a batch's output block.
+ */
+static int reserve_line(batch_t* batch) {
+    if (batch->out_used + TEXT_WRITER_MAX_LINE_SIZE <= batch->out_capacity) {
+        return 0;
+    }
+    size_t new_capacity = batch->out_capacity * 2;
+    char* new_out = (char*)realloc(batch->out, new_capacity);
+    if (new_out == NULL) {
+        return -1;
+    }
+    batch->out = new_out;
+    batch->out_capacity = new_capacity;
+    return 0;
+}
+
+static void render_batch(format_pool_t* pool, worker_t* worker, batch_t* batch) {
+    const char* p = batch->raw;
+    const char* end = batch->raw + batch->raw_used;
+
+    while (p < end) {
+        cnanolog_entry_header_t header;
+        memcpy(&header, p, sizeof(header));
+        size_t arg_data_len;
+        const char* arg_data = staging_entry_data(p, &arg_data_len);
+        p = arg_data + arg_data_len;
+
+        if (unlikely(reserve_line(batch) != 0)) {
+            continue;  /* Out of memory: drop the line, keep going */
+        }
+
+        batch->out_used += text_writer_format_entry(pool->writer, &worker->time_cache,
+                                                    header.log_id,
+#ifndef CNANOLOG_NO_TIMESTAMPS
+                                                    header.timestamp,
+#else
+                                                    0,  /* No timestamp */
+#endif
+                                                    arg_data, arg_data_len,
+                                                    pool->registry,
+                                                    batch->out + batch->out_used);
+    }
+}
+
+static void* worker_main(void* arg) {
+    worker_t* worker = (worker_t*)arg;
+    format_pool_t* pool = worker->pool;
+
+    cnanolog_mutex_lock(&pool->lock);
+    for (;;) {
+        while (!pool->stop && pool->next_render_seq == pool->fill_seq) {
+            cnanolog_cond_wait(&pool->work_ready, &pool->lock);
+        }
+        if (pool->next_render_seq == pool->fill_seq) {
+            break;  /* Stopping and nothing left to render */
+        }
+
+        batch_t* batch = &pool->batches[pool->next_render_seq % pool->num_batches];
+        pool->next_render_seq++;
+        cnanolog_mutex_unlock(&pool->lock);
+
+        render_batch(pool, worker, batch);
+
+        cnanolog_mutex_lock(&pool->lock);
+        batch->state = BATCH_DONE;
+        cnanolog_cond_signal(&pool->batch_done);
+    }
+    cnanolog_mutex_unlock(&pool->lock);
+    return NULL;
+}
+
+/* ============================================================================
+ * Sequencer (writer thread)
+ * ============================================================================ */
+
+/**
+ * Append the oldest outstanding batch if it has been rendered.
+ *
+ * @param wait Block until it is rendered
+ * @return 1 if a batch was appended, 0 otherwise
+ */
+static int write_next_batch(format_pool_t* pool, int wait) {
+    if (pool->write_seq == pool->fill_seq) {
+        return 0;  /* Nothing handed off */
+    }
+
+    batch_t* batch = &pool->batches[pool->write_seq % pool->num_batches];
+
+    cnanolog_mutex_lock(&pool->lock);
+    while (batch->state != BATCH_DONE) {
+        if (!wait) {
+            cnanolog_mutex_unlock(&pool->lock);
+            return 0;
+        }
+        cnanolog_cond_wait(&pool->batch_done, &pool->lock);
+    }
+    cnanolog_mutex_unlock(&pool->lock);
+
+    text_writer_write_block(pool->writer, batch->out, batch->out_used);
+
+    batch->raw_used = 0;
+    batch->out_used = 0;
+    batch->state = BATCH_FREE;
+    pool->write_seq++;
+    return 1;
+}
+
+/**
+ * Queue the batch being filled and make sure the next one is free.
+ */
+static void dispatch_batch(format_pool_t* pool) {
+    batch_t* batch = &pool->batches[pool->fill_seq % pool->num_batches];
+    if (batch->raw_used == 0) {
+        return;
+    }
+
+    cnanolog_mutex_lock(&pool->lock);
+    batch->state = BATCH_QUEUED;
+    pool->fill_seq++;
+    cnanolog_cond_signal(&pool->work_ready);
+    cnanolog_mutex_unlock(&pool->lock);
+
+    /* Ring full: the next batch to fill is the oldest one outstanding */
+    while (pool->fill_seq - pool->write_seq >= pool->num_batches) {
+        write_next_batch(pool, 1);
+    }
+
+    format_pool_collect(pool);
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+format_pool_t* format_pool_create(uint32_t num_threads,
+                                  text_writer_t* writer,
+                                  const log_registry_t* registry) {
+    if (writer == NULL || registry == NULL) {
+        return NULL;
+    }
+    if (num_threads == 0 || num_threads > FORMAT_POOL_MAX_THREADS) {
+        fprintf(stderr, "format_pool: thread count %u out of range (1-%d)\n",
+                num_threads, FORMAT_POOL_MAX_THREADS);
+        return NULL;
+    }
+
+    format_pool_t* pool = (format_pool_t*)calloc(1, sizeof(format_pool_t));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->writer = writer;
+    pool->registry = registry;
+    cnanolog_mutex_init(&pool->lock);
+    cnanolog_cond_init(&pool->work_ready);
+    cnanolog_cond_init(&pool->batch_done);
+
+    pool->num_batches = num_threads * FORMAT_POOL_BATCHES_PER_THREAD;
+    pool->batches = (batch_t*)calloc(pool->num_batches, sizeof(batch_t));
+    if (pool->batches == NULL) {
+        format_pool_destroy(pool);
+        return NULL;
+    }
+    for (uint32_t i = 0; i < pool->num_batches; i++) {
+        batch_t* batch = &pool->batches[i];
+        batch->raw = (char*)malloc(FORMAT_POOL_BATCH_SIZE);
+        batch->out = (char*)malloc(INITIAL_OUTPUT_SIZE);
+        batch->out_capacity = INITIAL_OUTPUT_SIZE;
+        if (batch->raw == NULL || batch->out == NULL) {
+            fprintf(stderr, "format_pool: batch malloc failed\n");
+            format_pool_destroy(pool);
+            return NULL;
+        }
+    }
+
+    for (uint32_t i = 0; i < num_threads; i++) {
+        pool->workers[i].pool = pool;
+        if (cnanolog_thread_create(&pool->threads[i], worker_main, &pool->workers[i]) != 0) {
+            fprintf(stderr, "format_pool: failed to start formatter thread %u\n", i);
+            format_pool_destroy(pool);
+            return NULL;
+        }
+        pool->num_threads++;
+    }
+
+    return pool;
+}
+
+int format_pool_submit(format_pool_t* pool, const char* entry, size_t entry_size) {
+    if (unlikely(entry_size > FORMAT_POOL_BATCH_SIZE)) {
+        return -1;
+    }
+
+    batch_t* batch = &pool->batches[pool->fill_seq % pool->num_batches];
+    if (batch->raw_used + entry_size > FORMAT_POOL_BATCH_SIZE) {
+        dispatch_batch(pool);
+        batch = &pool->batches[pool->fill_seq % pool->num_batches];
+    }
+
+    memcpy(batch->raw + batch->raw_used, entry, entry_size);
+    batch->raw_used += entry_size;
+    return 0;
+}
+
+void format_pool_collect(format_pool_t* pool) {
+    while (write_next_batch(pool, 0)) {
+    }
+}
+
+void format_pool_drain(format_pool_t* pool) {
+    dispatch_batch(pool);
+    while (write_next_batch(pool, 1)) {
+    }
+}
+
+void format_pool_destroy(format_pool_t* pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    if (pool->num_threads > 0) {
+        format_pool_drain(pool);
+
+        cnanolog_mutex_lock(&pool->lock);
+        pool->stop = 1;
+        cnanolog_cond_broadcast(&pool->work_ready);
+        cnanolog_mutex_unlock(&pool->lock);
+        for (uint32_t i = 0; i < pool->num_threads; i++) {
+            cnanolog_thread_join(pool->threads[i], NULL);
+        }
+    }
+
+    if (pool->batches != NULL) {
+        for (uint32_t i = 0; i < pool->num_batches; i++) {
+            free(pool->batches[i].raw);
+            free(pool->batches[i].out);
+        }
+        free(pool->batches);
+    }
+
+    cnanolog_cond_destroy(&pool->batch_done);
+    cnanolog_cond_destroy(&pool->work_ready);
+    cnanolog_mutex_destroy(&pool->lock);
+    free(pool);
+}
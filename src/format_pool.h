@@ -0,0 +1,88 @@
+/* Copyright (c) 2025
+ * CNanoLog Formatter Pool
+ *
+ * Moves text formatting off the writer thread. The writer copies raw entries
+ * (header + argument bytes) into batches; worker threads render each batch
+ * into its own output block; the writer then appends finished blocks to the
+ * text writer strictly in submission order, so the file keeps the same line
+ * order as single-threaded formatting.
+ */
+
+#pragma once
+
+#include "text_formatter.h"
+#include "log_registry.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+/** Maximum number of formatter threads. */
+#define FORMAT_POOL_MAX_THREADS 16
+
+/**
+ * Raw bytes per batch. A batch is handed to a worker when it is full or
+ * when the writer flushes. Must hold at least one maximum-size entry.
+ */
+#define FORMAT_POOL_BATCH_SIZE (256 * 1024)
+
+/** Batches in flight per worker (double buffering). */
+#define FORMAT_POOL_BATCHES_PER_THREAD 2
+
+/* ============================================================================
+ * Formatter Pool API
+ * ============================================================================ */
+
+/**
+ * Pool context. Opaque type - implementation details hidden in format_pool.c.
+ */
+typedef struct format_pool format_pool_t;
+
+/**
+ * Start a pool of formatter threads that render into a text writer.
+ *
+ * @param num_threads Number of workers (1..FORMAT_POOL_MAX_THREADS)
+ * @param writer Text writer providing pattern/calibration and receiving output
+ * @param registry Log site registry
+ * @return Pool, or NULL on failure
+ */
+format_pool_t* format_pool_create(uint32_t num_threads,
+                                  text_writer_t* writer,
+                                  const log_registry_t* registry);
+
+/**
+ * Queue one raw entry for formatting. Called from the writer thread only.
+ * Blocks only when every batch is still waiting to be rendered.
+ *
+ * @param entry Entry header followed by its argument data
+ * @param entry_size Total size (header + data_length)
+ * @return 0 on success, -1 on failure
+ */
+int format_pool_submit(format_pool_t* pool, const char* entry, size_t entry_size);
+
+/**
+ * Append every batch that has finished rendering (in order) to the text
+ * writer without waiting for batches still in progress.
+ */
+void format_pool_collect(format_pool_t* pool);
+
+/**
+ * Hand off the partial batch and wait until everything submitted so far
+ * has been rendered and appended to the text writer.
+ */
+void format_pool_drain(format_pool_t* pool);
+
+/**
+ * Drain, stop the workers and release the pool.
+ */
+void format_pool_destroy(format_pool_t* pool);
+
+#ifdef __cplusplus
+}
+#endif
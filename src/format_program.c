@@ -0,0 +1,754 @@
+/* Copyright (c) 2025
+ * CNanoLog Precompiled Format Programs Implementation
+ */
+
+#include "format_program.h"
+#include "fast_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+/* Width/precision above this are clamped (keeps scratch buffers bounded) */
+#define FMT_MAX_FIELD 255
+
+/* ============================================================================
+ * Program Builder
+ * ============================================================================ */
+
+typedef struct {
+    fmt_op_t* ops;
+    uint32_t num_ops;
+    char* text;
+    uint32_t text_len;
+} program_builder_t;
+
+static int builder_init(program_builder_t* b, size_t source_len) {
+    /* Every op consumes at least one source character */
+    b->ops = (fmt_op_t*)malloc((source_len + 1) * sizeof(fmt_op_t));
+    b->text = (char*)malloc(source_len + 1);
+    b->num_ops = 0;
+    b->text_len = 0;
+    if (b->ops == NULL || b->text == NULL) {
+        free(b->ops);
+        free(b->text);
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * Append literal text, merging with the previous literal op when possible.
+ * Runs longer than an op's 16-bit length are split across several ops; each
+ * still covers at least one source character, so builder_init's sizing holds.
+ */
+static void builder_literal(program_builder_t* b, const char* src, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    memcpy(b->text + b->text_len, src, len);
+
+    fmt_op_t* last = (b->num_ops > 0) ? &b->ops[b->num_ops - 1] : NULL;
+    if (last != NULL && last->kind == FMT_OP_LITERAL &&
+        last->offset + last->length == b->text_len) {
+        size_t room = UINT16_MAX - last->length;
+        size_t n = (len < room) ? len : room;
+        last->length = (uint16_t)(last->length + n);
+        b->text_len += (uint32_t)n;
+        len -= n;
+    }
+    while (len > 0) {
+        size_t n = (len < UINT16_MAX) ? len : UINT16_MAX;
+        fmt_op_t* op = &b->ops[b->num_ops++];
+        memset(op, 0, sizeof(*op));
+        op->kind = FMT_OP_LITERAL;
+        op->offset = b->text_len;
+        op->length = (uint16_t)n;
+        b->text_len += (uint32_t)n;
+        len -= n;
+    }
+}
+
+static inline int is_name_char(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+           (c >= '0' && c <= '9') || c == '_' || c == '.' || c == '-';
+}
+
+/**
+ * Find a field name ("user=", "latency: ") at the end of the literal text
+ * immediately before the conversion being compiled.
+ *
+ * @param name_len Output: length of the name (0 = none)
+ * @return Offset of the name in builder text
+ */
+static uint32_t builder_field_name(const program_builder_t* b, uint16_t* name_len) {
+    *name_len = 0;
+    const fmt_op_t* last = (b->num_ops > 0) ? &b->ops[b->num_ops - 1] : NULL;
+    if (last == NULL || last->kind != FMT_OP_LITERAL ||
+        last->offset + last->length != b->text_len) {
+        return 0;
+    }
+
+    uint32_t start = last->offset;
+    uint32_t i = b->text_len;
+    while (i > start && b->text[i - 1] == ' ') i--;
+    if (i == start || (b->text[i - 1] != '=' && b->text[i - 1] != ':')) {
+        return 0;
+    }
+    i--;
+    while (i > start && b->text[i - 1] == ' ') i--;
+
+    uint32_t end = i;
+    while (i > start && is_name_char(b->text[i - 1])) i--;
+    if (end - i > 0 && end - i <= UINT8_MAX) {
+        *name_len = (uint16_t)(end - i);
+    }
+    return i;
+}
+
+static fmt_op_t* builder_op(program_builder_t* b, uint8_t kind) {
+    fmt_op_t* op = &b->ops[b->num_ops++];
+    memset(op, 0, sizeof(*op));
+    op->kind = kind;
+    op->width = -1;
+    op->precision = -1;
+    return op;
+}
+
+/**
+ * Pack builder contents into a single allocation: header | ops | text.
+ */
+static fmt_program_t* builder_finish(program_builder_t* b) {
+    size_t ops_size = (size_t)b->num_ops * sizeof(fmt_op_t);
+    fmt_program_t* program = (fmt_program_t*)malloc(sizeof(fmt_program_t) +
+                                                    ops_size + b->text_len + 1);
+    if (program != NULL) {
+        fmt_op_t* ops = (fmt_op_t*)(program + 1);
+        char* text = (char*)ops + ops_size;
+        memcpy(ops, b->ops, ops_size);
+        memcpy(text, b->text, b->text_len);
+        text[b->text_len] = '\0';
+
+        program->num_ops = b->num_ops;
+        program->ops = ops;
+        program->text = text;
+    }
+
+    free(b->ops);
+    free(b->text);
+    return program;
+}
+
+/* ============================================================================
+ * Compilation
+ * ============================================================================ */
+
+static int parse_number(const char** p) {
+    int val = 0;
+    while (**p >= '0' && **p <= '9') {
+        if (val < FMT_MAX_FIELD) {
+            val = val * 10 + (**p - '0');
+        }
+        (*p)++;
+    }
+    return (val > FMT_MAX_FIELD) ? FMT_MAX_FIELD : val;
+}
+
+fmt_program_t* fmt_program_compile_format(const char* format,
+                                          uint8_t num_args,
+                                          const uint8_t* arg_types) {
+    if (format == NULL) {
+        return NULL;
+    }
+
+    program_builder_t b;
+    if (builder_init(&b, strlen(format)) != 0) {
+        return NULL;
+    }
+
+    const char* p = format;
+    uint8_t arg_index = 0;
+
+    while (*p) {
+        /* Literal run up to the next '%' */
+        const char* lit = p;
+        while (*p && *p != '%') {
+            p++;
+        }
+        builder_literal(&b, lit, (size_t)(p - lit));
+        if (*p == '\0') {
+            break;
+        }
+
+        const char* spec = p++;  /* Skip '%' */
+        if (*p == '%') {
+            builder_literal(&b, "%", 1);
+            p++;
+            continue;
+        }
+
+        uint8_t flags = 0;
+        int width = -1;
+        int precision = -1;
+
+        /* Flags */
+        for (;; p++) {
+            if (*p == '-') flags |= FMT_FLAG_LEFT;
+            else if (*p == '+') flags |= FMT_FLAG_PLUS;
+            else if (*p == ' ') flags |= FMT_FLAG_SPACE;
+            else if (*p == '#') flags |= FMT_FLAG_ALT;
+            else if (*p == '0') flags |= FMT_FLAG_ZERO;
+            else break;
+        }
+
+        /* Width */
+        if (*p == '*') {
+            flags |= FMT_FLAG_WIDTH_ARG;
+            p++;
+        } else if (*p >= '0' && *p <= '9') {
+            width = parse_number(&p);
+        }
+
+        /* Precision */
+        if (*p == '.') {
+            p++;
+            if (*p == '*') {
+                flags |= FMT_FLAG_PREC_ARG;
+                p++;
+            } else {
+                precision = parse_number(&p);
+            }
+        }
+
+        /* Length modifiers: argument sizes come from arg_types */
+        while (*p && strchr("hlLqjzt", *p)) {
+            p++;
+        }
+
+        char conversion = *p;
+        if (conversion != '\0') {
+            p++;
+        }
+
+        int needed = 1 + ((flags & FMT_FLAG_WIDTH_ARG) ? 1 : 0) +
+                         ((flags & FMT_FLAG_PREC_ARG) ? 1 : 0);
+        if (conversion == '\0' || arg_index + needed > num_args) {
+            /* No argument for this conversion - keep the text as-is */
+            builder_literal(&b, spec, (size_t)(p - spec));
+            continue;
+        }
+
+        uint16_t name_len;
+        uint32_t name_offset = builder_field_name(&b, &name_len);
+
+        fmt_op_t* op = builder_op(&b, FMT_OP_ARG);
+        op->offset = name_offset;
+        op->length = name_len;
+        if (flags & FMT_FLAG_WIDTH_ARG) {
+            op->width_type = arg_types[arg_index++];
+        }
+        if (flags & FMT_FLAG_PREC_ARG) {
+            op->prec_type = arg_types[arg_index++];
+        }
+        op->arg_type = arg_types[arg_index++];
+        op->conversion = (uint8_t)conversion;
+        op->flags = flags;
+        op->width = (int16_t)width;
+        op->precision = (int16_t)precision;
+    }
+
+    return builder_finish(&b);
+}
+
+fmt_program_t* fmt_program_compile_pattern(const char* pattern) {
+    if (pattern == NULL) {
+        return NULL;
+    }
+
+    program_builder_t b;
+    if (builder_init(&b, strlen(pattern)) != 0) {
+        return NULL;
+    }
+
+    const char* p = pattern;
+    while (*p) {
+        const char* lit = p;
+        while (*p && !(*p == '%' && *(p + 1))) {
+            p++;
+        }
+        builder_literal(&b, lit, (size_t)(p - lit));
+        if (*p == '\0') {
+            break;
+        }
+
+        p++;  /* Skip '%' */
+        if (*p == '%') {
+            builder_literal(&b, "%", 1);
+        } else {
+            fmt_op_t* op = builder_op(&b, FMT_OP_TOKEN);
+            op->conversion = (uint8_t)*p;
+        }
+        p++;
+    }
+
+    return builder_finish(&b);
+}
+
+void fmt_program_free(fmt_program_t* program) {
+    free(program);
+}
+
+/* ============================================================================
+ * Rendering Helpers
+ * ============================================================================ */
+
+static inline char* pad_chars(char* out, const char* out_end, char c, int count) {
+    while (count-- > 0 && out < out_end) {
+        *out++ = c;
+    }
+    return out;
+}
+
+/**
+ * Emit prefix + zeros + body inside a field of 'width' characters.
+ */
+static char* emit_field(char* out, const char* out_end, int flags, int width,
+                        const char* prefix, size_t prefix_len, int zeros,
+                        const char* body, size_t body_len) {
+    int total = (int)(prefix_len + body_len) + zeros;
+    int padding = (width > total) ? width - total : 0;
+
+    if (!(flags & FMT_FLAG_LEFT)) {
+        out = pad_chars(out, out_end, ' ', padding);
+    }
+    out = fmt_append(out, out_end, prefix, prefix_len);
+    out = pad_chars(out, out_end, '0', zeros);
+    out = fmt_append(out, out_end, body, body_len);
+    if (flags & FMT_FLAG_LEFT) {
+        out = pad_chars(out, out_end, ' ', padding);
+    }
+    return out;
+}
+
+/**
+ * Read a fixed-size scalar argument.
+ * @return 0 on success, -1 if the data is truncated
+ */
+static inline int read_scalar(const char** rp, const char* end, void* dst, size_t size) {
+    if ((size_t)(end - *rp) < size) {
+        return -1;
+    }
+    memcpy(dst, *rp, size);
+    *rp += size;
+    return 0;
+}
+
+/**
+ * Read an integer argument of any type as raw bits.
+ * @param bits Output: raw value (zero-extended)
+ * @param size_bits Output: 8, 32 or 64
+ * @param is_signed Output: natural signedness of the type
+ */
+static int read_integer(const char** rp, const char* end, uint8_t type,
+                        uint64_t* bits, int* size_bits, int* is_signed) {
+    switch (type) {
+        case ARG_TYPE_CHAR: {
+            uint8_t v;
+            if (read_scalar(rp, end, &v, 1) != 0) return -1;
+            *bits = v;
+            *size_bits = 8;
+            *is_signed = 1;
+            return 0;
+        }
+        case ARG_TYPE_INT32:
+        case ARG_TYPE_UINT32: {
+            uint32_t v;
+            if (read_scalar(rp, end, &v, 4) != 0) return -1;
+            *bits = v;
+            *size_bits = 32;
+            *is_signed = (type == ARG_TYPE_INT32);
+            return 0;
+        }
+        case ARG_TYPE_INT64:
+        case ARG_TYPE_UINT64:
+        case ARG_TYPE_POINTER:
+        case ARG_TYPE_DOUBLE: {
+            uint64_t v;
+            if (read_scalar(rp, end, &v, 8) != 0) return -1;
+            *bits = v;
+            *size_bits = 64;
+            *is_signed = (type == ARG_TYPE_INT64);
+            return 0;
+        }
+        default:
+            return -1;
+    }
+}
+
+/**
+ * Read a string argument: length + text, or a pre-interned handle
+ * (staged data in text mode only).
+ * @return 0 on success, -1 if the data is truncated
+ */
+static int read_string(const char** rp, const char* end, uint8_t type,
+                       const char** str, uint32_t* len) {
+    if (type == ARG_TYPE_INTERNED) {
+        uint64_t bits;
+        if (read_scalar(rp, end, &bits, sizeof(bits)) != 0) return -1;
+        const cnanolog_string_t* handle = (const cnanolog_string_t*)(uintptr_t)bits;
+        *str = handle ? handle->str : "";
+        *len = handle ? handle->len : 0;
+        return 0;
+    }
+
+    if (read_scalar(rp, end, len, sizeof(*len)) != 0 ||
+        (size_t)(end - *rp) < *len) {
+        return -1;
+    }
+    *str = *rp;
+    *rp += *len;
+    return 0;
+}
+
+/**
+ * Sign-extend 'bits' from size_bits wide.
+ */
+static inline int64_t sign_extend(uint64_t bits, int size_bits) {
+    if (size_bits == 64) {
+        return (int64_t)bits;
+    }
+    uint64_t sign = 1ULL << (size_bits - 1);
+    return (int64_t)((bits ^ sign) - sign);
+}
+
+/**
+ * Read a '*' width/precision argument as int.
+ */
+static int read_star(const char** rp, const char* end, uint8_t type, int* value) {
+    uint64_t bits;
+    int size_bits, is_signed;
+    if (read_integer(rp, end, type, &bits, &size_bits, &is_signed) != 0) {
+        return -1;
+    }
+    int64_t v = is_signed ? sign_extend(bits, size_bits) : (int64_t)bits;
+    if (v > FMT_MAX_FIELD) v = FMT_MAX_FIELD;
+    if (v < -FMT_MAX_FIELD) v = -FMT_MAX_FIELD;
+    *value = (int)v;
+    return 0;
+}
+
+static size_t format_octal(char* out, uint64_t val) {
+    char tmp[24];
+    int n = 0;
+    do {
+        tmp[n++] = (char)('0' + (val & 7));
+        val >>= 3;
+    } while (val != 0);
+    for (int i = 0; i < n; i++) {
+        out[i] = tmp[n - 1 - i];
+    }
+    return (size_t)n;
+}
+
+/**
+ * Render an integer argument (d i u x X o c, or the type's natural form).
+ */
+static char* render_integer(char* out, const char* out_end, char conversion,
+                            int flags, int width, int precision,
+                            uint64_t bits, int size_bits, int is_signed) {
+    if (conversion == 'c') {
+        char c = (char)bits;
+        return emit_field(out, out_end, flags, width, NULL, 0, 0, &c, 1);
+    }
+
+    int signed_conv;
+    switch (conversion) {
+        case 'd': case 'i':
+            signed_conv = 1;
+            break;
+        case 'u': case 'x': case 'X': case 'o':
+            signed_conv = 0;
+            break;
+        default:
+            signed_conv = is_signed;
+            conversion = 'd';
+            break;
+    }
+
+    char prefix[2];
+    size_t prefix_len = 0;
+    uint64_t mag;
+    if (signed_conv) {
+        int64_t v = sign_extend(bits, size_bits);
+        mag = (v < 0) ? 0 - (uint64_t)v : (uint64_t)v;
+        if (v < 0) prefix[prefix_len++] = '-';
+        else if (flags & FMT_FLAG_PLUS) prefix[prefix_len++] = '+';
+        else if (flags & FMT_FLAG_SPACE) prefix[prefix_len++] = ' ';
+    } else {
+        mag = (size_bits == 64) ? bits : (bits & ((1ULL << size_bits) - 1));
+    }
+
+    char digits[24];
+    size_t ndigits;
+    if (precision == 0 && mag == 0) {
+        ndigits = 0;  /* printf: zero precision and zero value print nothing */
+    } else if (conversion == 'x' || conversion == 'X') {
+        ndigits = fmt_hex(digits, mag, conversion == 'X');
+        if ((flags & FMT_FLAG_ALT) && mag != 0) {
+            prefix[prefix_len++] = '0';
+            prefix[prefix_len++] = (char)conversion;
+        }
+    } else if (conversion == 'o') {
+        ndigits = format_octal(digits, mag);
+    } else {
+        ndigits = fmt_u64(digits, mag);
+    }
+
+    int zeros = (precision > (int)ndigits) ? precision - (int)ndigits : 0;
+    if (conversion == 'o' && (flags & FMT_FLAG_ALT) && zeros == 0 &&
+        (ndigits == 0 || digits[0] != '0')) {
+        zeros = 1;
+    }
+    if ((flags & FMT_FLAG_ZERO) && !(flags & FMT_FLAG_LEFT) && precision < 0) {
+        int fill = width - (int)(prefix_len + ndigits);
+        if (fill > zeros) zeros = fill;
+    }
+
+    return emit_field(out, out_end, flags, width, prefix, prefix_len, zeros,
+                      digits, ndigits);
+}
+
+/**
+ * Render a double. Common cases use fast_format, the rest go to snprintf
+ * with a spec rebuilt from the compiled fields.
+ */
+static char* render_double(char* out, const char* out_end, char conversion,
+                           int flags, int width, int precision, double val) {
+    char body[FMT_DOUBLE_MAX_CHARS];
+    size_t len = 0;
+    int fast = !(flags & (FMT_FLAG_PLUS | FMT_FLAG_SPACE | FMT_FLAG_ALT | FMT_FLAG_ZERO));
+
+    if (fast && (conversion == 'f' || !strchr("eEgGaAF", conversion))) {
+        int prec = (precision < 0) ? 6 : precision;
+        /* Larger values need up to ~320 characters: snprintf into out */
+        if (prec <= 9 && !(val >= 1e15 || val <= -1e15)) {
+            len = fmt_double_fixed(body, val, prec);
+            if (len > 0) {
+                return emit_field(out, out_end, flags, width, NULL, 0, 0, body, len);
+            }
+        }
+        conversion = 'f';
+    } else if (fast && conversion == 'g' && precision < 0) {
+        len = fmt_double_general(body, val);
+        return emit_field(out, out_end, flags, width, NULL, 0, 0, body, len);
+    }
+
+    /* Rebuild "%<flags><width>.<precision><conv>" */
+    char spec[24];
+    char* s = spec;
+    *s++ = '%';
+    if (flags & FMT_FLAG_LEFT) *s++ = '-';
+    if (flags & FMT_FLAG_PLUS) *s++ = '+';
+    if (flags & FMT_FLAG_SPACE) *s++ = ' ';
+    if (flags & FMT_FLAG_ALT) *s++ = '#';
+    if (flags & FMT_FLAG_ZERO) *s++ = '0';
+    if (width >= 0) s += fmt_u64(s, (uint64_t)width);
+    if (precision >= 0) {
+        *s++ = '.';
+        s += fmt_u64(s, (uint64_t)precision);
+    }
+    *s++ = strchr("eEgGaAfF", conversion) ? conversion : 'f';
+    *s = '\0';
+
+    size_t room = (size_t)(out_end - out);
+    int w = snprintf(out, room + 1, spec, val);
+    if (w < 0) {
+        return out;
+    }
+    return out + (((size_t)w < room) ? (size_t)w : room);
+}
+
+/**
+ * Render a pointer the way glibc "%p" does.
+ */
+static char* render_pointer(char* out, const char* out_end,
+                            int flags, int width, uint64_t val) {
+    char body[24];
+    size_t len;
+    if (val == 0) {
+        memcpy(body, "(nil)", 5);
+        len = 5;
+    } else {
+        body[0] = '0';
+        body[1] = 'x';
+        len = 2 + fmt_hex(body + 2, val, 0);
+    }
+    return emit_field(out, out_end, flags, width, NULL, 0, 0, body, len);
+}
+
+/* ============================================================================
+ * Interpreter
+ * ============================================================================ */
+
+size_t fmt_program_render(const fmt_program_t* program,
+                          const char* arg_data, size_t arg_len,
+                          char* out, size_t out_size) {
+    const char* rp = arg_data;
+    const char* rend = arg_data + arg_len;
+    char* w = out;
+    const char* wend = out + out_size - 1;
+
+    for (uint32_t i = 0; i < program->num_ops && w < wend; i++) {
+        const fmt_op_t* op = &program->ops[i];
+
+        if (op->kind == FMT_OP_LITERAL) {
+            w = fmt_append(w, wend, program->text + op->offset, op->length);
+            continue;
+        }
+
+        int flags = op->flags;
+        int width = op->width;
+        int precision = op->precision;
+
+        if (flags & FMT_FLAG_WIDTH_ARG) {
+            if (read_star(&rp, rend, op->width_type, &width) != 0) break;
+            if (width < 0) {
+                flags |= FMT_FLAG_LEFT;
+                width = -width;
+            }
+        }
+        if (flags & FMT_FLAG_PREC_ARG) {
+            if (read_star(&rp, rend, op->prec_type, &precision) != 0) break;
+            if (precision < 0) precision = -1;
+        }
+
+        char conversion = (char)op->conversion;
+        switch (op->arg_type) {
+            case ARG_TYPE_STRING:
+            case ARG_TYPE_INTERNED: {
+                const char* str;
+                uint32_t str_len;
+                if (read_string(&rp, rend, op->arg_type, &str, &str_len) != 0) {
+                    goto done;
+                }
+                size_t n = str_len;
+                if (precision >= 0 && n > (size_t)precision) {
+                    n = (size_t)precision;
+                }
+                w = emit_field(w, wend, flags, width, NULL, 0, 0, str, n);
+                break;
+            }
+
+            case ARG_TYPE_DOUBLE: {
+                double val;
+                if (read_scalar(&rp, rend, &val, sizeof(val)) != 0) goto done;
+                w = render_double(w, wend, conversion, flags, width, precision, val);
+                break;
+            }
+
+            case ARG_TYPE_POINTER:
+                if (conversion == 'p' || !strchr("diuxXoc", conversion)) {
+                    uint64_t val;
+                    if (read_scalar(&rp, rend, &val, sizeof(val)) != 0) goto done;
+                    w = render_pointer(w, wend, flags, width, val);
+                    break;
+                }
+                /* fall through: pointer printed as integer */
+
+            default: {
+                uint64_t bits;
+                int size_bits, is_signed;
+                if (read_integer(&rp, rend, op->arg_type, &bits,
+                                 &size_bits, &is_signed) != 0) {
+                    goto done;
+                }
+                /* char arguments default to %c */
+                if (op->arg_type == ARG_TYPE_CHAR && !strchr("diuxXo", conversion)) {
+                    conversion = 'c';
+                }
+                w = render_integer(w, wend, conversion, flags, width, precision,
+                                   bits, size_bits, is_signed);
+                break;
+            }
+        }
+    }
+
+done:
+    *w = '\0';
+    return (size_t)(w - out);
+}
+
+/* ============================================================================
+ * Field Decoding
+ * ============================================================================ */
+
+size_t fmt_program_fields(const fmt_program_t* program,
+                          const char* arg_data, size_t arg_len,
+                          fmt_field_t* fields, size_t max_fields) {
+    const char* rp = arg_data;
+    const char* rend = arg_data + arg_len;
+    size_t count = 0;
+    uint8_t index = 0;
+
+    for (uint32_t i = 0; i < program->num_ops && count < max_fields; i++) {
+        const fmt_op_t* op = &program->ops[i];
+        if (op->kind != FMT_OP_ARG) {
+            continue;
+        }
+
+        int unused;
+        if ((op->flags & FMT_FLAG_WIDTH_ARG) &&
+            read_star(&rp, rend, op->width_type, &unused) != 0) {
+            break;
+        }
+        if ((op->flags & FMT_FLAG_PREC_ARG) &&
+            read_star(&rp, rend, op->prec_type, &unused) != 0) {
+            break;
+        }
+
+        fmt_field_t* f = &fields[count];
+        f->name = (op->length > 0) ? program->text + op->offset : NULL;
+        f->name_len = op->length;
+        f->index = index++;
+        char conversion = (char)op->conversion;
+
+        if (op->arg_type == ARG_TYPE_STRING || op->arg_type == ARG_TYPE_INTERNED) {
+            const char* str;
+            uint32_t str_len;
+            if (read_string(&rp, rend, op->arg_type, &str, &str_len) != 0) {
+                break;
+            }
+            f->kind = FMT_FIELD_STRING;
+            f->value.str.ptr = str;
+            f->value.str.len = str_len;
+        } else if (op->arg_type == ARG_TYPE_DOUBLE) {
+            if (read_scalar(&rp, rend, &f->value.d, sizeof(double)) != 0) break;
+            f->kind = FMT_FIELD_DOUBLE;
+        } else {
+            const char* value_ptr = rp;
+            uint64_t bits;
+            int size_bits, is_signed;
+            if (read_integer(&rp, rend, op->arg_type, &bits, &size_bits, &is_signed) != 0) {
+                break;
+            }
+
+            if (conversion == 'c' ||
+                (op->arg_type == ARG_TYPE_CHAR && !strchr("diuxXo", conversion))) {
+                f->kind = FMT_FIELD_STRING;  /* "%c" is text (low byte, little-endian) */
+                f->value.str.ptr = value_ptr;
+                f->value.str.len = 1;
+            } else if (op->arg_type == ARG_TYPE_POINTER &&
+                       (conversion == 'p' || !strchr("diuxXoc", conversion))) {
+                f->kind = FMT_FIELD_POINTER;
+                f->value.u = bits;
+            } else if (is_signed) {
+                f->kind = FMT_FIELD_INT;
+                f->value.i = sign_extend(bits, size_bits);
+            } else {
+                f->kind = FMT_FIELD_UINT;
+                f->value.u = bits;
+            }
+        }
+        count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,181 @@
+/* Copyright (c) 2025
+ * CNanoLog Precompiled Format Programs
+ *
+ * printf-style format strings and text patterns are compiled once (at site
+ * registration or dictionary load) into a compact list of opcodes: literal
+ * spans, argument slots with flags/width/precision, and pattern tokens.
+ * Rendering is then a tight interpreter loop with no re-parsing.
+ */
+
+#pragma once
+
+#include "../include/cnanolog_format.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Opcodes
+ * ============================================================================ */
+
+/** Opcode kinds */
+#define FMT_OP_LITERAL 0  /* Copy text[offset .. offset+length) */
+#define FMT_OP_ARG     1  /* Render next argument */
+#define FMT_OP_TOKEN   2  /* Pattern token (%t, %l, %m, ...) */
+
+/** Conversion flags (FMT_OP_ARG) */
+#define FMT_FLAG_LEFT      0x01  /* '-' */
+#define FMT_FLAG_PLUS      0x02  /* '+' */
+#define FMT_FLAG_SPACE     0x04  /* ' ' */
+#define FMT_FLAG_ALT       0x08  /* '#' */
+#define FMT_FLAG_ZERO      0x10  /* '0' */
+#define FMT_FLAG_WIDTH_ARG 0x20  /* '*' width: consumes an argument */
+#define FMT_FLAG_PREC_ARG  0x40  /* '.*' precision: consumes an argument */
+
+/**
+ * One compiled instruction (16 bytes).
+ */
+typedef struct {
+    uint8_t kind;        /* FMT_OP_* */
+    uint8_t conversion;  /* printf conversion ('d', 'f', ...) or pattern token char */
+    uint8_t flags;       /* FMT_FLAG_* */
+    uint8_t arg_type;    /* cnanolog_arg_type_t of the rendered argument */
+    int16_t width;       /* Minimum field width (-1 = none) */
+    int16_t precision;   /* Precision (-1 = none) */
+    uint8_t width_type;  /* Argument type consumed by '*' width */
+    uint8_t prec_type;   /* Argument type consumed by '.*' precision */
+    uint16_t length;     /* Literal length / ARG: field name length (0 = unnamed) */
+    uint32_t offset;     /* Literal / ARG field name offset into program text */
+} fmt_op_t;
+
+/**
+ * Compiled program. Allocated as one block: header, ops, literal text.
+ * Release with fmt_program_free().
+ */
+typedef struct {
+    uint32_t num_ops;
+    const fmt_op_t* ops;
+    const char* text;    /* Literal bytes referenced by FMT_OP_LITERAL */
+} fmt_program_t;
+
+/* ============================================================================
+ * Compilation
+ * ============================================================================ */
+
+/**
+ * Compile a printf-style format string for a log site.
+ * Conversions beyond num_args are kept as literal text (matching the
+ * previous formatter's behavior). Length modifiers are accepted and ignored,
+ * since argument sizes come from arg_types.
+ *
+ * @param format Format string
+ * @param num_args Number of packed arguments
+ * @param arg_types Argument types (uint8_t cnanolog_arg_type_t values)
+ * @return Compiled program, or NULL on allocation failure
+ */
+fmt_program_t* fmt_program_compile_format(const char* format,
+                                          uint8_t num_args,
+                                          const uint8_t* arg_types);
+
+/**
+ * Compile a text pattern ("[%t] [%l] %m") into literals and tokens.
+ * "%%" becomes a literal '%'; every other "%c" becomes an FMT_OP_TOKEN
+ * with conversion = c. Token meaning is left to the caller.
+ *
+ * @param pattern Pattern string
+ * @return Compiled program, or NULL on allocation failure
+ */
+fmt_program_t* fmt_program_compile_pattern(const char* pattern);
+
+/**
+ * Release a compiled program (NULL is allowed).
+ */
+void fmt_program_free(fmt_program_t* program);
+
+/* ============================================================================
+ * Rendering
+ * ============================================================================ */
+
+/**
+ * Render a compiled format program against packed (uncompressed) arguments.
+ * Output is truncated to out_size - 1 bytes and null-terminated.
+ *
+ * @param program Program from fmt_program_compile_format()
+ * @param arg_data Packed argument data
+ * @param arg_len Length of arg_data (reads never go past it)
+ * @param out Output buffer
+ * @param out_size Output buffer size (must be > 0)
+ * @return Length of the rendered message (no null terminator)
+ */
+size_t fmt_program_render(const fmt_program_t* program,
+                          const char* arg_data, size_t arg_len,
+                          char* out, size_t out_size);
+
+/* ============================================================================
+ * Argument Fields
+ * ============================================================================ */
+
+/** Field value kinds (fmt_field_t.kind) */
+#define FMT_FIELD_INT     0  /* value.i */
+#define FMT_FIELD_UINT    1  /* value.u */
+#define FMT_FIELD_DOUBLE  2  /* value.d */
+#define FMT_FIELD_STRING  3  /* value.str (also "%c" characters) */
+#define FMT_FIELD_POINTER 4  /* value.u */
+
+/**
+ * One decoded argument, for structured (JSON/logfmt) output.
+ */
+typedef struct {
+    const char* name;      /* Name from "name=%d" / "name: %d" (NULL = unnamed) */
+    uint16_t name_len;
+    uint8_t kind;          /* FMT_FIELD_* */
+    uint8_t index;         /* Position among rendered arguments (for "argN") */
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        struct {
+            const char* ptr;   /* Points into arg_data (not null-terminated) */
+            uint32_t len;
+        } str;
+    } value;
+} fmt_field_t;
+
+/**
+ * Decode the arguments of a compiled format program as typed fields.
+ * '*' width/precision arguments are consumed but not reported.
+ * Names come from the literal text right before each conversion: an
+ * identifier followed by '=' or ':' (optionally space-padded).
+ *
+ * @param program Program from fmt_program_compile_format()
+ * @param arg_data Packed argument data
+ * @param arg_len Length of arg_data (reads never go past it)
+ * @param fields Output array
+ * @param max_fields Capacity of fields
+ * @return Number of fields decoded (stops early on truncated data)
+ */
+size_t fmt_program_fields(const fmt_program_t* program,
+                          const char* arg_data, size_t arg_len,
+                          fmt_field_t* fields, size_t max_fields);
+
+/**
+ * Append bytes to an output cursor, truncating at out_end.
+ * Shared by pattern interpreters.
+ */
+static inline char* fmt_append(char* out, const char* out_end,
+                               const char* src, size_t len) {
+    size_t room = (size_t)(out_end - out);
+    if (len > room) {
+        len = room;
+    }
+    memcpy(out, src, len);
+    return out + len;
+}
+
+#ifdef __cplusplus
+}
+#endif
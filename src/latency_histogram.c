@@ -0,0 +1,66 @@
+/* Copyright (c) 2025
+ * CNanoLog Latency Histograms - Implementation
+ */
+
+#include "latency_histogram.h"
+#include <string.h>
+
+/**
+ * Largest value that falls in a bucket.
+ */
+static uint64_t latency_bucket_upper(uint32_t bucket) {
+    if (bucket < 2 * LATENCY_SUB_COUNT) {
+        return bucket;
+    }
+    uint32_t shift = bucket / LATENCY_SUB_COUNT - 1;
+    uint64_t mantissa = LATENCY_SUB_COUNT + bucket % LATENCY_SUB_COUNT;
+    return ((mantissa + 1) << shift) - 1;  /* Wraps to UINT64_MAX at the top */
+}
+
+void latency_merge(latency_histogram_t* dst, const latency_histogram_t* src) {
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; i++) {
+        dst->counts[i] += src->counts[i];
+    }
+    if (src->max > dst->max) {
+        dst->max = src->max;
+    }
+}
+
+uint64_t latency_count(const latency_histogram_t* histogram) {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; i++) {
+        total += histogram->counts[i];
+    }
+    return total;
+}
+
+uint64_t latency_percentile(const latency_histogram_t* histogram, double percentile) {
+    uint64_t total = latency_count(histogram);
+    if (total == 0) {
+        return 0;
+    }
+
+    /* Rank of the value (1-based), rounded up: p50 of 3 values is the 2nd */
+    double exact_rank = (double)total * percentile / 100.0;
+    uint64_t rank = (uint64_t)exact_rank;
+    if ((double)rank < exact_rank) {
+        rank++;
+    }
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < LATENCY_BUCKETS; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            uint64_t upper = latency_bucket_upper(i);
+            return upper < histogram->max ? upper : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+void latency_reset(latency_histogram_t* histogram) {
+    memset(histogram, 0, sizeof(*histogram));
+}
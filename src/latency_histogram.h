@@ -0,0 +1,111 @@
+/* Copyright (c) 2025
+ * CNanoLog Latency Histograms
+ *
+ * Log-linear (HDR-style) histograms of timestamp-tick durations: values
+ * below 64 get a bucket each, above that every power of two is split into
+ * 32 buckets, so any recorded value is known to within 1/32 (~3%) across
+ * the whole 64-bit range. Recording is a bit scan and an increment.
+ *
+ * Each histogram has a single writer (a producer thread for call cost,
+ * the writer thread for staging delay); queries read them without locks
+ * and merge, so a query racing a record may miss that one sample.
+ *
+ * Compiled in with CNANOLOG_LATENCY_HISTOGRAMS (CMake option
+ * CNANOLOG_ENABLE_LATENCY_HISTOGRAMS), and only with timestamps.
+ */
+
+#pragma once
+
+#include "platform.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if defined(CNANOLOG_LATENCY_HISTOGRAMS) && !defined(CNANOLOG_NO_TIMESTAMPS)
+    #define LATENCY_TRACKING 1
+#else
+    #define LATENCY_TRACKING 0
+#endif
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+#define LATENCY_SUB_BITS 5                            /* 32 buckets per octave */
+#define LATENCY_SUB_COUNT (1u << LATENCY_SUB_BITS)
+#define LATENCY_BUCKETS ((64 - LATENCY_SUB_BITS + 1) * LATENCY_SUB_COUNT)  /* 1920 */
+
+/* ============================================================================
+ * Types
+ * ============================================================================ */
+
+typedef struct {
+    uint64_t counts[LATENCY_BUCKETS];
+    uint64_t max;                      /* Largest value recorded (exact) */
+} latency_histogram_t;
+
+/* ============================================================================
+ * Recording
+ * ============================================================================ */
+
+/**
+ * Bucket of a value: the value itself below 2 * LATENCY_SUB_COUNT, else
+ * its octave and the LATENCY_SUB_BITS bits below the leading one.
+ */
+static inline uint32_t latency_bucket(uint64_t value) {
+    if (value < 2 * LATENCY_SUB_COUNT) {
+        return (uint32_t)value;
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    uint32_t msb = 63 - (uint32_t)__builtin_clzll(value);
+#else
+    uint32_t msb = 0;
+    for (uint64_t v = value; v > 1; v >>= 1) {
+        msb++;
+    }
+#endif
+    uint32_t shift = msb - LATENCY_SUB_BITS;
+    return (shift + 1) * LATENCY_SUB_COUNT + (uint32_t)(value >> shift) - LATENCY_SUB_COUNT;
+}
+
+static inline void latency_record(latency_histogram_t* histogram, uint64_t value) {
+    histogram->counts[latency_bucket(value)]++;
+    if (unlikely(value > histogram->max)) {
+        histogram->max = value;
+    }
+}
+
+/* ============================================================================
+ * Queries
+ * ============================================================================ */
+
+/**
+ * Add src's counts to dst (dst is only touched by the caller).
+ */
+void latency_merge(latency_histogram_t* dst, const latency_histogram_t* src);
+
+/**
+ * Number of values recorded.
+ */
+uint64_t latency_count(const latency_histogram_t* histogram);
+
+/**
+ * Value at or below which the given share of values lies: the upper end
+ * of its bucket (never above the maximum).
+ *
+ * @param percentile 0-100 (e.g. 99.9)
+ * @return Value in the recorded unit, 0 if the histogram is empty
+ */
+uint64_t latency_percentile(const latency_histogram_t* histogram, double percentile);
+
+/**
+ * Clear all counts.
+ */
+void latency_reset(latency_histogram_t* histogram);
+
+#ifdef __cplusplus
+}
+#endif
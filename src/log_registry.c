@@ -25,16 +25,19 @@ void log_registry_init(log_registry_t* registry) {
  * ============================================================================ */
 
 /**
- * Check if a site with matching file:line:format already exists.
+ * Check if a site with matching level:file:line:format already exists
+ * (a span's begin and end differ only in level).
  * Returns log_id if found, UINT32_MAX if not found.
  */
 static uint32_t find_existing_site(const log_registry_t* registry,
+                                    cnanolog_level_t level,
                                     const char* filename,
                                     uint32_t line_number,
                                     const char* format) {
     for (uint32_t i = 0; i < registry->count; i++) {
         const log_site_t* site = &registry->sites[i];
         if (site->line_number == line_number &&
+            site->log_level == level &&
             strcmp(site->filename, filename) == 0 &&
             strcmp(site->format, format) == 0) {
             return site->log_id;
@@ -76,7 +79,7 @@ uint32_t log_registry_register(log_registry_t* registry,
     cnanolog_mutex_lock(&registry->lock);
 
     /* Check if this site already exists */
-    uint32_t existing_id = find_existing_site(registry, filename, line_number, format);
+    uint32_t existing_id = find_existing_site(registry, level, filename, line_number, format);
     if (existing_id != UINT32_MAX) {
         cnanolog_mutex_unlock(&registry->lock);
         return existing_id;
@@ -109,6 +112,10 @@ uint32_t log_registry_register(log_registry_t* registry,
         site->arg_types[i] = ARG_TYPE_NONE;
     }
 
+    /* Compile once here so the writer never re-parses format strings */
+    site->format_program = fmt_program_compile_format(format, num_args, arg_types);
+    site->pattern_program = fmt_program_compile_pattern(text_pattern);
+
     registry->count++;
 
     cnanolog_mutex_unlock(&registry->lock);
@@ -143,6 +150,10 @@ const log_site_t* log_registry_get_all(const log_registry_t* registry, uint32_t*
 
 void log_registry_destroy(log_registry_t* registry) {
     if (registry->sites != NULL) {
+        for (uint32_t i = 0; i < registry->count; i++) {
+            fmt_program_free(registry->sites[i].format_program);
+            fmt_program_free(registry->sites[i].pattern_program);
+        }
         free(registry->sites);
         registry->sites = NULL;
     }
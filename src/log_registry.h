@@ -10,6 +10,7 @@
 #include "../include/cnanolog.h"
 #include "../include/cnanolog_format.h"
 #include "platform.h"
+#include "format_program.h"
 #include <stdint.h>
 #include <stddef.h>
 
@@ -34,6 +35,8 @@ typedef struct {
     uint8_t num_args;
     cnanolog_arg_type_t arg_types[CNANOLOG_MAX_ARGS];
     const char* text_pattern;  /* Custom text pattern (NULL = use global pattern) */
+    fmt_program_t* format_program;   /* Compiled format (NULL if compilation failed) */
+    fmt_program_t* pattern_program;  /* Compiled text_pattern (NULL = use global) */
 } log_site_t;
 
 /* ============================================================================
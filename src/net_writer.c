@@ -0,0 +1,879 @@
+/* Copyright (c) 2025
+ * CNanoLog Network Writer Implementation
+ *
+ * Order of the bytes on a connection: header and site definitions
+ * (rebuilt for each connection), the memory queue, the spool, the open
+ * batch. Batches move to the spool only while it is non-empty or the
+ * queue is full, and come back into the queue as it empties, so that
+ * order holds across disconnects.
+ */
+
+#include "net_writer.h"
+#include "tsc_calibration.h"
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(PLATFORM_POSIX) && !defined(CNANOLOG_NO_TIMESTAMPS)
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0  /* SO_NOSIGPIPE is set on the socket instead */
+#endif
+
+/* ============================================================================
+ * Internal Structure
+ * ============================================================================ */
+
+typedef struct {
+    char* data;
+    size_t len;
+    size_t capacity;
+} net_batch_t;
+
+typedef enum {
+    NET_DISCONNECTED = 0,
+    NET_CONNECTING,
+    NET_CONNECTED
+} net_state_t;
+
+struct net_writer {
+    /* Collector */
+    char address[512];
+    struct sockaddr_storage addr;
+    socklen_t addr_len;
+    int family;
+
+    /* Connection */
+    int fd;                        /* -1 = none */
+    net_state_t state;
+    uint64_t retry_at_ns;          /* Next connect attempt (CLOCK_MONOTONIC) */
+    uint64_t retry_delay_ns;       /* Doubles per failure up to the maximum */
+
+    /* Stream state */
+    cnanolog_file_header_t header;
+    const log_registry_t* registry;
+    uint32_t sites_announced;      /* Sites 0..n-1 have been sent in-band */
+
+    net_batch_t hello;             /* Header and sites for this connection */
+    size_t hello_sent;
+
+    net_batch_t fill;              /* Open batch */
+    net_batch_t queue[NETWRITER_QUEUE_BATCHES];  /* Sealed, oldest first */
+    uint32_t queue_head;
+    uint32_t queue_count;
+    size_t head_sent;              /* Bytes of the oldest batch sent */
+
+    /* Spool: [uint32_t length][batch] records, newer than the queue */
+    char spool_path[512];
+    int spool_fd;                  /* -1 = not created yet */
+    uint64_t spool_read;
+    uint64_t spool_write;
+
+    uint64_t bytes_sent;
+    uint32_t connections;
+};
+
+/* ============================================================================
+ * Batches
+ * ============================================================================ */
+
+/**
+ * Make room for len more bytes.
+ * Returns pointer to write to, or NULL on allocation failure.
+ */
+static char* batch_reserve(net_batch_t* batch, size_t len) {
+    if (batch->len + len > batch->capacity) {
+        size_t capacity = batch->capacity ? batch->capacity : NETWRITER_BATCH_SIZE;
+        while (capacity < batch->len + len) {
+            capacity *= 2;
+        }
+        char* grown = (char*)realloc(batch->data, capacity);
+        if (grown == NULL) {
+            return NULL;
+        }
+        batch->data = grown;
+        batch->capacity = capacity;
+    }
+    return batch->data + batch->len;
+}
+
+/**
+ * Append an entry header for data_len bytes of data and reserve the data.
+ * Returns pointer to write the data to, or NULL on allocation failure.
+ */
+static char* batch_append_record(net_batch_t* batch, uint32_t log_id, uint64_t timestamp,
+                                 size_t data_len) {
+    char* dst = batch_reserve(batch, sizeof(cnanolog_entry_header_t) +
+                              CNANOLOG_VARINT_MAX_BYTES + data_len);
+    if (dst == NULL) {
+        return NULL;
+    }
+
+    cnanolog_entry_header_t header;
+    header.log_id = log_id;
+    header.timestamp = timestamp;
+    size_t len = sizeof(header);
+    if (likely(data_len <= CNANOLOG_MAX_INLINE_LENGTH)) {
+        header.data_length = (uint16_t)data_len;
+        memcpy(dst, &header, sizeof(header));
+    } else {
+        header.data_length = CNANOLOG_LENGTH_EXTENDED;
+        memcpy(dst, &header, sizeof(header));
+        len += cnanolog_varint_encode((uint32_t)data_len, (uint8_t*)dst + len);
+    }
+
+    batch->len += len + data_len;
+    return dst + len;
+}
+
+/**
+ * Append a site definition (dictionary entry as a stream record).
+ */
+static int batch_append_site(net_batch_t* batch, const log_site_t* site) {
+    cnanolog_dict_entry_t entry;
+    entry.log_id = site->log_id;
+    entry.log_level = (uint8_t)site->log_level;
+    entry.num_args = site->num_args;
+    entry.filename_length = (uint16_t)strlen(site->filename);
+    entry.format_length = (uint16_t)strlen(site->format);
+    entry.line_number = site->line_number;
+
+    /* Pre-interned strings are written as strings (as in files) */
+    memset(entry.arg_types, 0, sizeof(entry.arg_types));
+    for (int i = 0; i < site->num_args && i < CNANOLOG_MAX_ARGS; i++) {
+        entry.arg_types[i] = (site->arg_types[i] == ARG_TYPE_INTERNED)
+                                 ? (uint8_t)ARG_TYPE_STRING
+                                 : (uint8_t)site->arg_types[i];
+    }
+
+    char* dst = batch_append_record(batch, CNANOLOG_STREAM_SITE_LOG_ID, 0,
+                                    sizeof(entry) + entry.filename_length +
+                                    entry.format_length);
+    if (dst == NULL) {
+        return -1;
+    }
+    memcpy(dst, &entry, sizeof(entry));
+    memcpy(dst + sizeof(entry), site->filename, entry.filename_length);
+    memcpy(dst + sizeof(entry) + entry.filename_length, site->format, entry.format_length);
+    return 0;
+}
+
+/* ============================================================================
+ * Spool
+ * ============================================================================ */
+
+static int spool_pwrite(int fd, const char* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t written = pwrite(fd, data, len, (off_t)offset);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += written;
+        len -= (size_t)written;
+        offset += (uint64_t)written;
+    }
+    return 0;
+}
+
+static int spool_pread(int fd, char* data, size_t len, uint64_t offset) {
+    while (len > 0) {
+        ssize_t got = pread(fd, data, len, (off_t)offset);
+        if (got <= 0) {
+            if (got < 0 && errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        data += got;
+        len -= (size_t)got;
+        offset += (uint64_t)got;
+    }
+    return 0;
+}
+
+static int spool_append(net_writer_t* writer, const net_batch_t* batch) {
+    if (writer->spool_fd < 0) {
+        writer->spool_fd = open(writer->spool_path, O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                0600);
+        if (writer->spool_fd < 0) {
+            fprintf(stderr, "cnanolog: Cannot create spool %s: %s\n",
+                    writer->spool_path, strerror(errno));
+            return -1;
+        }
+    }
+
+    uint32_t len = (uint32_t)batch->len;
+    if (spool_pwrite(writer->spool_fd, (const char*)&len, sizeof(len),
+                     writer->spool_write) != 0 ||
+        spool_pwrite(writer->spool_fd, batch->data, batch->len,
+                     writer->spool_write + sizeof(len)) != 0) {
+        fprintf(stderr, "cnanolog: Spool write failed: %s\n", strerror(errno));
+        return -1;
+    }
+    writer->spool_write += sizeof(len) + batch->len;
+    return 0;
+}
+
+/**
+ * Move spooled batches into free queue slots (oldest first).
+ */
+static void spool_refill(net_writer_t* writer) {
+    while (writer->spool_read < writer->spool_write &&
+           writer->queue_count < NETWRITER_QUEUE_BATCHES) {
+        net_batch_t* slot = &writer->queue[(writer->queue_head + writer->queue_count) %
+                                           NETWRITER_QUEUE_BATCHES];
+        uint32_t len;
+        slot->len = 0;
+        if (spool_pread(writer->spool_fd, (char*)&len, sizeof(len), writer->spool_read) != 0 ||
+            batch_reserve(slot, len) == NULL ||
+            spool_pread(writer->spool_fd, slot->data, len,
+                        writer->spool_read + sizeof(len)) != 0) {
+            /* Unreadable spool: what is left of it is lost */
+            fprintf(stderr, "cnanolog: Spool read failed, %llu bytes dropped\n",
+                    (unsigned long long)(writer->spool_write - writer->spool_read));
+            writer->spool_read = writer->spool_write;
+            break;
+        }
+        slot->len = len;
+        writer->queue_count++;
+        writer->spool_read += sizeof(len) + len;
+    }
+
+    if (writer->spool_fd >= 0 && writer->spool_read == writer->spool_write &&
+        writer->spool_write > 0) {
+        if (ftruncate(writer->spool_fd, 0) != 0) {
+            /* Offsets restart at 0 either way; stale bytes get overwritten */
+        }
+        writer->spool_read = 0;
+        writer->spool_write = 0;
+    }
+}
+
+/**
+ * Move the open batch to the end of the stream: the queue, or the spool
+ * while the spool holds anything or the queue is full.
+ */
+static int seal_batch(net_writer_t* writer) {
+    if (writer->fill.len == 0) {
+        return 0;
+    }
+
+    if (writer->spool_read < writer->spool_write ||
+        writer->queue_count == NETWRITER_QUEUE_BATCHES) {
+        int result = spool_append(writer, &writer->fill);
+        writer->fill.len = 0;
+        return result;
+    }
+
+    /* Swap buffers with the free slot (no copy) */
+    uint32_t tail = (writer->queue_head + writer->queue_count) % NETWRITER_QUEUE_BATCHES;
+    net_batch_t free_slot = writer->queue[tail];
+    writer->queue[tail] = writer->fill;
+    writer->fill = free_slot;
+    writer->fill.len = 0;
+    writer->queue_count++;
+    return 0;
+}
+
+/* ============================================================================
+ * Connection
+ * ============================================================================ */
+
+static void disconnect(net_writer_t* writer, uint64_t now_ns) {
+    if (writer->state == NET_CONNECTED) {
+        fprintf(stderr, "cnanolog: Lost collector %s, spooling\n", writer->address);
+    }
+    if (writer->fd >= 0) {
+        close(writer->fd);
+        writer->fd = -1;
+    }
+    writer->state = NET_DISCONNECTED;
+
+    /* The next connection starts over with the header and a whole batch */
+    writer->hello_sent = 0;
+    writer->head_sent = 0;
+
+    writer->retry_at_ns = now_ns + writer->retry_delay_ns;
+    writer->retry_delay_ns *= 2;
+    if (writer->retry_delay_ns > NETWRITER_RETRY_MAX_NS) {
+        writer->retry_delay_ns = NETWRITER_RETRY_MAX_NS;
+    }
+}
+
+/**
+ * Connected: queue the header and every site announced so far.
+ */
+static void on_connected(net_writer_t* writer) {
+    writer->state = NET_CONNECTED;
+    writer->connections++;
+    writer->retry_delay_ns = NETWRITER_RETRY_MIN_NS;
+
+    writer->hello.len = 0;
+    writer->hello_sent = 0;
+    char* dst = batch_reserve(&writer->hello, sizeof(writer->header));
+    if (dst == NULL) {
+        disconnect(writer, tsc_monotonic_ns());
+        return;
+    }
+    memcpy(dst, &writer->header, sizeof(writer->header));
+    writer->hello.len = sizeof(writer->header);
+
+    for (uint32_t i = 0; i < writer->sites_announced; i++) {
+        const log_site_t* site = log_registry_get(writer->registry, i);
+        if (site == NULL || batch_append_site(&writer->hello, site) != 0) {
+            disconnect(writer, tsc_monotonic_ns());
+            return;
+        }
+    }
+}
+
+static void connect_start(net_writer_t* writer, uint64_t now_ns) {
+    writer->fd = socket(writer->family, SOCK_STREAM, 0);
+    if (writer->fd < 0) {
+        disconnect(writer, now_ns);
+        return;
+    }
+    fcntl(writer->fd, F_SETFD, FD_CLOEXEC);
+    fcntl(writer->fd, F_SETFL, fcntl(writer->fd, F_GETFL) | O_NONBLOCK);
+#ifdef SO_NOSIGPIPE
+    int one_nosigpipe = 1;
+    setsockopt(writer->fd, SOL_SOCKET, SO_NOSIGPIPE, &one_nosigpipe, sizeof(one_nosigpipe));
+#endif
+    if (writer->family != AF_UNIX) {
+        /* Batches are large already; do not hold back the last one */
+        int one = 1;
+        setsockopt(writer->fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    if (connect(writer->fd, (const struct sockaddr*)&writer->addr, writer->addr_len) == 0) {
+        on_connected(writer);
+    } else if (errno == EINPROGRESS) {
+        writer->state = NET_CONNECTING;
+    } else {
+        disconnect(writer, now_ns);
+    }
+}
+
+static void connect_check(net_writer_t* writer, uint64_t now_ns) {
+    struct pollfd pfd = {writer->fd, POLLOUT, 0};
+    if (poll(&pfd, 1, 0) <= 0) {
+        return;
+    }
+    int error = 0;
+    socklen_t len = sizeof(error);
+    if (getsockopt(writer->fd, SOL_SOCKET, SO_ERROR, &error, &len) == 0 && error == 0) {
+        on_connected(writer);
+    } else {
+        disconnect(writer, now_ns);
+    }
+}
+
+/* ============================================================================
+ * Sending
+ * ============================================================================ */
+
+/**
+ * Drop sent bytes from the front of the stream.
+ */
+static void consume(net_writer_t* writer, size_t sent) {
+    size_t hello_left = writer->hello.len - writer->hello_sent;
+    if (hello_left > 0) {
+        size_t taken = sent < hello_left ? sent : hello_left;
+        writer->hello_sent += taken;
+        sent -= taken;
+    }
+
+    while (sent > 0 && writer->queue_count > 0) {
+        net_batch_t* head = &writer->queue[writer->queue_head];
+        size_t left = head->len - writer->head_sent;
+        if (sent < left) {
+            writer->head_sent += sent;
+            return;
+        }
+        sent -= left;
+        head->len = 0;
+        writer->head_sent = 0;
+        writer->queue_head = (writer->queue_head + 1) % NETWRITER_QUEUE_BATCHES;
+        writer->queue_count--;
+    }
+}
+
+/**
+ * Send as much as the socket takes: one sendmsg() covering the rest of the
+ * header and every queued batch, repeated until it would block.
+ */
+static void pump(net_writer_t* writer, uint64_t now_ns) {
+    while (writer->state == NET_CONNECTED) {
+        spool_refill(writer);
+
+        struct iovec iov[1 + NETWRITER_QUEUE_BATCHES];
+        int count = 0;
+        if (writer->hello_sent < writer->hello.len) {
+            iov[count].iov_base = writer->hello.data + writer->hello_sent;
+            iov[count].iov_len = writer->hello.len - writer->hello_sent;
+            count++;
+        }
+        for (uint32_t i = 0; i < writer->queue_count; i++) {
+            net_batch_t* batch = &writer->queue[(writer->queue_head + i) %
+                                                NETWRITER_QUEUE_BATCHES];
+            size_t skip = (i == 0) ? writer->head_sent : 0;
+            iov[count].iov_base = batch->data + skip;
+            iov[count].iov_len = batch->len - skip;
+            count++;
+        }
+        if (writer->queue_count == 0) {
+            return;  /* Header alone waits for the first batch */
+        }
+
+        struct msghdr msg;
+        memset(&msg, 0, sizeof(msg));
+        msg.msg_iov = iov;
+        msg.msg_iovlen = count;
+        ssize_t sent = sendmsg(writer->fd, &msg, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                disconnect(writer, now_ns);
+            }
+            return;
+        }
+        writer->bytes_sent += (uint64_t)sent;
+        consume(writer, (size_t)sent);
+    }
+}
+
+static int stream_pending(const net_writer_t* writer) {
+    return writer->queue_count > 0 || writer->spool_read < writer->spool_write ||
+           writer->fill.len > 0;
+}
+
+/* ============================================================================
+ * Address Parsing
+ * ============================================================================ */
+
+int netwriter_is_address(const char* path) {
+    return path != NULL && (strncmp(path, "unix:", 5) == 0 || strncmp(path, "tcp:", 4) == 0);
+}
+
+static int parse_address(net_writer_t* writer, const char* address) {
+    if (strncmp(address, "unix:", 5) == 0) {
+        struct sockaddr_un* un = (struct sockaddr_un*)&writer->addr;
+        const char* path = address + 5;
+        if (path[0] == '\0' || strlen(path) >= sizeof(un->sun_path)) {
+            return -1;
+        }
+        un->sun_family = AF_UNIX;
+        strcpy(un->sun_path, path);
+        writer->family = AF_UNIX;
+        writer->addr_len = (socklen_t)sizeof(*un);
+        return 0;
+    }
+
+    /* tcp:host:port, tcp:[v6-host]:port or tcp:port (localhost) */
+    char host[256] = "127.0.0.1";
+    const char* spec = address + 4;
+    const char* port = strrchr(spec, ':');
+    if (port != NULL) {
+        size_t host_len = (size_t)(port - spec);
+        if (host_len >= 2 && spec[0] == '[' && spec[host_len - 1] == ']') {
+            spec++;
+            host_len -= 2;
+        }
+        if (host_len == 0 || host_len >= sizeof(host)) {
+            return -1;
+        }
+        memcpy(host, spec, host_len);
+        host[host_len] = '\0';
+        port++;
+    } else {
+        port = spec;
+    }
+    if (port[0] == '\0') {
+        return -1;
+    }
+
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_NUMERICSERV;
+    struct addrinfo* result = NULL;
+    if (getaddrinfo(host, port, &hints, &result) != 0 || result == NULL) {
+        return -1;
+    }
+    memcpy(&writer->addr, result->ai_addr, result->ai_addrlen);
+    writer->addr_len = (socklen_t)result->ai_addrlen;
+    writer->family = result->ai_family;
+    freeaddrinfo(result);
+    return 0;
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+net_writer_t* netwriter_create(const char* address, const char* spool_path) {
+    static uint32_t spool_counter = 0;
+
+    net_writer_t* writer = (net_writer_t*)calloc(1, sizeof(net_writer_t));
+    if (writer == NULL) {
+        fprintf(stderr, "netwriter_create: malloc failed\n");
+        return NULL;
+    }
+    if (!netwriter_is_address(address) || parse_address(writer, address) != 0) {
+        fprintf(stderr, "netwriter_create: Bad collector address: %s\n", address);
+        free(writer);
+        return NULL;
+    }
+
+    strncpy(writer->address, address, sizeof(writer->address) - 1);
+    if (spool_path != NULL) {
+        strncpy(writer->spool_path, spool_path, sizeof(writer->spool_path) - 1);
+    } else {
+        snprintf(writer->spool_path, sizeof(writer->spool_path), "cnanolog-%d-%u.spool",
+                 (int)getpid(), spool_counter++);
+    }
+
+    writer->fd = -1;
+    writer->spool_fd = -1;
+    writer->state = NET_DISCONNECTED;
+    writer->retry_delay_ns = NETWRITER_RETRY_MIN_NS;
+    writer->retry_at_ns = 0;  /* First poll connects */
+    return writer;
+}
+
+void netwriter_set_header(net_writer_t* writer, uint64_t timestamp_frequency,
+                          uint64_t start_timestamp, int64_t start_time_sec,
+                          int32_t start_time_nsec, uint32_t uncertainty_ppb) {
+    cnanolog_file_header_t* header = &writer->header;
+    memset(header, 0, sizeof(*header));
+    header->magic = CNANOLOG_MAGIC;
+    header->version_major = CNANOLOG_VERSION_MAJOR;
+    header->version_minor = CNANOLOG_VERSION_MINOR;
+    header->timestamp_frequency = timestamp_frequency;
+    header->start_timestamp = start_timestamp;
+    header->start_time_sec = start_time_sec;
+    header->start_time_nsec = start_time_nsec;
+    header->endianness = CNANOLOG_ENDIAN_MAGIC;
+    header->frequency_uncertainty_ppb = uncertainty_ppb;
+    header->flags = CNANOLOG_FLAG_HAS_TIMESTAMPS | CNANOLOG_FLAG_HAS_SYNC_RECORDS |
+                    CNANOLOG_FLAG_DOUBLE_XOR | CNANOLOG_FLAG_INT_DELTA |
+                    CNANOLOG_FLAG_STRING_INTERN;
+}
+
+int netwriter_begin_entry(net_writer_t* writer, const log_registry_t* registry,
+                          uint32_t log_id) {
+    int started = 0;
+
+    if (writer->fill.len >= NETWRITER_BATCH_SIZE && netwriter_flush(writer) != 0) {
+        return -1;
+    }
+    if (writer->fill.len == 0) {
+        tsc_sample_t now;
+        tsc_sample(&now);
+        if (netwriter_write_sync(writer, now.tsc, now.real_sec, now.real_nsec,
+                                 now.mono_ns) != 0) {
+            return -1;
+        }
+        started = 1;
+    }
+
+    writer->registry = registry;
+    while (writer->sites_announced <= log_id) {
+        const log_site_t* site = log_registry_get(registry, writer->sites_announced);
+        if (site == NULL || batch_append_site(&writer->fill, site) != 0) {
+            return -1;
+        }
+        writer->sites_announced++;
+    }
+    return started;
+}
+
+int netwriter_write_entry(net_writer_t* writer, uint32_t log_id, uint64_t timestamp,
+                          const void* arg_data, size_t data_len) {
+    if (data_len > CNANOLOG_MAX_COMPRESSED_SIZE) {
+        return -1;
+    }
+    char* dst = batch_append_record(&writer->fill, log_id, timestamp, data_len);
+    if (dst == NULL) {
+        return -1;
+    }
+    if (data_len > 0) {
+        memcpy(dst, arg_data, data_len);
+    }
+    return 0;
+}
+
+int netwriter_write_sync(net_writer_t* writer, uint64_t timestamp, int64_t real_sec,
+                         int32_t real_nsec, uint64_t mono_ns) {
+    cnanolog_sync_record_t record;
+    record.real_sec = real_sec;
+    record.real_nsec = real_nsec;
+    record.reserved = 0;
+    record.mono_ns = mono_ns;
+
+    char* dst = batch_append_record(&writer->fill, CNANOLOG_SYNC_LOG_ID, timestamp,
+                                    sizeof(record));
+    if (dst == NULL) {
+        return -1;
+    }
+    memcpy(dst, &record, sizeof(record));
+    return 0;
+}
+
+void netwriter_set_timestamp_frequency(net_writer_t* writer, uint64_t timestamp_frequency,
+                                       uint32_t uncertainty_ppb) {
+    writer->header.timestamp_frequency = timestamp_frequency;
+    writer->header.frequency_uncertainty_ppb = uncertainty_ppb;
+}
+
+int netwriter_flush(net_writer_t* writer) {
+    int result = seal_batch(writer);
+    netwriter_poll(writer, tsc_monotonic_ns());
+    return result;
+}
+
+void netwriter_poll(net_writer_t* writer, uint64_t now_ns) {
+    if (writer->state == NET_CONNECTING) {
+        connect_check(writer, now_ns);
+    } else if (writer->state == NET_DISCONNECTED && now_ns >= writer->retry_at_ns) {
+        connect_start(writer, now_ns);
+    }
+    if (writer->state == NET_CONNECTED && writer->queue_count + writer->spool_write > 0) {
+        pump(writer, now_ns);
+    }
+}
+
+int netwriter_close(net_writer_t* writer,
+                    const custom_level_entry_t* custom_levels,
+                    uint32_t num_custom_levels) {
+    if (writer == NULL) {
+        return -1;
+    }
+
+    /* Levels and the final frequency close the stream */
+    int result = 0;
+    for (uint32_t i = 0; i < num_custom_levels; i++) {
+        cnanolog_level_dict_entry_t entry;
+        entry.level = custom_levels[i].level;
+        entry.name_length = (uint8_t)strlen(custom_levels[i].name);
+        entry.reserved[0] = 0;
+        entry.reserved[1] = 0;
+        char* dst = batch_append_record(&writer->fill, CNANOLOG_STREAM_LEVEL_LOG_ID, 0,
+                                        sizeof(entry) + entry.name_length);
+        if (dst == NULL) {
+            result = -1;
+            break;
+        }
+        memcpy(dst, &entry, sizeof(entry));
+        memcpy(dst + sizeof(entry), custom_levels[i].name, entry.name_length);
+    }
+    cnanolog_stream_end_t end;
+    end.timestamp_frequency = writer->header.timestamp_frequency;
+    end.frequency_uncertainty_ppb = writer->header.frequency_uncertainty_ppb;
+    end.reserved = 0;
+    char* dst = batch_append_record(&writer->fill, CNANOLOG_STREAM_END_LOG_ID, 0, sizeof(end));
+    if (dst != NULL) {
+        memcpy(dst, &end, sizeof(end));
+    }
+    if (dst == NULL || seal_batch(writer) != 0) {
+        result = -1;
+    }
+
+    /* Deliver the rest, reconnecting quickly if the collector is away */
+    uint64_t now_ns = tsc_monotonic_ns();
+    uint64_t deadline_ns = now_ns + (uint64_t)NETWRITER_CLOSE_TIMEOUT_MS * 1000000ULL;
+    writer->retry_at_ns = now_ns;
+    writer->retry_delay_ns = NETWRITER_RETRY_MIN_NS;
+    while (stream_pending(writer) && now_ns < deadline_ns) {
+        netwriter_poll(writer, now_ns);
+        if (!stream_pending(writer)) {
+            break;
+        }
+        if (writer->fd >= 0) {
+            struct pollfd pfd = {writer->fd, POLLOUT, 0};
+            poll(&pfd, 1, 10);
+        } else {
+            struct timespec ts = {0, 10000000};  /* 10ms */
+            nanosleep(&ts, NULL);
+        }
+        now_ns = tsc_monotonic_ns();
+    }
+
+    if (stream_pending(writer)) {
+        uint64_t left = writer->spool_write - writer->spool_read;
+        for (uint32_t i = 0; i < writer->queue_count; i++) {
+            left += writer->queue[(writer->queue_head + i) % NETWRITER_QUEUE_BATCHES].len;
+        }
+        fprintf(stderr, "cnanolog: Collector %s unreachable, %llu bytes not delivered\n",
+                writer->address, (unsigned long long)(left - writer->head_sent));
+        result = -1;
+    }
+
+    if (writer->fd >= 0) {
+        shutdown(writer->fd, SHUT_WR);
+        close(writer->fd);
+    }
+    if (writer->spool_fd >= 0) {
+        close(writer->spool_fd);
+        unlink(writer->spool_path);
+    }
+    free(writer->hello.data);
+    free(writer->fill.data);
+    for (uint32_t i = 0; i < NETWRITER_QUEUE_BATCHES; i++) {
+        free(writer->queue[i].data);
+    }
+    free(writer);
+    return result;
+}
+
+/**
+ * Blocking send until the deadline (crash path: no malloc, no stdio).
+ */
+static int send_until(int fd, const char* data, size_t len, uint64_t deadline_ns) {
+    while (len > 0) {
+        ssize_t sent = send(fd, data, len, MSG_NOSIGNAL | MSG_DONTWAIT);
+        if (sent > 0) {
+            data += sent;
+            len -= (size_t)sent;
+            continue;
+        }
+        if (sent < 0 && errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK) {
+            return -1;
+        }
+        uint64_t now_ns = tsc_monotonic_ns();
+        if (now_ns >= deadline_ns) {
+            return -1;
+        }
+        struct pollfd pfd = {fd, POLLOUT, 0};
+        int wait_ms = (int)((deadline_ns - now_ns) / 1000000ULL) + 1;
+        poll(&pfd, 1, wait_ms);
+    }
+    return 0;
+}
+
+int netwriter_crash_close(net_writer_t* writer, uint64_t deadline_ns) {
+    if (writer == NULL || writer->state != NET_CONNECTED ||
+        writer->spool_read < writer->spool_write) {
+        return -1;
+    }
+
+    /* End record only if it fits without growing the batch */
+    cnanolog_stream_end_t end;
+    end.timestamp_frequency = writer->header.timestamp_frequency;
+    end.frequency_uncertainty_ppb = writer->header.frequency_uncertainty_ppb;
+    end.reserved = 0;
+    if (writer->fill.capacity - writer->fill.len >=
+        sizeof(cnanolog_entry_header_t) + CNANOLOG_VARINT_MAX_BYTES + sizeof(end)) {
+        memcpy(batch_append_record(&writer->fill, CNANOLOG_STREAM_END_LOG_ID, 0, sizeof(end)),
+               &end, sizeof(end));
+    }
+
+    if (send_until(writer->fd, writer->hello.data + writer->hello_sent,
+                   writer->hello.len - writer->hello_sent, deadline_ns) != 0) {
+        return -1;
+    }
+    for (uint32_t i = 0; i < writer->queue_count; i++) {
+        const net_batch_t* batch = &writer->queue[(writer->queue_head + i) %
+                                                  NETWRITER_QUEUE_BATCHES];
+        size_t skip = (i == 0) ? writer->head_sent : 0;
+        if (send_until(writer->fd, batch->data + skip, batch->len - skip, deadline_ns) != 0) {
+            return -1;
+        }
+    }
+    if (send_until(writer->fd, writer->fill.data, writer->fill.len, deadline_ns) != 0) {
+        return -1;
+    }
+    shutdown(writer->fd, SHUT_WR);
+    return 0;
+}
+
+uint64_t netwriter_get_bytes_sent(const net_writer_t* writer) {
+    return writer != NULL ? writer->bytes_sent : 0;
+}
+
+uint32_t netwriter_get_connections(const net_writer_t* writer) {
+    return writer != NULL ? writer->connections : 0;
+}
+
+#else  /* No sockets or no timestamps: network sinks are unavailable */
+
+int netwriter_is_address(const char* path) {
+    return path != NULL && (strncmp(path, "unix:", 5) == 0 || strncmp(path, "tcp:", 4) == 0);
+}
+
+net_writer_t* netwriter_create(const char* address, const char* spool_path) {
+    (void)spool_path;
+    fprintf(stderr, "netwriter_create: %s: Network sinks need POSIX sockets and timestamps\n",
+            address);
+    return NULL;
+}
+
+void netwriter_set_header(net_writer_t* writer, uint64_t timestamp_frequency,
+                          uint64_t start_timestamp, int64_t start_time_sec,
+                          int32_t start_time_nsec, uint32_t uncertainty_ppb) {
+    (void)writer; (void)timestamp_frequency; (void)start_timestamp;
+    (void)start_time_sec; (void)start_time_nsec; (void)uncertainty_ppb;
+}
+
+int netwriter_close(net_writer_t* writer, const custom_level_entry_t* custom_levels,
+                    uint32_t num_custom_levels) {
+    (void)writer; (void)custom_levels; (void)num_custom_levels;
+    return -1;
+}
+
+int netwriter_crash_close(net_writer_t* writer, uint64_t deadline_ns) {
+    (void)writer; (void)deadline_ns;
+    return -1;
+}
+
+int netwriter_begin_entry(net_writer_t* writer, const log_registry_t* registry,
+                          uint32_t log_id) {
+    (void)writer; (void)registry; (void)log_id;
+    return -1;
+}
+
+int netwriter_write_entry(net_writer_t* writer, uint32_t log_id, uint64_t timestamp,
+                          const void* arg_data, size_t data_len) {
+    (void)writer; (void)log_id; (void)timestamp; (void)arg_data; (void)data_len;
+    return -1;
+}
+
+int netwriter_write_sync(net_writer_t* writer, uint64_t timestamp, int64_t real_sec,
+                         int32_t real_nsec, uint64_t mono_ns) {
+    (void)writer; (void)timestamp; (void)real_sec; (void)real_nsec; (void)mono_ns;
+    return -1;
+}
+
+void netwriter_set_timestamp_frequency(net_writer_t* writer, uint64_t timestamp_frequency,
+                                       uint32_t uncertainty_ppb) {
+    (void)writer; (void)timestamp_frequency; (void)uncertainty_ppb;
+}
+
+int netwriter_flush(net_writer_t* writer) {
+    (void)writer;
+    return -1;
+}
+
+void netwriter_poll(net_writer_t* writer, uint64_t now_ns) {
+    (void)writer; (void)now_ns;
+}
+
+uint64_t netwriter_get_bytes_sent(const net_writer_t* writer) {
+    (void)writer;
+    return 0;
+}
+
+uint32_t netwriter_get_connections(const net_writer_t* writer) {
+    (void)writer;
+    return 0;
+}
+
+#endif
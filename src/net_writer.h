@@ -0,0 +1,165 @@
+/* Copyright (c) 2025
+ * CNanoLog Network Writer
+ *
+ * Streams the binary entry format to a collector over a Unix domain or TCP
+ * socket: a file header, then entries, with sites and levels sent in-band
+ * (CNANOLOG_STREAM_*_LOG_ID) ahead of the entries that use them.
+ *
+ * Entries are encoded into batches. Every batch starts with a clock sync
+ * record, so argument history restarts with it and any batch decodes on
+ * its own. Sealed batches queue in memory and leave in one non-blocking
+ * sendmsg() per round; the writer thread never waits on the socket. When
+ * the queue is full (collector down or slow) sealed batches go to a spool
+ * file instead. After a reconnect the header and sites are sent again,
+ * then the queue, then the spool, in order. A batch cut off by a
+ * disconnect is sent again in full (entries may arrive twice, not never).
+ *
+ * Needs timestamps (the sync records) and POSIX sockets.
+ */
+
+#pragma once
+
+#include "../include/cnanolog_format.h"
+#include "binary_writer.h"
+#include "log_registry.h"
+#include "platform.h"
+#include <stddef.h>
+#include <stdint.h>
+#ifdef PLATFORM_POSIX
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+#define NETWRITER_BATCH_SIZE (1024 * 1024)     /* Batch is sealed past this size */
+#define NETWRITER_QUEUE_BATCHES 8              /* Sealed batches kept in memory */
+#define NETWRITER_RETRY_MIN_NS 50000000ULL     /* First reconnect delay (50ms) */
+#define NETWRITER_RETRY_MAX_NS 2000000000ULL   /* Longest reconnect delay (2s) */
+#define NETWRITER_CLOSE_TIMEOUT_MS 3000        /* Shutdown: time to deliver the rest */
+
+/* ============================================================================
+ * Types
+ * ============================================================================ */
+
+typedef struct net_writer net_writer_t;
+
+/* ============================================================================
+ * Lifecycle
+ * ============================================================================ */
+
+/**
+ * Parse the address and start connecting (without waiting). A collector
+ * that is not up yet is not an error: entries queue and spool until it is.
+ *
+ * @param address "unix:/path/to/socket" or "tcp:host:port"
+ * @param spool_path Spool file (NULL = cnanolog-<pid>-<n>.spool), created
+ *                   when first needed and removed at close
+ * @return Writer, or NULL on a malformed address or allocation failure
+ */
+net_writer_t* netwriter_create(const char* address, const char* spool_path);
+
+/**
+ * Whether a sink path names a network address (unix: or tcp: prefix).
+ */
+int netwriter_is_address(const char* path);
+
+/**
+ * Set the stream header (sent first on every connection).
+ */
+void netwriter_set_header(net_writer_t* writer, uint64_t timestamp_frequency,
+                          uint64_t start_timestamp, int64_t start_time_sec,
+                          int32_t start_time_nsec, uint32_t uncertainty_ppb);
+
+/**
+ * Send the rest (custom levels and an end record last) for up to
+ * NETWRITER_CLOSE_TIMEOUT_MS, then close the socket and remove the spool.
+ *
+ * @return 0 if everything was delivered, -1 otherwise
+ */
+int netwriter_close(net_writer_t* writer,
+                    const custom_level_entry_t* custom_levels,
+                    uint32_t num_custom_levels);
+
+/**
+ * Crash handler: send the queued batches and the open one until the
+ * deadline if connected (async-signal-safe; the spool is not replayed).
+ */
+int netwriter_crash_close(net_writer_t* writer, uint64_t deadline_ns);
+
+/* ============================================================================
+ * Writing
+ * ============================================================================ */
+
+/**
+ * Prepare for an entry of a site: seal the batch if it is full, start a
+ * new batch with a sync record, and send the definitions of sites not
+ * announced yet. Call before compressing the entry's arguments.
+ *
+ * @return 1 if a batch was started (reset the argument history),
+ *         0 if not, -1 on failure
+ */
+int netwriter_begin_entry(net_writer_t* writer, const log_registry_t* registry,
+                          uint32_t log_id);
+
+/**
+ * Append an entry (arguments already compressed) to the open batch.
+ *
+ * @return 0 on success, -1 on failure
+ */
+int netwriter_write_entry(net_writer_t* writer, uint32_t log_id, uint64_t timestamp,
+                          const void* arg_data, size_t data_len);
+
+/**
+ * Append a clock sync record (argument history restarts after it).
+ *
+ * @return 0 on success, -1 on failure
+ */
+int netwriter_write_sync(net_writer_t* writer, uint64_t timestamp, int64_t real_sec,
+                         int32_t real_nsec, uint64_t mono_ns);
+
+/**
+ * Record the refined frequency (sent in the end record).
+ */
+void netwriter_set_timestamp_frequency(net_writer_t* writer, uint64_t timestamp_frequency,
+                                       uint32_t uncertainty_ppb);
+
+/**
+ * Seal the open batch and send what the socket takes.
+ *
+ * @return 0 on success, -1 on failure (spool write)
+ */
+int netwriter_flush(net_writer_t* writer);
+
+/**
+ * Make progress without new entries: finish connecting, reconnect after
+ * the retry delay, send queued and spooled batches. Does not block.
+ */
+void netwriter_poll(net_writer_t* writer, uint64_t now_ns);
+
+/* ============================================================================
+ * Statistics
+ * ============================================================================ */
+
+/** Bytes handed to the socket so far (including resent batches). */
+uint64_t netwriter_get_bytes_sent(const net_writer_t* writer);
+
+/** Connections made so far. */
+uint32_t netwriter_get_connections(const net_writer_t* writer);
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,21 +9,59 @@
  * Packing Implementation
  * ============================================================================ */
 
+/* Minimum bytes needed to represent the value (at least 1) */
+static inline uint8_t uint64_bytes(uint64_t val) {
+#if defined(__GNUC__) || defined(__clang__)
+    /* Branch-free: lengths vary per argument and mispredict the cascade */
+    return (uint8_t)((71 - __builtin_clzll(val | 1)) >> 3);
+#else
+    if (val < (1ULL << 8))       return 1;
+    else if (val < (1ULL << 16)) return 2;
+    else if (val < (1ULL << 24)) return 3;
+    else if (val < (1ULL << 32)) return 4;
+    else if (val < (1ULL << 40)) return 5;
+    else if (val < (1ULL << 48)) return 6;
+    else if (val < (1ULL << 56)) return 7;
+    else                         return 8;
+#endif
+}
+
+/*
+ * Store/load the low n bytes (1-8) without a variable-length memcpy.
+ * Lengths of 4+ use two overlapping 4-byte words, shorter ones the first,
+ * middle and last byte; both touch exactly n bytes of the buffer.
+ */
+static inline void store_low_bytes(char* p, uint64_t val, uint8_t n) {
+    if (n >= 4) {
+        uint32_t lo = (uint32_t)val;
+        uint32_t hi = (uint32_t)(val >> ((n - 4) * 8));
+        memcpy(p + n - 4, &hi, sizeof(hi));
+        memcpy(p, &lo, sizeof(lo));
+    } else {
+        p[0] = (char)val;
+        p[n >> 1] = (char)(val >> ((n >> 1) * 8));
+        p[n - 1] = (char)(val >> ((n - 1) * 8));
+    }
+}
+
+static inline uint64_t load_low_bytes(const char* p, uint8_t n) {
+    if (n >= 4) {
+        uint32_t lo, hi;
+        memcpy(&lo, p, sizeof(lo));
+        memcpy(&hi, p + n - 4, sizeof(hi));
+        return (uint64_t)lo | ((uint64_t)hi << ((n - 4) * 8));
+    }
+    const uint8_t* b = (const uint8_t*)p;
+    return (uint64_t)b[0] |
+           ((uint64_t)b[n >> 1] << ((n >> 1) * 8)) |
+           ((uint64_t)b[n - 1] << ((n - 1) * 8));
+}
+
 uint8_t pack_uint64(char** buffer, uint64_t val) {
-    uint8_t num_bytes;
-
-    /* Determine minimum bytes needed to represent the value */
-    if (val < (1ULL << 8))       num_bytes = 1;
-    else if (val < (1ULL << 16)) num_bytes = 2;
-    else if (val < (1ULL << 24)) num_bytes = 3;
-    else if (val < (1ULL << 32)) num_bytes = 4;
-    else if (val < (1ULL << 40)) num_bytes = 5;
-    else if (val < (1ULL << 48)) num_bytes = 6;
-    else if (val < (1ULL << 56)) num_bytes = 7;
-    else                         num_bytes = 8;
+    uint8_t num_bytes = uint64_bytes(val);
 
     /* Copy only the needed bytes (little-endian) */
-    memcpy(*buffer, &val, num_bytes);
+    store_low_bytes(*buffer, val, num_bytes);
     *buffer += num_bytes;
 
     return num_bytes;
@@ -41,6 +79,85 @@ uint8_t pack_int64(char** buffer, int64_t val, int* is_negative) {
     }
 }
 
+/* Move recent[index] to the front, or push bits if index == XOR_HISTORY */
+static inline void xor_slot_promote(xor_slot_t* slot, int index, uint64_t bits) {
+    if (index == XOR_HISTORY) {
+        index = XOR_HISTORY - 1;  /* Oldest value drops out */
+    }
+    for (int i = index; i > 0; i--) {
+        slot->recent[i] = slot->recent[i - 1];
+    }
+    slot->recent[0] = bits;
+}
+
+uint8_t pack_double_xor(char** buffer, double val, xor_slot_t* slot) {
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+
+    for (int i = 0; i < XOR_HISTORY; i++) {
+        if (slot->recent[i] == bits) {
+            xor_slot_promote(slot, i, bits);
+            return i == 0 ? XOR_NIBBLE_REPEAT : (uint8_t)(XOR_NIBBLE_RECENT + i - 1);
+        }
+    }
+
+    uint64_t xor_bits = bits ^ slot->recent[0];
+    xor_slot_promote(slot, XOR_HISTORY, bits);
+
+#if defined(__GNUC__) || defined(__clang__)
+    uint8_t trailing = (uint8_t)(__builtin_ctzll(xor_bits) >> 3);
+#else
+    uint8_t trailing = 0;
+    while ((xor_bits >> (trailing * 8) & 0xFF) == 0) {
+        trailing++;
+    }
+#endif
+
+    /* Keep the current window when it costs no more than opening a new one */
+    uint8_t new_bytes = uint64_bytes(xor_bits >> (trailing * 8));
+    if (trailing >= slot->shift) {
+        uint8_t window_bytes = uint64_bytes(xor_bits >> (slot->shift * 8));
+        if (window_bytes <= 1 + new_bytes) {
+            return pack_uint64(buffer, xor_bits >> (slot->shift * 8));
+        }
+    }
+
+    slot->shift = trailing;
+    **buffer = (char)(trailing | (new_bytes << 4));
+    *buffer += 1;
+    pack_uint64(buffer, xor_bits >> (trailing * 8));
+    return XOR_NIBBLE_WINDOW;
+}
+
+/* Interleave signs so small magnitudes stay small: 0, -1, 1, -2, ... */
+static inline uint64_t zigzag_encode(uint64_t val) {
+    return (val << 1) ^ (uint64_t)((int64_t)val >> 63);
+}
+
+static inline uint64_t zigzag_decode(uint64_t val) {
+    return (val >> 1) ^ (0 - (val & 1));
+}
+
+uint8_t pack_int_delta(char** buffer, uint64_t val, int is_signed, delta_slot_t* slot) {
+    uint64_t delta = val - slot->prev;
+    uint64_t prev_delta = slot->delta;
+    slot->prev = val;
+    slot->delta = delta;
+
+    if (delta == prev_delta) {
+        return DELTA_NIBBLE_REPEAT;
+    }
+
+    uint64_t absolute = is_signed ? zigzag_encode(val) : val;
+    uint64_t zigzag_delta = zigzag_encode(delta);
+    uint8_t delta_bytes = uint64_bytes(zigzag_delta);
+    if (delta_bytes < uint64_bytes(absolute) && delta_bytes < 8) {
+        pack_uint64(buffer, zigzag_delta);
+        return (uint8_t)(DELTA_NIBBLE_DELTA + delta_bytes);
+    }
+    return pack_uint64(buffer, absolute);
+}
+
 /* ============================================================================
  * Unpacking Implementation
  * ============================================================================ */
@@ -54,7 +171,7 @@ uint64_t unpack_uint64(const char** buffer, uint8_t num_bytes) {
     }
 
     /* Copy the bytes and zero-extend to 64 bits */
-    memcpy(&val, *buffer, num_bytes);
+    val = load_low_bytes(*buffer, num_bytes);
     *buffer += num_bytes;
 
     return val;
@@ -71,3 +188,62 @@ int64_t unpack_int64(const char** buffer, uint8_t num_bytes, int is_negative) {
         return (int64_t)abs_val;
     }
 }
+
+int unpack_double_xor(const char** buffer, const char* end, uint8_t nibble,
+                      xor_slot_t* slot, double* val) {
+    uint64_t bits;
+
+    if (nibble == XOR_NIBBLE_REPEAT || nibble >= XOR_NIBBLE_RECENT) {
+        int index = nibble == XOR_NIBBLE_REPEAT ? 0 : nibble - XOR_NIBBLE_RECENT + 1;
+        if (index >= XOR_HISTORY) {
+            return -1;
+        }
+        bits = slot->recent[index];
+        xor_slot_promote(slot, index, bits);
+    } else {
+        uint8_t num_bytes = nibble;
+        if (nibble == XOR_NIBBLE_WINDOW) {
+            if (*buffer >= end) {
+                return -1;
+            }
+            uint8_t control = (uint8_t)**buffer;
+            *buffer += 1;
+            slot->shift = control & 0x0F;
+            num_bytes = control >> 4;
+        }
+        if (num_bytes == 0 || slot->shift + num_bytes > 8 || *buffer + num_bytes > end) {
+            return -1;
+        }
+        bits = slot->recent[0] ^ (unpack_uint64(buffer, num_bytes) << (slot->shift * 8));
+        xor_slot_promote(slot, XOR_HISTORY, bits);
+    }
+
+    memcpy(val, &bits, sizeof(*val));
+    return 0;
+}
+
+int unpack_int_delta(const char** buffer, const char* end, uint8_t nibble,
+                     int is_signed, delta_slot_t* slot, uint64_t* val) {
+    uint64_t delta;
+
+    if (nibble == DELTA_NIBBLE_REPEAT) {
+        delta = slot->delta;
+    } else if (nibble > DELTA_NIBBLE_DELTA) {
+        uint8_t num_bytes = nibble - DELTA_NIBBLE_DELTA;
+        if (*buffer + num_bytes > end) {
+            return -1;
+        }
+        delta = zigzag_decode(unpack_uint64(buffer, num_bytes));
+    } else {
+        if (*buffer + nibble > end) {
+            return -1;
+        }
+        uint64_t absolute = unpack_uint64(buffer, nibble);
+        delta = (is_signed ? zigzag_decode(absolute) : absolute) - slot->prev;
+    }
+
+    slot->prev += delta;
+    slot->delta = delta;
+    *val = slot->prev;
+    return 0;
+}
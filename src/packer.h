@@ -103,6 +103,116 @@ static inline int32_t unpack_int32(const char** buffer, uint8_t num_bytes, int i
     return (int32_t)unpack_int64(buffer, num_bytes, is_negative);
 }
 
+/* ============================================================================
+ * Double XOR Encoding
+ * ============================================================================ */
+
+/* Recent distinct values remembered per slot */
+#define XOR_HISTORY 7
+
+/**
+ * History for one double argument slot of one log site.
+ *
+ * Prices tend to revisit a handful of levels, so a value equal to one of
+ * the slot's recent distinct values costs only its nibble (as in Chimp128,
+ * which matches against earlier values). Otherwise it is XORed with the
+ * newest value: nearby values share sign, exponent and high mantissa
+ * bits, so only the bytes inside a window are stored - a byte-granular
+ * Gorilla that fits the nibble metadata. Encoder and decoder keep
+ * identical history, so slots must see every entry in file order.
+ */
+typedef struct {
+    uint64_t recent[XOR_HISTORY];  /* Distinct value bits, newest first */
+    uint8_t shift;                 /* Trailing zero bytes dropped from the XOR */
+} xor_slot_t;
+
+/* Nibble values for doubles (1-8: that many XOR bytes in the current window) */
+#define XOR_NIBBLE_REPEAT 0   /* Same bits as recent[0] */
+#define XOR_NIBBLE_WINDOW 9   /* Window byte (shift | bytes << 4), then XOR bytes */
+#define XOR_NIBBLE_RECENT 10  /* 10-15: same bits as recent[1..6] */
+
+/* Largest encoding of one double: control byte plus 8 bytes */
+#define XOR_MAX_BYTES 9
+
+/**
+ * Pack a double as a match against, or an XOR with, the slot's recent values.
+ *
+ * @param buffer Pointer to buffer pointer (will be advanced)
+ * @param val Value to pack
+ * @param slot History for this site and argument (updated)
+ * @return Nibble describing the encoding
+ */
+uint8_t pack_double_xor(char** buffer, double val, xor_slot_t* slot);
+
+/**
+ * Unpack a double written by pack_double_xor().
+ *
+ * @param buffer Pointer to buffer pointer (will be advanced)
+ * @param end End of the readable data
+ * @param nibble Nibble stored for this argument
+ * @param slot History for this site and argument (updated)
+ * @param val Output: unpacked value
+ * @return 0 on success, -1 if the encoding is invalid or truncated
+ */
+int unpack_double_xor(const char** buffer, const char* end, uint8_t nibble,
+                      xor_slot_t* slot, double* val);
+
+/* ============================================================================
+ * Integer Delta Encoding
+ * ============================================================================ */
+
+/**
+ * History for one integer argument slot of one log site.
+ *
+ * Sequence numbers, ids and offsets grow steadily: the delta from the
+ * previous value is small even when the value is not, and often equal to
+ * the previous delta. Values are handled as 64 bits (signed types
+ * sign-extended), deltas wrap modulo 2^64.
+ */
+typedef struct {
+    uint64_t prev;   /* Previous value */
+    uint64_t delta;  /* Previous delta (prev minus the value before it) */
+} delta_slot_t;
+
+/* Nibble values for integers (1-8: absolute value in that many bytes,
+ * zig-zag for signed types) */
+#define DELTA_NIBBLE_REPEAT 0  /* Value = prev + delta, no bytes */
+#define DELTA_NIBBLE_DELTA  8  /* 9-15: zig-zag delta in (nibble - 8) bytes */
+
+/**
+ * Pack an integer as a delta or absolute value, whichever is smaller.
+ *
+ * @param buffer Pointer to buffer pointer (will be advanced)
+ * @param val Value (signed types sign-extended to 64 bits)
+ * @param is_signed 1 for signed argument types
+ * @param slot History for this site and argument (updated)
+ * @return Nibble describing the encoding
+ */
+uint8_t pack_int_delta(char** buffer, uint64_t val, int is_signed, delta_slot_t* slot);
+
+/**
+ * Unpack an integer written by pack_int_delta().
+ *
+ * @param buffer Pointer to buffer pointer (will be advanced)
+ * @param end End of the readable data
+ * @param nibble Nibble stored for this argument
+ * @param is_signed 1 for signed argument types
+ * @param slot History for this site and argument (updated)
+ * @param val Output: value (signed types sign-extended to 64 bits)
+ * @return 0 on success, -1 if the encoding is invalid or truncated
+ */
+int unpack_int_delta(const char** buffer, const char* end, uint8_t nibble,
+                     int is_signed, delta_slot_t* slot, uint64_t* val);
+
+/**
+ * History for one argument slot: doubles and integers each use their own
+ * view (a slot's type is fixed by its log site).
+ */
+typedef union {
+    xor_slot_t dbl;
+    delta_slot_t num;
+} arg_slot_t;
+
 /* ============================================================================
  * Nibble Helper Functions
  * ============================================================================ */
@@ -62,6 +62,10 @@ int cnanolog_cond_signal(cnanolog_cond_t* cond) {
     return pthread_cond_signal(cond);
 }
 
+int cnanolog_cond_broadcast(cnanolog_cond_t* cond) {
+    return pthread_cond_broadcast(cond);
+}
+
 void cnanolog_cond_destroy(cnanolog_cond_t* cond) {
     pthread_cond_destroy(cond);
 }
@@ -119,6 +123,24 @@ int cnanolog_thread_set_affinity(cnanolog_thread_t thread, int core_id) {
 #endif
 }
 
+int cnanolog_thread_get_name(char* name, size_t size) {
+    if (name == NULL || size == 0) {
+        return -1;
+    }
+    name[0] = '\0';
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MACOS)
+    /* Linux: 16 bytes at most (comm); macOS: up to 64 */
+    if (pthread_getname_np(pthread_self(), name, size) != 0) {
+        name[0] = '\0';
+        return -1;
+    }
+    return 0;
+#else
+    return -1;
+#endif
+}
+
 #elif defined(PLATFORM_WINDOWS)
 
 // Thread functions
@@ -173,6 +195,11 @@ int cnanolog_cond_signal(cnanolog_cond_t* cond) {
     return 0;
 }
 
+int cnanolog_cond_broadcast(cnanolog_cond_t* cond) {
+    WakeAllConditionVariable(cond);
+    return 0;
+}
+
 void cnanolog_cond_destroy(cnanolog_cond_t* cond) {
     // No-op on Windows
 }
@@ -196,4 +223,12 @@ int cnanolog_thread_set_affinity(cnanolog_thread_t thread, int core_id) {
     return 0;
 }
 
+int cnanolog_thread_get_name(char* name, size_t size) {
+    if (name == NULL || size == 0) {
+        return -1;
+    }
+    name[0] = '\0';  /* GetThreadDescription needs Windows 10 */
+    return -1;
+}
+
 #endif
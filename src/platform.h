@@ -101,8 +101,12 @@ void cnanolog_mutex_destroy(cnanolog_mutex_t* mutex);
 int cnanolog_cond_init(cnanolog_cond_t* cond);
 int cnanolog_cond_wait(cnanolog_cond_t* cond, cnanolog_mutex_t* mutex);
 int cnanolog_cond_signal(cnanolog_cond_t* cond);
+int cnanolog_cond_broadcast(cnanolog_cond_t* cond);
 void cnanolog_cond_destroy(cnanolog_cond_t* cond);
 
 // CPU affinity functions
 int cnanolog_thread_set_affinity(cnanolog_thread_t thread, int core_id);
 
+// Name of the calling thread ("" and -1 where unsupported)
+int cnanolog_thread_get_name(char* name, size_t size);
+
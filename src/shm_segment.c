@@ -0,0 +1,222 @@
+/* Copyright (c) 2025
+ * CNanoLog Shared Memory Segment Implementation
+ */
+
+#include "shm_segment.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+static size_t segment_size(uint32_t max_buffers) {
+    size_t first = (sizeof(shm_header_t) + 4095) & ~(size_t)4095;
+    return first + (size_t)max_buffers * sizeof(staging_buffer_t);
+}
+
+/* ============================================================================
+ * Lifecycle
+ * ============================================================================ */
+
+shm_header_t* shm_segment_create(const char* name, uint32_t max_buffers) {
+#ifdef PLATFORM_POSIX
+    if (max_buffers == 0) {
+        max_buffers = SHM_DEFAULT_BUFFERS;
+    }
+    if (max_buffers > SHM_MAX_BUFFERS) {
+        fprintf(stderr, "shm_segment_create: max_buffers %u exceeds %d\n",
+                max_buffers, SHM_MAX_BUFFERS);
+        return NULL;
+    }
+
+    /* A segment left by an earlier run that no agent attached to */
+    shm_unlink(name);
+
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd == -1) {
+        fprintf(stderr, "shm_segment_create: shm_open %s failed: %s\n", name, strerror(errno));
+        return NULL;
+    }
+
+    /* Sparse: pages are allocated on first touch */
+    size_t size = segment_size(max_buffers);
+    if (ftruncate(fd, (off_t)size) != 0) {
+        fprintf(stderr, "shm_segment_create: ftruncate failed: %s\n", strerror(errno));
+        close(fd);
+        shm_unlink(name);
+        return NULL;
+    }
+
+    void* base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        fprintf(stderr, "shm_segment_create: mmap failed: %s\n", strerror(errno));
+        shm_unlink(name);
+        return NULL;
+    }
+
+    /* A fresh object reads as zeros: only the identity needs writing */
+    shm_header_t* shm = (shm_header_t*)base;
+    shm->version = SHM_SEGMENT_VERSION;
+    shm->segment_size = size;
+    shm->max_buffers = max_buffers;
+    shm->app_pid = (int32_t)getpid();
+    shm->app_state = SHM_APP_RUNNING;
+    __atomic_store_n(&shm->magic, SHM_SEGMENT_MAGIC, __ATOMIC_RELEASE);
+    return shm;
+#else
+    (void)name;
+    (void)max_buffers;
+    return NULL;
+#endif
+}
+
+shm_header_t* shm_segment_attach(const char* name) {
+#ifdef PLATFORM_POSIX
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd == -1) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(shm_header_t)) {
+        close(fd);
+        return NULL;
+    }
+
+    void* base = mmap(NULL, (size_t)st.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    shm_header_t* shm = (shm_header_t*)base;
+    if (__atomic_load_n(&shm->magic, __ATOMIC_ACQUIRE) != SHM_SEGMENT_MAGIC ||
+        shm->version != SHM_SEGMENT_VERSION ||
+        shm->segment_size != (uint64_t)st.st_size ||
+        segment_size(shm->max_buffers) != (size_t)st.st_size) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    return shm;
+#else
+    (void)name;
+    return NULL;
+#endif
+}
+
+void shm_segment_detach(shm_header_t* shm) {
+#ifdef PLATFORM_POSIX
+    if (shm != NULL) {
+        munmap(shm, (size_t)shm->segment_size);
+    }
+#else
+    (void)shm;
+#endif
+}
+
+/* ============================================================================
+ * Application Side
+ * ============================================================================ */
+
+staging_buffer_t* shm_segment_claim_buffer(shm_header_t* shm, uint32_t thread_id) {
+    /* The agent may see the index first: the buffer's fields are still
+     * zero then, which reads as empty */
+    uint32_t index;
+    do {
+        index = __atomic_load_n(&shm->num_buffers, __ATOMIC_ACQUIRE);
+        if (index >= shm->max_buffers) {
+            return NULL;
+        }
+    } while (!__atomic_compare_exchange_n(&shm->num_buffers, &index, index + 1, 0,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    staging_buffer_t* sb = shm_segment_buffer(shm, index);
+    staging_buffer_init(sb, thread_id);
+    return sb;
+}
+
+/**
+ * Copy a string into the string area.
+ * Returns its offset, or UINT32_MAX if the area is full.
+ */
+static uint32_t copy_string(shm_header_t* shm, const char* str, size_t len) {
+    if (shm->strings_used + len + 1 > SHM_STRING_AREA_SIZE) {
+        return UINT32_MAX;
+    }
+    uint32_t offset = shm->strings_used;
+    memcpy(shm->strings + offset, str, len);
+    shm->strings[offset + len] = '\0';
+    shm->strings_used += (uint32_t)len + 1;
+    return offset;
+}
+
+void shm_segment_publish_sites(shm_header_t* shm, log_registry_t* registry) {
+    cnanolog_mutex_lock(&registry->lock);
+
+    uint32_t published = shm->num_sites;
+    while (published < registry->count && published < SHM_MAX_SITES) {
+        const log_site_t* site = &registry->sites[published];
+        shm_site_t* out = &shm->sites[published];
+
+        out->line_number = site->line_number;
+        out->log_level = (uint8_t)site->log_level;
+        out->num_args = site->num_args;
+        for (uint8_t i = 0; i < site->num_args && i < CNANOLOG_MAX_ARGS; i++) {
+            out->arg_types[i] = (uint8_t)site->arg_types[i];
+        }
+
+        uint32_t filename = copy_string(shm, site->filename, strlen(site->filename));
+        uint32_t format = copy_string(shm, site->format, strlen(site->format));
+        if (filename == UINT32_MAX || format == UINT32_MAX) {
+            /* Area full: keep the entries decodable by type, without text */
+            static int warned = 0;
+            if (!warned) {
+                fprintf(stderr, "cnanolog: Shared string area full, sites lose their text\n");
+                warned = 1;
+            }
+            uint32_t empty = copy_string(shm, "", 0);
+            out->filename_offset = (filename != UINT32_MAX) ? filename : empty;
+            out->format_offset = (format != UINT32_MAX) ? format : empty;
+            if (empty == UINT32_MAX) {
+                out->filename_offset = out->format_offset = SHM_STRING_AREA_SIZE - 1;
+            }
+        } else {
+            out->filename_offset = filename;
+            out->format_offset = format;
+        }
+
+        published++;
+    }
+    __atomic_store_n(&shm->num_sites, published, __ATOMIC_RELEASE);
+
+    cnanolog_mutex_unlock(&registry->lock);
+}
+
+int shm_segment_publish_interned(shm_header_t* shm, const cnanolog_string_t* handle) {
+    uint32_t count = shm->num_interned;
+    if (count >= SHM_MAX_INTERNED) {
+        return -1;
+    }
+    uint32_t text = copy_string(shm, handle->str, handle->len);
+    if (text == UINT32_MAX) {
+        return -1;
+    }
+
+    shm->interned[count].handle = (uint64_t)(uintptr_t)handle;
+    shm->interned[count].text_offset = text;
+    shm->interned[count].len = handle->len;
+    __atomic_store_n(&shm->num_interned, count + 1, __ATOMIC_RELEASE);
+    return 0;
+}
+
+void shm_segment_publish_levels(shm_header_t* shm, const custom_level_entry_t* levels,
+                                uint32_t num_levels) {
+    if (num_levels > CNANOLOG_MAX_CUSTOM_LEVELS) {
+        num_levels = CNANOLOG_MAX_CUSTOM_LEVELS;
+    }
+    for (uint32_t i = shm->num_levels; i < num_levels; i++) {
+        shm->levels[i] = levels[i];
+    }
+    if (num_levels > shm->num_levels) {
+        __atomic_store_n(&shm->num_levels, num_levels, __ATOMIC_RELEASE);
+    }
+}
@@ -0,0 +1,171 @@
+/* Copyright (c) 2025
+ * CNanoLog Shared Memory Segment
+ *
+ * Staging buffers, site dictionary and clock calibration of an application
+ * in a POSIX shared memory object, so a separate process (cnanolog-agent)
+ * can run the writer loop. The application only reserves and commits;
+ * everything it publishes stays readable after it exits or crashes.
+ *
+ * Layout: shm_header_t, then max_buffers staging buffers. Tables are
+ * append-only: entries are filled in, then their count is published with
+ * release semantics (readers load it with acquire).
+ */
+
+#pragma once
+
+#include "binary_writer.h"
+#include "log_registry.h"
+#include "staging_buffer.h"
+#include <stddef.h>
+#include <stdint.h>
+#ifdef PLATFORM_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+#define SHM_SEGMENT_MAGIC 0x4D48534E   /* "NSHM" in little-endian */
+#define SHM_SEGMENT_VERSION 2
+
+#define SHM_DEFAULT_BUFFERS 16         /* Logging threads (128MB of address space each) */
+#define SHM_MAX_BUFFERS 256            /* Same limit as the in-process buffer registry */
+#define SHM_MAX_SITES 16384
+#define SHM_MAX_INTERNED 16384
+#define SHM_STRING_AREA_SIZE (4 * 1024 * 1024)  /* Filenames, formats, interned text */
+
+/* Application state */
+#define SHM_APP_RUNNING 1
+#define SHM_APP_CLOSED 2               /* cnanolog_shutdown() called */
+
+/* ============================================================================
+ * Types
+ * ============================================================================ */
+
+/** Log site as published for the agent (strings in the string area). */
+typedef struct {
+    uint32_t line_number;
+    uint32_t filename_offset;
+    uint32_t format_offset;
+    uint8_t log_level;
+    uint8_t num_args;
+    uint8_t arg_types[CNANOLOG_MAX_ARGS];
+} shm_site_t;
+
+/** Interned string: the handle's address in the application, and its text. */
+typedef struct {
+    uint64_t handle;
+    uint32_t text_offset;
+    uint32_t len;
+} shm_interned_t;
+
+typedef struct ALIGN_CACHELINE {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t segment_size;
+    uint32_t max_buffers;
+    int32_t app_pid;
+    volatile uint32_t app_state;        /* SHM_APP_* */
+    volatile uint32_t agent_pid;        /* Attached agent (0 = none yet) */
+
+    /* Clock calibration of the application (see tsc_calibration.h) */
+    uint32_t clock_source;              /* tsc_source_t */
+    uint32_t frequency_uncertainty_ppb;
+    uint64_t timestamp_frequency;
+    uint64_t start_tsc;
+    uint64_t start_mono_ns;
+    int64_t start_real_sec;
+    int32_t start_real_nsec;
+    uint32_t _reserved;
+
+    /* Published counts (release) */
+    volatile uint32_t num_buffers;      /* Claimed staging buffers */
+    volatile uint32_t num_sites;
+    volatile uint32_t num_interned;
+    volatile uint32_t num_levels;
+    uint32_t strings_used;              /* Application side only */
+
+    custom_level_entry_t levels[CNANOLOG_MAX_CUSTOM_LEVELS];
+    shm_site_t sites[SHM_MAX_SITES];
+    shm_interned_t interned[SHM_MAX_INTERNED];
+    char strings[SHM_STRING_AREA_SIZE];
+} shm_header_t;
+
+/* ============================================================================
+ * Lifecycle
+ * ============================================================================ */
+
+/**
+ * Create the segment (replacing a stale one of the same name) and map it.
+ * Staging buffer pages are allocated only as threads use them.
+ *
+ * @param name POSIX shared memory name ("/app-log")
+ * @param max_buffers Staging buffers (0 = SHM_DEFAULT_BUFFERS)
+ * @return Mapped header, or NULL on failure
+ */
+shm_header_t* shm_segment_create(const char* name, uint32_t max_buffers);
+
+/**
+ * Map an existing segment (agent).
+ *
+ * @return Mapped header, or NULL if it does not exist or is not a segment
+ *         of this version
+ */
+shm_header_t* shm_segment_attach(const char* name);
+
+void shm_segment_detach(shm_header_t* shm);
+
+/**
+ * Staging buffer at an index (< num_buffers).
+ */
+static inline staging_buffer_t* shm_segment_buffer(shm_header_t* shm, uint32_t index) {
+    size_t first = (sizeof(shm_header_t) + 4095) & ~(size_t)4095;
+    return (staging_buffer_t*)((char*)shm + first) + index;
+}
+
+/* ============================================================================
+ * Application Side
+ * ============================================================================ */
+
+/**
+ * Claim and initialize the next staging buffer (lock-free).
+ *
+ * @return Buffer, or NULL if all max_buffers are taken
+ */
+staging_buffer_t* shm_segment_claim_buffer(shm_header_t* shm, uint32_t thread_id);
+
+/*
+ * Publishers share the string area: the caller serializes all of them.
+ */
+
+/**
+ * Publish sites registered since the last call, in log_id order
+ * (also takes the registry lock). Sites whose strings do not fit are
+ * published with empty strings, so their entries are still written.
+ */
+void shm_segment_publish_sites(shm_header_t* shm, log_registry_t* registry);
+
+/**
+ * Publish an interned string.
+ *
+ * @return 0 on success, -1 if the tables are full
+ */
+int shm_segment_publish_interned(shm_header_t* shm, const cnanolog_string_t* handle);
+
+/**
+ * Publish custom levels from index num_levels on.
+ */
+void shm_segment_publish_levels(shm_header_t* shm, const custom_level_entry_t* levels,
+                                uint32_t num_levels);
+
+#ifdef __cplusplus
+}
+#endif
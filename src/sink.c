@@ -0,0 +1,249 @@
+/* Copyright (c) 2025
+ * CNanoLog Output Sinks Implementation
+ */
+
+#include "sink.h"
+#include "staging_buffer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================================================================
+ * Lifecycle
+ * ============================================================================ */
+
+int sink_open(log_sink_t* sink, const cnanolog_sink_config_t* config,
+              uint64_t frequency, uint32_t uncertainty_ppb, const tsc_sample_t* start) {
+    memset(sink, 0, sizeof(*sink));
+    sink->format = config->format;
+    sink->file_filter = config->file_filter;
+    sink->flush_interval_ns = (uint64_t)config->flush_interval_ms * 1000000ULL;
+    sink->last_flush_ns = tsc_monotonic_ns();
+
+    if (config->levels == NULL) {
+        memset(sink->levels, 1, sizeof(sink->levels));
+    } else {
+        for (uint32_t i = 0; i < config->num_levels; i++) {
+            sink->levels[config->levels[i]] = 1;
+        }
+    }
+
+    if (sink->format != CNANOLOG_OUTPUT_BINARY) {
+        sink->text = text_writer_create(config->path);
+        if (sink->text == NULL) {
+            fprintf(stderr, "cnanolog: Failed to open sink: %s\n", config->path);
+            return -1;
+        }
+        if (start != NULL) {
+            text_writer_set_timestamp_info(sink->text, frequency, start->tsc,
+                                           (time_t)start->real_sec, start->real_nsec);
+        }
+        text_writer_set_pattern(sink->text, config->text_pattern);
+        text_writer_set_output_format(sink->text, sink->format);
+        return 0;
+    }
+
+    if (netwriter_is_address(config->path)) {
+        if (start == NULL) {
+            fprintf(stderr, "cnanolog: Network sink %s needs timestamps\n", config->path);
+            return -1;
+        }
+        sink->net = netwriter_create(config->path, config->spool_path);
+        if (sink->net == NULL) {
+            fprintf(stderr, "cnanolog: Failed to open sink: %s\n", config->path);
+            return -1;
+        }
+        compress_history_init(&sink->history);
+        netwriter_set_header(sink->net, frequency, start->tsc, start->real_sec,
+                             start->real_nsec, uncertainty_ppb);
+        return 0;
+    }
+
+    sink->binary = binwriter_create(config->path);
+    if (sink->binary == NULL) {
+        fprintf(stderr, "cnanolog: Failed to open sink: %s\n", config->path);
+        return -1;
+    }
+    compress_history_init(&sink->history);
+
+    int result;
+    if (start != NULL) {
+        binwriter_set_timestamp_frequency(sink->binary, frequency, uncertainty_ppb);
+        result = binwriter_write_header(sink->binary, frequency, start->tsc,
+                                        (time_t)start->real_sec, start->real_nsec);
+        binwriter_write_sync(sink->binary, start->tsc, start->real_sec, start->real_nsec,
+                             start->mono_ns);
+    } else {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        result = binwriter_write_header(sink->binary, 0, 0, ts.tv_sec, (int32_t)ts.tv_nsec);
+    }
+    if (result != 0) {
+        fprintf(stderr, "cnanolog: Failed to write sink header: %s\n", config->path);
+        binwriter_close(sink->binary, NULL, 0, NULL, 0);
+        compress_history_destroy(&sink->history);
+        sink->binary = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+void sink_close(log_sink_t* sink, const log_site_t* sites, uint32_t num_sites,
+                const custom_level_entry_t* custom_levels, uint32_t num_custom_levels) {
+    if (sink->text != NULL) {
+        text_writer_close(sink->text);
+        sink->text = NULL;
+    }
+    if (sink->binary != NULL) {
+        if (binwriter_close(sink->binary, sites, num_sites,
+                            custom_levels, num_custom_levels) != 0) {
+            fprintf(stderr, "cnanolog: Failed to close binary sink\n");
+        }
+        compress_history_destroy(&sink->history);
+        sink->binary = NULL;
+    }
+    if (sink->net != NULL) {
+        netwriter_close(sink->net, custom_levels, num_custom_levels);
+        compress_history_destroy(&sink->history);
+        sink->net = NULL;
+    }
+    free(sink->site_match);
+    sink->site_match = NULL;
+    sink->site_match_capacity = 0;
+}
+
+void sink_crash_close(log_sink_t* sink, const log_site_t* sites, uint32_t num_sites,
+                      const custom_level_entry_t* custom_levels, uint32_t num_custom_levels,
+                      uint64_t deadline_ns) {
+    if (sink->text != NULL) {
+        text_writer_crash_flush(sink->text, deadline_ns);
+    }
+    if (sink->binary != NULL) {
+        binwriter_crash_close(sink->binary, sites, num_sites,
+                              custom_levels, num_custom_levels, deadline_ns);
+    }
+    if (sink->net != NULL) {
+        netwriter_crash_close(sink->net, deadline_ns);
+    }
+}
+
+/* ============================================================================
+ * Entries
+ * ============================================================================ */
+
+/**
+ * Site filter, evaluated once per site and cached by log_id.
+ */
+int sink_match_file(log_sink_t* sink, const log_site_t* site) {
+    uint32_t log_id = site->log_id;
+    if (log_id >= sink->site_match_capacity) {
+        uint32_t capacity = sink->site_match_capacity ? sink->site_match_capacity : 256;
+        while (capacity <= log_id) {
+            capacity *= 2;
+        }
+        uint8_t* grown = (uint8_t*)realloc(sink->site_match, capacity);
+        if (grown == NULL) {
+            return strstr(site->filename, sink->file_filter) != NULL;
+        }
+        memset(grown + sink->site_match_capacity, 0, capacity - sink->site_match_capacity);
+        sink->site_match = grown;
+        sink->site_match_capacity = capacity;
+    }
+
+    if (sink->site_match[log_id] == 0) {
+        sink->site_match[log_id] = (strstr(site->filename, sink->file_filter) != NULL) ? 1 : 2;
+    }
+    return sink->site_match[log_id] == 1;
+}
+
+int sink_write_entry(log_sink_t* sink, const char* entry, const log_site_t* site,
+                     log_registry_t* registry, char* compressed_buf) {
+    const cnanolog_entry_header_t* header = (const cnanolog_entry_header_t*)entry;
+    size_t arg_data_len;
+    const char* arg_data = staging_entry_data(entry, &arg_data_len);
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    uint64_t timestamp = header->timestamp;
+#else
+    uint64_t timestamp = 0;
+#endif
+
+    sink->unflushed++;
+    if (sink->text != NULL) {
+        return text_writer_write_entry(sink->text, header->log_id, timestamp,
+                                       arg_data, arg_data_len, registry);
+    }
+
+    if (sink->net != NULL) {
+        /* A new batch starts a new history (batches decode on their own) */
+        int started = netwriter_begin_entry(sink->net, registry, header->log_id);
+        if (started < 0) {
+            return -1;
+        }
+        if (started) {
+            compress_history_reset(&sink->history);
+        }
+    }
+
+    const char* data = arg_data;
+    size_t data_len = arg_data_len;
+    if (site->num_args > 0) {
+        arg_slot_t* history = compress_history_get(&sink->history, site);
+        if (history == NULL) {
+            /* Without history the decoder would lose track of this site */
+            return -1;
+        }
+        size_t compressed_len = 0;
+        if (compress_entry_args(arg_data, arg_data_len, compressed_buf, &compressed_len,
+                                site, history, &sink->history.strings) == 0) {
+            data = compressed_buf;
+            data_len = compressed_len;
+        }
+    }
+    if (sink->net != NULL) {
+        return netwriter_write_entry(sink->net, header->log_id, timestamp, data, data_len);
+    }
+    return binwriter_write_entry(sink->binary, header->log_id, timestamp, data, data_len);
+}
+
+void sink_flush(log_sink_t* sink, uint64_t now_ns) {
+    if (sink->text != NULL) {
+        text_writer_flush(sink->text);
+    } else if (sink->binary != NULL) {
+        binwriter_flush(sink->binary);
+    } else if (sink->net != NULL) {
+        netwriter_flush(sink->net);
+    }
+    sink->unflushed = 0;
+    sink->last_flush_ns = now_ns;
+}
+
+/* ============================================================================
+ * Clock
+ * ============================================================================ */
+
+void sink_sync(log_sink_t* sink, const tsc_sample_t* now, uint64_t frequency,
+               uint32_t uncertainty_ppb) {
+    if (sink->net != NULL) {
+        netwriter_set_timestamp_frequency(sink->net, frequency, uncertainty_ppb);
+        if (netwriter_write_sync(sink->net, now->tsc, now->real_sec, now->real_nsec,
+                                 now->mono_ns) == 0) {
+            compress_history_reset(&sink->history);
+        }
+        return;
+    }
+    if (sink->binary == NULL) {
+        return;
+    }
+    binwriter_set_timestamp_frequency(sink->binary, frequency, uncertainty_ppb);
+    if (binwriter_write_sync(sink->binary, now->tsc, now->real_sec, now->real_nsec,
+                             now->mono_ns) == 0) {
+        compress_history_reset(&sink->history);
+    }
+}
+
+void sink_set_text_clock(log_sink_t* sink, uint64_t frequency, uint64_t timestamp,
+                         time_t sec, int32_t nsec) {
+    if (sink->text != NULL) {
+        text_writer_set_timestamp_info(sink->text, frequency, timestamp, sec, nsec);
+    }
+}
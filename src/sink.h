@@ -0,0 +1,148 @@
+/* Copyright (c) 2025
+ * CNanoLog Output Sinks
+ *
+ * A sink is one extra output (binary_writer_t, text_writer_t, or a
+ * net_writer_t streaming to a collector) with its own level and site
+ * filters, argument history and flush policy. The
+ * writer thread looks up an entry's site once and offers the entry to
+ * every sink. Owned by the writer thread (then shutdown, after the join).
+ */
+
+#pragma once
+
+#include "../include/cnanolog.h"
+#include "binary_writer.h"
+#include "compressor.h"
+#include "log_registry.h"
+#include "net_writer.h"
+#include "text_formatter.h"
+#include "tsc_calibration.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    cnanolog_output_format_t format;
+    binary_writer_t* binary;       /* Binary sinks */
+    net_writer_t* net;             /* Binary sinks to a unix: or tcp: address */
+    text_writer_t* text;           /* Text, JSON and logfmt sinks */
+    compress_history_t history;    /* Binary: this stream's argument history */
+
+    uint8_t levels[256];           /* Nonzero = level written */
+    const char* file_filter;       /* NULL = all sites */
+    uint8_t* site_match;           /* Filter result per log_id: 0 = not */
+    uint32_t site_match_capacity;  /* checked yet, 1 = write, 2 = skip */
+
+    uint64_t flush_interval_ns;    /* 0 = flushed with the main output */
+    uint64_t last_flush_ns;        /* CLOCK_MONOTONIC */
+    uint64_t unflushed;            /* Entries since the last flush */
+} log_sink_t;
+
+/* ============================================================================
+ * Lifecycle
+ * ============================================================================ */
+
+/**
+ * Open a sink's file and write the binary header and first sync point
+ * (network sinks: start connecting to the collector).
+ * The config's strings must outlive the sink.
+ *
+ * @param sink Sink to initialize
+ * @param config Sink configuration
+ * @param frequency Timestamp frequency in Hz (0 without timestamps)
+ * @param uncertainty_ppb Frequency error
+ * @param start Startup clock sample (NULL without timestamps)
+ * @return 0 on success, -1 on failure
+ */
+int sink_open(log_sink_t* sink, const cnanolog_sink_config_t* config,
+              uint64_t frequency, uint32_t uncertainty_ppb, const tsc_sample_t* start);
+
+/**
+ * Flush and close. Binary sinks get the dictionaries and final header.
+ */
+void sink_close(log_sink_t* sink, const log_site_t* sites, uint32_t num_sites,
+                const custom_level_entry_t* custom_levels, uint32_t num_custom_levels);
+
+/**
+ * Crash handler: write buffered output (binary: with dictionaries and
+ * header) using async-signal-safe calls only.
+ */
+void sink_crash_close(log_sink_t* sink, const log_site_t* sites, uint32_t num_sites,
+                      const custom_level_entry_t* custom_levels, uint32_t num_custom_levels,
+                      uint64_t deadline_ns);
+
+/* ============================================================================
+ * Entries
+ * ============================================================================ */
+
+int sink_match_file(log_sink_t* sink, const log_site_t* site);
+
+/**
+ * Whether the sink's level and site filters accept entries of a site.
+ */
+static inline int sink_accepts(log_sink_t* sink, const log_site_t* site) {
+    if (!sink->levels[(uint8_t)site->log_level]) {
+        return 0;
+    }
+    return sink->file_filter == NULL || sink_match_file(sink, site);
+}
+
+/**
+ * Write one staged entry (binary: compressed against the sink's history).
+ *
+ * @param sink Sink that accepts the entry's site
+ * @param entry Staged entry (header and argument data)
+ * @param site The entry's site
+ * @param registry Site registry (text rendering)
+ * @param compressed_buf Scratch buffer of CNANOLOG_MAX_COMPRESSED_SIZE bytes
+ * @return 0 on success, -1 on failure
+ */
+int sink_write_entry(log_sink_t* sink, const char* entry, const log_site_t* site,
+                     log_registry_t* registry, char* compressed_buf);
+
+/**
+ * Submit buffered output for writing.
+ */
+void sink_flush(log_sink_t* sink, uint64_t now_ns);
+
+/**
+ * Flush if the sink's own interval has passed (sinks with an interval), or
+ * if the main output is being flushed (sinks without one). Network sinks
+ * also move their backlog along on every call.
+ */
+static inline void sink_flush_if_due(log_sink_t* sink, uint64_t now_ns, int main_flushed) {
+    if (sink->net != NULL) {
+        netwriter_poll(sink->net, now_ns);  /* Connect, send the backlog */
+    }
+    if (sink->unflushed == 0) {
+        return;
+    }
+    if (sink->flush_interval_ns == 0 ? main_flushed
+                                     : now_ns - sink->last_flush_ns >= sink->flush_interval_ns) {
+        sink_flush(sink, now_ns);
+    }
+}
+
+/* ============================================================================
+ * Clock
+ * ============================================================================ */
+
+/**
+ * Binary sinks: record the frequency and a sync record, and reset the
+ * argument history (decoders reset theirs at sync records).
+ */
+void sink_sync(log_sink_t* sink, const tsc_sample_t* now, uint64_t frequency,
+               uint32_t uncertainty_ppb);
+
+/**
+ * Text sinks: move to a new timestamp-to-wall-clock mapping.
+ */
+void sink_set_text_clock(log_sink_t* sink, uint64_t frequency, uint64_t timestamp,
+                         time_t sec, int32_t nsec);
+
+#ifdef __cplusplus
+}
+#endif
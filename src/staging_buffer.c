@@ -26,19 +26,28 @@ staging_buffer_t* staging_buffer_create(uint32_t thread_id) {
     }
 #endif
 
-    /* Zero out the entire structure first */
-    memset(sb, 0, sizeof(staging_buffer_t));
+    /* Zero the control fields only: data pages stay unallocated until the
+     * thread logs that far (a 128MB memset per thread adds up) */
+    memset(sb, 0, offsetof(staging_buffer_t, data));
+    staging_buffer_init(sb, thread_id);
 
+    return sb;
+}
+
+void staging_buffer_init(staging_buffer_t* sb, uint32_t thread_id) {
     /* Initialize non-atomic fields */
     sb->write_pos = 0;
     sb->read_pos = 0;
     sb->thread_id = thread_id;
     sb->active = 1;
+    sb->bytes_produced = 0;
+    sb->drops = 0;
+    sb->high_water = 0;
+    sb->last_drain_ns = 0;
+    sb->name[0] = '\0';
 
     /* Initialize atomic committed field */
     atomic_store_explicit(&sb->committed, 0, memory_order_relaxed);
-
-    return sb;
 }
 
 void staging_buffer_destroy(staging_buffer_t* sb) {
@@ -109,6 +118,7 @@ void staging_commit(staging_buffer_t* sb, size_t nbytes) {
 
     /* Atomically publish write_pos to committed (release semantics) */
     atomic_store_explicit(&sb->committed, sb->write_pos, memory_order_release);
+    sb->bytes_produced += nbytes;
 }
 
 void staging_adjust_reservation(staging_buffer_t* sb, size_t reserved_bytes, size_t actual_bytes) {
@@ -168,6 +178,38 @@ size_t staging_read(staging_buffer_t* sb, char* out, size_t max_len) {
     return to_read;
 }
 
+int staging_peek_entry(staging_buffer_t* sb, cnanolog_entry_header_t* header,
+                       size_t* entry_size) {
+    while (staging_available(sb) >= sizeof(cnanolog_entry_header_t)) {
+        size_t nread = staging_read(sb, (char*)header, sizeof(cnanolog_entry_header_t));
+        if (nread < sizeof(cnanolog_entry_header_t)) {
+            return 0;
+        }
+
+        /* Check for wrap marker (circular buffer wrap-around) */
+        if (header->log_id == STAGING_WRAP_MARKER_LOG_ID) {
+            staging_consume(sb, sizeof(cnanolog_entry_header_t));
+            staging_wrap_read_pos(sb);
+            continue;  /* Continue processing from beginning */
+        }
+
+        size_t size = sizeof(cnanolog_entry_header_t) + header->data_length;
+        if (unlikely(header->data_length == CNANOLOG_LENGTH_EXTENDED)) {
+            char prefix[STAGING_EXTENDED_PREFIX_SIZE];
+            if (staging_read(sb, prefix, sizeof(prefix)) < sizeof(prefix)) {
+                return 0;
+            }
+            size = staging_entry_size(prefix);
+        }
+
+        if (entry_size != NULL) {
+            *entry_size = size;
+        }
+        return staging_available(sb) >= size;
+    }
+    return 0;
+}
+
 void staging_consume(staging_buffer_t* sb, size_t nbytes) {
     if (sb == NULL || nbytes == 0) {
         return;
@@ -192,6 +234,14 @@ void staging_wrap_read_pos(staging_buffer_t* sb) {
     sb->read_pos = 0;
 }
 
+void staging_begin_drain(staging_buffer_t* sb, uint64_t now_ns) {
+    size_t used = staging_used(sb);
+    if (used > sb->high_water) {
+        sb->high_water = used;
+    }
+    sb->last_drain_ns = now_ns;
+}
+
 void staging_reset(staging_buffer_t* sb) {
     if (sb == NULL) {
         return;
@@ -206,12 +256,26 @@ void staging_reset(staging_buffer_t* sb) {
  * Statistics
  * ============================================================================ */
 
+size_t staging_used(const staging_buffer_t* sb) {
+    if (sb == NULL) {
+        return 0;
+    }
+
+    size_t committed_pos = atomic_load_explicit(&sb->committed, memory_order_acquire);
+    size_t read_pos = sb->read_pos;
+    if (committed_pos >= read_pos) {
+        return committed_pos - read_pos;
+    }
+    /* Producer wrapped: the tail up to the end, plus the start */
+    return STAGING_BUFFER_SIZE - read_pos + committed_pos;
+}
+
 uint8_t staging_fill_percent(const staging_buffer_t* sb) {
     if (sb == NULL) {
         return 0;
     }
 
-    return (uint8_t)((sb->write_pos * 100) / STAGING_BUFFER_SIZE);
+    return (uint8_t)(((uint64_t)staging_used(sb) * 100) / STAGING_BUFFER_SIZE);
 }
 
 int staging_is_full(const staging_buffer_t* sb) {
@@ -8,9 +8,11 @@
 #pragma once
 
 #include "platform.h"
+#include "../include/cnanolog_format.h"
 #include <stdatomic.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -45,6 +47,49 @@ extern "C" {
  */
 #define STAGING_WRAP_MARKER_LOG_ID 0xFFFFFFFF
 
+/* Thread name stored with each buffer, terminating NUL included */
+#define STAGING_THREAD_NAME_SIZE 32
+
+/* ============================================================================
+ * Staged Entry Layout
+ * ============================================================================ */
+
+/**
+ * A staged entry is a cnanolog_entry_header_t followed by argument data.
+ * Data longer than CNANOLOG_MAX_INLINE_LENGTH sets data_length to
+ * CNANOLOG_LENGTH_EXTENDED and stores the real length as a uint32_t right
+ * after the header (fixed width here; the file uses a varint).
+ */
+#define STAGING_EXTENDED_PREFIX_SIZE (sizeof(cnanolog_entry_header_t) + sizeof(uint32_t))
+
+/* Largest staged entry: extended prefix + CNANOLOG_MAX_ENTRY_SIZE of data */
+#define STAGING_MAX_ENTRY_SIZE (STAGING_EXTENDED_PREFIX_SIZE + CNANOLOG_MAX_ENTRY_SIZE)
+
+/**
+ * Argument data of a staged entry (entry must hold the extended prefix
+ * when data_length is CNANOLOG_LENGTH_EXTENDED).
+ */
+static inline const char* staging_entry_data(const char* entry, size_t* data_len) {
+    const cnanolog_entry_header_t* header = (const cnanolog_entry_header_t*)entry;
+    if (likely(header->data_length != CNANOLOG_LENGTH_EXTENDED)) {
+        *data_len = header->data_length;
+        return entry + sizeof(cnanolog_entry_header_t);
+    }
+    uint32_t len;
+    memcpy(&len, entry + sizeof(cnanolog_entry_header_t), sizeof(len));
+    *data_len = len;
+    return entry + STAGING_EXTENDED_PREFIX_SIZE;
+}
+
+/**
+ * Total size (header, length prefix and data) of a staged entry.
+ */
+static inline size_t staging_entry_size(const char* entry) {
+    size_t data_len;
+    const char* data = staging_entry_data(entry, &data_len);
+    return (size_t)(data - entry) + data_len;
+}
+
 /* ============================================================================
  * Staging Buffer Structure
  * ============================================================================ */
@@ -61,10 +106,14 @@ extern "C" {
 typedef struct ALIGN_CACHELINE {
     /* Producer cache line - only written by logging thread */
     size_t write_pos;
-    char _pad1[CACHE_LINE_SIZE - sizeof(size_t)];
+    uint64_t bytes_produced;         /* Committed bytes, wrap markers excluded */
+    uint64_t drops;                  /* Entries lost to a full buffer */
+    char _pad1[CACHE_LINE_SIZE - sizeof(size_t) - 2 * sizeof(uint64_t)];
 
-    /* Extra padding for maximum separation (128 bytes total) */
-    char _pad2[CACHE_LINE_SIZE];
+    /* Extra padding for maximum separation (128 bytes total); the name is
+     * written once by its thread, so it does not disturb either side */
+    char name[STAGING_THREAD_NAME_SIZE];
+    char _pad2[CACHE_LINE_SIZE - STAGING_THREAD_NAME_SIZE];
 
     /* Consumer-dominated cache line - atomic, written by producer on commit, read by consumer frequently */
     atomic_size_t committed;
@@ -72,9 +121,12 @@ typedef struct ALIGN_CACHELINE {
 
     /* Consumer cache line - only written by background thread */
     size_t read_pos;
+    size_t high_water;               /* Largest fill seen by the consumer (bytes) */
+    uint64_t last_drain_ns;          /* CLOCK_MONOTONIC of the last drain (0 = never) */
     uint32_t thread_id;
     uint8_t active;
-    char _pad4[CACHE_LINE_SIZE - sizeof(size_t) - sizeof(uint32_t) - sizeof(uint8_t)];
+    char _pad4[CACHE_LINE_SIZE - 2 * sizeof(size_t) - sizeof(uint64_t) -
+               sizeof(uint32_t) - sizeof(uint8_t)];
 
     /* Buffer storage - at end to keep hot fields close to struct base */
     char data[STAGING_BUFFER_SIZE];
@@ -96,6 +148,16 @@ CNANOLOG_STATIC_ASSERT(sizeof(staging_buffer_t) % CACHE_LINE_SIZE == 0,
  */
 staging_buffer_t* staging_buffer_create(uint32_t thread_id);
 
+/**
+ * Initialize the control fields of a buffer placed in caller-provided
+ * memory (e.g. a shared memory segment). The data area is not touched,
+ * so its pages stay unallocated until used.
+ *
+ * @param sb Buffer (cache-line aligned)
+ * @param thread_id Identifier for the thread (for debugging)
+ */
+void staging_buffer_init(staging_buffer_t* sb, uint32_t thread_id);
+
 /**
  * Destroy a staging buffer.
  * Should only be called after all data has been consumed.
@@ -158,6 +220,18 @@ size_t staging_available(const staging_buffer_t* sb);
  */
 size_t staging_read(staging_buffer_t* sb, char* out, size_t max_len);
 
+/**
+ * Peek the header of the next complete entry, consuming any wrap markers
+ * in front of it.
+ *
+ * @param sb Staging buffer
+ * @param header Output: entry header
+ * @param entry_size Output (optional): total staged size of the entry
+ * @return 1 if a complete entry is available, 0 otherwise
+ */
+int staging_peek_entry(staging_buffer_t* sb, cnanolog_entry_header_t* header,
+                       size_t* entry_size);
+
 /**
  * Mark bytes as consumed, freeing space in the buffer.
  *
@@ -174,6 +248,16 @@ void staging_consume(staging_buffer_t* sb, size_t nbytes);
  */
 void staging_wrap_read_pos(staging_buffer_t* sb);
 
+/**
+ * Note the start of a drain pass over a buffer that has entries: updates
+ * the high-water mark with the current fill (the fill peaks right before
+ * the consumer drains) and the drain time.
+ *
+ * @param sb Staging buffer
+ * @param now_ns CLOCK_MONOTONIC in nanoseconds
+ */
+void staging_begin_drain(staging_buffer_t* sb, uint64_t now_ns);
+
 /**
  * Reset the staging buffer to empty state.
  *
@@ -185,6 +269,15 @@ void staging_reset(staging_buffer_t* sb);
  * Statistics
  * ============================================================================ */
 
+/**
+ * Bytes committed but not yet consumed. Callable from any thread (the
+ * value may be stale by the time it is used).
+ *
+ * @param sb Staging buffer
+ * @return Bytes in use
+ */
+size_t staging_used(const staging_buffer_t* sb);
+
 /**
  * Get the current fill percentage of the buffer.
  *
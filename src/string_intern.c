@@ -0,0 +1,162 @@
+/* Copyright (c) 2025
+ * CNanoLog String Intern Table Implementation
+ */
+
+#include "string_intern.h"
+#include <string.h>
+
+/* FNV-1a */
+static inline uint32_t string_hash(const char* str, uint32_t len) {
+    uint32_t hash = 2166136261u;
+    for (uint32_t i = 0; i < len; i++) {
+        hash ^= (uint8_t)str[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static inline uint16_t* bucket_of(string_intern_t* table, uint32_t hash) {
+    return &table->buckets[hash & (STRING_INTERN_BUCKETS - 1)];
+}
+
+static void lru_unlink(string_intern_t* table, uint16_t id) {
+    string_intern_entry_t* e = &table->entries[id];
+    if (e->prev != STRING_INTERN_NONE) {
+        table->entries[e->prev].next = e->next;
+    } else {
+        table->head = e->next;
+    }
+    if (e->next != STRING_INTERN_NONE) {
+        table->entries[e->next].prev = e->prev;
+    } else {
+        table->tail = e->prev;
+    }
+}
+
+static void lru_push_front(string_intern_t* table, uint16_t id) {
+    string_intern_entry_t* e = &table->entries[id];
+    e->prev = STRING_INTERN_NONE;
+    e->next = table->head;
+    if (table->head != STRING_INTERN_NONE) {
+        table->entries[table->head].prev = id;
+    } else {
+        table->tail = id;
+    }
+    table->head = id;
+}
+
+static void string_intern_touch(string_intern_t* table, uint16_t id) {
+    if (table->head != id) {
+        lru_unlink(table, id);
+        lru_push_front(table, id);
+    }
+}
+
+static int string_intern_find(string_intern_t* table, const char* str,
+                              uint32_t len, uint32_t hash) {
+    uint16_t id = *bucket_of(table, hash);
+    while (id != STRING_INTERN_NONE) {
+        const string_intern_entry_t* e = &table->entries[id];
+        if (e->hash == hash && e->len == len && memcmp(e->data, str, len) == 0) {
+            return id;
+        }
+        id = e->chain;
+    }
+    return -1;
+}
+
+/* Take a free id, or the least recently used one once the table is full */
+static void string_intern_add(string_intern_t* table, const char* str,
+                              uint32_t len, uint32_t hash) {
+    uint16_t id;
+    if (table->count < STRING_INTERN_CAPACITY) {
+        id = table->count++;
+    } else {
+        id = table->tail;
+        lru_unlink(table, id);
+
+        uint16_t* link = bucket_of(table, table->entries[id].hash);
+        while (*link != id) {
+            link = &table->entries[*link].chain;
+        }
+        *link = table->entries[id].chain;
+    }
+
+    string_intern_entry_t* e = &table->entries[id];
+    e->hash = hash;
+    e->len = (uint16_t)len;
+    memcpy(e->data, str, len);
+
+    uint16_t* bucket = bucket_of(table, hash);
+    e->chain = *bucket;
+    *bucket = id;
+    lru_push_front(table, id);
+}
+
+void string_intern_reset(string_intern_t* table) {
+    /* Entries are only read through buckets and ids below count */
+    memset(table->buckets, 0xFF, sizeof(table->buckets));
+    table->count = 0;
+    table->head = STRING_INTERN_NONE;
+    table->tail = STRING_INTERN_NONE;
+}
+
+size_t pack_string_interned(char** buffer, const char* str, uint32_t len,
+                            string_intern_t* table) {
+    uint8_t* out = (uint8_t*)*buffer;
+    size_t written;
+
+    if (table != NULL && STRING_INTERN_ELIGIBLE(len)) {
+        uint32_t hash = string_hash(str, len);
+        int id = string_intern_find(table, str, len, hash);
+        if (id >= 0) {
+            string_intern_touch(table, (uint16_t)id);
+            written = cnanolog_varint_encode(((uint32_t)id << 1) | 1, out);
+            *buffer += written;
+            return written;
+        }
+        string_intern_add(table, str, len, hash);
+    }
+
+    written = cnanolog_varint_encode(len << 1, out);
+    if (len > 0) {
+        memcpy(out + written, str, len);
+    }
+    written += len;
+    *buffer += written;
+    return written;
+}
+
+int unpack_string_interned(const char** buffer, const char* end,
+                           string_intern_t* table, const char** str, uint32_t* len) {
+    uint32_t tag;
+    size_t used = cnanolog_varint_decode((const uint8_t*)*buffer,
+                                         (size_t)(end - *buffer), &tag);
+    if (used == 0) {
+        return -1;
+    }
+    *buffer += used;
+
+    if (tag & 1) {
+        uint32_t id = tag >> 1;
+        if (id >= table->count) {
+            return -1;
+        }
+        string_intern_touch(table, (uint16_t)id);
+        *str = table->entries[id].data;
+        *len = table->entries[id].len;
+        return 0;
+    }
+
+    uint32_t n = tag >> 1;
+    if ((size_t)(end - *buffer) < n) {
+        return -1;
+    }
+    *str = *buffer;
+    *len = n;
+    *buffer += n;
+    if (STRING_INTERN_ELIGIBLE(n)) {
+        string_intern_add(table, *str, n, string_hash(*str, n));
+    }
+    return 0;
+}
@@ -0,0 +1,81 @@
+/* Copyright (c) 2025
+ * CNanoLog String Intern Table
+ *
+ * Bounded table of recently logged strings, shared by the writer and the
+ * decompressor. The first time a string appears it is written as text
+ * and both sides add it to their table; after that it is written as the
+ * table id. When the table is full the least recently used string gives
+ * up its id. Both sides apply the same operations in the same order, so
+ * their tables stay identical without ever writing ids explicitly.
+ */
+
+#pragma once
+
+#include "../include/cnanolog_format.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STRING_INTERN_CAPACITY 1024  /* Strings kept (ids 0..CAPACITY-1) */
+#define STRING_INTERN_BUCKETS  2048  /* Hash buckets (power of two) */
+#define STRING_INTERN_NONE     0xFFFF
+
+/* Strings short enough to be interned (empty strings are not: a literal
+ * costs the same single byte as a reference) */
+#define STRING_INTERN_ELIGIBLE(len) ((len) >= 1 && (len) <= CNANOLOG_INTERN_MAX_LEN)
+
+typedef struct {
+    uint32_t hash;
+    uint16_t len;
+    uint16_t chain;   /* Next id in the same hash bucket */
+    uint16_t prev;    /* LRU list: more recently used */
+    uint16_t next;    /* LRU list: less recently used */
+    char data[CNANOLOG_INTERN_MAX_LEN];
+} string_intern_entry_t;
+
+typedef struct {
+    string_intern_entry_t entries[STRING_INTERN_CAPACITY];
+    uint16_t buckets[STRING_INTERN_BUCKETS];
+    uint16_t count;   /* Ids in use */
+    uint16_t head;    /* Most recently used id */
+    uint16_t tail;    /* Least recently used id (next to be replaced) */
+} string_intern_t;
+
+/**
+ * Empty the table (new file or clock sync record).
+ */
+void string_intern_reset(string_intern_t* table);
+
+/**
+ * Write a string argument: "(id << 1) | 1" as a varint if the table holds
+ * it, otherwise "len << 1" as a varint followed by the text (added to the
+ * table if eligible).
+ *
+ * @param buffer Pointer to buffer pointer (will be advanced)
+ * @param str Text (need not be NUL-terminated)
+ * @param len Length of the text
+ * @param table Intern table (updated), or NULL to always write text
+ * @return Number of bytes written (at most CNANOLOG_VARINT_MAX_BYTES + len)
+ */
+size_t pack_string_interned(char** buffer, const char* str, uint32_t len,
+                            string_intern_t* table);
+
+/**
+ * Read a string argument written by pack_string_interned().
+ *
+ * @param buffer Pointer to buffer pointer (will be advanced)
+ * @param end End of the readable data
+ * @param table Intern table (updated)
+ * @param str Output: text (points into the buffer or the table)
+ * @param len Output: length of the text
+ * @return 0 on success, -1 if the encoding is invalid or truncated
+ */
+int unpack_string_interned(const char** buffer, const char* end,
+                           string_intern_t* table, const char** str, uint32_t* len);
+
+#ifdef __cplusplus
+}
+#endif
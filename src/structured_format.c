@@ -0,0 +1,379 @@
+/* Copyright (c) 2025
+ * CNanoLog Structured Output Encoders Implementation
+ */
+
+#include "structured_format.h"
+#include "fast_format.h"
+#include <string.h>
+
+/* Upper bound on an argument field's value when it is not a string */
+#define SCALAR_VALUE_MAX (FMT_DOUBLE_MAX_CHARS + 2)
+
+/* ============================================================================
+ * Escape Scanning
+ * ============================================================================ */
+
+#define SWAR_ONES  0x0101010101010101ULL
+#define SWAR_HIGHS 0x8080808080808080ULL
+
+/** Nonzero if any byte of x is below n (n <= 128). */
+static inline uint64_t swar_has_less(uint64_t x, uint8_t n) {
+    return (x - SWAR_ONES * n) & ~x & SWAR_HIGHS;
+}
+
+/** Nonzero if any byte of x equals c. */
+static inline uint64_t swar_has_byte(uint64_t x, uint8_t c) {
+    uint64_t y = x ^ (SWAR_ONES * c);
+    return (y - SWAR_ONES) & ~y & SWAR_HIGHS;
+}
+
+/* Bytes >= 0x80 leave the fast path so UTF-8 is validated and cut whole */
+static inline int json_needs_escape(unsigned char c) {
+    return c < 0x20 || c == '"' || c == '\\' || c >= 0x80;
+}
+
+static inline int logfmt_needs_quote(unsigned char c) {
+    return c <= ' ' || c == '"' || c == '\\' || c == '=' || c >= 0x80;
+}
+
+/**
+ * Length of the leading run that can be copied into a JSON string as-is.
+ * Checks 8 bytes per step; the first dirty word is finished byte by byte.
+ */
+static size_t json_clean_prefix(const char* s, size_t len) {
+    size_t i = 0;
+    while (i + 8 <= len) {
+        uint64_t x;
+        memcpy(&x, s + i, sizeof(x));
+        if (swar_has_less(x, 0x20) | swar_has_byte(x, '"') |
+            swar_has_byte(x, '\\') | (x & SWAR_HIGHS)) {
+            break;
+        }
+        i += 8;
+    }
+    while (i < len && !json_needs_escape((unsigned char)s[i])) {
+        i++;
+    }
+    return i;
+}
+
+/**
+ * Length of the well-formed UTF-8 sequence starting with a byte >= 0x80,
+ * or 0 if it is invalid or incomplete (overlongs, surrogates and code
+ * points above U+10FFFF are rejected, as RFC 3629 requires).
+ */
+static size_t utf8_sequence_length(const unsigned char* s, size_t len) {
+    unsigned char c = s[0];
+    size_t n;
+    unsigned char lo = 0x80, hi = 0xBF;  /* Allowed range of the second byte */
+    if (c >= 0xC2 && c <= 0xDF) {
+        n = 2;
+    } else if (c >= 0xE0 && c <= 0xEF) {
+        n = 3;
+        if (c == 0xE0) lo = 0xA0;
+        if (c == 0xED) hi = 0x9F;
+    } else if (c >= 0xF0 && c <= 0xF4) {
+        n = 4;
+        if (c == 0xF0) lo = 0x90;
+        if (c == 0xF4) hi = 0x8F;
+    } else {
+        return 0;
+    }
+    if (len < n || s[1] < lo || s[1] > hi) {
+        return 0;
+    }
+    for (size_t i = 2; i < n; i++) {
+        if ((s[i] & 0xC0) != 0x80) {
+            return 0;
+        }
+    }
+    return n;
+}
+
+/**
+ * Nonzero if s can be written as a bare logfmt value. Non-ASCII values are
+ * quoted so they get the same UTF-8 checks and whole-character truncation.
+ */
+static int logfmt_is_bare(const char* s, size_t len) {
+    if (len == 0) {
+        return 0;  /* Empty values must be quoted */
+    }
+    size_t i = 0;
+    while (i + 8 <= len) {
+        uint64_t x;
+        memcpy(&x, s + i, sizeof(x));
+        if (swar_has_less(x, 0x21) | swar_has_byte(x, '"') |
+            swar_has_byte(x, '\\') | swar_has_byte(x, '=') | (x & SWAR_HIGHS)) {
+            break;
+        }
+        i += 8;
+    }
+    for (; i < len; i++) {
+        if (logfmt_needs_quote((unsigned char)s[i])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * Copy s with JSON escapes, stopping before an escape or a UTF-8 character
+ * that would not fit. Bytes that are not well-formed UTF-8 become \ufffd.
+ */
+static char* write_escaped(char* out, const char* limit, const char* s, size_t len) {
+    static const char hex[] = "0123456789abcdef";
+
+    while (len > 0 && out < limit) {
+        size_t clean = json_clean_prefix(s, len);
+        size_t room = (size_t)(limit - out);
+        if (clean > room) {
+            clean = room;
+        }
+        memcpy(out, s, clean);
+        out += clean;
+        s += clean;
+        len -= clean;
+        if (len == 0 || out >= limit) {
+            break;
+        }
+
+        unsigned char c = (unsigned char)*s;
+        if (c >= 0x80) {
+            size_t seq = utf8_sequence_length((const unsigned char*)s, len);
+            if (seq > 0) {
+                if ((size_t)(limit - out) < seq) {
+                    break;
+                }
+                memcpy(out, s, seq);
+                out += seq;
+                s += seq;
+                len -= seq;
+                continue;
+            }
+            if ((size_t)(limit - out) < 6) {
+                break;
+            }
+            memcpy(out, "\\ufffd", 6);
+            out += 6;
+            s++;
+            len--;
+            continue;
+        }
+
+        char esc[6] = { '\\', 0, 0, 0, 0, 0 };
+        size_t n = 2;
+        switch (c) {
+            case '"':  esc[1] = '"';  break;
+            case '\\': esc[1] = '\\'; break;
+            case '\n': esc[1] = 'n';  break;
+            case '\r': esc[1] = 'r';  break;
+            case '\t': esc[1] = 't';  break;
+            case '\b': esc[1] = 'b';  break;
+            case '\f': esc[1] = 'f';  break;
+            default:
+                esc[1] = 'u';
+                esc[2] = '0';
+                esc[3] = '0';
+                esc[4] = hex[c >> 4];
+                esc[5] = hex[c & 0xF];
+                n = 6;
+                break;
+        }
+        if ((size_t)(limit - out) < n) {
+            break;
+        }
+        memcpy(out, esc, n);
+        out += n;
+        s++;
+        len--;
+    }
+    return out;
+}
+
+char* sfmt_json_string(char* out, const char* out_end, const char* s, size_t len) {
+    if (out_end - out < 2) {
+        return out;
+    }
+    *out++ = '"';
+    out = write_escaped(out, out_end - 1, s, len);
+    *out++ = '"';
+    return out;
+}
+
+char* sfmt_logfmt_value(char* out, const char* out_end, const char* s, size_t len) {
+    if (logfmt_is_bare(s, len)) {
+        return fmt_append(out, out_end, s, len);
+    }
+    return sfmt_json_string(out, out_end, s, len);
+}
+
+/* ============================================================================
+ * Record Encoding
+ * ============================================================================ */
+
+/**
+ * Names the metadata keys use; argument fields with these names fall back
+ * to "argN" so keys stay unique.
+ */
+static int is_reserved_key(const char* name, size_t len) {
+    static const char* const reserved[] = { "time", "level", "file", "line", "msg" };
+    for (size_t i = 0; i < sizeof(reserved) / sizeof(reserved[0]); i++) {
+        if (strlen(reserved[i]) == len && memcmp(reserved[i], name, len) == 0) {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * Write a key: ,"key": for JSON, " key=" for logfmt (no separator first).
+ * Keys are identifiers and never need escaping.
+ */
+static char* put_key(char* out, int style, int first, const char* key, size_t key_len) {
+    if (style == SFMT_JSON) {
+        if (!first) *out++ = ',';
+        *out++ = '"';
+        memcpy(out, key, key_len);
+        out += key_len;
+        *out++ = '"';
+        *out++ = ':';
+    } else {
+        if (!first) *out++ = ' ';
+        memcpy(out, key, key_len);
+        out += key_len;
+        *out++ = '=';
+    }
+    return out;
+}
+
+static char* put_string(char* out, const char* out_end, int style,
+                        const char* s, size_t len) {
+    return (style == SFMT_JSON) ? sfmt_json_string(out, out_end, s, len)
+                                : sfmt_logfmt_value(out, out_end, s, len);
+}
+
+/**
+ * Write a double as a number; NaN and infinities become strings in JSON.
+ * Checks the exponent bits directly so -ffast-math cannot fold the test.
+ */
+static char* put_double(char* out, int style, double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    if (((bits >> 52) & 0x7FF) != 0x7FF) {
+        return out + fmt_double_shortest(out, d);
+    }
+
+    const char* text;
+    if ((bits & 0xFFFFFFFFFFFFFULL) != 0) {
+        text = (style == SFMT_JSON) ? "\"NaN\"" : "NaN";
+    } else if (bits >> 63) {
+        text = (style == SFMT_JSON) ? "\"-Infinity\"" : "-Inf";
+    } else {
+        text = (style == SFMT_JSON) ? "\"Infinity\"" : "+Inf";
+    }
+    size_t len = strlen(text);
+    memcpy(out, text, len);
+    return out + len;
+}
+
+static char* put_field_value(char* out, const char* out_end, int style,
+                             const fmt_field_t* field) {
+    switch (field->kind) {
+        case FMT_FIELD_INT:
+            return out + fmt_i64(out, field->value.i);
+        case FMT_FIELD_UINT:
+            return out + fmt_u64(out, field->value.u);
+        case FMT_FIELD_DOUBLE:
+            return put_double(out, style, field->value.d);
+        case FMT_FIELD_POINTER: {
+            if (style == SFMT_JSON) *out++ = '"';
+            *out++ = '0';
+            *out++ = 'x';
+            out += fmt_hex(out, field->value.u, 0);
+            if (style == SFMT_JSON) *out++ = '"';
+            return out;
+        }
+        default:
+            return put_string(out, out_end, style,
+                              field->value.str.ptr, field->value.str.len);
+    }
+}
+
+size_t sfmt_encode(int style, const sfmt_record_t* record, char* out, size_t out_size) {
+    char* w = out;
+    /* JSON keeps one byte back for the closing brace */
+    const char* end = out + out_size - ((style == SFMT_JSON) ? 1 : 0);
+    int first = 1;
+
+    if (style == SFMT_JSON) {
+        *w++ = '{';
+    }
+
+    /* Metadata */
+    if (record->timestamp_len == FMT_TIMESTAMP_CHARS &&
+        end - w > 8 + FMT_TIMESTAMP_CHARS + 2) {
+        char iso[FMT_TIMESTAMP_CHARS];
+        memcpy(iso, record->timestamp, FMT_TIMESTAMP_CHARS);
+        iso[10] = 'T';  /* ISO 8601 date/time separator */
+        w = put_key(w, style, first, "time", 4);
+        w = put_string(w, end, style, iso, FMT_TIMESTAMP_CHARS);
+        first = 0;
+    }
+
+    if (end - w > 8 + 2) {
+        w = put_key(w, style, first, "level", 5);
+        w = put_string(w, end, style, record->level, strlen(record->level));
+        first = 0;
+    }
+    if (end - w > 8 + 2) {
+        w = put_key(w, style, first, "file", 4);
+        w = put_string(w, end, style, record->file, strlen(record->file));
+        first = 0;
+    }
+    if (end - w > 8 + FMT_INT_MAX_CHARS) {
+        w = put_key(w, style, first, "line", 4);
+        w += fmt_u64(w, record->line);
+        first = 0;
+    }
+    if (end - w > 8 + 2) {
+        w = put_key(w, style, first, "msg", 3);
+        w = put_string(w, end, style, record->message, record->message_len);
+        first = 0;
+    }
+
+    /* One typed field per argument */
+    if (record->format != NULL) {
+        fmt_field_t fields[CNANOLOG_MAX_ARGS];
+        size_t num_fields = fmt_program_fields(record->format,
+                                               record->arg_data, record->arg_len,
+                                               fields, CNANOLOG_MAX_ARGS);
+
+        for (size_t i = 0; i < num_fields; i++) {
+            const fmt_field_t* field = &fields[i];
+
+            char key_buf[8];
+            const char* key = field->name;
+            size_t key_len = field->name_len;
+            if (key == NULL || is_reserved_key(key, key_len)) {
+                memcpy(key_buf, "arg", 3);
+                key_len = 3 + fmt_u64(key_buf + 3, field->index);
+                key = key_buf;
+            }
+
+            /* Whole field or nothing, so the record stays well-formed */
+            size_t need = key_len + 4 +
+                          ((field->kind == FMT_FIELD_STRING) ? 2 : SCALAR_VALUE_MAX);
+            if ((size_t)(end - w) < need) {
+                break;
+            }
+            w = put_key(w, style, first, key, key_len);
+            w = put_field_value(w, end, style, field);
+            first = 0;
+        }
+    }
+
+    if (style == SFMT_JSON) {
+        *w++ = '}';
+    }
+    return (size_t)(w - out);
+}
@@ -0,0 +1,81 @@
+/* Copyright (c) 2025
+ * CNanoLog Structured Output Encoders
+ *
+ * Encodes one log record as a JSON object or a logfmt line. Metadata
+ * (time, level, file, line, msg) comes first, followed by one typed field
+ * per argument, named from the format string ("user=%s" -> user) or by
+ * position (arg0, arg1, ...). Output streams straight into the caller's
+ * buffer; strings are escaped after a word-at-a-time scan for bytes that
+ * need it.
+ */
+
+#pragma once
+
+#include "format_program.h"
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Types
+ * ============================================================================ */
+
+/** Output styles */
+#define SFMT_JSON   0  /* {"time":"...","level":"INFO",...,"id":7} */
+#define SFMT_LOGFMT 1  /* time=... level=INFO ... id=7 */
+
+/**
+ * Everything needed to encode one record.
+ */
+typedef struct {
+    const char* timestamp;      /* "YYYY-MM-DD HH:MM:SS.nnnnnnnnn" (other forms omitted) */
+    size_t timestamp_len;
+    const char* level;          /* Level name */
+    const char* file;           /* Source filename */
+    uint32_t line;              /* Source line */
+    const char* message;        /* Rendered message */
+    size_t message_len;
+    const fmt_program_t* format;  /* Compiled site format (NULL = no fields) */
+    const char* arg_data;       /* Packed, uncompressed arguments */
+    size_t arg_len;
+} sfmt_record_t;
+
+/* ============================================================================
+ * Encoding
+ * ============================================================================ */
+
+/**
+ * Encode a record (no trailing newline). When the buffer is too small the
+ * message is truncated and trailing fields are dropped, but the output is
+ * always well-formed.
+ *
+ * @param style SFMT_JSON or SFMT_LOGFMT
+ * @param record Record to encode
+ * @param out Output buffer
+ * @param out_size Output buffer size (at least 2 bytes)
+ * @return Length written (not null-terminated)
+ */
+size_t sfmt_encode(int style, const sfmt_record_t* record, char* out, size_t out_size);
+
+/**
+ * Write a quoted, escaped JSON string. Escapes are never split; the closing
+ * quote always fits when at least 2 bytes are available.
+ *
+ * @return New output cursor
+ */
+char* sfmt_json_string(char* out, const char* out_end, const char* s, size_t len);
+
+/**
+ * Write a logfmt value: bare when it contains no space, '=', '"', '\\' or
+ * control bytes, otherwise quoted and escaped like JSON.
+ *
+ * @return New output cursor
+ */
+char* sfmt_logfmt_value(char* out, const char* out_end, const char* s, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,26 +5,47 @@
  */
 
 #include "text_formatter.h"
+#include "fast_format.h"
+#include "format_program.h"
+#include "structured_format.h"
+#include "async_writer.h"
 #include "../include/cnanolog.h"
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <errno.h>
+#ifndef _WIN32
+#include <unistd.h>  /* For close(), lseek() */
+#include <fcntl.h>   /* For open() */
+#endif
 
 /* Buffer size for message formatting */
 #define MESSAGE_BUFFER_SIZE 8192
 
+/* Pattern used when neither the site nor the writer sets one */
+#define DEFAULT_TEXT_PATTERN "[%t] [%l] [%f:%n] %m"
+
 /* ============================================================================
  * Text Writer Implementation
  * ============================================================================ */
 
 struct text_writer {
-    FILE* file;
+    int fd;                  /* Log file, written from its end at open */
+    async_writer_t io;       /* Double-buffered async output */
     uint64_t timestamp_frequency;
     uint64_t start_timestamp;
     time_t start_time_sec;
     int32_t start_time_nsec;
+    uint64_t prev_frequency; /* Segment before start_timestamp (0 = none) */
+    uint64_t prev_start_timestamp;
+    time_t prev_start_time_sec;
+    int32_t prev_start_time_nsec;
+    uint32_t clock_seq;      /* Seqlock over the eight fields above (odd = updating) */
     uint64_t bytes_written;  /* Track total bytes written for statistics */
     const char* pattern;     /* Format pattern (NULL = use default) */
+    fmt_program_t* pattern_program;  /* Compiled pattern (or default) */
+    int structured_style;    /* SFMT_JSON / SFMT_LOGFMT, or -1 for patterns */
+    fmt_time_cache_t time_cache;  /* Per-second "YYYY-MM-DD HH:MM:SS." prefix */
 };
 
 /* ============================================================================
@@ -33,66 +54,83 @@ struct text_writer {
 
 /**
  * Convert log level enum to string.
+ * Custom levels are rendered into the caller's buffer so concurrent
+ * formatters never share storage.
  */
-static const char* level_to_string(cnanolog_level_t level) {
+static const char* level_to_string(cnanolog_level_t level, char* buf, size_t buf_size) {
     switch (level) {
         case LOG_LEVEL_INFO:  return "INFO";
         case LOG_LEVEL_WARN:  return "WARN";
         case LOG_LEVEL_ERROR: return "ERROR";
         case LOG_LEVEL_DEBUG: return "DEBUG";
-        default: {
-            static char buf[16];
-            snprintf(buf, sizeof(buf), "LEVEL_%u", (unsigned int)level);
+        case LOG_LEVEL_SPAN_BEGIN: return "SPAN_BEGIN";
+        case LOG_LEVEL_SPAN_END:   return "SPAN_END";
+        default:
+            snprintf(buf, buf_size, "LEVEL_%u", (unsigned int)level);
             return buf;
-        }
     }
 }
 
 /**
  * Format rdtsc timestamp to human-readable string.
  * Output: YYYY-MM-DD HH:MM:SS.nnnnnnnnn
+ *
+ * @return Number of characters written (no null terminator)
  */
-static void format_timestamp(text_writer_t* writer, uint64_t timestamp,
-                              char* buf, size_t buf_size) {
+static size_t format_timestamp(const text_writer_t* writer, fmt_time_cache_t* cache,
+                               uint64_t timestamp, char* buf) {
 #ifndef CNANOLOG_NO_TIMESTAMPS
-    if (writer->timestamp_frequency == 0) {
-        snprintf(buf, buf_size, "NO_TIMESTAMP");
-        return;
+    /* Snapshot the calibration; the writer thread may re-anchor it */
+    uint64_t frequency, start_timestamp;
+    int64_t start_sec;
+    int32_t start_nsec;
+#if defined(__GNUC__) || defined(__clang__)
+    uint32_t seq;
+    do {
+        seq = __atomic_load_n(&writer->clock_seq, __ATOMIC_ACQUIRE);
+        frequency = writer->timestamp_frequency;
+        start_timestamp = writer->start_timestamp;
+        start_sec = (int64_t)writer->start_time_sec;
+        start_nsec = writer->start_time_nsec;
+        if (timestamp < start_timestamp && writer->prev_frequency != 0) {
+            frequency = writer->prev_frequency;
+            start_timestamp = writer->prev_start_timestamp;
+            start_sec = (int64_t)writer->prev_start_time_sec;
+            start_nsec = writer->prev_start_time_nsec;
+        }
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while ((seq & 1) || seq != __atomic_load_n(&writer->clock_seq, __ATOMIC_RELAXED));
+#else
+    frequency = writer->timestamp_frequency;
+    start_timestamp = writer->start_timestamp;
+    start_sec = (int64_t)writer->start_time_sec;
+    start_nsec = writer->start_time_nsec;
+    if (timestamp < start_timestamp && writer->prev_frequency != 0) {
+        frequency = writer->prev_frequency;
+        start_timestamp = writer->prev_start_timestamp;
+        start_sec = (int64_t)writer->prev_start_time_sec;
+        start_nsec = writer->prev_start_time_nsec;
     }
+#endif
 
-    /* Calculate elapsed time since start */
-    uint64_t elapsed_ticks = timestamp - writer->start_timestamp;
-    double elapsed_seconds = (double)elapsed_ticks / (double)writer->timestamp_frequency;
-
-    /* Calculate wall-clock time */
-    time_t wall_time = writer->start_time_sec + (time_t)elapsed_seconds;
-    double fractional = elapsed_seconds - (time_t)elapsed_seconds;
-    long nanoseconds = writer->start_time_nsec + (long)(fractional * 1000000000.0);
-
-    /* Handle nanosecond overflow */
-    if (nanoseconds >= 1000000000L) {
-        wall_time += 1;
-        nanoseconds -= 1000000000L;
-    } else if (nanoseconds < 0) {
-        wall_time -= 1;
-        nanoseconds += 1000000000L;
+    if (frequency == 0) {
+        memcpy(buf, "NO_TIMESTAMP", 12);
+        return 12;
     }
 
-    /* Format to string */
-    struct tm tm_buf;
-    struct tm* tm = localtime_r(&wall_time, &tm_buf);
-    if (tm != NULL) {
-        snprintf(buf, buf_size, "%04d-%02d-%02d %02d:%02d:%02d.%09ld",
-                 tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday,
-                 tm->tm_hour, tm->tm_min, tm->tm_sec,
-                 nanoseconds);
-    } else {
-        snprintf(buf, buf_size, "INVALID_TIME");
-    }
+    int64_t wall_sec;
+    uint32_t wall_nsec;
+    fmt_ticks_to_wall(timestamp, frequency, start_timestamp, start_sec, start_nsec,
+                      &wall_sec, &wall_nsec);
+
+    /* Only the nanosecond suffix changes within a second */
+    return fmt_timestamp(cache, wall_sec, wall_nsec, buf);
 #else
     (void)writer;
+    (void)cache;
     (void)timestamp;
-    snprintf(buf, buf_size, "NO_TIMESTAMP");
+    memcpy(buf, "NO_TIMESTAMP", 12);
+    return 12;
 #endif
 }
 
@@ -100,9 +138,9 @@ static void format_timestamp(text_writer_t* writer, uint64_t timestamp,
  * Data from staging buffers is already uncompressed.
  * Just return it as-is. (Compression only happens for binary mode)
  */
-static const char* get_uncompressed_data(text_writer_t* writer,
+static const char* get_uncompressed_data(const text_writer_t* writer,
                                          const char* arg_data,
-                                         uint16_t arg_data_len,
+                                         size_t arg_data_len,
                                          const log_site_t* site,
                                          size_t* uncompressed_len) {
     (void)writer;  /* Unused */
@@ -114,236 +152,125 @@ static const char* get_uncompressed_data(text_writer_t* writer,
 }
 
 /**
- * Format message by substituting arguments into format string.
- * Reads arguments from binary data and formats them.
- */
-static void format_message(const log_site_t* site,
-                           const char* arg_data,
-                           char* output,
-                           size_t output_size) {
-    const char* read_ptr = arg_data;
-    char* write_ptr = output;
-    const char* fmt_ptr = site->format;
-    const char* output_end = output + output_size - 1;
-    int arg_index = 0;
-
-    /* Process format string */
-    while (*fmt_ptr && write_ptr < output_end) {
-        if (*fmt_ptr == '%' && *(fmt_ptr + 1) != '%') {
-            /* Found format specifier */
-            if (arg_index >= site->num_args) {
-                /* No more arguments - just copy the % */
-                *write_ptr++ = *fmt_ptr++;
-                continue;
-            }
-
-            cnanolog_arg_type_t arg_type = (cnanolog_arg_type_t)site->arg_types[arg_index];
-            arg_index++;
-
-            /* Skip the % and format specifier */
-            fmt_ptr++;
-            while (*fmt_ptr && strchr("-+ #0123456789.*lhz", *fmt_ptr)) {
-                fmt_ptr++;
-            }
-            if (*fmt_ptr) fmt_ptr++;  /* Skip conversion specifier */
-
-            /* Extract and format argument */
-            int remaining = output_end - write_ptr;
-            switch (arg_type) {
-                case ARG_TYPE_CHAR: {
-                    char val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    int written = snprintf(write_ptr, remaining, "%c", (int)val);
-                    write_ptr += (written > 0 && written < remaining) ? written : 0;
-                    break;
-                }
-
-                case ARG_TYPE_INT32: {
-                    int32_t val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    int written = snprintf(write_ptr, remaining, "%d", val);
-                    write_ptr += (written > 0 && written < remaining) ? written : 0;
-                    break;
-                }
-
-                case ARG_TYPE_INT64: {
-                    int64_t val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    int written = snprintf(write_ptr, remaining, "%lld", (long long)val);
-                    write_ptr += (written > 0 && written < remaining) ? written : 0;
-                    break;
-                }
-
-                case ARG_TYPE_UINT32: {
-                    uint32_t val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    int written = snprintf(write_ptr, remaining, "%u", val);
-                    write_ptr += (written > 0 && written < remaining) ? written : 0;
-                    break;
-                }
-
-                case ARG_TYPE_UINT64: {
-                    uint64_t val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    int written = snprintf(write_ptr, remaining, "%llu", (unsigned long long)val);
-                    write_ptr += (written > 0 && written < remaining) ? written : 0;
-                    break;
-                }
-
-                case ARG_TYPE_DOUBLE: {
-                    double val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    int written = snprintf(write_ptr, remaining, "%f", val);
-                    write_ptr += (written > 0 && written < remaining) ? written : 0;
-                    break;
-                }
-
-                case ARG_TYPE_STRING: {
-                    uint32_t str_len;
-                    memcpy(&str_len, read_ptr, sizeof(str_len));
-                    read_ptr += sizeof(str_len);
-
-                    /* Copy string directly (not null-terminated in binary) */
-                    size_t copy_len = str_len;
-                    if (write_ptr + copy_len >= output_end) {
-                        copy_len = output_end - write_ptr;
-                    }
-                    if (copy_len > 0) {
-                        memcpy(write_ptr, read_ptr, copy_len);
-                        write_ptr += copy_len;
-                    }
-                    read_ptr += str_len;
-                    break;
-                }
-
-                case ARG_TYPE_POINTER: {
-                    uint64_t val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    int written = snprintf(write_ptr, remaining, "%p", (void*)val);
-                    write_ptr += (written > 0 && written < remaining) ? written : 0;
-                    break;
-                }
-
-                default:
-                    break;
-            }
-        } else {
-            /* Regular character or %% */
-            *write_ptr++ = *fmt_ptr++;
-            if (*(fmt_ptr - 1) == '%' && *fmt_ptr == '%') {
-                fmt_ptr++;  /* Skip second % */
-            }
-        }
-    }
-
-    *write_ptr = '\0';
-}
-
-/**
- * Format entry according to custom pattern.
- * Replaces pattern tokens with actual values.
+ * Render a log line from a compiled pattern program.
+ * Token handling matches the documented pattern tokens in cnanolog.h.
+ *
+ * @return Length of the formatted line (no null terminator)
  */
-static void format_entry_with_pattern(
-    const char* pattern,
+static size_t format_entry_with_pattern(
+    const fmt_program_t* pattern,
     const char* timestamp_buf,
+    size_t timestamp_len,
     const char* level_str,
     const log_site_t* site,
     const char* message_buf,
+    size_t message_len,
     char* output,
     size_t output_size)
 {
-    const char* p = pattern;
     char* out = output;
     char* out_end = output + output_size - 1;
+    /* Only a full "YYYY-MM-DD HH:MM:SS.nnnnnnnnn" can be sliced */
+    int full_ts = (timestamp_len == FMT_TIMESTAMP_CHARS);
 
-    while (*p && out < out_end) {
-        if (*p == '%' && *(p + 1)) {
-            p++;  /* Skip % */
-            switch (*p) {
-                case 't':  /* Full timestamp: YYYY-MM-DD HH:MM:SS.nnnnnnnnn */
-                    out += snprintf(out, out_end - out, "%s", timestamp_buf);
-                    break;
-
-                case 'T': {  /* Short timestamp: HH:MM:SS.nnn (microsecond precision) */
-                    /* Extract time portion and first 3 decimal digits */
-                    if (strlen(timestamp_buf) >= 23) {
-                        /* Format: YYYY-MM-DD HH:MM:SS.nnnnnnnnn */
-                        /*         0123456789012345678901234567 */
-                        /* Extract: HH:MM:SS.nnn (11-22 range, take first 12 chars) */
-                        out += snprintf(out, out_end - out, "%.12s", timestamp_buf + 11);
-                    } else {
-                        out += snprintf(out, out_end - out, "%s", timestamp_buf);
-                    }
-                    break;
-                }
-
-                case 'd':  /* Date only: YYYY-MM-DD */
-                    out += snprintf(out, out_end - out, "%.10s", timestamp_buf);
-                    break;
-
-                case 'D': {  /* Time only: HH:MM:SS */
-                    if (strlen(timestamp_buf) >= 19) {
-                        out += snprintf(out, out_end - out, "%.8s", timestamp_buf + 11);
-                    } else {
-                        out += snprintf(out, out_end - out, "%s", timestamp_buf);
-                    }
-                    break;
-                }
-
-                case 'l':  /* Log level name: INFO, WARN, ERROR, DEBUG */
-                    out += snprintf(out, out_end - out, "%s", level_str);
-                    break;
-
-                case 'L':  /* Log level letter: I, W, E, D */
-                    out += snprintf(out, out_end - out, "%c", level_str[0]);
-                    break;
-
-                case 'f':  /* Filename (basename) */
-                    out += snprintf(out, out_end - out, "%s", site->filename);
-                    break;
+    for (uint32_t i = 0; i < pattern->num_ops && out < out_end; i++) {
+        const fmt_op_t* op = &pattern->ops[i];
 
-                case 'F':  /* Full file path (same as basename for now) */
-                    out += snprintf(out, out_end - out, "%s", site->filename);
-                    break;
+        if (op->kind == FMT_OP_LITERAL) {
+            out = fmt_append(out, out_end, pattern->text + op->offset, op->length);
+            continue;
+        }
 
-                case 'n':  /* Line number */
-                    out += snprintf(out, out_end - out, "%u", site->line_number);
-                    break;
+        switch (op->conversion) {
+            case 't':  /* Full timestamp: YYYY-MM-DD HH:MM:SS.nnnnnnnnn */
+                out = fmt_append(out, out_end, timestamp_buf, timestamp_len);
+                break;
 
-                case 'm':  /* Formatted message */
-                    out += snprintf(out, out_end - out, "%s", message_buf);
-                    break;
+            case 'T':  /* Short timestamp: HH:MM:SS.nnn (millisecond precision) */
+                if (full_ts) {
+                    out = fmt_append(out, out_end, timestamp_buf + 11, 12);
+                } else {
+                    out = fmt_append(out, out_end, timestamp_buf, timestamp_len);
+                }
+                break;
+
+            case 'd':  /* Date only: YYYY-MM-DD */
+                out = fmt_append(out, out_end, timestamp_buf,
+                                 timestamp_len < 10 ? timestamp_len : 10);
+                break;
+
+            case 'D':  /* Time only: HH:MM:SS */
+                if (full_ts) {
+                    out = fmt_append(out, out_end, timestamp_buf + 11, 8);
+                } else {
+                    out = fmt_append(out, out_end, timestamp_buf, timestamp_len);
+                }
+                break;
+
+            case 'l':  /* Log level name: INFO, WARN, ERROR, DEBUG */
+                out = fmt_append(out, out_end, level_str, strlen(level_str));
+                break;
+
+            case 'L':  /* Log level letter: I, W, E, D */
+                *out++ = level_str[0];
+                break;
+
+            case 'f':  /* Filename (basename) */
+            case 'F':  /* Full file path (same as basename for now) */
+                out = fmt_append(out, out_end, site->filename, strlen(site->filename));
+                break;
+
+            case 'n': {  /* Line number */
+                char num_buf[FMT_INT_MAX_CHARS];
+                size_t len = fmt_u64(num_buf, site->line_number);
+                out = fmt_append(out, out_end, num_buf, len);
+                break;
+            }
 
-                case '%':  /* Literal % */
-                    if (out < out_end) *out++ = '%';
-                    break;
+            case 'm':  /* Formatted message */
+                out = fmt_append(out, out_end, message_buf, message_len);
+                break;
 
-                default:  /* Unknown token - output as-is */
-                    if (out < out_end) *out++ = '%';
-                    if (out < out_end) *out++ = *p;
-                    break;
-            }
-            p++;
-        } else {
-            /* Regular character - copy as-is */
-            *out++ = *p++;
+            default:  /* Unknown token - output as-is */
+                *out++ = '%';
+                if (out < out_end) *out++ = (char)op->conversion;
+                break;
         }
     }
 
     *out = '\0';
+    return (size_t)(out - output);
 }
 
 /* ============================================================================
  * Public API Implementation
  * ============================================================================ */
 
+/**
+ * Open a text log for appending.
+ * Not O_APPEND: Linux ignores pwrite() offsets on O_APPEND descriptors, and
+ * the async writer relies on them (a crash flush rewrites an unfinished
+ * AIO buffer at its offset, which must not append a second copy).
+ * @param end_offset Output: current file size (where appends land)
+ * @return File descriptor, or -1 on failure
+ */
+static int open_log_file(const char* file_path, uint64_t* end_offset) {
+#ifndef _WIN32
+    int fd = open(file_path, O_WRONLY | O_CREAT, 0644);
+    if (fd == -1) {
+        fprintf(stderr, "text_writer: open '%s' failed: %s\n", file_path, strerror(errno));
+        return -1;
+    }
+    off_t end = lseek(fd, 0, SEEK_END);
+    *end_offset = (end > 0) ? (uint64_t)end : 0;
+    return fd;
+#else
+    (void)file_path;
+    (void)end_offset;
+    return -1;
+#endif
+}
+
 text_writer_t* text_writer_create(const char* file_path) {
     if (file_path == NULL) {
         return NULL;
@@ -354,18 +281,32 @@ text_writer_t* text_writer_create(const char* file_path) {
         return NULL;
     }
 
-    /* Open file in append mode */
-    writer->file = fopen(file_path, "a");
-    if (writer->file == NULL) {
+    /* Allocate double buffers for async I/O */
+    if (async_writer_init(&writer->io, TEXT_WRITER_BUFFER_SIZE) != 0) {
         free(writer);
         return NULL;
     }
 
-    /* Enable line buffering for better tail -f experience */
-    setvbuf(writer->file, NULL, _IOLBF, 0);
+    /* Open file in append mode */
+    uint64_t end_offset = 0;
+    writer->fd = open_log_file(file_path, &end_offset);
+    if (writer->fd == -1) {
+        async_writer_destroy(&writer->io);
+        free(writer);
+        return NULL;
+    }
+    async_writer_attach(&writer->io, writer->fd, end_offset);
 
     writer->bytes_written = 0;
     writer->pattern = NULL;  /* NULL = use default pattern */
+    writer->pattern_program = fmt_program_compile_pattern(DEFAULT_TEXT_PATTERN);
+    writer->structured_style = -1;
+    if (writer->pattern_program == NULL) {
+        close(writer->fd);
+        async_writer_destroy(&writer->io);
+        free(writer);
+        return NULL;
+    }
     return writer;
 }
 
@@ -378,39 +319,78 @@ void text_writer_set_timestamp_info(text_writer_t* writer,
         return;
     }
 
+#if defined(__GNUC__) || defined(__clang__)
+    /* Formatter threads may be converting timestamps right now */
+    __atomic_store_n(&writer->clock_seq, writer->clock_seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+#endif
+    /* Entries stamped before a re-anchor (still in the reorder window or a
+     * formatter batch) keep the segment they were logged in, so a rate
+     * change never reorders neighbouring lines */
+    if (writer->timestamp_frequency != 0 && start_timestamp > writer->start_timestamp) {
+        writer->prev_frequency = writer->timestamp_frequency;
+        writer->prev_start_timestamp = writer->start_timestamp;
+        writer->prev_start_time_sec = writer->start_time_sec;
+        writer->prev_start_time_nsec = writer->start_time_nsec;
+    } else {
+        writer->prev_frequency = 0;
+    }
     writer->timestamp_frequency = frequency;
     writer->start_timestamp = start_timestamp;
     writer->start_time_sec = start_time_sec;
     writer->start_time_nsec = start_time_nsec;
+#if defined(__GNUC__) || defined(__clang__)
+    __atomic_store_n(&writer->clock_seq, writer->clock_seq + 1, __ATOMIC_RELEASE);
+#endif
 }
 
 void text_writer_set_pattern(text_writer_t* writer, const char* pattern) {
     if (writer == NULL) {
         return;
     }
+    fmt_program_t* program = fmt_program_compile_pattern(
+        pattern != NULL ? pattern : DEFAULT_TEXT_PATTERN);
+    if (program == NULL) {
+        return;  /* Keep the previous pattern */
+    }
+
+    fmt_program_free(writer->pattern_program);
+    writer->pattern_program = program;
     writer->pattern = pattern;  /* NULL = use default pattern */
 }
 
-int text_writer_write_entry(text_writer_t* writer,
-                             uint32_t log_id,
-                             uint64_t timestamp,
-                             const char* arg_data,
-                             uint16_t arg_data_len,
-                             const log_registry_t* registry) {
-    if (writer == NULL || writer->file == NULL || registry == NULL) {
-        return -1;
+void text_writer_set_output_format(text_writer_t* writer, cnanolog_output_format_t format) {
+    if (writer == NULL) {
+        return;
     }
+    switch (format) {
+        case CNANOLOG_OUTPUT_JSON:   writer->structured_style = SFMT_JSON;   break;
+        case CNANOLOG_OUTPUT_LOGFMT: writer->structured_style = SFMT_LOGFMT; break;
+        default:                     writer->structured_style = -1;          break;
+    }
+}
 
+size_t text_writer_format_entry(const text_writer_t* writer,
+                               fmt_time_cache_t* cache,
+                               uint32_t log_id,
+                               uint64_t timestamp,
+                               const char* arg_data,
+                               size_t arg_data_len,
+                               const log_registry_t* registry,
+                               char* out) {
     /* Lookup log site */
     const log_site_t* site = log_registry_get(registry, log_id);
     if (site == NULL) {
-        fprintf(writer->file, "[UNKNOWN_LOG_ID_%u]\n", log_id);
-        return -1;
+        memcpy(out, "[UNKNOWN_LOG_ID_", 16);
+        size_t len = 16 + fmt_u64(out + 16, log_id);
+        out[len++] = ']';
+        out[len++] = '\n';
+        return len;
     }
 
     /* Format timestamp */
     char timestamp_buf[64];
-    format_timestamp(writer, timestamp, timestamp_buf, sizeof(timestamp_buf));
+    size_t timestamp_len = format_timestamp(writer, cache, timestamp, timestamp_buf);
 
     /* Get uncompressed data (already uncompressed from staging buffer) */
     size_t uncompressed_len = 0;
@@ -419,54 +399,128 @@ int text_writer_write_entry(text_writer_t* writer,
 
     /* Format message */
     char message_buf[MESSAGE_BUFFER_SIZE];
-    format_message(site, uncompressed_data, message_buf, sizeof(message_buf));
+    size_t message_len;
+    if (likely(site->format_program != NULL)) {
+        message_len = fmt_program_render(site->format_program,
+                                         uncompressed_data, uncompressed_len,
+                                         message_buf, sizeof(message_buf));
+    } else {
+        /* Compilation failed at registration: show the raw format */
+        message_len = strlen(site->format);
+        if (message_len >= sizeof(message_buf)) {
+            message_len = sizeof(message_buf) - 1;
+        }
+        memcpy(message_buf, site->format, message_len);
+    }
 
     /* Get level string */
-    const char* level_str = level_to_string(site->log_level);
+    char level_buf[16];
+    const char* level_str = level_to_string(site->log_level, level_buf, sizeof(level_buf));
+
+    /* Structured output: metadata plus one typed field per argument */
+    if (writer->structured_style >= 0) {
+        sfmt_record_t record = {
+            .timestamp = timestamp_buf,
+            .timestamp_len = timestamp_len,
+            .level = level_str,
+            .file = site->filename,
+            .line = site->line_number,
+            .message = message_buf,
+            .message_len = message_len,
+            .format = site->format_program,
+            .arg_data = uncompressed_data,
+            .arg_len = uncompressed_len
+        };
+        size_t len = sfmt_encode(writer->structured_style, &record,
+                                 out, TEXT_WRITER_MAX_LINE_SIZE - 1);
+        out[len++] = '\n';
+        return len;
+    }
 
     /* Format complete log line using pattern
      * Priority: 1) Per-log pattern, 2) Global pattern, 3) Default pattern */
-    char output_buf[MESSAGE_BUFFER_SIZE + 256];  /* Extra space for timestamp, etc. */
-    const char* pattern = site->text_pattern ? site->text_pattern :
-                          (writer->pattern ? writer->pattern : "[%t] [%l] [%f:%n] %m");
-
-    format_entry_with_pattern(pattern, timestamp_buf, level_str, site,
-                              message_buf, output_buf, sizeof(output_buf));
+    const fmt_program_t* pattern = site->pattern_program ? site->pattern_program :
+                                   writer->pattern_program;
+
+    /* Reserve one byte so the newline always fits */
+    size_t line_len = format_entry_with_pattern(pattern, timestamp_buf, timestamp_len,
+                                                level_str, site,
+                                                message_buf, message_len,
+                                                out, TEXT_WRITER_MAX_LINE_SIZE - 1);
+    out[line_len++] = '\n';
+    return line_len;
+}
 
-    /* Write formatted line (with newline) */
-    int written = fprintf(writer->file, "%s\n", output_buf);
+int text_writer_write_entry(text_writer_t* writer,
+                             uint32_t log_id,
+                             uint64_t timestamp,
+                             const char* arg_data,
+                             size_t arg_data_len,
+                             const log_registry_t* registry) {
+    if (writer == NULL || writer->fd == -1 || registry == NULL) {
+        return -1;
+    }
 
-    if (written > 0) {
-        writer->bytes_written += written;
+    /* Format straight into the active output buffer */
+    char* line = async_writer_reserve(&writer->io, TEXT_WRITER_MAX_LINE_SIZE);
+    if (line == NULL) {
+        return -1;
     }
 
-    return (written > 0) ? 0 : -1;
+    size_t line_len = text_writer_format_entry(writer, &writer->time_cache, log_id,
+                                               timestamp, arg_data, arg_data_len,
+                                               registry, line);
+
+    async_writer_commit(&writer->io, line_len);
+    writer->bytes_written += line_len;
+    return 0;
+}
+
+int text_writer_write_block(text_writer_t* writer, const char* data, size_t len) {
+    if (writer == NULL || writer->fd == -1) {
+        return -1;
+    }
+    if (async_writer_write(&writer->io, data, len) != 0) {
+        return -1;
+    }
+    writer->bytes_written += len;
+    return 0;
 }
 
 void text_writer_flush(text_writer_t* writer) {
-    if (writer != NULL && writer->file != NULL) {
-        fflush(writer->file);
+    if (writer != NULL && writer->fd != -1) {
+        /* Hand the active buffer to AIO; does not wait for the disk */
+        async_writer_flush(&writer->io);
     }
 }
 
+int text_writer_crash_flush(text_writer_t* writer, uint64_t deadline_ns) {
+    if (writer == NULL || writer->fd == -1) {
+        return -1;
+    }
+    int result = async_writer_crash_flush(&writer->io, deadline_ns);
+    fsync(writer->fd);
+    return result;
+}
+
 int text_writer_rotate(text_writer_t* writer, const char* new_path) {
     if (writer == NULL || new_path == NULL) {
         return -1;
     }
 
-    /* Close current file */
-    if (writer->file != NULL) {
-        fclose(writer->file);
+    /* Drain and close current file */
+    if (writer->fd != -1) {
+        async_writer_sync(&writer->io);
+        close(writer->fd);
     }
 
     /* Open new file */
-    writer->file = fopen(new_path, "a");
-    if (writer->file == NULL) {
+    uint64_t end_offset = 0;
+    writer->fd = open_log_file(new_path, &end_offset);
+    if (writer->fd == -1) {
         return -1;
     }
-
-    /* Enable line buffering */
-    setvbuf(writer->file, NULL, _IOLBF, 0);
+    async_writer_attach(&writer->io, writer->fd, end_offset);
 
     return 0;
 }
@@ -476,12 +530,14 @@ void text_writer_close(text_writer_t* writer) {
         return;
     }
 
-    if (writer->file != NULL) {
-        fflush(writer->file);
-        fclose(writer->file);
-        writer->file = NULL;
+    if (writer->fd != -1) {
+        async_writer_sync(&writer->io);
+        close(writer->fd);
+        writer->fd = -1;
     }
 
+    async_writer_destroy(&writer->io);
+    fmt_program_free(writer->pattern_program);
     free(writer);
 }
 
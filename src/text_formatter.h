@@ -7,8 +7,10 @@
 
 #pragma once
 
+#include "../include/cnanolog.h"
 #include "../include/cnanolog_format.h"
 #include "log_registry.h"
+#include "fast_format.h"
 #include <stdio.h>
 #include <stdint.h>
 #include <time.h>
@@ -17,6 +19,25 @@
 extern "C" {
 #endif
 
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+/**
+ * Size of each of the text writer's two output buffers.
+ * Lines are formatted directly into the active buffer; a full buffer is
+ * handed to AIO while the other one fills.
+ *
+ * Memory usage: TEXT_WRITER_BUFFER_SIZE * 2 (16MB total)
+ */
+#define TEXT_WRITER_BUFFER_SIZE (8 * 1024 * 1024)  // 8MB (16MB total)
+
+/**
+ * Upper bound on one formatted line, including the trailing newline
+ * (8KB message plus pattern decoration).
+ */
+#define TEXT_WRITER_MAX_LINE_SIZE (8192 + 256)
+
 /* ============================================================================
  * Text Writer Context
  * ============================================================================ */
@@ -33,7 +54,7 @@ typedef struct text_writer text_writer_t;
 
 /**
  * Create a text writer for the given file.
- * Opens the file in append mode.
+ * Opens the file in append mode and allocates the output double buffer.
  *
  * @param file_path Path to text log file
  * @return Pointer to text writer, or NULL on failure
@@ -42,6 +63,8 @@ text_writer_t* text_writer_create(const char* file_path);
 
 /**
  * Set timestamp calibration data (called after rdtsc calibration).
+ * May be called again from the writer thread to re-anchor the mapping
+ * while formatter threads are running (single updater only).
  *
  * @param writer Text writer context
  * @param frequency CPU frequency in Hz
@@ -65,6 +88,14 @@ void text_writer_set_timestamp_info(text_writer_t* writer,
  */
 void text_writer_set_pattern(text_writer_t* writer, const char* pattern);
 
+/**
+ * Select line encoding: CNANOLOG_OUTPUT_TEXT renders the pattern,
+ * CNANOLOG_OUTPUT_JSON / CNANOLOG_OUTPUT_LOGFMT emit structured records
+ * (patterns, including per-log patterns, are ignored).
+ * Must be called before any log entries are written.
+ */
+void text_writer_set_output_format(text_writer_t* writer, cnanolog_output_format_t format);
+
 /**
  * Format and write a log entry to text file.
  * This is called by the background thread for each log entry.
@@ -81,14 +112,53 @@ int text_writer_write_entry(text_writer_t* writer,
                              uint32_t log_id,
                              uint64_t timestamp,
                              const char* arg_data,
-                             uint16_t arg_data_len,
+                             size_t arg_data_len,
                              const log_registry_t* registry);
 
 /**
- * Flush buffered data to disk.
+ * Render one log line (with trailing newline) into a caller buffer.
+ * Reads the writer's pattern and calibration but never modifies the writer,
+ * so formatter threads can call it concurrently, each with its own cache.
+ *
+ * @param writer Text writer context (pattern and timestamp calibration)
+ * @param cache Timestamp prefix cache owned by the calling thread
+ * @param log_id Log site ID
+ * @param timestamp rdtsc timestamp (0 if timestamps disabled)
+ * @param arg_data Packed argument data
+ * @param arg_data_len Length of argument data
+ * @param registry Log site registry
+ * @param out Output buffer of at least TEXT_WRITER_MAX_LINE_SIZE bytes
+ * @return Length of the line (not null-terminated)
+ */
+size_t text_writer_format_entry(const text_writer_t* writer,
+                               fmt_time_cache_t* cache,
+                               uint32_t log_id,
+                               uint64_t timestamp,
+                               const char* arg_data,
+                               size_t arg_data_len,
+                               const log_registry_t* registry,
+                               char* out);
+
+/**
+ * Append already-rendered lines to the output (used by the formatter pool).
+ *
+ * @return 0 on success, -1 on failure
+ */
+int text_writer_write_block(text_writer_t* writer, const char* data, size_t len);
+
+/**
+ * Submit buffered lines for writing (asynchronous; returns immediately).
  */
 void text_writer_flush(text_writer_t* writer);
 
+/**
+ * Write buffered lines from a crash handler (async-signal-safe; waits for
+ * in-flight AIO until deadline_ns on CLOCK_MONOTONIC).
+ *
+ * @return 0 on success, -1 on failure
+ */
+int text_writer_crash_flush(text_writer_t* writer, uint64_t deadline_ns);
+
 /**
  * Rotate to a new log file (for log rotation).
  * Closes current file and opens a new one.
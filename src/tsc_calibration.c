@@ -0,0 +1,200 @@
+/* Copyright (c) 2025
+ * CNanoLog Timestamp Counter Calibration Implementation
+ */
+
+#include "tsc_calibration.h"
+#include "cycles.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+    #include <cpuid.h>
+    #define TSC_HAVE_CPUID 1
+#endif
+
+/* Clock read attempts per sample (the tightest bracket wins) */
+#define SAMPLE_ATTEMPTS 5
+
+/* Spin length of the fallback startup calibration */
+#define QUICK_CALIBRATION_NS 2000000ULL
+
+static tsc_source_t g_source = TSC_SOURCE_CYCLES;
+
+/* ============================================================================
+ * Clock Source
+ * ============================================================================ */
+
+int tsc_is_invariant(void) {
+#if defined(TSC_HAVE_CPUID)
+    unsigned int eax, ebx, ecx, edx;
+    if (__get_cpuid_max(0x80000000, NULL) < 0x80000007) {
+        return 0;
+    }
+    __cpuid(0x80000007, eax, ebx, ecx, edx);
+    return (edx & (1u << 8)) != 0;
+#elif defined(__arm__) && !defined(__aarch64__)
+    return 0;
+#else
+    /* ARM64 generic timer, or rdtsc() already reads CLOCK_MONOTONIC */
+    return 1;
+#endif
+}
+
+tsc_source_t tsc_select_source(void) {
+    const char* env = getenv("CNANOLOG_CLOCK");
+    if (env != NULL && strcmp(env, "system") == 0) {
+        g_source = TSC_SOURCE_MONOTONIC;
+    } else if (env != NULL && strcmp(env, "tsc") == 0) {
+        g_source = TSC_SOURCE_CYCLES;
+    } else {
+        g_source = tsc_is_invariant() ? TSC_SOURCE_CYCLES : TSC_SOURCE_MONOTONIC;
+    }
+    return g_source;
+}
+
+tsc_source_t tsc_get_source(void) {
+    return g_source;
+}
+
+void tsc_set_source(tsc_source_t source) {
+    g_source = source;
+}
+
+/* ============================================================================
+ * Clock Samples
+ * ============================================================================ */
+
+static inline uint64_t read_counter(void) {
+    return (g_source == TSC_SOURCE_CYCLES) ? rdtsc() : tsc_monotonic_ns();
+}
+
+void tsc_sample(tsc_sample_t* sample) {
+    uint64_t best_window = UINT64_MAX;
+
+    for (int i = 0; i < SAMPLE_ATTEMPTS; i++) {
+        struct timespec real;
+        clock_gettime(CLOCK_REALTIME, &real);
+        uint64_t before = tsc_monotonic_ns();
+        uint64_t tsc = read_counter();
+        uint64_t after = tsc_monotonic_ns();
+
+        uint64_t window = after - before;
+        if (window < best_window) {
+            best_window = window;
+            sample->tsc = tsc;
+            /* The monotonic source is its own reference: no midpoint error */
+            sample->mono_ns = (g_source == TSC_SOURCE_CYCLES) ? before + window / 2 : tsc;
+            sample->real_sec = (int64_t)real.tv_sec;
+            sample->real_nsec = (int32_t)real.tv_nsec;
+            sample->error_ns = (uint32_t)(window / 2 + 1);
+        }
+    }
+}
+
+/* ============================================================================
+ * Frequency
+ * ============================================================================ */
+
+#ifdef TSC_HAVE_CPUID
+static uint64_t cpuid_frequency(void) {
+    unsigned int eax, ebx, ecx, edx;
+    unsigned int max_leaf = __get_cpuid_max(0, NULL);
+
+    /* Leaf 0x15: TSC = crystal * EBX / EAX */
+    if (max_leaf >= 0x15) {
+        __cpuid_count(0x15, 0, eax, ebx, ecx, edx);
+        if (eax != 0 && ebx != 0 && ecx != 0) {
+            return (uint64_t)ecx * ebx / eax;
+        }
+    }
+
+    /* Hypervisor timing leaf (KVM, VMware, ...): EAX = TSC kHz */
+    __cpuid(1, eax, ebx, ecx, edx);
+    if (ecx & (1u << 31)) {
+        __cpuid(0x40000000, eax, ebx, ecx, edx);
+        if (eax >= 0x40000010) {
+            __cpuid(0x40000010, eax, ebx, ecx, edx);
+            if (eax != 0) {
+                return (uint64_t)eax * 1000;
+            }
+        }
+    }
+
+    /* Leaf 0x16: base frequency in MHz (equals the TSC rate on Intel) */
+    if (max_leaf >= 0x16) {
+        __cpuid_count(0x16, 0, eax, ebx, ecx, edx);
+        if (eax != 0) {
+            return (uint64_t)eax * 1000000;
+        }
+    }
+
+    return 0;
+}
+#endif
+
+uint64_t tsc_known_frequency(void) {
+    const char* env = getenv("CNANOLOG_TSC_HZ");
+    if (env != NULL) {
+        uint64_t hz = strtoull(env, NULL, 10);
+        if (hz > 0) {
+            return hz;
+        }
+    }
+
+#if defined(TSC_HAVE_CPUID)
+    return cpuid_frequency();
+#elif defined(__aarch64__) && (defined(__GNUC__) || defined(__clang__))
+    /* The generic timer frequency is exact by definition */
+    uint64_t hz;
+    __asm__ __volatile__("mrs %0, cntfrq_el0" : "=r"(hz));
+    return hz;
+#else
+    return 0;
+#endif
+}
+
+uint64_t tsc_measure_frequency(const tsc_sample_t* start, const tsc_sample_t* end,
+                               uint32_t* uncertainty_ppb) {
+    if (end->mono_ns <= start->mono_ns || end->tsc <= start->tsc) {
+        return 0;
+    }
+
+    uint64_t elapsed_ns = end->mono_ns - start->mono_ns;
+    uint64_t ticks = end->tsc - start->tsc;
+    double hz = (double)ticks * 1e9 / (double)elapsed_ns;
+
+    if (uncertainty_ppb != NULL) {
+        double ppb = (double)(start->error_ns + end->error_ns) * 1e9 / (double)elapsed_ns;
+        *uncertainty_ppb = (ppb >= (double)UINT32_MAX) ? UINT32_MAX : (uint32_t)ppb + 1;
+    }
+    return (uint64_t)(hz + 0.5);
+}
+
+uint64_t tsc_calibrate_quick(tsc_sample_t* start, uint32_t* uncertainty_ppb) {
+    tsc_sample(start);
+
+    if (g_source == TSC_SOURCE_MONOTONIC) {
+        *uncertainty_ppb = 0;
+        return 1000000000ULL;
+    }
+
+    uint64_t hz = tsc_known_frequency();
+    if (hz > 0) {
+        *uncertainty_ppb = 0;
+        return hz;
+    }
+
+    /* Nothing to ask: spin briefly instead of sleeping 100ms */
+    tsc_sample_t end;
+    do {
+        tsc_sample(&end);
+    } while (end.mono_ns - start->mono_ns < QUICK_CALIBRATION_NS);
+
+    hz = tsc_measure_frequency(start, &end, uncertainty_ppb);
+    if (hz == 0) {
+        hz = 1000000000ULL;  /* rdtsc() fallback counts nanoseconds */
+        *uncertainty_ppb = 0;
+    }
+    return hz;
+}
@@ -0,0 +1,129 @@
+/* Copyright (c) 2025
+ * CNanoLog Timestamp Counter Calibration
+ *
+ * Finds the rdtsc() frequency without the old 100ms sleep at init. The
+ * provisional value comes from CNANOLOG_TSC_HZ, the CPU (CPUID leaf 0x15,
+ * hypervisor leaf 0x40000010, leaf 0x16, or CNTFRQ on ARM64), or a 2ms
+ * spin. The writer thread later measures the frequency over a longer
+ * interval and that refined value is what ends up in the file header.
+ *
+ * Counters that are not invariant (frequency follows P-states, stops in
+ * deep C-states) are replaced by CLOCK_MONOTONIC, read through the vDSO.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <time.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================================
+ * Clock Source
+ * ============================================================================ */
+
+/**
+ * What entry timestamps count.
+ */
+typedef enum {
+    TSC_SOURCE_CYCLES = 0,      /* rdtsc() (CNTVCT on ARM64) */
+    TSC_SOURCE_MONOTONIC = 1    /* CLOCK_MONOTONIC nanoseconds (vDSO) */
+} tsc_source_t;
+
+/**
+ * Whether rdtsc() ticks at a constant rate in every P-state and C-state.
+ * x86: CPUID 0x80000007 EDX bit 8. ARM64: the generic timer always is.
+ * ARM32's PMU cycle counter is not.
+ */
+int tsc_is_invariant(void);
+
+/**
+ * Pick the timestamp source: CNANOLOG_CLOCK=tsc|system overrides,
+ * otherwise rdtsc() if it is invariant and CLOCK_MONOTONIC if not.
+ * Also makes it the source used by tsc_sample().
+ */
+tsc_source_t tsc_select_source(void);
+
+/**
+ * Source chosen by the last tsc_select_source() (TSC_SOURCE_CYCLES before).
+ */
+tsc_source_t tsc_get_source(void);
+
+/**
+ * Use the source another process selected (out-of-process writer), so
+ * tsc_sample() counts in the same units as its entry timestamps.
+ */
+void tsc_set_source(tsc_source_t source);
+
+/**
+ * CLOCK_MONOTONIC in nanoseconds.
+ */
+static inline uint64_t tsc_monotonic_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* ============================================================================
+ * Clock Samples
+ * ============================================================================ */
+
+/**
+ * One rdtsc() reading paired with the system clocks.
+ */
+typedef struct {
+    uint64_t tsc;          /* Counter value (rdtsc() or monotonic ns, see tsc_source_t) */
+    uint64_t mono_ns;      /* CLOCK_MONOTONIC (nanoseconds) */
+    int64_t real_sec;      /* CLOCK_REALTIME seconds */
+    int32_t real_nsec;     /* CLOCK_REALTIME nanoseconds */
+    uint32_t error_ns;     /* Half-width of the clock read window around rdtsc() */
+} tsc_sample_t;
+
+/**
+ * Take a clock sample. Retries a few times and keeps the tightest
+ * CLOCK_MONOTONIC bracket around the rdtsc() read.
+ */
+void tsc_sample(tsc_sample_t* sample);
+
+/* ============================================================================
+ * Frequency
+ * ============================================================================ */
+
+/**
+ * Frequency reported by the environment or the CPU, without measuring.
+ * Checked in order: CNANOLOG_TSC_HZ environment variable, CPUID leaf 0x15
+ * (crystal ratio), hypervisor leaf 0x40000010, CPUID leaf 0x16 (base
+ * frequency), CNTFRQ_EL0 on ARM64.
+ *
+ * @return Frequency in Hz, or 0 if unknown
+ */
+uint64_t tsc_known_frequency(void);
+
+/**
+ * Frequency between two samples, measured against CLOCK_MONOTONIC.
+ *
+ * @param start Earlier sample
+ * @param end Later sample
+ * @param uncertainty_ppb Output: worst-case error in parts per billion
+ * @return Frequency in Hz, or 0 if the samples are unusable
+ */
+uint64_t tsc_measure_frequency(const tsc_sample_t* start, const tsc_sample_t* end,
+                               uint32_t* uncertainty_ppb);
+
+/**
+ * Fast startup calibration: take the start sample and return a provisional
+ * frequency. Uses tsc_known_frequency() when available (uncertainty 0 =
+ * not measured), otherwise spins for ~2ms. The monotonic source is exactly
+ * 1GHz.
+ *
+ * @param start Output: sample anchoring the rdtsc-to-wall-clock mapping
+ * @param uncertainty_ppb Output: error of the returned frequency (0 = nominal)
+ * @return Frequency in Hz
+ */
+uint64_t tsc_calibrate_quick(tsc_sample_t* start, uint32_t* uncertainty_ppb);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,215 @@
+/*
+ * CNanoLog Packer Microbenchmark
+ *
+ * Measures the variable-byte integer packer against a plain scalar
+ * reference (compare cascade + variable-length memcpy), and the
+ * compress/decode path for an entry with many integer arguments.
+ * Output bytes are checked against the reference, so the benchmark
+ * also fails on a format change.
+ */
+
+#include "../src/compressor.h"
+#include "../src/packer.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define NUM_VALUES   (1 << 20)
+#define ROUNDS       20
+#define ENTRY_ARGS   16
+#define NUM_ENTRIES  200000
+
+static uint64_t g_values[NUM_VALUES];
+static uint8_t g_lengths[NUM_VALUES];
+static char g_packed[NUM_VALUES * 8];
+static char g_reference[NUM_VALUES * 8];
+static volatile uint64_t g_sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ============================================================================
+ * Scalar Reference
+ * ============================================================================ */
+
+static uint8_t reference_pack(char** buffer, uint64_t val) {
+    uint8_t num_bytes;
+    if (val < (1ULL << 8))       num_bytes = 1;
+    else if (val < (1ULL << 16)) num_bytes = 2;
+    else if (val < (1ULL << 24)) num_bytes = 3;
+    else if (val < (1ULL << 32)) num_bytes = 4;
+    else if (val < (1ULL << 40)) num_bytes = 5;
+    else if (val < (1ULL << 48)) num_bytes = 6;
+    else if (val < (1ULL << 56)) num_bytes = 7;
+    else                         num_bytes = 8;
+    memcpy(*buffer, &val, num_bytes);
+    *buffer += num_bytes;
+    return num_bytes;
+}
+
+static uint64_t reference_unpack(const char** buffer, uint8_t num_bytes) {
+    uint64_t val = 0;
+    memcpy(&val, *buffer, num_bytes);
+    *buffer += num_bytes;
+    return val;
+}
+
+/* ============================================================================
+ * Benchmarks
+ * ============================================================================ */
+
+/* Values of 1-8 significant bytes in random order (unpredictable lengths) */
+static void fill_values(void) {
+    uint64_t state = 88172645463325252ULL;
+    for (int i = 0; i < NUM_VALUES; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        int bytes = (int)(state % 8) + 1;
+        g_values[i] = (state >> 3) >> (64 - bytes * 8) | (1ULL << (bytes * 8 - 1));
+    }
+}
+
+static int benchmark_pack(void) {
+    double best_lib = 1e18, best_ref = 1e18;
+    size_t lib_len = 0, ref_len = 0;
+
+    for (int r = 0; r < ROUNDS; r++) {
+        double start = now_ns();
+        char* p = g_packed;
+        for (int i = 0; i < NUM_VALUES; i++) {
+            g_lengths[i] = pack_uint64(&p, g_values[i]);
+        }
+        double lib = now_ns() - start;
+        lib_len = (size_t)(p - g_packed);
+
+        start = now_ns();
+        p = g_reference;
+        for (int i = 0; i < NUM_VALUES; i++) {
+            reference_pack(&p, g_values[i]);
+        }
+        double ref = now_ns() - start;
+        ref_len = (size_t)(p - g_reference);
+
+        if (lib < best_lib) best_lib = lib;
+        if (ref < best_ref) best_ref = ref;
+    }
+
+    printf("  pack_uint64:    %5.2f ns/value (reference %5.2f ns, %.2fx)\n",
+           best_lib / NUM_VALUES, best_ref / NUM_VALUES, best_ref / best_lib);
+    if (lib_len != ref_len || memcmp(g_packed, g_reference, lib_len) != 0) {
+        printf("  ✗ packed bytes differ from the reference\n");
+        return 1;
+    }
+    return 0;
+}
+
+static int benchmark_unpack(void) {
+    double best_lib = 1e18, best_ref = 1e18;
+    uint64_t lib_sum = 0, ref_sum = 0;
+
+    for (int r = 0; r < ROUNDS; r++) {
+        double start = now_ns();
+        const char* p = g_packed;
+        uint64_t sum = 0;
+        for (int i = 0; i < NUM_VALUES; i++) {
+            sum += unpack_uint64(&p, g_lengths[i]);
+        }
+        double lib = now_ns() - start;
+        lib_sum = sum;
+
+        start = now_ns();
+        p = g_packed;
+        sum = 0;
+        for (int i = 0; i < NUM_VALUES; i++) {
+            sum += reference_unpack(&p, g_lengths[i]);
+        }
+        double ref = now_ns() - start;
+        ref_sum = sum;
+
+        if (lib < best_lib) best_lib = lib;
+        if (ref < best_ref) best_ref = ref;
+    }
+    g_sink = lib_sum;
+
+    printf("  unpack_uint64:  %5.2f ns/value (reference %5.2f ns, %.2fx)\n",
+           best_lib / NUM_VALUES, best_ref / NUM_VALUES, best_ref / best_lib);
+    if (lib_sum != ref_sum) {
+        printf("  ✗ unpacked values differ from the reference\n");
+        return 1;
+    }
+    return 0;
+}
+
+/* Compress and decode an entry of ENTRY_ARGS uint64 arguments */
+static int benchmark_entry(void) {
+    log_site_t site;
+    memset(&site, 0, sizeof(site));
+    site.num_args = ENTRY_ARGS;
+    for (int i = 0; i < ENTRY_ARGS; i++) {
+        site.arg_types[i] = ARG_TYPE_UINT64;
+    }
+
+    arg_slot_t enc[ENTRY_ARGS];
+    delta_slot_t dec[ENTRY_ARGS];
+    memset(enc, 0, sizeof(enc));
+    memset(dec, 0, sizeof(dec));
+
+    char compressed[ENTRY_ARGS * 9 + 16];
+    double compress_ns = 0, decode_ns = 0;
+    size_t total_bytes = 0;
+    int errors = 0;
+
+    for (int e = 0; e < NUM_ENTRIES; e++) {
+        const uint64_t* args = &g_values[(e * ENTRY_ARGS) % (NUM_VALUES - ENTRY_ARGS)];
+        size_t compressed_len;
+
+        double start = now_ns();
+        compress_entry_args((const char*)args, ENTRY_ARGS * sizeof(uint64_t), compressed,
+                            &compressed_len, &site, enc, NULL);
+        double mid = now_ns();
+
+        const uint8_t* nibbles = (const uint8_t*)compressed;
+        const char* p = compressed + nibble_bytes(ENTRY_ARGS);
+        const char* end = compressed + compressed_len;
+        for (int i = 0; i < ENTRY_ARGS; i++) {
+            uint64_t val;
+            if (unpack_int_delta(&p, end, get_nibble(nibbles, i), 0, &dec[i], &val) != 0 ||
+                val != args[i]) {
+                errors++;
+                break;
+            }
+        }
+        decode_ns += now_ns() - mid;
+        compress_ns += mid - start;
+        total_bytes += compressed_len;
+    }
+
+    printf("  %d-arg entry:   compress %6.1f ns, decode %6.1f ns, %zu -> %.1f bytes\n",
+           ENTRY_ARGS, compress_ns / NUM_ENTRIES, decode_ns / NUM_ENTRIES,
+           (size_t)ENTRY_ARGS * sizeof(uint64_t), (double)total_bytes / NUM_ENTRIES);
+    if (errors != 0) {
+        printf("  ✗ decoded entries differ\n");
+        return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    int failures = 0;
+
+    printf("CNanoLog Packer Microbenchmark\n");
+    printf("==============================\n\n");
+
+    fill_values();
+    failures += benchmark_pack();
+    failures += benchmark_unpack();
+    failures += benchmark_entry();
+
+    printf("\n");
+    return failures == 0 ? 0 : 1;
+}
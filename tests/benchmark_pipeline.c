@@ -0,0 +1,728 @@
+/*
+ * CNanoLog Writer Pipeline Microbenchmark
+ *
+ * Splits the writer thread's per-entry work into its stages and times
+ * each one on a prerecorded entry stream, alone and stacked:
+ * - staging read:  staging_peek_entry + staging_read + staging_consume
+ * - lookup:        log_registry_get
+ * - compress:      compress_history_get + compress_entry_args
+ * - encode:        binwriter_write_entry (into the in-memory buffer)
+ * - aio:           async_writer_write of the encoded file bytes + sync
+ *
+ * The stream uses the benchmark_suite workloads, packed the way the
+ * logging thread packs them (arg_pack_write_fast) and staged in a real
+ * staging buffer. It is capped at one binary writer buffer, so the encode
+ * stage never waits on the disk.
+ *
+ * Reported per stage: ns/entry, MB/s of the stage's input (staged bytes;
+ * argument bytes for compress, compressed bytes for encode, file bytes
+ * for aio), and on Linux the perf_event_open counters cycles,
+ * instructions and cache misses per entry when the kernel allows them.
+ * Counters cover this thread only: glibc runs POSIX AIO on helper
+ * threads, so the aio row shows the submit and wait, not the write.
+ */
+
+#include "../src/arg_packing.h"
+#include "../src/async_writer.h"
+#include "../src/binary_writer.h"
+#include "../src/compressor.h"
+#include "../src/log_registry.h"
+#include "../src/staging_buffer.h"
+#include <fcntl.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+
+#define DEFAULT_ENTRIES 1000000
+#define DEFAULT_ROUNDS  5
+#define MAX_STREAM_BYTES BINARY_WRITER_BUFFER_SIZE
+
+static volatile uint64_t g_sink;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* ============================================================================
+ * Hardware Counters
+ * ============================================================================ */
+
+#define NUM_COUNTERS 3
+
+static int g_counter_fds[NUM_COUNTERS] = {-1, -1, -1};
+static int g_counters_user_only = 0;
+
+/* Open cycles, instructions and cache misses for this thread, with kernel
+ * time if allowed. Returns the number of counters opened. */
+static int counters_open(void) {
+#if defined(__linux__)
+    static const uint64_t configs[NUM_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_CACHE_MISSES
+    };
+    int opened = 0;
+    for (int user_only = 0; user_only <= 1 && opened == 0; user_only++) {
+        for (int c = 0; c < NUM_COUNTERS; c++) {
+            struct perf_event_attr attr;
+            memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = configs[c];
+            attr.disabled = 1;
+            attr.exclude_kernel = (unsigned)user_only;
+            attr.exclude_hv = 1;
+            g_counter_fds[c] = (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+            if (g_counter_fds[c] >= 0) {
+                opened++;
+            }
+        }
+        g_counters_user_only = user_only;
+    }
+    return opened;
+#else
+    return 0;
+#endif
+}
+
+static void counters_start(void) {
+#if defined(__linux__)
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        if (g_counter_fds[c] >= 0) {
+            ioctl(g_counter_fds[c], PERF_EVENT_IOC_RESET, 0);
+            ioctl(g_counter_fds[c], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+/* UINT64_MAX for a counter that is not available */
+static void counters_stop(uint64_t* values) {
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        values[c] = UINT64_MAX;
+#if defined(__linux__)
+        if (g_counter_fds[c] >= 0) {
+            ioctl(g_counter_fds[c], PERF_EVENT_IOC_DISABLE, 0);
+            uint64_t value;
+            if (read(g_counter_fds[c], &value, sizeof(value)) == (ssize_t)sizeof(value)) {
+                values[c] = value;
+            }
+        }
+#endif
+    }
+}
+
+static void counters_close(void) {
+    for (int c = 0; c < NUM_COUNTERS; c++) {
+        if (g_counter_fds[c] >= 0) {
+            close(g_counter_fds[c]);
+            g_counter_fds[c] = -1;
+        }
+    }
+}
+
+/* ============================================================================
+ * Entry Stream
+ * ============================================================================ */
+
+#define MAX_SITES 8
+
+typedef struct {
+    const char* format;
+    uint8_t num_args;
+    uint8_t arg_types[4];
+} site_def_t;
+
+static const char* const SYMBOLS[] = {"AAPL", "MSFT", "GOOGL", "AMZN", "NVDA", "META", "TSLA"};
+static char g_long_text[4][192];
+
+static const char* const WORKLOAD_NAMES[] = {"noargs", "int", "mixed", "string"};
+#define NUM_WORKLOADS 4
+
+/* Sites of each workload, as the LOG_INFO calls in benchmark_suite register them */
+static const site_def_t WORKLOAD_SITES[NUM_WORKLOADS][MAX_SITES] = {
+    {{"heartbeat", 0, {0}}},
+    {{"order %d qty %d", 2, {ARG_TYPE_INT32, ARG_TYPE_INT32}}},
+    {{"seq %d", 1, {ARG_TYPE_INT32}},
+     {"offset %llu", 1, {ARG_TYPE_UINT64}},
+     {"price %f", 1, {ARG_TYPE_DOUBLE}},
+     {"side %c level %u", 2, {ARG_TYPE_CHAR, ARG_TYPE_UINT32}},
+     {"book %p", 1, {ARG_TYPE_POINTER}},
+     {"symbol %s", 1, {ARG_TYPE_STRING}}},
+    {{"request %s from %s: %s", 3, {ARG_TYPE_STRING, ARG_TYPE_STRING, ARG_TYPE_STRING}}},
+};
+static const int WORKLOAD_NUM_SITES[NUM_WORKLOADS] = {1, 1, 6, 1};
+
+static log_registry_t g_registry;
+static uint32_t g_site_ids[MAX_SITES];
+
+/* Staged entries back to back, as the logging thread writes them */
+static char* g_stream;
+static size_t g_stream_bytes;
+static uint32_t* g_offsets;      /* Entry i starts at g_stream + g_offsets[i] */
+static const log_site_t** g_sites;
+static size_t g_entries;
+static size_t g_arg_bytes;
+static uint64_t g_timestamp;
+
+/* Compressed arguments and the encoded file bytes, for the stages after compress */
+static char* g_compressed;
+static uint32_t* g_compressed_offsets;
+static uint32_t* g_compressed_lens;
+static size_t g_compressed_bytes;
+static char* g_encoded;
+static uint32_t* g_encoded_lens;
+static size_t g_encoded_bytes;
+
+static staging_buffer_t* g_staging;
+static compress_history_t g_history;
+static char g_temp_buf[STAGING_MAX_ENTRY_SIZE];
+static char g_compressed_buf[CNANOLOG_MAX_COMPRESSED_SIZE];
+static char g_path[512];
+
+/* Append one entry for site s; returns 0 once the stream is full */
+static int stream_add(int s, ...) {
+    const log_site_t* site = log_registry_get(&g_registry, g_site_ids[s]);
+    size_t max_size = sizeof(cnanolog_entry_header_t) + 3 * (sizeof(uint32_t) + 192) + 64;
+    if (g_stream_bytes + max_size > MAX_STREAM_BYTES) {
+        return 0;
+    }
+
+    char* entry = g_stream + g_stream_bytes;
+    uint8_t types[4];
+    for (int a = 0; a < site->num_args; a++) {
+        types[a] = (uint8_t)site->arg_types[a];
+    }
+
+    va_list args;
+    va_start(args, s);
+    size_t len = arg_pack_write_fast(entry + sizeof(cnanolog_entry_header_t),
+                                     max_size - sizeof(cnanolog_entry_header_t),
+                                     site->num_args, types, args);
+    va_end(args);
+
+    cnanolog_entry_header_t header;
+    header.log_id = site->log_id;
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    g_timestamp += 40 + (g_timestamp & 7);
+    header.timestamp = g_timestamp;
+#endif
+    header.data_length = (uint16_t)len;
+    memcpy(entry, &header, sizeof(header));
+
+    g_offsets[g_entries] = (uint32_t)g_stream_bytes;
+    g_sites[g_entries] = site;
+    g_stream_bytes += sizeof(header) + len;
+    g_arg_bytes += len;
+    g_entries++;
+    return 1;
+}
+
+static int stream_add_entry(int workload, uint64_t i) {
+    switch (workload) {
+        case 0:
+            return stream_add(0);
+        case 1:
+            return stream_add(0, (int32_t)i, (int32_t)(i & 1023));
+        case 2:
+            switch (i % 6) {
+                case 0: return stream_add(0, (int32_t)i);
+                case 1: return stream_add(1, (uint64_t)(i * 4096));
+                case 2: return stream_add(2, 100.0 + (double)(i & 255) * 0.01);
+                case 3: return stream_add(3, (i & 1) ? 'B' : 'S', (uint32_t)(i & 15));
+                case 4: return stream_add(4, (void*)(uintptr_t)(0x10000 + (i & 0xFFF0)));
+                default: return stream_add(5, SYMBOLS[i % 7]);
+            }
+        default:
+            return stream_add(0, SYMBOLS[i % 7], SYMBOLS[(i + 3) % 7], g_long_text[i & 3]);
+    }
+}
+
+/* Build the staged stream, then its compressed and encoded forms */
+static int stream_build(int workload, size_t max_entries) {
+    log_registry_init(&g_registry);
+    for (int s = 0; s < WORKLOAD_NUM_SITES[workload]; s++) {
+        const site_def_t* def = &WORKLOAD_SITES[workload][s];
+        g_site_ids[s] = log_registry_register(&g_registry, LOG_LEVEL_INFO, "benchmark_pipeline.c",
+                                              (uint32_t)(100 + s), def->format, def->num_args,
+                                              def->arg_types, NULL);
+        if (g_site_ids[s] == UINT32_MAX) {
+            return -1;
+        }
+    }
+
+    g_stream_bytes = 0;
+    g_arg_bytes = 0;
+    g_entries = 0;
+    g_timestamp = 1000000;
+    while (g_entries < max_entries && stream_add_entry(workload, g_entries)) {
+    }
+
+    /* Compressed arguments in file order, against one running history */
+    compress_history_reset(&g_history);
+    g_compressed_bytes = 0;
+    g_encoded_bytes = 0;
+    for (size_t i = 0; i < g_entries; i++) {
+        const char* entry = g_stream + g_offsets[i];
+        size_t arg_len;
+        const char* args = staging_entry_data(entry, &arg_len);
+        const log_site_t* site = g_sites[i];
+        char* out = g_compressed + g_compressed_bytes;
+        size_t out_len = arg_len;
+        if (site->num_args > 0) {
+            arg_slot_t* history = compress_history_get(&g_history, site);
+            if (history == NULL || compress_entry_args(args, arg_len, out, &out_len, site, history,
+                                                       &g_history.strings) != 0) {
+                return -1;
+            }
+        } else {
+            memcpy(out, args, arg_len);
+        }
+        g_compressed_offsets[i] = (uint32_t)g_compressed_bytes;
+        g_compressed_lens[i] = (uint32_t)out_len;
+        g_compressed_bytes += out_len;
+
+        /* File bytes: header with inline length, then the compressed data */
+        cnanolog_entry_header_t header;
+        memcpy(&header, entry, sizeof(header));
+        header.data_length = (uint16_t)out_len;
+        memcpy(g_encoded + g_encoded_bytes, &header, sizeof(header));
+        memcpy(g_encoded + g_encoded_bytes + sizeof(header), out, out_len);
+        g_encoded_lens[i] = (uint32_t)(sizeof(header) + out_len);
+        g_encoded_bytes += sizeof(header) + out_len;
+    }
+    return 0;
+}
+
+/* ============================================================================
+ * Stages
+ * ============================================================================ */
+
+/* Pipeline depth: each level adds the next stage */
+enum {
+    DEPTH_READ = 1,
+    DEPTH_LOOKUP,
+    DEPTH_COMPRESS,
+    DEPTH_ENCODE,
+    DEPTH_CLOSE
+};
+
+static binary_writer_t* g_writer;
+static async_writer_t g_async;
+static int g_async_fd = -1;
+
+static void fill_staging(void) {
+    staging_reset(g_staging);
+    for (size_t i = 0; i < g_entries; i++) {
+        const char* entry = g_stream + g_offsets[i];
+        size_t size = staging_entry_size(entry);
+        char* dst = staging_reserve(g_staging, size);
+        memcpy(dst, entry, size);
+        staging_commit(g_staging, size);
+    }
+}
+
+static void open_writer(void) {
+    g_writer = binwriter_create(g_path);
+    binwriter_write_header(g_writer, 1000000000ULL, 0, 0, 0);
+}
+
+/* A long-running writer reuses its two buffers; fill and submit both once
+ * so the timed writes do not pay first-touch page faults */
+static void warm_writer(void) {
+    open_writer();
+    for (int pass = 0; pass < 2; pass++) {
+        const char* p = g_encoded;
+        for (size_t i = 0; i < g_entries; i++) {
+            binwriter_write_entry(g_writer, 0, 0, p, g_encoded_lens[i]);
+            p += g_encoded_lens[i];
+        }
+        binwriter_flush(g_writer);
+    }
+}
+
+static void close_writer(void) {
+    uint32_t num_sites;
+    const log_site_t* sites = log_registry_get_all(&g_registry, &num_sites);
+    binwriter_close(g_writer, sites, num_sites, NULL, 0);
+    g_writer = NULL;
+}
+
+/* Setup and teardown run outside the timed region */
+static void setup(int stage) {
+    compress_history_reset(&g_history);
+    switch (stage) {
+        case -DEPTH_ENCODE:
+            warm_writer();
+            break;
+        case -DEPTH_CLOSE:
+            g_async_fd = open(g_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            async_writer_attach(&g_async, g_async_fd, 0);
+            break;
+        case -DEPTH_READ:
+            fill_staging();
+            break;
+        default:
+            if (stage > 0) {
+                fill_staging();
+                if (stage >= DEPTH_ENCODE) {
+                    warm_writer();
+                }
+            }
+            break;
+    }
+}
+
+static void teardown(int stage) {
+    if (stage == -DEPTH_ENCODE || (stage >= DEPTH_ENCODE && stage < DEPTH_CLOSE)) {
+        close_writer();
+    } else if (stage == -DEPTH_CLOSE) {
+        close(g_async_fd);
+        g_async_fd = -1;
+    }
+}
+
+/* Stages in isolation (negative ids), each on precomputed input */
+static void run_isolated(int stage) {
+    uint64_t sum = 0;
+    switch (stage) {
+        case -DEPTH_READ: {
+            cnanolog_entry_header_t header;
+            size_t entry_size;
+            while (staging_peek_entry(g_staging, &header, &entry_size)) {
+                sum += staging_read(g_staging, g_temp_buf, entry_size);
+                staging_consume(g_staging, entry_size);
+            }
+            break;
+        }
+        case -DEPTH_LOOKUP:
+            for (size_t i = 0; i < g_entries; i++) {
+                const cnanolog_entry_header_t* header =
+                    (const cnanolog_entry_header_t*)(g_stream + g_offsets[i]);
+                sum += log_registry_get(&g_registry, header->log_id)->num_args;
+            }
+            break;
+        case -DEPTH_COMPRESS:
+            for (size_t i = 0; i < g_entries; i++) {
+                const log_site_t* site = g_sites[i];
+                if (site->num_args == 0) {
+                    continue;
+                }
+                size_t arg_len, compressed_len;
+                const char* args = staging_entry_data(g_stream + g_offsets[i], &arg_len);
+                arg_slot_t* history = compress_history_get(&g_history, site);
+                compress_entry_args(args, arg_len, g_compressed_buf, &compressed_len, site,
+                                    history, &g_history.strings);
+                sum += compressed_len;
+            }
+            break;
+        case -DEPTH_ENCODE:
+            for (size_t i = 0; i < g_entries; i++) {
+                const cnanolog_entry_header_t* header =
+                    (const cnanolog_entry_header_t*)(g_stream + g_offsets[i]);
+#ifndef CNANOLOG_NO_TIMESTAMPS
+                uint64_t timestamp = header->timestamp;
+#else
+                uint64_t timestamp = 0;
+#endif
+                binwriter_write_entry(g_writer, header->log_id, timestamp,
+                                      g_compressed + g_compressed_offsets[i],
+                                      g_compressed_lens[i]);
+            }
+            break;
+        default: {
+            const char* p = g_encoded;
+            for (size_t i = 0; i < g_entries; i++) {
+                async_writer_write(&g_async, p, g_encoded_lens[i]);
+                p += g_encoded_lens[i];
+            }
+            async_writer_sync(&g_async);
+            break;
+        }
+    }
+    g_sink = sum;
+}
+
+/* The writer thread's loop (process_next_entry / write_binary_entry) cut
+ * off after the given depth */
+static void run_pipeline(int depth) {
+    cnanolog_entry_header_t header;
+    size_t entry_size;
+    uint64_t sum = 0;
+
+    while (staging_peek_entry(g_staging, &header, &entry_size)) {
+        staging_read(g_staging, g_temp_buf, entry_size);
+        if (depth >= DEPTH_LOOKUP) {
+            const log_site_t* site = log_registry_get(&g_registry, header.log_id);
+            size_t arg_len;
+            const char* data = staging_entry_data(g_temp_buf, &arg_len);
+            size_t data_len = arg_len;
+            if (depth >= DEPTH_COMPRESS && site->num_args > 0) {
+                arg_slot_t* history = compress_history_get(&g_history, site);
+                if (compress_entry_args(data, arg_len, g_compressed_buf, &data_len, site,
+                                        history, &g_history.strings) == 0) {
+                    data = g_compressed_buf;
+                }
+            }
+            if (depth >= DEPTH_ENCODE) {
+#ifndef CNANOLOG_NO_TIMESTAMPS
+                binwriter_write_entry(g_writer, header.log_id, header.timestamp, data, data_len);
+#else
+                binwriter_write_entry(g_writer, header.log_id, 0, data, data_len);
+#endif
+            }
+            sum += data_len;
+        }
+        staging_consume(g_staging, entry_size);
+    }
+    if (depth >= DEPTH_CLOSE) {
+        close_writer();
+    }
+    g_sink = sum;
+}
+
+/* ============================================================================
+ * Measurement
+ * ============================================================================ */
+
+typedef struct {
+    double ns;
+    uint64_t counters[NUM_COUNTERS];
+} sample_t;
+
+static int g_rounds = DEFAULT_ROUNDS;
+
+/* Best of g_rounds (counters from the fastest round) */
+static sample_t measure(int stage) {
+    sample_t best;
+    best.ns = 1e18;
+    for (int r = 0; r < g_rounds; r++) {
+        setup(stage);
+        sample_t s;
+        counters_start();
+        double start = now_ns();
+        if (stage < 0) {
+            run_isolated(stage);
+        } else {
+            run_pipeline(stage);
+        }
+        s.ns = now_ns() - start;
+        counters_stop(s.counters);
+        teardown(stage);
+        if (s.ns < best.ns) {
+            best = s;
+        }
+    }
+    return best;
+}
+
+static void print_row(const char* label, const sample_t* s, size_t bytes) {
+    double n = (double)g_entries;
+    printf("  %-26s %8.2f", label, s->ns / n);
+    if (bytes > 0 && s->ns > 0) {
+        printf(" %9.1f", (double)bytes * 1e3 / s->ns);
+    } else {
+        printf(" %9s", "-");
+    }
+    if (s->counters[0] != UINT64_MAX && s->counters[1] != UINT64_MAX) {
+        printf(" %8.1f %8.1f %5.2f", (double)s->counters[0] / n, (double)s->counters[1] / n,
+               s->counters[0] > 0 ? (double)s->counters[1] / (double)s->counters[0] : 0.0);
+    } else {
+        printf(" %8s %8s %5s", "n/a", "n/a", "n/a");
+    }
+    if (s->counters[2] != UINT64_MAX) {
+        printf(" %9.3f\n", (double)s->counters[2] / n);
+    } else {
+        printf(" %9s\n", "n/a");
+    }
+}
+
+static void print_header(const char* title) {
+    printf("\n  %-26s %8s %9s %8s %8s %5s %9s\n", title, "ns/entry", "MB/s", "cycles",
+           "instr", "IPC", "misses");
+}
+
+static int benchmark_workload(int workload, size_t max_entries) {
+    if (stream_build(workload, max_entries) != 0) {
+        printf("  ✗ could not build the %s stream\n", WORKLOAD_NAMES[workload]);
+        return 1;
+    }
+    printf("\n%s: %zu entries%s, %.1f MB staged (%.1f B/entry), %.1f MB in the file\n",
+           WORKLOAD_NAMES[workload], g_entries, g_entries < max_entries ? " (capped)" : "",
+           (double)g_stream_bytes / 1e6, (double)g_stream_bytes / (double)g_entries,
+           (double)g_encoded_bytes / 1e6);
+
+    static const char* const ISOLATED[] = {
+        "staging read", "lookup", "compress", "encode", "aio write + sync"
+    };
+    size_t isolated_bytes[] = {
+        g_stream_bytes, g_stream_bytes, g_arg_bytes, g_compressed_bytes, g_encoded_bytes
+    };
+    print_header("stage (isolated)");
+    double sum_ns = 0;
+    for (int d = DEPTH_READ; d <= DEPTH_CLOSE; d++) {
+        sample_t s = measure(-d);
+        print_row(ISOLATED[d - 1], &s, isolated_bytes[d - 1]);
+        sum_ns += s.ns;
+    }
+    printf("  %-26s %8.2f\n", "sum of stages", sum_ns / (double)g_entries);
+
+    static const char* const COMBINED[] = {
+        "read", "+ lookup", "+ compress", "+ encode", "+ flush and close"
+    };
+    print_header("pipeline (cumulative)");
+    for (int d = DEPTH_READ; d <= DEPTH_CLOSE; d++) {
+        sample_t s = measure(d);
+        print_row(COMBINED[d - 1], &s, g_stream_bytes);
+    }
+
+    /* The pipeline must produce the bytes the stages were fed */
+    compress_history_reset(&g_history);
+    fill_staging();
+    open_writer();
+    run_pipeline(DEPTH_CLOSE);
+    FILE* f = fopen(g_path, "rb");
+    int failed = 1;
+    if (f != NULL) {
+        char* file = (char*)malloc(g_encoded_bytes);
+        if (file != NULL && fseek(f, (long)sizeof(cnanolog_file_header_t), SEEK_SET) == 0 &&
+            fread(file, 1, g_encoded_bytes, f) == g_encoded_bytes) {
+            failed = memcmp(file, g_encoded, g_encoded_bytes) != 0;
+        }
+        free(file);
+        fclose(f);
+    }
+    unlink(g_path);
+    log_registry_destroy(&g_registry);
+    if (failed) {
+        printf("  ✗ pipeline output differs from the staged stages\n");
+        return 1;
+    }
+    return 0;
+}
+
+static void usage(const char* prog) {
+    printf("Usage: %s [options]\n", prog);
+    printf("  --entries N        entries per stream (default %d, capped at %d MB staged)\n",
+           DEFAULT_ENTRIES, MAX_STREAM_BYTES >> 20);
+    printf("  --workload NAME    noargs, int, mixed, string or all (default mixed)\n");
+    printf("  --rounds N         rounds per measurement, best reported (default %d)\n",
+           DEFAULT_ROUNDS);
+    printf("  --dir DIR          directory for the output file (default .)\n");
+}
+
+int main(int argc, char** argv) {
+    size_t max_entries = DEFAULT_ENTRIES;
+    int first = 2, last = 2;
+    const char* dir = ".";
+
+    for (int i = 1; i < argc; i++) {
+        const char* opt = argv[i];
+        const char* val = i + 1 < argc ? argv[i + 1] : NULL;
+        if (strcmp(opt, "--help") == 0 || strcmp(opt, "-h") == 0) {
+            usage(argv[0]);
+            return 0;
+        }
+        if (val == NULL) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+        if (strcmp(opt, "--entries") == 0 && atol(val) > 0) {
+            max_entries = (size_t)atol(val);
+        } else if (strcmp(opt, "--rounds") == 0 && atoi(val) > 0) {
+            g_rounds = atoi(val);
+        } else if (strcmp(opt, "--dir") == 0) {
+            dir = val;
+        } else if (strcmp(opt, "--workload") == 0) {
+            first = -1;
+            for (int w = 0; w < NUM_WORKLOADS; w++) {
+                if (strcmp(val, WORKLOAD_NAMES[w]) == 0) first = last = w;
+            }
+            if (strcmp(val, "all") == 0) {
+                first = 0;
+                last = NUM_WORKLOADS - 1;
+            }
+            if (first < 0) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    snprintf(g_path, sizeof(g_path), "%s/benchmark_pipeline.clog", dir);
+
+    printf("CNanoLog Writer Pipeline Microbenchmark\n");
+    printf("=======================================\n\n");
+
+    for (int k = 0; k < 4; k++) {
+        for (size_t c = 0; c < sizeof(g_long_text[k]) - 1; c++) {
+            g_long_text[k][c] = (char)('a' + (c * 7 + (size_t)k) % 26);
+        }
+        g_long_text[k][64 + k * 40] = '\0';  /* 64 to 184 characters */
+    }
+
+    /* The largest stream: MAX_STREAM_BYTES of the smallest entries */
+    size_t capacity = MAX_STREAM_BYTES / sizeof(cnanolog_entry_header_t) + 1;
+    if (max_entries < capacity) {
+        capacity = max_entries;
+    }
+    g_stream = (char*)malloc(MAX_STREAM_BYTES);
+    g_compressed = (char*)malloc(2 * MAX_STREAM_BYTES);
+    g_encoded = (char*)malloc(3 * MAX_STREAM_BYTES);
+    g_offsets = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    g_sites = (const log_site_t**)malloc(capacity * sizeof(const log_site_t*));
+    g_compressed_offsets = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    g_compressed_lens = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    g_encoded_lens = (uint32_t*)malloc(capacity * sizeof(uint32_t));
+    g_staging = staging_buffer_create(0);
+    if (g_stream == NULL || g_compressed == NULL || g_encoded == NULL || g_offsets == NULL ||
+        g_sites == NULL || g_compressed_offsets == NULL || g_compressed_lens == NULL ||
+        g_encoded_lens == NULL || g_staging == NULL ||
+        async_writer_init(&g_async, BINARY_WRITER_BUFFER_SIZE) != 0) {
+        printf("  ✗ out of memory\n");
+        return 1;
+    }
+    compress_history_init(&g_history);
+
+    int counters = counters_open();
+    if (counters == 0) {
+        printf("Hardware counters: not available (perf_event_open failed)\n");
+    } else {
+        printf("Hardware counters: %d of %d%s\n", counters, NUM_COUNTERS,
+               g_counters_user_only ? " (user space only)" : "");
+    }
+    printf("Best of %d rounds; MB/s is the stage's input, counters are per entry\n", g_rounds);
+
+    int failures = 0;
+    for (int w = first; w <= last; w++) {
+        failures += benchmark_workload(w, max_entries);
+    }
+
+    counters_close();
+    compress_history_destroy(&g_history);
+    async_writer_destroy(&g_async);
+    staging_buffer_destroy(g_staging);
+    free(g_stream);
+    free(g_compressed);
+    free(g_encoded);
+    free(g_offsets);
+    free(g_sites);
+    free(g_compressed_offsets);
+    free(g_compressed_lens);
+    free(g_encoded_lens);
+
+    printf("\n");
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,651 @@
+/*
+ * CNanoLog Benchmark Suite
+ *
+ * Runs a matrix of scenarios (output format x workload x load mode x
+ * thread count) and reports, per scenario:
+ * - Log call latency as HDR percentiles (p50 to p99.99 and max)
+ * - Throughput, drop rate, and the CPU the logger's own threads used
+ *
+ * Load modes:
+ * - Max rate: every producer logs back to back. Latency is the service
+ *   time of each call.
+ * - Fixed rate: every producer logs on a schedule of N calls per second.
+ *   Latency is measured from the scheduled start, so a call that stalls
+ *   also charges the calls queued behind it (coordinated-omission
+ *   correction). The uncorrected service time is reported next to it.
+ *
+ * Each scenario runs in its own process, so staging buffers and writer
+ * state never carry over. Results can be written as JSON and compared
+ * between commits with scripts/compare_benchmarks.py.
+ */
+
+#include <cnanolog.h>
+#include "../src/cycles.h"
+#include "../src/latency_histogram.h"
+#include "../src/tsc_calibration.h"
+#include <errno.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ============================================================================
+ * Configuration
+ * ============================================================================ */
+
+#define MAX_THREADS 64
+#define MAX_LIST 16
+#define DEFAULT_DURATION_MS 1000
+#define SPIN_LIMIT_NS 50000   /* Sleep instead of spinning for longer waits */
+
+typedef enum {
+    FORMAT_BINARY,
+    FORMAT_TEXT
+} output_t;
+
+static const char* const FORMAT_NAMES[] = {"binary", "text"};
+
+/* Workloads: argument type mixes and string-heavy entries */
+typedef void (*emit_fn)(uint64_t i);
+
+static const char* const SYMBOLS[] = {"AAPL", "MSFT", "GOOGL", "AMZN", "NVDA", "META", "TSLA"};
+
+static char g_long_text[4][192];
+
+static void emit_noargs(uint64_t i) {
+    (void)i;
+    LOG_INFO("heartbeat");
+}
+
+static void emit_int(uint64_t i) {
+    LOG_INFO("order %d qty %d", (int)i, (int)(i & 1023));
+}
+
+/* One argument type per site, all types in turn */
+static void emit_mixed(uint64_t i) {
+    switch (i % 6) {
+        case 0: LOG_INFO("seq %d", (int)i); break;
+        case 1: LOG_INFO("offset %llu", (unsigned long long)(i * 4096)); break;
+        case 2: LOG_INFO("price %f", 100.0 + (double)(i & 255) * 0.01); break;
+        case 3: LOG_INFO("side %c level %u", (i & 1) ? 'B' : 'S', (unsigned)(i & 15)); break;
+        case 4: LOG_INFO("book %p", (void*)(uintptr_t)(0x10000 + (i & 0xFFF0))); break;
+        default: LOG_INFO("symbol %s", SYMBOLS[i % 7]); break;
+    }
+}
+
+static void emit_string(uint64_t i) {
+    LOG_INFO("request %s from %s: %s", SYMBOLS[i % 7], SYMBOLS[(i + 3) % 7], g_long_text[i & 3]);
+}
+
+typedef struct {
+    const char* name;
+    emit_fn emit;
+} workload_t;
+
+static const workload_t WORKLOADS[] = {
+    {"noargs", emit_noargs},
+    {"int", emit_int},
+    {"mixed", emit_mixed},
+    {"string", emit_string},
+};
+#define NUM_WORKLOADS (sizeof(WORKLOADS) / sizeof(WORKLOADS[0]))
+
+/* Options */
+static int g_threads[MAX_LIST] = {1, 2, 4};
+static int g_num_threads = 3;
+static uint64_t g_rates[MAX_LIST] = {0, 100000};  /* Per thread, 0 = max rate */
+static int g_num_rates = 2;
+static int g_workloads[MAX_LIST] = {0, 1, 2, 3};
+static int g_num_workloads = 4;
+static int g_formats[2] = {FORMAT_BINARY, FORMAT_TEXT};
+static int g_num_formats = 2;
+static uint64_t g_duration_ms = DEFAULT_DURATION_MS;
+static const char* g_json_path = NULL;
+static const char* g_label = "";
+static const char* g_dir = ".";
+
+/* ============================================================================
+ * Clock
+ * ============================================================================ */
+
+static tsc_source_t g_source;
+static tsc_sample_t g_clock_start;
+
+static inline uint64_t now_ticks(void) {
+    return (g_source == TSC_SOURCE_CYCLES) ? rdtsc() : tsc_monotonic_ns();
+}
+
+/* Measured over the run so far (the run is seconds long, so ppm-accurate) */
+static uint64_t ticks_per_second(void) {
+    tsc_sample_t now;
+    tsc_sample(&now);
+    uint32_t uncertainty_ppb;
+    uint64_t frequency = tsc_measure_frequency(&g_clock_start, &now, &uncertainty_ppb);
+    if (frequency == 0) {
+        frequency = tsc_calibrate_quick(&now, &uncertainty_ppb);
+    }
+    return frequency;
+}
+
+static uint64_t thread_cpu_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static uint64_t process_cpu_ns(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return ((uint64_t)usage.ru_utime.tv_sec + (uint64_t)usage.ru_stime.tv_sec) * 1000000000ULL +
+           ((uint64_t)usage.ru_utime.tv_usec + (uint64_t)usage.ru_stime.tv_usec) * 1000ULL;
+}
+
+/* ============================================================================
+ * Scenario
+ * ============================================================================ */
+
+typedef struct {
+    output_t format;
+    int workload;
+    int threads;
+    uint64_t rate;      /* Calls per second per thread, 0 = max rate */
+} scenario_t;
+
+/* Latencies in nanoseconds */
+typedef struct {
+    uint64_t p50, p90, p99, p999, p9999, max;
+    double mean;
+} latency_summary_t;
+
+typedef struct {
+    int ok;
+    uint64_t calls;
+    uint64_t drops;
+    double seconds;           /* Producers' run */
+    double drain_seconds;     /* Shutdown: writing what was still staged */
+    double writer_cpu;        /* Cores used outside the producers, whole run */
+    latency_summary_t response;  /* From the scheduled start (fixed rate) */
+    latency_summary_t service;   /* From the actual start */
+} scenario_result_t;
+
+typedef struct {
+    pthread_t thread;
+    int index;
+    const scenario_t* scenario;
+    latency_histogram_t response;
+    latency_histogram_t service;
+    uint64_t response_sum;
+    uint64_t service_sum;
+    uint64_t calls;
+    uint64_t cpu_ns;
+} producer_t;
+
+static volatile int g_go = 0;
+static uint64_t g_run_start;
+static uint64_t g_run_ticks;
+static uint64_t g_ticks_per_sec;
+
+static void wait_until(uint64_t target) {
+    for (;;) {
+        uint64_t now = now_ticks();
+        if (now >= target) {
+            return;
+        }
+        uint64_t wait_ns = (target - now) * 1000000000ULL / g_ticks_per_sec;
+        if (wait_ns > SPIN_LIMIT_NS) {
+            uint64_t sleep_ns = wait_ns - SPIN_LIMIT_NS / 2;
+            struct timespec ts = {(time_t)(sleep_ns / 1000000000ULL),
+                                  (long)(sleep_ns % 1000000000ULL)};
+            nanosleep(&ts, NULL);
+        }
+    }
+}
+
+static void* producer_main(void* arg) {
+    producer_t* p = (producer_t*)arg;
+    const scenario_t* s = p->scenario;
+    emit_fn emit = WORKLOADS[s->workload].emit;
+
+    cnanolog_preallocate();
+    emit(0);  /* Site registration and first touch */
+    uint64_t cpu_start = thread_cpu_ns();
+
+    while (!__atomic_load_n(&g_go, __ATOMIC_ACQUIRE)) {
+        sched_yield();
+    }
+    uint64_t end = g_run_start + g_run_ticks;
+    uint64_t i = 1;
+
+    if (s->rate == 0) {
+        uint64_t t0;
+        while ((t0 = now_ticks()) < end) {
+            emit(i++);
+            uint64_t elapsed = now_ticks() - t0;
+            latency_record(&p->service, elapsed);
+            p->service_sum += elapsed;
+        }
+    } else {
+        /* Threads start staggered within one interval */
+        uint64_t interval = g_ticks_per_sec / s->rate;
+        if (interval == 0) {
+            interval = 1;
+        }
+        uint64_t scheduled = g_run_start + interval * (uint64_t)p->index / (uint64_t)s->threads;
+        while (scheduled < end) {
+            wait_until(scheduled);
+            uint64_t t0 = now_ticks();
+            emit(i++);
+            uint64_t t1 = now_ticks();
+            latency_record(&p->service, t1 - t0);
+            latency_record(&p->response, t1 - scheduled);
+            p->service_sum += t1 - t0;
+            p->response_sum += t1 - scheduled;
+            scheduled += interval;
+        }
+    }
+
+    p->calls = i - 1;
+    p->cpu_ns = thread_cpu_ns() - cpu_start;
+    return NULL;
+}
+
+static void summarize(latency_summary_t* out, const latency_histogram_t* h, uint64_t sum) {
+    double ns_per_tick = 1e9 / (double)g_ticks_per_sec;
+    uint64_t count = latency_count(h);
+    out->p50 = (uint64_t)(latency_percentile(h, 50.0) * ns_per_tick);
+    out->p90 = (uint64_t)(latency_percentile(h, 90.0) * ns_per_tick);
+    out->p99 = (uint64_t)(latency_percentile(h, 99.0) * ns_per_tick);
+    out->p999 = (uint64_t)(latency_percentile(h, 99.9) * ns_per_tick);
+    out->p9999 = (uint64_t)(latency_percentile(h, 99.99) * ns_per_tick);
+    out->max = (uint64_t)((double)h->max * ns_per_tick);
+    out->mean = count > 0 ? (double)sum / (double)count * ns_per_tick : 0.0;
+}
+
+static int start_logger(const scenario_t* s, char* path, size_t path_size) {
+    snprintf(path, path_size, "%s/benchmark_suite_%d.%s", g_dir, (int)getpid(),
+             s->format == FORMAT_TEXT ? "log" : "clog");
+    unlink(path);
+    if (s->format == FORMAT_BINARY) {
+        return cnanolog_init(path);
+    }
+    cnanolog_rotation_config_t config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = path,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = NULL
+    };
+    return cnanolog_init_ex(&config);
+}
+
+/* Runs in the scenario's own process */
+static void run_scenario(const scenario_t* s, scenario_result_t* result) {
+    static producer_t producers[MAX_THREADS];
+    memset(result, 0, sizeof(*result));
+    memset(producers, 0, sizeof(producers));
+
+    char path[512];
+    uint64_t process_cpu_start = process_cpu_ns();
+    uint64_t main_cpu_start = thread_cpu_ns();
+    uint64_t wall_start = tsc_monotonic_ns();
+    if (start_logger(s, path, sizeof(path)) != 0) {
+        return;
+    }
+
+    g_ticks_per_sec = ticks_per_second();
+    g_run_ticks = g_duration_ms * g_ticks_per_sec / 1000;
+    for (int t = 0; t < s->threads; t++) {
+        producers[t].index = t;
+        producers[t].scenario = s;
+        pthread_create(&producers[t].thread, NULL, producer_main, &producers[t]);
+    }
+    usleep(50000);  /* Producers ready */
+    g_run_start = now_ticks() + g_ticks_per_sec / 1000;
+    __atomic_store_n(&g_go, 1, __ATOMIC_RELEASE);
+
+    for (int t = 0; t < s->threads; t++) {
+        pthread_join(producers[t].thread, NULL);
+    }
+    double run_end = (double)tsc_monotonic_ns();
+
+    cnanolog_buffer_info_t buffers[MAX_THREADS + 1];
+    int num_buffers = cnanolog_get_buffer_info(buffers, MAX_THREADS + 1);
+    for (int b = 0; b < num_buffers && b < MAX_THREADS + 1; b++) {
+        result->drops += buffers[b].drops;
+    }
+
+    cnanolog_shutdown();
+    double shutdown_end = (double)tsc_monotonic_ns();
+    unlink(path);
+
+    /* Everything not spent in producers or here: writer, formatters */
+    uint64_t producer_cpu = 0;
+    latency_histogram_t* response = (latency_histogram_t*)calloc(1, sizeof(latency_histogram_t));
+    latency_histogram_t* service = (latency_histogram_t*)calloc(1, sizeof(latency_histogram_t));
+    if (response == NULL || service == NULL) {
+        free(response);
+        free(service);
+        return;
+    }
+    uint64_t response_sum = 0, service_sum = 0;
+    for (int t = 0; t < s->threads; t++) {
+        producer_cpu += producers[t].cpu_ns;
+        result->calls += producers[t].calls;
+        response_sum += producers[t].response_sum;
+        service_sum += producers[t].service_sum;
+        latency_merge(response, &producers[t].response);
+        latency_merge(service, &producers[t].service);
+    }
+    uint64_t other_cpu = process_cpu_ns() - process_cpu_start;
+    uint64_t main_cpu = thread_cpu_ns() - main_cpu_start;
+    other_cpu = (other_cpu > producer_cpu + main_cpu) ? other_cpu - producer_cpu - main_cpu : 0;
+
+    result->seconds = (double)g_run_ticks / (double)g_ticks_per_sec;
+    result->drain_seconds = (shutdown_end - run_end) / 1e9;
+    result->writer_cpu = (double)other_cpu / (shutdown_end - (double)wall_start);
+    if (s->rate == 0) {
+        /* No schedule to fall behind: the response is the service time */
+        summarize(&result->response, service, service_sum);
+    } else {
+        summarize(&result->response, response, response_sum);
+    }
+    summarize(&result->service, service, service_sum);
+    result->ok = 1;
+    free(response);
+    free(service);
+}
+
+/* Fork, run, and read the result back through a pipe */
+static int run_isolated(const scenario_t* s, scenario_result_t* result) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return -1;
+    }
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        close(fds[0]);
+        run_scenario(s, result);
+        ssize_t n = write(fds[1], result, sizeof(*result));
+        _exit(n == (ssize_t)sizeof(*result) ? 0 : 1);
+    }
+
+    close(fds[1]);
+    memset(result, 0, sizeof(*result));
+    size_t got = 0;
+    while (got < sizeof(*result)) {
+        ssize_t n = read(fds[0], (char*)result + got, sizeof(*result) - got);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            break;
+        }
+        got += (size_t)n;
+    }
+    close(fds[0]);
+    int status;
+    waitpid(pid, &status, 0);
+    return (got == sizeof(*result) && result->ok) ? 0 : -1;
+}
+
+/* ============================================================================
+ * Output
+ * ============================================================================ */
+
+static void scenario_name(const scenario_t* s, char* out, size_t size) {
+    if (s->rate == 0) {
+        snprintf(out, size, "%s/%s/max/%dt", FORMAT_NAMES[s->format],
+                 WORKLOADS[s->workload].name, s->threads);
+    } else {
+        snprintf(out, size, "%s/%s/%llu/%dt", FORMAT_NAMES[s->format],
+                 WORKLOADS[s->workload].name, (unsigned long long)s->rate, s->threads);
+    }
+}
+
+static void print_result(const scenario_t* s, const scenario_result_t* r) {
+    char name[128];
+    scenario_name(s, name, sizeof(name));
+    double drop_percent = r->calls > 0 ? 100.0 * (double)r->drops / (double)r->calls : 0.0;
+    printf("  %-30s %7.2f M/s  p50 %6llu  p99 %7llu  p99.9 %8llu  max %9llu ns"
+           "  drop %6.3f%%  writer %3.0f%%\n",
+           name, (double)(r->calls - r->drops) / r->seconds / 1e6,
+           (unsigned long long)r->response.p50, (unsigned long long)r->response.p99,
+           (unsigned long long)r->response.p999, (unsigned long long)r->response.max,
+           drop_percent, r->writer_cpu * 100.0);
+}
+
+/* Quote a string for JSON (control characters dropped) */
+static void json_string(FILE* f, const char* text) {
+    fputc('"', f);
+    for (const char* c = text; *c != '\0'; c++) {
+        if (*c == '"' || *c == '\\') {
+            fputc('\\', f);
+        }
+        if ((unsigned char)*c >= 0x20) {
+            fputc(*c, f);
+        }
+    }
+    fputc('"', f);
+}
+
+static void json_latency(FILE* f, const char* key, const latency_summary_t* l) {
+    fprintf(f, "      \"%s\": {\"p50\": %llu, \"p90\": %llu, \"p99\": %llu, \"p99.9\": %llu, "
+               "\"p99.99\": %llu, \"max\": %llu, \"mean\": %.1f}",
+            key, (unsigned long long)l->p50, (unsigned long long)l->p90,
+            (unsigned long long)l->p99, (unsigned long long)l->p999,
+            (unsigned long long)l->p9999, (unsigned long long)l->max, l->mean);
+}
+
+static void json_result(FILE* f, const scenario_t* s, const scenario_result_t* r, int first) {
+    char name[128];
+    scenario_name(s, name, sizeof(name));
+    fprintf(f, "%s    {\n", first ? "" : ",\n");
+    fprintf(f, "      \"name\": \"%s\",\n", name);
+    fprintf(f, "      \"format\": \"%s\",\n", FORMAT_NAMES[s->format]);
+    fprintf(f, "      \"workload\": \"%s\",\n", WORKLOADS[s->workload].name);
+    fprintf(f, "      \"mode\": \"%s\",\n", s->rate == 0 ? "max" : "fixed");
+    fprintf(f, "      \"rate_per_thread\": %llu,\n", (unsigned long long)s->rate);
+    fprintf(f, "      \"threads\": %d,\n", s->threads);
+    fprintf(f, "      \"seconds\": %.3f,\n", r->seconds);
+    fprintf(f, "      \"calls\": %llu,\n", (unsigned long long)r->calls);
+    fprintf(f, "      \"dropped\": %llu,\n", (unsigned long long)r->drops);
+    fprintf(f, "      \"drop_rate\": %.6f,\n",
+            r->calls > 0 ? (double)r->drops / (double)r->calls : 0.0);
+    fprintf(f, "      \"throughput_per_sec\": %.0f,\n", (double)(r->calls - r->drops) / r->seconds);
+    fprintf(f, "      \"writer_cpu\": %.3f,\n", r->writer_cpu);
+    fprintf(f, "      \"drain_seconds\": %.3f,\n", r->drain_seconds);
+    json_latency(f, "latency_ns", &r->response);
+    fprintf(f, ",\n");
+    json_latency(f, "service_ns", &r->service);
+    fprintf(f, "\n    }");
+}
+
+/* ============================================================================
+ * Main
+ * ============================================================================ */
+
+static void usage(const char* program) {
+    printf("Usage: %s [options]\n\n", program);
+    printf("  --threads LIST     Producer thread counts, 1-%d (default 1,2,4)\n", MAX_THREADS);
+    printf("  --full             Threads 1,2,4,8,16,32,64\n");
+    printf("  --rates LIST       Calls/s per thread, 0 = max rate (default 0,100000)\n");
+    printf("  --workloads LIST   noargs,int,mixed,string (default all)\n");
+    printf("  --formats LIST     binary,text (default both)\n");
+    printf("  --duration MS      Measured time per scenario (default %d)\n", DEFAULT_DURATION_MS);
+    printf("  --json FILE        Write the results as JSON\n");
+    printf("  --label TEXT       Stored in the JSON (e.g. the commit)\n");
+    printf("  --dir DIR          Directory for the log files (default .)\n");
+}
+
+/* Comma-separated list; names are looked up in a table when given */
+static int parse_list(const char* arg, const char* const* names, int num_names,
+                      uint64_t* out, int max) {
+    char copy[256];
+    snprintf(copy, sizeof(copy), "%s", arg);
+    int count = 0;
+    for (char* item = strtok(copy, ","); item != NULL; item = strtok(NULL, ",")) {
+        if (count == max) {
+            return -1;
+        }
+        if (names == NULL) {
+            char* end;
+            out[count++] = strtoull(item, &end, 10);
+            if (*end != '\0') {
+                return -1;
+            }
+            continue;
+        }
+        int found = -1;
+        for (int n = 0; n < num_names; n++) {
+            if (strcmp(item, names[n]) == 0) {
+                found = n;
+            }
+        }
+        if (found < 0) {
+            return -1;
+        }
+        out[count++] = (uint64_t)found;
+    }
+    return count;
+}
+
+static int parse_args(int argc, char** argv) {
+    const char* workload_names[NUM_WORKLOADS];
+    for (size_t w = 0; w < NUM_WORKLOADS; w++) {
+        workload_names[w] = WORKLOADS[w].name;
+    }
+    uint64_t values[MAX_LIST];
+
+    for (int i = 1; i < argc; i++) {
+        const char* opt = argv[i];
+        const char* val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int n;
+        if (strcmp(opt, "--full") == 0) {
+            static const int full[] = {1, 2, 4, 8, 16, 32, 64};
+            g_num_threads = (int)(sizeof(full) / sizeof(full[0]));
+            memcpy(g_threads, full, sizeof(full));
+            continue;
+        }
+        if (strcmp(opt, "--help") == 0 || val == NULL) {
+            return -1;
+        }
+        i++;
+        if (strcmp(opt, "--threads") == 0) {
+            if ((n = parse_list(val, NULL, 0, values, MAX_LIST)) <= 0) return -1;
+            for (int k = 0; k < n; k++) {
+                if (values[k] < 1 || values[k] > MAX_THREADS) return -1;
+                g_threads[k] = (int)values[k];
+            }
+            g_num_threads = n;
+        } else if (strcmp(opt, "--rates") == 0) {
+            if ((n = parse_list(val, NULL, 0, g_rates, MAX_LIST)) <= 0) return -1;
+            g_num_rates = n;
+        } else if (strcmp(opt, "--workloads") == 0) {
+            if ((n = parse_list(val, workload_names, (int)NUM_WORKLOADS, values, MAX_LIST)) <= 0) {
+                return -1;
+            }
+            for (int k = 0; k < n; k++) g_workloads[k] = (int)values[k];
+            g_num_workloads = n;
+        } else if (strcmp(opt, "--formats") == 0) {
+            if ((n = parse_list(val, FORMAT_NAMES, 2, values, 2)) <= 0) return -1;
+            for (int k = 0; k < n; k++) g_formats[k] = (int)values[k];
+            g_num_formats = n;
+        } else if (strcmp(opt, "--duration") == 0) {
+            g_duration_ms = strtoull(val, NULL, 10);
+            if (g_duration_ms == 0) return -1;
+        } else if (strcmp(opt, "--json") == 0) {
+            g_json_path = val;
+        } else if (strcmp(opt, "--label") == 0) {
+            g_label = val;
+        } else if (strcmp(opt, "--dir") == 0) {
+            g_dir = val;
+        } else {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (parse_args(argc, argv) != 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (int k = 0; k < 4; k++) {
+        for (size_t c = 0; c < sizeof(g_long_text[k]) - 1; c++) {
+            g_long_text[k][c] = (char)('a' + (c * 7 + (size_t)k) % 26);
+        }
+        g_long_text[k][64 + k * 40] = '\0';  /* 64 to 184 characters */
+    }
+
+    g_source = tsc_select_source();
+    tsc_sample(&g_clock_start);
+    usleep(100000);
+    g_ticks_per_sec = ticks_per_second();
+
+    printf("CNanoLog Benchmark Suite\n");
+    printf("========================\n");
+    printf("Clock: %s, %.3f GHz; %ld CPUs; %llu ms per scenario\n\n",
+           g_source == TSC_SOURCE_CYCLES ? "TSC" : "CLOCK_MONOTONIC", g_ticks_per_sec / 1e9,
+           sysconf(_SC_NPROCESSORS_ONLN), (unsigned long long)g_duration_ms);
+
+    FILE* json = NULL;
+    if (g_json_path != NULL) {
+        json = fopen(g_json_path, "w");
+        if (json == NULL) {
+            fprintf(stderr, "Cannot write %s\n", g_json_path);
+            return 1;
+        }
+        fprintf(json, "{\n  \"suite\": \"cnanolog\",\n  \"label\": ");
+        json_string(json, g_label);
+        fprintf(json, ",\n");
+        fprintf(json, "  \"cpus\": %ld,\n  \"clock\": \"%s\",\n  \"ticks_per_sec\": %llu,\n",
+                sysconf(_SC_NPROCESSORS_ONLN), g_source == TSC_SOURCE_CYCLES ? "tsc" : "monotonic",
+                (unsigned long long)g_ticks_per_sec);
+        fprintf(json, "  \"duration_ms\": %llu,\n  \"results\": [\n",
+                (unsigned long long)g_duration_ms);
+    }
+
+    int failures = 0;
+    int first = 1;
+    for (int f = 0; f < g_num_formats; f++) {
+        for (int w = 0; w < g_num_workloads; w++) {
+            for (int r = 0; r < g_num_rates; r++) {
+                for (int t = 0; t < g_num_threads; t++) {
+                    scenario_t s = {(output_t)g_formats[f], g_workloads[w], g_threads[t], g_rates[r]};
+                    scenario_result_t result;
+                    if (run_isolated(&s, &result) != 0) {
+                        char name[128];
+                        scenario_name(&s, name, sizeof(name));
+                        printf("  %-30s FAILED\n", name);
+                        failures++;
+                        continue;
+                    }
+                    print_result(&s, &result);
+                    if (json != NULL) {
+                        json_result(json, &s, &result, first);
+                        first = 0;
+                    }
+                }
+            }
+        }
+    }
+
+    if (json != NULL) {
+        fprintf(json, "\n  ]\n}\n");
+        fclose(json);
+        printf("\nResults written to %s\n", g_json_path);
+    }
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/*
+ * Staging buffer health tests
+ * Checks cnanolog_get_buffer_info(): one entry per logging thread with its
+ * name, the bytes each produced, high-water marks and drain times, and
+ * drops that add up to the global statistics.
+ */
+
+#if defined(__linux__)
+    #define _GNU_SOURCE  /* pthread_setname_np */
+#endif
+
+#include "../include/cnanolog.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_buffer_health.clog";
+
+#define MAX_INFO 16
+
+typedef struct {
+    const char* name;   /* Set with cnanolog_set_thread_name (NULL = OS name) */
+    int entries;
+} thread_plan_t;
+
+static void* log_thread(void* arg) {
+    const thread_plan_t* plan = (const thread_plan_t*)arg;
+    if (plan->name != NULL) {
+        cnanolog_set_thread_name(plan->name);
+    } else {
+#if defined(__linux__)
+        pthread_setname_np(pthread_self(), "os-named");
+#endif
+    }
+    for (int i = 0; i < plan->entries; i++) {
+        LOG_INFO("entry %d of %s", i, "health");
+    }
+    return NULL;
+}
+
+static const cnanolog_buffer_info_t* find(const cnanolog_buffer_info_t* info, int n,
+                                          const char* name) {
+    for (int i = 0; i < n; i++) {
+        if (strcmp(info[i].name, name) == 0) return &info[i];
+    }
+    return NULL;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int test_not_initialized() {
+    cnanolog_buffer_info_t info[MAX_INFO];
+    if (cnanolog_get_buffer_info(info, MAX_INFO) != 0) TEST_FAIL("buffers before init");
+    if (cnanolog_set_thread_name("early") != -1) TEST_FAIL("named before init");
+    TEST_PASS();
+    return 0;
+}
+
+int test_per_thread_info() {
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+
+    thread_plan_t plans[3] = {{"flooder", 50000}, {"quiet", 100}, {NULL, 10}};
+    pthread_t threads[3];
+    for (int t = 0; t < 3; t++) {
+        pthread_create(&threads[t], NULL, log_thread, &plans[t]);
+    }
+    for (int t = 0; t < 3; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    usleep(300000);  /* Let the writer take everything */
+
+    cnanolog_buffer_info_t info[MAX_INFO];
+    int n = cnanolog_get_buffer_info(info, MAX_INFO);
+    if (n != 3) TEST_FAIL("expected one buffer per logging thread");
+    for (int i = 0; i < n; i++) {
+        printf("    thread %u %-10s produced %8llu bytes, peak %7llu, drained %llu us ago\n",
+               info[i].thread_id, info[i].name, (unsigned long long)info[i].bytes_produced,
+               (unsigned long long)info[i].high_water,
+               (unsigned long long)(info[i].ns_since_drain / 1000));
+    }
+
+    const cnanolog_buffer_info_t* flooder = find(info, n, "flooder");
+    const cnanolog_buffer_info_t* quiet = find(info, n, "quiet");
+    if (flooder == NULL || quiet == NULL) TEST_FAIL("names not reported");
+#if defined(__linux__)
+    if (find(info, n, "os-named") == NULL) TEST_FAIL("OS thread name not picked up");
+#endif
+    if (flooder->thread_id == quiet->thread_id) TEST_FAIL("thread ids not distinct");
+
+    /* 50000 entries of header + int + string, 100 of the same */
+    if (flooder->bytes_produced != 500 * quiet->bytes_produced) TEST_FAIL("bytes not per thread");
+    if (quiet->bytes_produced < 100 * 16) TEST_FAIL("bytes produced too low");
+
+    for (int i = 0; i < n; i++) {
+        if (info[i].capacity == 0) TEST_FAIL("no capacity");
+        if (info[i].used != 0 || info[i].fill_percent != 0) TEST_FAIL("drained buffer not empty");
+        if (info[i].high_water == 0 || info[i].high_water > info[i].bytes_produced) {
+            TEST_FAIL("high-water mark out of range");
+        }
+        if (info[i].drops != 0) TEST_FAIL("unexpected drops");
+        if (info[i].ns_since_drain == UINT64_MAX || info[i].ns_since_drain > 10000000000ULL) {
+            TEST_FAIL("drain time not recorded");
+        }
+    }
+
+    /* Short array: only that many filled, the total still returned */
+    cnanolog_buffer_info_t one[2];
+    memset(one, 0xAB, sizeof(one));
+    if (cnanolog_get_buffer_info(one, 1) != 3) TEST_FAIL("total not returned");
+    if (one[0].capacity == 0 || one[1].capacity != 0xABABABABABABABABULL) TEST_FAIL("array overrun");
+    if (cnanolog_get_buffer_info(NULL, 0) != 3) TEST_FAIL("count query failed");
+
+    cnanolog_shutdown();
+    unlink(LOG_PATH);
+    TEST_PASS();
+    return 0;
+}
+
+int test_rename_and_drops() {
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+
+    /* Buffers outlive shutdown (threads keep pointing at them) */
+    int before = cnanolog_get_buffer_info(NULL, 0);
+    cnanolog_stats_t stats;
+    cnanolog_get_stats(&stats);
+    uint64_t dropped_before = stats.dropped_logs;
+
+    /* Naming before logging creates the buffer; long names are truncated */
+    if (cnanolog_set_thread_name("a-thread-name-well-over-the-limit-of-31") != 0) {
+        TEST_FAIL("set name failed");
+    }
+    cnanolog_buffer_info_t info[MAX_INFO];
+    if (cnanolog_get_buffer_info(info, MAX_INFO) != before + 1) TEST_FAIL("no buffer after naming");
+    const cnanolog_buffer_info_t* mine = &info[before];
+    if (strcmp(mine->name, "a-thread-name-well-over-the-lim") != 0) TEST_FAIL("name not truncated");
+    if (mine->bytes_produced != 0 || mine->ns_since_drain != UINT64_MAX) {
+        TEST_FAIL("unused buffer has activity");
+    }
+    cnanolog_set_thread_name("main");
+
+    /* Entries over the size limit are dropped and counted per thread */
+    size_t big_len = 2 * 1024 * 1024;
+    char* big = (char*)malloc(big_len + 1);
+    memset(big, 'x', big_len);
+    big[big_len] = '\0';
+    for (int i = 0; i < 5; i++) {
+        LOG_WARN("too large %s", big);
+    }
+    free(big);
+
+    cnanolog_get_stats(&stats);
+    if (cnanolog_get_buffer_info(info, MAX_INFO) != before + 1) TEST_FAIL("buffer count changed");
+    if (strcmp(mine->name, "main") != 0) TEST_FAIL("rename not reported");
+    if (mine->drops != 5) TEST_FAIL("drops not counted for the thread");
+#if !defined(CNANOLOG_NO_TIMESTAMPS) && !defined(CNANOLOG_NO_STATISTICS)
+    if (stats.dropped_logs - dropped_before != mine->drops) TEST_FAIL("drops differ from statistics");
+#endif
+
+    cnanolog_shutdown();
+    unlink(LOG_PATH);
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Buffer Health Tests\n");
+    printf("============================\n\n");
+
+    failures += test_not_initialized();
+    failures += test_per_thread_info();
+    failures += test_rename_and_drops();
+
+    printf("\n============================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
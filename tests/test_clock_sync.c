@@ -0,0 +1,163 @@
+/*
+ * Clock sync tests
+ * Verifies that binary files carry periodic sync records that are not
+ * counted as entries, and that CNANOLOG_CLOCK=system switches timestamps
+ * to CLOCK_MONOTONIC nanoseconds.
+ */
+
+#include "../include/cnanolog.h"
+#include "../include/cnanolog_format.h"
+#include "../src/tsc_calibration.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_clock_sync.clog";
+
+#define MAX_RECORDS 64
+
+typedef struct {
+    cnanolog_file_header_t header;
+    uint32_t num_entries;
+    uint64_t entry_timestamps[MAX_RECORDS];
+    uint32_t num_syncs;
+    uint64_t sync_timestamps[MAX_RECORDS];
+    cnanolog_sync_record_t syncs[MAX_RECORDS];
+} parsed_log_t;
+
+/* Walk the entry section up to the dictionary */
+static int parse_log(parsed_log_t* log) {
+    memset(log, 0, sizeof(*log));
+    FILE* f = fopen(LOG_PATH, "rb");
+    if (f == NULL) return -1;
+
+    if (fread(&log->header, 1, sizeof(log->header), f) != sizeof(log->header)) {
+        fclose(f);
+        return -1;
+    }
+
+    long offset = (long)sizeof(log->header);
+    while ((uint64_t)offset < log->header.dictionary_offset) {
+        cnanolog_entry_header_t entry;
+        if (fread(&entry, 1, sizeof(entry), f) != sizeof(entry)) break;
+
+        if (entry.log_id == CNANOLOG_SYNC_LOG_ID) {
+            if (log->num_syncs < MAX_RECORDS &&
+                fread(&log->syncs[log->num_syncs], 1, sizeof(cnanolog_sync_record_t), f) ==
+                    sizeof(cnanolog_sync_record_t)) {
+                log->sync_timestamps[log->num_syncs++] = entry.timestamp;
+            }
+        } else {
+            if (log->num_entries < MAX_RECORDS) {
+                log->entry_timestamps[log->num_entries] = entry.timestamp;
+            }
+            log->num_entries++;
+        }
+        offset += (long)sizeof(entry) + entry.data_length;
+        fseek(f, offset, SEEK_SET);
+    }
+
+    fclose(f);
+    return 0;
+}
+
+int test_periodic_sync_records() {
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+
+    /* Span more than one sync interval */
+    for (int i = 0; i < 6; i++) {
+        LOG_INFO("sync %d", i);
+        struct timespec pause = {0, 250000000};
+        nanosleep(&pause, NULL);
+    }
+    cnanolog_shutdown();
+
+    parsed_log_t log;
+    if (parse_log(&log) != 0) TEST_FAIL("cannot read log");
+
+    if (!(log.header.flags & CNANOLOG_FLAG_HAS_SYNC_RECORDS)) TEST_FAIL("sync flag not set");
+    if (log.header.entry_count != 6 || log.num_entries != 6) TEST_FAIL("sync records counted as entries");
+    /* Startup, at least one periodic, shutdown */
+    if (log.num_syncs < 3) TEST_FAIL("too few sync records");
+
+    if (log.sync_timestamps[0] != log.header.start_timestamp) TEST_FAIL("first sync is not the header anchor");
+
+    for (uint32_t i = 1; i < log.num_syncs; i++) {
+        uint64_t ticks = log.sync_timestamps[i] - log.sync_timestamps[i - 1];
+        uint64_t ns = log.syncs[i].mono_ns - log.syncs[i - 1].mono_ns;
+        if (log.sync_timestamps[i] <= log.sync_timestamps[i - 1] || ns == 0) {
+            TEST_FAIL("sync records out of order");
+        }
+
+        /* Each segment runs at the header frequency (1% covers scheduling noise) */
+        double segment_hz = (double)ticks * 1e9 / (double)ns;
+        double error = segment_hz / (double)log.header.timestamp_frequency - 1.0;
+        if (error > 0.01 || error < -0.01) TEST_FAIL("segment rate disagrees with header");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+int test_system_clock_fallback() {
+    unlink(LOG_PATH);
+    setenv("CNANOLOG_CLOCK", "system", 1);
+    int rc = cnanolog_init(LOG_PATH);
+    unsetenv("CNANOLOG_CLOCK");
+    if (rc != 0) TEST_FAIL("init failed");
+
+    uint64_t before = tsc_monotonic_ns();
+    LOG_INFO("monotonic %d", 1);
+    uint64_t after = tsc_monotonic_ns();
+    cnanolog_shutdown();
+
+    parsed_log_t log;
+    if (parse_log(&log) != 0) TEST_FAIL("cannot read log");
+
+    if (log.header.timestamp_frequency != 1000000000ULL) TEST_FAIL("frequency is not 1GHz");
+    if (log.header.frequency_uncertainty_ppb != 0) TEST_FAIL("monotonic clock reported uncertainty");
+    if (log.num_entries != 1) TEST_FAIL("entry missing");
+    if (log.entry_timestamps[0] < before || log.entry_timestamps[0] > after) {
+        TEST_FAIL("timestamp is not CLOCK_MONOTONIC");
+    }
+    if (log.num_syncs < 2 || log.syncs[0].mono_ns != log.sync_timestamps[0]) {
+        TEST_FAIL("sync records do not match the monotonic clock");
+    }
+
+    /* Later inits pick the counter again */
+    if (tsc_select_source() != (tsc_is_invariant() ? TSC_SOURCE_CYCLES : TSC_SOURCE_MONOTONIC)) {
+        TEST_FAIL("source selection ignores invariance");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Clock Sync Tests\n");
+    printf("=========================\n\n");
+
+    failures += test_periodic_sync_records();
+    failures += test_system_clock_fallback();
+
+    unlink(LOG_PATH);
+
+    printf("\n=========================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
@@ -44,19 +44,24 @@ static int decompress_entry_args_test(const char* compressed,
     int nibble_idx = 0;
     int int_arg_idx = 0;
 
+    /* compress_entry_args() without history encodes against zeroed slots
+     * and an empty string table */
+    delta_slot_t history[16];
+    memset(history, 0, sizeof(history));
+    static string_intern_t strings;
+    string_intern_reset(&strings);
+
     for (uint8_t i = 0; i < site->num_args; i++) {
         switch (site->arg_types[i]) {
             case ARG_TYPE_INT32: {
-                if (read_ptr >= end_ptr) return -1;
 
                 uint8_t nibble = get_nibble(nibbles, nibble_idx++);
-                uint8_t num_bytes = nibble & 0x07;
-                int is_negative = (nibble & 0x08) ? 1 : 0;
-
-                if (num_bytes == 0 || num_bytes > 4) return -1;
 
-                int32_t val = unpack_int32(&read_ptr, num_bytes, is_negative);
-                int_values[int_arg_idx++] = (uint64_t)(uint32_t)val;
+                uint64_t val;
+                if (unpack_int_delta(&read_ptr, end_ptr, nibble, 1, &history[i], &val) != 0) {
+                    return -1;
+                }
+                int_values[int_arg_idx++] = val;
                 break;
             }
 
@@ -83,23 +88,20 @@ static int decompress_entry_args_test(const char* compressed,
             }
 
             case ARG_TYPE_STRING: {
-                /* Read and write string from compressed stream */
-                if (read_ptr + sizeof(uint32_t) > end_ptr) return -1;
-
+                /* Read string from compressed stream (intern id or text) */
+                const char* str;
                 uint32_t str_len;
-                memcpy(&str_len, read_ptr, sizeof(uint32_t));
-                read_ptr += sizeof(uint32_t);
+                if (unpack_string_interned(&read_ptr, end_ptr, &strings,
+                                           &str, &str_len) != 0) {
+                    return -1;
+                }
 
-                if (write_ptr + sizeof(uint32_t) > write_end) return -1;
+                if (write_ptr + sizeof(uint32_t) + str_len > write_end) return -1;
                 memcpy(write_ptr, &str_len, sizeof(uint32_t));
                 write_ptr += sizeof(uint32_t);
 
                 if (str_len > 0) {
-                    if (read_ptr + str_len > end_ptr) return -1;
-                    if (write_ptr + str_len > write_end) return -1;
-
-                    memcpy(write_ptr, read_ptr, str_len);
-                    read_ptr += str_len;
+                    memcpy(write_ptr, str, str_len);
                     write_ptr += str_len;
                 }
                 break;
@@ -136,7 +138,7 @@ void test_single_int() {
     char compressed[64];
     size_t compressed_len = 0;
     int result = compress_entry_args(uncompressed, uncompressed_len,
-                                      compressed, &compressed_len, &site);
+                                      compressed, &compressed_len, &site, NULL, NULL);
 
     printf("  Compress result: %d\n", result);
     printf("  Uncompressed size: %zu bytes\n", uncompressed_len);
@@ -177,7 +179,7 @@ void test_two_ints() {
     char compressed[64];
     size_t compressed_len = 0;
     int result = compress_entry_args(uncompressed, uncompressed_len,
-                                      compressed, &compressed_len, &site);
+                                      compressed, &compressed_len, &site, NULL, NULL);
 
     printf("  Compress result: %d\n", result);
     printf("  Uncompressed size: %zu bytes\n", uncompressed_len);
@@ -199,8 +201,7 @@ void test_two_ints() {
         const uint8_t* nibbles = (const uint8_t*)compressed;
         for (int i = 0; i < num_int_args; i++) {
             uint8_t nibble = get_nibble(nibbles, i);
-            printf("  Nibble[%d]: 0x%x (size=%d, sign=%d)\n",
-                   i, nibble, nibble & 0x07, (nibble & 0x08) ? 1 : 0);
+            printf("  Nibble[%d]: 0x%x\n", i, nibble);
         }
 
         // Decompress
@@ -267,7 +268,7 @@ void test_int_and_string() {
     char compressed[128];
     size_t compressed_len = 0;
     int result = compress_entry_args(uncompressed, uncompressed_len,
-                                      compressed, &compressed_len, &site);
+                                      compressed, &compressed_len, &site, NULL, NULL);
 
     printf("  Compress result: %d\n", result);
     printf("  Uncompressed size: %zu bytes\n", uncompressed_len);
@@ -342,7 +343,7 @@ void test_three_ints() {
     char compressed[64];
     size_t compressed_len = 0;
     int result = compress_entry_args(uncompressed, uncompressed_len,
-                                      compressed, &compressed_len, &site);
+                                      compressed, &compressed_len, &site, NULL, NULL);
 
     printf("  Compress result: %d\n", result);
     printf("  Uncompressed size: %zu bytes\n", uncompressed_len);
@@ -364,8 +365,7 @@ void test_three_ints() {
         const uint8_t* nibbles = (const uint8_t*)compressed;
         for (int i = 0; i < num_int_args; i++) {
             uint8_t nibble = get_nibble(nibbles, i);
-            printf("  Nibble[%d]: 0x%x (size=%d, sign=%d)\n",
-                   i, nibble, nibble & 0x07, (nibble & 0x08) ? 1 : 0);
+            printf("  Nibble[%d]: 0x%x\n", i, nibble);
         }
 
         // Decompress
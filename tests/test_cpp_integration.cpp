@@ -59,6 +59,20 @@ int main() {
     void* ptr = (void*)0x12345678;
     LOG_INFO("C++ test: pointer = %p", ptr);
 
+    /* Test scoped spans (end when the scope exits) */
+    {
+        CNANOLOG_SPAN("C++ test: outer span");
+        CNANOLOG_SPAN("C++ test: inner span");
+        LOG_INFO("C++ test: inside spans");
+    }
+
+    /* Test rate-limited and sampled macros */
+    for (int i = 0; i < 10; i++) {
+        LOG_WARN_EVERY_N(5, "C++ test: every 5th, i = %d", i);
+        LOG_INFO_RATE(100, "C++ test: rate limited, i = %d", i);
+        LOG_DEBUG_SAMPLED(0.5, "C++ test: sampled, i = %d", i);
+    }
+
     /* Get statistics */
     cnanolog_stats_t stats;
     cnanolog_get_stats(&stats);
@@ -0,0 +1,350 @@
+/*
+ * Crash flush tests
+ * Forks children that log and then crash (SIGSEGV, abort()), and checks
+ * that they die by the original signal and that their logs hold every
+ * entry committed before the crash, with a dictionary the decoder reads.
+ * A text log whose AIO write is still queued at the flush deadline must
+ * hold each line once.
+ */
+
+#if defined(__linux__)
+    #define _GNU_SOURCE  /* aio_init */
+#endif
+
+#include "../include/cnanolog.h"
+#include "text_formatter.h"
+#include <aio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_crash_flush.clog";
+static const char* TEXT_PATH = "test_crash_flush.txt";
+static const char* DECODED_PATH = "test_crash_flush_decoded.txt";
+
+#define CRASH_ENTRIES 20000
+#define CRASH_THREADS 4
+
+/* Not a constant, so the compiler cannot see the NULL store coming */
+static volatile uintptr_t g_bad_address = 0;
+
+static void crash_with_segv(void) {
+    *(volatile int*)g_bad_address = 1;
+}
+
+/* Count lines of a file containing a substring */
+static int count_lines(const char* path, const char* needle) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) return -1;
+    char line[256];
+    int count = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strstr(line, needle) != NULL) count++;
+    }
+    fclose(f);
+    return count;
+}
+
+static int count_decoded(const char* needle) {
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "../tools/decompressor %s %s 2>/dev/null",
+             LOG_PATH, DECODED_PATH);
+    if (system(cmd) != 0) return -1;
+    return count_lines(DECODED_PATH, needle);
+}
+
+/* Run fn in a child without core dumps; return the signal that ended it */
+static int run_crashing_child(void (*fn)(void)) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        struct rlimit no_core = {0, 0};
+        setrlimit(RLIMIT_CORE, &no_core);
+        fn();
+        _exit(0);  /* Did not crash */
+    }
+
+    int status;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid) return -1;
+    return WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void child_segv(void) {
+    cnanolog_install_crash_handler(0);
+    if (cnanolog_init(LOG_PATH) != 0) _exit(1);
+
+    /* Written by the writer thread: history already set up for this site */
+    for (int i = 0; i < 100; i++) {
+        LOG_INFO("before %d at %f", i, i * 0.5);
+    }
+    struct timespec ts = {0, 50000000};
+    nanosleep(&ts, NULL);
+
+    /* Mostly still staged or buffered at the crash; second site is new */
+    for (int i = 0; i < CRASH_ENTRIES; i++) {
+        LOG_INFO("before %d at %f", 100 + i, (100 + i) * 0.5);
+        LOG_WARN("crash entry %d of %s", i, "segv");
+    }
+    crash_with_segv();
+}
+
+int test_segv_flush() {
+    unlink(LOG_PATH);
+    int sig = run_crashing_child(child_segv);
+    if (sig != SIGSEGV) TEST_FAIL("child did not die by SIGSEGV");
+
+    int crash_entries = count_decoded("crash entry");
+    printf("    %d of %d entries saved\n", crash_entries, CRASH_ENTRIES);
+    if (crash_entries != CRASH_ENTRIES) TEST_FAIL("entries lost");
+    if (count_decoded("before ") != 100 + CRASH_ENTRIES) TEST_FAIL("first site entries lost");
+
+    /* Values still decode against the right history */
+    char last[64];
+    snprintf(last, sizeof(last), "before %d at %.6f", 99 + CRASH_ENTRIES,
+             (99 + CRASH_ENTRIES) * 0.5);
+    if (count_lines(DECODED_PATH, last) != 1) TEST_FAIL("last value decoded wrong");
+    snprintf(last, sizeof(last), "crash entry %d of segv", CRASH_ENTRIES - 1);
+    if (count_lines(DECODED_PATH, last) != 1) TEST_FAIL("last entry decoded wrong");
+    TEST_PASS();
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void* log_thread(void* arg) {
+    int thread = (int)(intptr_t)arg;
+    for (int i = 0; i < CRASH_ENTRIES / CRASH_THREADS; i++) {
+        LOG_INFO("thread %d entry %d", thread, i);
+    }
+    return NULL;
+}
+
+static void child_abort(void) {
+    if (cnanolog_init(LOG_PATH) != 0) _exit(1);
+    cnanolog_install_crash_handler(500);  /* After init works too */
+
+    pthread_t threads[CRASH_THREADS];
+    for (int t = 0; t < CRASH_THREADS; t++) {
+        pthread_create(&threads[t], NULL, log_thread, (void*)(intptr_t)t);
+    }
+    for (int t = 0; t < CRASH_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    abort();
+}
+
+int test_abort_flush_threads() {
+    unlink(LOG_PATH);
+    int sig = run_crashing_child(child_abort);
+    if (sig != SIGABRT) TEST_FAIL("child did not die by SIGABRT");
+
+    int saved = count_decoded("entry");
+    printf("    %d of %d entries saved\n", saved, CRASH_ENTRIES);
+    if (saved != CRASH_ENTRIES) TEST_FAIL("entries lost");
+    for (int t = 0; t < CRASH_THREADS; t++) {
+        char needle[64];
+        snprintf(needle, sizeof(needle), "thread %d entry %d", t,
+                 CRASH_ENTRIES / CRASH_THREADS - 1);
+        if (count_lines(DECODED_PATH, needle) != 1) TEST_FAIL("thread's last entry missing");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void child_text(void) {
+    cnanolog_install_crash_handler(0);
+    cnanolog_rotation_config_t config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = TEXT_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = "%m"
+    };
+    if (cnanolog_init_ex(&config) != 0) _exit(1);
+    for (int i = 0; i < 1000; i++) {
+        LOG_INFO("text line %d", i);
+    }
+
+    /* Let the writer render them: only rendered lines are saved */
+    struct timespec ts = {0, 200000000};
+    nanosleep(&ts, NULL);
+    crash_with_segv();
+}
+
+int test_text_flush() {
+    unlink(TEXT_PATH);
+    int sig = run_crashing_child(child_text);
+    if (sig != SIGSEGV) TEST_FAIL("child did not die by SIGSEGV");
+    if (count_lines(TEXT_PATH, "text line") != 1000) TEST_FAIL("text lines lost");
+    if (count_lines(TEXT_PATH, "text line 999") != 1) TEST_FAIL("last text line missing");
+    TEST_PASS();
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+#if defined(__GLIBC__)
+#define PIPE_BLOCK_SIZE (256 * 1024)  /* More than a pipe holds */
+
+static char g_pipe_block[PIPE_BLOCK_SIZE];
+
+/* "text line N\n" for N in [first, first + count) */
+static size_t make_text_lines(char* out, int first, int count) {
+    size_t len = 0;
+    for (int i = first; i < first + count; i++) {
+        len += (size_t)sprintf(out + len, "text line %d\n", i);
+    }
+    return len;
+}
+
+static void wait_aio(struct aiocb* cb) {
+    const struct aiocb* list[] = {cb};
+    while (aio_error(cb) == EINPROGRESS) {
+        aio_suspend(list, 1, NULL);
+    }
+}
+
+/*
+ * glibc runs AIO on helper threads. With one helper, blocked on a full
+ * pipe, the text writer's AIO stays queued past the crash flush deadline;
+ * it runs once the pipe is drained, after the flush rewrote its buffer.
+ */
+static void child_unfinished_aio(void) {
+    struct aioinit init;
+    memset(&init, 0, sizeof(init));
+    init.aio_threads = 1;
+    init.aio_num = 4;
+    aio_init(&init);
+
+    int fds[2];
+    if (pipe(fds) != 0) _exit(1);
+    struct aiocb blocker;
+    memset(&blocker, 0, sizeof(blocker));
+    blocker.aio_fildes = fds[1];
+    blocker.aio_buf = g_pipe_block;
+    blocker.aio_nbytes = sizeof(g_pipe_block);
+    if (aio_write(&blocker) != 0) _exit(1);
+
+    text_writer_t* writer = text_writer_create(TEXT_PATH);
+    if (writer == NULL) _exit(1);
+    static char lines[64 * 1024];
+    size_t len = make_text_lines(lines, 0, 500);
+    text_writer_write_block(writer, lines, len);
+    text_writer_flush(writer);  /* Queued behind the pipe */
+    len = make_text_lines(lines, 500, 500);
+    text_writer_write_block(writer, lines, len);
+
+    text_writer_crash_flush(writer, 0);  /* Deadline already passed */
+
+    /* Let the queued AIO land, then report like a crashed process */
+    size_t drained = 0;
+    while (drained < sizeof(g_pipe_block)) {
+        ssize_t n = read(fds[0], g_pipe_block, sizeof(g_pipe_block));
+        if (n <= 0) _exit(1);
+        drained += (size_t)n;
+    }
+    wait_aio(&blocker);
+    int null_fd = open("/dev/null", O_WRONLY);
+    struct aiocb marker;  /* Runs after the writer's AIO on the one helper */
+    memset(&marker, 0, sizeof(marker));
+    marker.aio_fildes = null_fd;
+    marker.aio_buf = g_pipe_block;
+    marker.aio_nbytes = 1;
+    if (aio_write(&marker) != 0) _exit(1);
+    wait_aio(&marker);
+    _exit(0);
+}
+
+int test_text_unfinished_aio() {
+    unlink(TEXT_PATH);
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        child_unfinished_aio();
+    }
+    int status;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid) TEST_FAIL("fork failed");
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) TEST_FAIL("child failed");
+
+    static char expected[128 * 1024];
+    size_t len = make_text_lines(expected, 0, 1000);
+    FILE* f = fopen(TEXT_PATH, "rb");
+    if (f == NULL) TEST_FAIL("no text log");
+    static char actual[256 * 1024];
+    size_t got = fread(actual, 1, sizeof(actual), f);
+    fclose(f);
+    if (got != len || memcmp(actual, expected, len) != 0) {
+        printf("    %zu bytes, expected %zu\n", got, len);
+        TEST_FAIL("lines missing or written twice");
+    }
+    TEST_PASS();
+    return 0;
+}
+#endif
+
+/* ---------------------------------------------------------------------- */
+
+static void child_after_shutdown(void) {
+    cnanolog_install_crash_handler(0);
+    if (cnanolog_init(LOG_PATH) != 0) _exit(1);
+    LOG_INFO("closed normally %d", 1);
+    cnanolog_shutdown();
+    raise(SIGSEGV);
+}
+
+int test_inactive_after_shutdown() {
+    unlink(LOG_PATH);
+    int sig = run_crashing_child(child_after_shutdown);
+    if (sig != SIGSEGV) TEST_FAIL("child did not die by SIGSEGV");
+    if (count_decoded("closed normally 1") != 1) TEST_FAIL("closed log damaged");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Crash Flush Tests\n");
+    printf("==========================\n\n");
+
+    failures += test_segv_flush();
+    failures += test_abort_flush_threads();
+    failures += test_text_flush();
+#if defined(__GLIBC__)
+    failures += test_text_unfinished_aio();
+#else
+    printf("  (unfinished AIO test needs glibc, skipped)\n");
+#endif
+    failures += test_inactive_after_shutdown();
+
+    unlink(LOG_PATH);
+    unlink(TEXT_PATH);
+    unlink(DECODED_PATH);
+
+    printf("\n==========================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
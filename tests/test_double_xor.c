@@ -0,0 +1,184 @@
+/*
+ * Double XOR encoding tests
+ * Verifies that doubles encoded against the recent values in their slot
+ * round-trip bit-exactly, shrink slowly moving prices, and decode through
+ * the decompressor with another site's entries interleaved and filtered.
+ */
+
+#include "../include/cnanolog.h"
+#include "../src/compressor.h"
+#include "../src/packer.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_double_xor.clog";
+static const char* TEXT_PATH = "test_double_xor.txt";
+
+#define NUM_PRICES 1000
+
+/* Deterministic random walk on a 0.01 tick ladder around 100 */
+static double price_at(int i) {
+    static int ticks[NUM_PRICES];
+    if (ticks[0] == 0) {
+        uint32_t state = 12345;
+        ticks[0] = 10000;
+        for (int k = 1; k < NUM_PRICES; k++) {
+            state = state * 1103515245u + 12345u;
+            ticks[k] = ticks[k - 1] + (int)((state >> 16) % 3) - 1;
+        }
+    }
+    return ticks[i] / 100.0;
+}
+
+int test_round_trip_bits() {
+    const double values[] = {
+        0.0, 0.0, -0.0, 1.0, 1.0, 100.25, 100.26, 100.25, -3.5e300, 4.9e-324,
+        INFINITY, -INFINITY, NAN, 123456789.123456789, 1e-9, 1e-9, 42.0
+    };
+    const size_t count = sizeof(values) / sizeof(values[0]);
+
+    char buf[count * XOR_MAX_BYTES];
+    uint8_t nibbles[count];
+    xor_slot_t enc;
+    memset(&enc, 0, sizeof(enc));
+    char* write_ptr = buf;
+    for (size_t i = 0; i < count; i++) {
+        nibbles[i] = pack_double_xor(&write_ptr, values[i], &enc);
+    }
+
+    xor_slot_t dec;
+    memset(&dec, 0, sizeof(dec));
+    const char* read_ptr = buf;
+    for (size_t i = 0; i < count; i++) {
+        double out;
+        if (unpack_double_xor(&read_ptr, write_ptr, nibbles[i], &dec, &out) != 0) {
+            TEST_FAIL("decode failed");
+        }
+        if (memcmp(&out, &values[i], sizeof(double)) != 0) TEST_FAIL("bits differ");
+    }
+    if (read_ptr != write_ptr) TEST_FAIL("decoder did not consume the stream");
+    if (nibbles[1] != XOR_NIBBLE_REPEAT || nibbles[15] != XOR_NIBBLE_REPEAT) {
+        TEST_FAIL("repeat not encoded as a bare nibble");
+    }
+
+    /* Corrupt window byte: shift + length past 8 bytes */
+    char bad[2] = {(char)(7 | (2 << 4)), 0};
+    const char* bad_ptr = bad;
+    double out;
+    if (unpack_double_xor(&bad_ptr, bad + sizeof(bad), XOR_NIBBLE_WINDOW, &dec, &out) == 0) {
+        TEST_FAIL("invalid window accepted");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+int test_price_shrinkage() {
+    log_site_t site;
+    memset(&site, 0, sizeof(site));
+    site.log_id = 0;
+    site.num_args = 2;
+    site.arg_types[0] = ARG_TYPE_DOUBLE;
+    site.arg_types[1] = ARG_TYPE_DOUBLE;
+
+    compress_history_t history;
+    compress_history_init(&history);
+    arg_slot_t* slots = compress_history_get(&history, &site);
+    if (slots == NULL) TEST_FAIL("no history");
+
+    size_t raw_total = 0;
+    size_t compressed_total = 0;
+    for (int i = 0; i < NUM_PRICES; i++) {
+        double args[2] = {price_at(i), (double)(100 * (1 + i % 3))};
+        char compressed[64];
+        size_t compressed_len = 0;
+        if (compress_entry_args((const char*)args, sizeof(args), compressed,
+                                &compressed_len, &site, slots, &history.strings) != 0) {
+            compress_history_destroy(&history);
+            TEST_FAIL("compress failed");
+        }
+        if (compressed_len > compress_max_size(&site, sizeof(args))) {
+            compress_history_destroy(&history);
+            TEST_FAIL("compress_max_size exceeded");
+        }
+        raw_total += sizeof(args);
+        compressed_total += compressed_len;
+    }
+    compress_history_destroy(&history);
+
+    printf("    %zu raw bytes -> %zu compressed (%.1fx)\n",
+           raw_total, compressed_total, (double)raw_total / (double)compressed_total);
+    if (compressed_total * 3 > raw_total) TEST_FAIL("prices shrank less than 3x");
+    TEST_PASS();
+    return 0;
+}
+
+int test_decompressor_round_trip() {
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+    for (int i = 0; i < NUM_PRICES; i++) {
+        if (i % 2 == 0) {
+            LOG_INFO("px %.2f qty %.0f", price_at(i), (double)(100 * (1 + i % 3)));
+        } else {
+            /* Another site with the same shape, filtered out below */
+            LOG_DEBUG("px %.2f qty %.0f", price_at(i), (double)(100 * (1 + i % 3)));
+        }
+    }
+    cnanolog_shutdown();
+
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "../tools/decompressor -l INFO %s %s 2>/dev/null",
+             LOG_PATH, TEXT_PATH);
+    if (system(cmd) != 0) TEST_FAIL("decompressor failed");
+
+    FILE* f = fopen(TEXT_PATH, "r");
+    if (f == NULL) TEST_FAIL("no output");
+    char line[256];
+    int i = 0;
+    int errors = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char expected[64];
+        snprintf(expected, sizeof(expected), "px %.2f qty %.0f",
+                 price_at(i), (double)(100 * (1 + i % 3)));
+        if (strstr(line, expected) == NULL) errors++;
+        i += 2;
+    }
+    fclose(f);
+
+    if (i != NUM_PRICES) TEST_FAIL("lines missing");
+    if (errors != 0) TEST_FAIL("decoded values differ");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Double XOR Tests\n");
+    printf("=========================\n\n");
+
+    failures += test_round_trip_bits();
+    failures += test_price_shrinkage();
+    failures += test_decompressor_round_trip();
+
+    unlink(LOG_PATH);
+    unlink(TEXT_PATH);
+
+    printf("\n=========================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
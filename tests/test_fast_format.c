@@ -0,0 +1,214 @@
+/*
+ * Fast formatter tests
+ * Verifies hand-rolled number/timestamp formatting against libc output
+ */
+
+#include "../src/fast_format.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+/* Deterministic xorshift so failures are reproducible */
+static uint64_t rng_state = 88172645463325252ULL;
+static uint64_t next_rand(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+
+/* Random double drawn from a mix of "log-like" and arbitrary bit patterns */
+static double random_double(int i) {
+    switch (i % 3) {
+        case 0: {
+            uint64_t bits = next_rand();
+            double v;
+            memcpy(&v, &bits, sizeof(v));
+            return v;
+        }
+        case 1:
+            return (double)(int64_t)(next_rand() % 2000000 - 1000000) /
+                   (double)(1 + next_rand() % 1000);
+        default:
+            return (double)(next_rand() % 100000) / 100.0;
+    }
+}
+
+int test_integers() {
+    char a[32], b[32];
+    int64_t edge[] = { 0, 1, -1, 9, 10, 99, 100, INT64_MAX, INT64_MIN };
+
+    for (size_t i = 0; i < sizeof(edge) / sizeof(edge[0]); i++) {
+        a[fmt_i64(a, edge[i])] = '\0';
+        snprintf(b, sizeof(b), "%lld", (long long)edge[i]);
+        if (strcmp(a, b) != 0) TEST_FAIL("signed edge case mismatch");
+    }
+
+    for (int i = 0; i < 100000; i++) {
+        uint64_t u = next_rand() >> (next_rand() % 64);
+        a[fmt_u64(a, u)] = '\0';
+        snprintf(b, sizeof(b), "%llu", (unsigned long long)u);
+        if (strcmp(a, b) != 0) TEST_FAIL("unsigned mismatch");
+
+        a[fmt_hex(a, u, 0)] = '\0';
+        snprintf(b, sizeof(b), "%llx", (unsigned long long)u);
+        if (strcmp(a, b) != 0) TEST_FAIL("hex mismatch");
+    }
+
+    fmt_u64_padded(a, 42, 9);
+    a[9] = '\0';
+    if (strcmp(a, "000000042") != 0) TEST_FAIL("padded mismatch");
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_double_fixed() {
+    char a[64], b[64];
+
+    for (int i = 0; i < 200000; i++) {
+        double v = random_double(i);
+        int precision = i % 10;
+        size_t len = fmt_double_fixed(a, v, precision);
+        a[len] = '\0';
+        int w = snprintf(b, sizeof(b), "%.*f", precision, v);
+        if (w >= FMT_DOUBLE_MAX_CHARS) {
+            if (len != 0) TEST_FAIL("oversized result not reported");
+            continue;
+        }
+        if (strcmp(a, b) != 0) {
+            printf("    got %s, expected %s\n", a, b);
+            TEST_FAIL("%.*f mismatch");
+        }
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_double_fixed_large() {
+    char a[64];
+
+    /* Too long for the buffer: reported, never cut short */
+    const double large[] = { 1e25, -1e25, 1e300, -1.7976931348623157e308 };
+    for (size_t i = 0; i < sizeof(large) / sizeof(large[0]); i++) {
+        if (fmt_double_fixed(a, large[i], 6) != 0) TEST_FAIL("large value truncated");
+    }
+
+    /* The longest results that still fit */
+    a[fmt_double_fixed(a, 1e20, 9)] = '\0';
+    if (strcmp(a, "100000000000000000000.000000000") != 0) TEST_FAIL("1e20 wrong");
+    a[fmt_double_fixed(a, 1e25, 4)] = '\0';
+    if (strcmp(a, "10000000000000000905969664.0000") != 0) TEST_FAIL("1e25 wrong");
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_double_general() {
+    char a[64], b[64];
+
+    for (int i = 0; i < 200000; i++) {
+        double v = random_double(i);
+        a[fmt_double_general(a, v)] = '\0';
+        snprintf(b, sizeof(b), "%g", v);
+        if (strcmp(a, b) != 0) {
+            printf("    got %s, expected %s\n", a, b);
+            TEST_FAIL("%g mismatch");
+        }
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_double_shortest() {
+    char a[64];
+    struct { double v; const char* expected; } cases[] = {
+        { 0.1, "0.1" }, { 0.3, "0.3" }, { 123.456, "123.456" },
+        { -2.5, "-2.5" }, { 100000.0, "100000" }, { 0.0, "0" }
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        a[fmt_double_shortest(a, cases[i].v)] = '\0';
+        if (strcmp(a, cases[i].expected) != 0) TEST_FAIL("not shortest");
+    }
+
+    for (int i = 0; i < 200000; i++) {
+        double v = random_double(i);
+        if (v != v) continue;  /* NaN never compares equal */
+        a[fmt_double_shortest(a, v)] = '\0';
+        if (strtod(a, NULL) != v) {
+            printf("    %s does not round-trip\n", a);
+            TEST_FAIL("round-trip failed");
+        }
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_timestamp() {
+    fmt_time_cache_t cache;
+    memset(&cache, 0, sizeof(cache));
+    char a[64], b[64];
+
+    time_t now = time(NULL);
+    for (int i = 0; i < 5; i++) {
+        time_t t = now + i / 2;  /* Hit the cache and the refresh path */
+        uint32_t nsec = (uint32_t)(next_rand() % 1000000000ULL);
+
+        if (fmt_timestamp(&cache, (int64_t)t, nsec, a) != FMT_TIMESTAMP_CHARS)
+            TEST_FAIL("wrong timestamp length");
+        a[FMT_TIMESTAMP_CHARS] = '\0';
+
+        struct tm tm_buf;
+        localtime_r(&t, &tm_buf);
+        size_t n = strftime(b, sizeof(b), "%Y-%m-%d %H:%M:%S", &tm_buf);
+        snprintf(b + n, sizeof(b) - n, ".%09u", nsec);
+        if (strcmp(a, b) != 0) TEST_FAIL("timestamp mismatch");
+    }
+
+    /* 2.5 ticks/ns: 1.5s after start, and 1ns before start */
+    int64_t sec;
+    uint32_t nsec;
+    fmt_ticks_to_wall(1000 + 3750000000ULL, 2500000000ULL, 1000, 100, 999999999, &sec, &nsec);
+    if (sec != 102 || nsec != 499999999) TEST_FAIL("tick conversion wrong");
+
+    fmt_ticks_to_wall(1000 - 5, 2500000000ULL, 1000, 100, 0, &sec, &nsec);
+    if (sec != 99 || nsec != 999999998) TEST_FAIL("negative tick conversion wrong");
+
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Fast Formatter Tests\n");
+    printf("=============================\n\n");
+
+    failures += test_integers();
+    failures += test_double_fixed();
+    failures += test_double_fixed_large();
+    failures += test_double_general();
+    failures += test_double_shortest();
+    failures += test_timestamp();
+
+    printf("\n=============================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
@@ -0,0 +1,270 @@
+/*
+ * Flight recorder tests
+ * Verifies that the ring drops its oldest entries, that recorded levels
+ * stay out of the log, and that dumps on request, on ERROR and on a
+ * signal produce .clog files holding the most recent recorded entries.
+ */
+
+#include "../include/cnanolog.h"
+#include "../src/flight_recorder.h"
+#include "../src/staging_buffer.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_flight_recorder.clog";
+static const char* TEXT_PATH = "test_flight_recorder.txt";
+static const char* DUMP_PATH = "test_flight_recorder_dump.clog";
+static const char* DUMP_BASE = "test_flight_recorder_auto.clog";
+static const char* DECODED_PATH = "test_flight_recorder_decoded.txt";
+
+/* Auto-named dumps are numbered per process */
+static int g_auto_dumps = 0;
+
+static char g_auto_path[64];
+static const char* auto_dump_path(int n) {
+    snprintf(g_auto_path, sizeof(g_auto_path), "test_flight_recorder_auto-%d.clog", n);
+    return g_auto_path;
+}
+
+/* Decode a .clog and count lines containing a substring */
+static int count_decoded(const char* clog_path, const char* needle) {
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "../tools/decompressor %s %s 2>/dev/null",
+             clog_path, DECODED_PATH);
+    if (system(cmd) != 0) return -1;
+
+    FILE* f = fopen(DECODED_PATH, "r");
+    if (f == NULL) return -1;
+    char line[256];
+    int count = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strstr(line, needle) != NULL) count++;
+    }
+    fclose(f);
+    return count;
+}
+
+/* Build a staged entry with data_size bytes of data */
+static size_t make_entry(char* entry, uint32_t log_id, size_t data_size) {
+    cnanolog_entry_header_t header;
+    memset(&header, 0, sizeof(header));
+    header.log_id = log_id;
+    header.data_length = (uint16_t)data_size;
+    memcpy(entry, &header, sizeof(header));
+    memset(entry + sizeof(header), (int)(log_id & 0xFF), data_size);
+    return sizeof(header) + data_size;
+}
+
+int test_ring_overwrite() {
+    flight_recorder_t fr;
+    if (flight_recorder_init(&fr, 1000) != 0) TEST_FAIL("init failed");
+
+    static char entry[STAGING_MAX_ENTRY_SIZE];
+    static char out[STAGING_MAX_ENTRY_SIZE];
+
+    /* Sizes that do not divide the capacity, so entries straddle the end */
+    for (uint32_t id = 0; id < 100; id++) {
+        size_t size = make_entry(entry, id, 10 + id % 37);
+        if (flight_recorder_append(&fr, entry, size) != 0) {
+            flight_recorder_destroy(&fr);
+            TEST_FAIL("append failed");
+        }
+    }
+    if (fr.overwritten == 0 || fr.entries + fr.overwritten != 100) {
+        flight_recorder_destroy(&fr);
+        TEST_FAIL("entries not overwritten");
+    }
+
+    /* The newest entries remain, in order and intact */
+    uint64_t pos = fr.head;
+    uint32_t expected = (uint32_t)fr.overwritten;
+    size_t size;
+    while ((size = flight_recorder_read(&fr, &pos, out)) > 0) {
+        const cnanolog_entry_header_t* header = (const cnanolog_entry_header_t*)out;
+        if (header->log_id != expected || size != sizeof(*header) + 10 + expected % 37 ||
+            (uint8_t)out[size - 1] != (expected & 0xFF)) {
+            flight_recorder_destroy(&fr);
+            TEST_FAIL("wrong entry read back");
+        }
+        expected++;
+    }
+    if (expected != 100) {
+        flight_recorder_destroy(&fr);
+        TEST_FAIL("entries missing");
+    }
+
+    if (flight_recorder_append(&fr, entry, make_entry(entry, 1, 2000)) == 0) {
+        flight_recorder_destroy(&fr);
+        TEST_FAIL("entry larger than the ring accepted");
+    }
+    flight_recorder_clear(&fr);
+    pos = fr.head;
+    if (fr.entries != 0 || flight_recorder_read(&fr, &pos, out) != 0) {
+        flight_recorder_destroy(&fr);
+        TEST_FAIL("clear left entries");
+    }
+
+    flight_recorder_destroy(&fr);
+    TEST_PASS();
+    return 0;
+}
+
+int test_dump_on_request() {
+    cnanolog_flight_recorder_config_t config = {
+        .capacity = 8192,
+        .dump_path = DUMP_BASE
+    };
+    if (cnanolog_enable_flight_recorder(&config) != 0) TEST_FAIL("enable failed");
+
+    unlink(LOG_PATH);
+    unlink(DUMP_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+    for (int i = 0; i < 1000; i++) {
+        LOG_DEBUG("recorded step %d of %s", i, "warmup");
+        if (i % 100 == 0) {
+            LOG_INFO("written progress %d", i);
+        }
+    }
+    int result = cnanolog_dump_flight_recorder(DUMP_PATH);
+    cnanolog_shutdown();
+    cnanolog_enable_flight_recorder(NULL);
+
+    if (result != 0) TEST_FAIL("dump failed");
+    if (count_decoded(LOG_PATH, "written progress") != 10) TEST_FAIL("INFO lines missing");
+    if (count_decoded(LOG_PATH, "recorded step") != 0) TEST_FAIL("DEBUG written to the log");
+
+    /* Ring of 8KB: only the newest steps, ending with the last one */
+    int recorded = count_decoded(DUMP_PATH, "recorded step");
+    printf("    dump holds %d of 1000 DEBUG entries\n", recorded);
+    if (recorded <= 0 || recorded >= 1000) TEST_FAIL("dump not bounded by the ring");
+    if (count_decoded(DUMP_PATH, "recorded step 999 of warmup") != 1) TEST_FAIL("newest entry missing");
+    if (count_decoded(DUMP_PATH, "recorded step 0 of") != 0) TEST_FAIL("oldest entry kept");
+    TEST_PASS();
+    return 0;
+}
+
+int test_dump_on_error() {
+    uint8_t levels[] = {LOG_LEVEL_DEBUG, LOG_LEVEL_WARN};
+    cnanolog_flight_recorder_config_t config = {
+        .levels = levels,
+        .num_levels = 2,
+        .dump_path = DUMP_BASE,
+        .dump_on_error = 1
+    };
+    if (cnanolog_enable_flight_recorder(&config) != 0) TEST_FAIL("enable failed");
+
+    unlink(TEXT_PATH);
+    cnanolog_rotation_config_t log_config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = TEXT_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = "%m"
+    };
+    if (cnanolog_init_ex(&log_config) != 0) TEST_FAIL("init failed");
+    for (int i = 0; i < 5; i++) {
+        LOG_DEBUG("context %d", i);
+        LOG_WARN("warning %d", i);
+    }
+    LOG_ERROR("failure %d", 1);
+    LOG_ERROR("failure %d", 2);  /* Ring is empty again: no second dump */
+    cnanolog_shutdown();
+    cnanolog_enable_flight_recorder(NULL);
+
+    int first = ++g_auto_dumps;
+    char first_path[64];
+    snprintf(first_path, sizeof(first_path), "%s", auto_dump_path(first));
+    if (access(auto_dump_path(first + 1), F_OK) == 0) TEST_FAIL("dumped without recorded entries");
+
+    if (count_decoded(first_path, "context") != 5) TEST_FAIL("DEBUG context missing");
+    if (count_decoded(first_path, "warning") != 5) TEST_FAIL("WARN context missing");
+    if (count_decoded(first_path, "failure 1") != 1) TEST_FAIL("ERROR missing from dump");
+
+    /* The text log has both errors and nothing that was recorded */
+    FILE* f = fopen(TEXT_PATH, "r");
+    if (f == NULL) TEST_FAIL("no text output");
+    char line[128];
+    int errors = 0, recorded = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strncmp(line, "failure", 7) == 0) errors++;
+        if (strncmp(line, "context", 7) == 0 || strncmp(line, "warning", 7) == 0) recorded++;
+    }
+    fclose(f);
+    unlink(first_path);
+
+    if (errors != 2) TEST_FAIL("ERROR lines missing from the log");
+    if (recorded != 0) TEST_FAIL("recorded levels written to the log");
+    TEST_PASS();
+    return 0;
+}
+
+int test_dump_on_signal() {
+    cnanolog_flight_recorder_config_t config = {
+        .dump_path = DUMP_BASE,
+        .dump_signal = SIGUSR1
+    };
+    if (cnanolog_enable_flight_recorder(&config) != 0) TEST_FAIL("enable failed");
+
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+    for (int i = 0; i < 50; i++) {
+        LOG_DEBUG("before signal %d", i);
+    }
+
+    /* Give the writer thread time to move the entries into the ring */
+    struct timespec ts = {0, 50000000};
+    nanosleep(&ts, NULL);
+    raise(SIGUSR1);
+
+    int dump = ++g_auto_dumps;
+    char dump_path[64];
+    snprintf(dump_path, sizeof(dump_path), "%s", auto_dump_path(dump));
+    for (int i = 0; i < 100 && access(dump_path, F_OK) != 0; i++) {
+        nanosleep(&ts, NULL);
+    }
+    cnanolog_shutdown();
+    cnanolog_enable_flight_recorder(NULL);
+
+    int recorded = count_decoded(dump_path, "before signal");
+    unlink(dump_path);
+    if (recorded != 50) TEST_FAIL("signal dump incomplete");
+    if (cnanolog_dump_flight_recorder(NULL) != -1) TEST_FAIL("dump accepted after shutdown");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Flight Recorder Tests\n");
+    printf("==============================\n\n");
+
+    failures += test_ring_overwrite();
+    failures += test_dump_on_request();
+    failures += test_dump_on_error();
+    failures += test_dump_on_signal();
+
+    unlink(LOG_PATH);
+    unlink(TEXT_PATH);
+    unlink(DUMP_PATH);
+    unlink(DECODED_PATH);
+
+    printf("\n==============================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
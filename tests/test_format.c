@@ -65,8 +65,10 @@ int test_file_header_offsets() {
         TEST_FAIL("entry_count offset wrong");
     if ((char*)&h.flags - base != 52)
         TEST_FAIL("flags offset wrong");
-    if ((char*)&h.reserved - base != 56)
-        TEST_FAIL("reserved offset wrong");
+    if ((char*)&h.frequency_uncertainty_ppb - base != 56)
+        TEST_FAIL("frequency_uncertainty_ppb offset wrong");
+    if ((char*)&h.entry_count_high - base != 60)
+        TEST_FAIL("entry_count_high offset wrong");
 
     TEST_PASS();
     return 0;
@@ -0,0 +1,150 @@
+/*
+ * Formatter pool tests
+ * Verifies text mode loses no lines and keeps per-thread order, both with
+ * formatter threads and when everything is drained at shutdown.
+ */
+
+#include "../include/cnanolog.h"
+#include "../src/platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+#define NUM_PRODUCERS 2
+#define LOGS_PER_PRODUCER 100000
+
+static const char* LOG_PATH = "test_format_pool.log";
+
+static void* producer_main(void* arg) {
+    int id = (int)(size_t)arg;
+    for (int i = 0; i < LOGS_PER_PRODUCER; i++) {
+        LOG_INFO("producer %d seq %d value %.3f", id, i, i * 0.5);
+    }
+    return NULL;
+}
+
+/**
+ * Check that every producer's lines are all present and in order.
+ */
+static int verify_log(const char* path, int num_producers, int logs_per_producer) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        return -1;
+    }
+
+    int next_seq[NUM_PRODUCERS + 1] = {0};
+    char line[512];
+    int errors = 0;
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        const char* msg = strstr(line, "producer ");
+        int id, seq;
+        if (msg == NULL || sscanf(msg, "producer %d seq %d", &id, &seq) != 2 ||
+            id < 0 || id >= num_producers) {
+            errors++;
+            continue;
+        }
+        if (seq != next_seq[id]) {
+            errors++;
+        }
+        next_seq[id] = seq + 1;
+    }
+    fclose(f);
+
+    for (int id = 0; id < num_producers; id++) {
+        if (next_seq[id] != logs_per_producer) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+static int run_text_logger(uint32_t formatter_threads, int num_producers) {
+    unlink(LOG_PATH);
+
+    cnanolog_rotation_config_t config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = LOG_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = NULL,
+        .formatter_threads = formatter_threads
+    };
+    if (cnanolog_init_ex(&config) != 0) {
+        return -1;
+    }
+
+    cnanolog_thread_t threads[NUM_PRODUCERS];
+    for (int i = 0; i < num_producers; i++) {
+        cnanolog_thread_create(&threads[i], producer_main, (void*)(size_t)i);
+    }
+    for (int i = 0; i < num_producers; i++) {
+        cnanolog_thread_join(threads[i], NULL);
+    }
+
+    /* No settling delay: shutdown must drain whatever is still staged */
+    cnanolog_shutdown();
+    return 0;
+}
+
+int test_pool_keeps_order() {
+    if (run_text_logger(4, NUM_PRODUCERS) != 0) TEST_FAIL("init failed");
+    if (verify_log(LOG_PATH, NUM_PRODUCERS, LOGS_PER_PRODUCER) != 0) {
+        TEST_FAIL("missing or reordered lines");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+int test_inline_shutdown_drain() {
+    if (run_text_logger(0, 1) != 0) TEST_FAIL("init failed");
+    if (verify_log(LOG_PATH, 1, LOGS_PER_PRODUCER) != 0) {
+        TEST_FAIL("lines lost in shutdown drain");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+int test_pool_rejects_bad_thread_count() {
+    cnanolog_rotation_config_t config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = LOG_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .formatter_threads = 1000
+    };
+    if (cnanolog_init_ex(&config) == 0) {
+        cnanolog_shutdown();
+        TEST_FAIL("accepted 1000 formatter threads");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Formatter Pool Tests\n");
+    printf("=============================\n\n");
+
+    failures += test_pool_keeps_order();
+    failures += test_inline_shutdown_drain();
+    failures += test_pool_rejects_bad_thread_count();
+
+    unlink(LOG_PATH);
+
+    printf("\n=============================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
@@ -0,0 +1,237 @@
+/*
+ * Format program tests
+ * Verifies compiled format strings render like printf, including
+ * width/precision/flags, and that patterns compile into tokens.
+ */
+
+#include "../src/format_program.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+/* Minimal packer for uncompressed staging-buffer argument layout */
+typedef struct {
+    char data[512];
+    size_t len;
+    uint8_t types[CNANOLOG_MAX_ARGS];
+    uint8_t num_args;
+} args_t;
+
+static void add_i32(args_t* a, int32_t v) {
+    memcpy(a->data + a->len, &v, sizeof(v));
+    a->len += sizeof(v);
+    a->types[a->num_args++] = ARG_TYPE_INT32;
+}
+
+static void add_u64(args_t* a, uint64_t v, uint8_t type) {
+    memcpy(a->data + a->len, &v, sizeof(v));
+    a->len += sizeof(v);
+    a->types[a->num_args++] = type;
+}
+
+static void add_double(args_t* a, double v) {
+    memcpy(a->data + a->len, &v, sizeof(v));
+    a->len += sizeof(v);
+    a->types[a->num_args++] = ARG_TYPE_DOUBLE;
+}
+
+static void add_string(args_t* a, const char* s) {
+    uint32_t n = (uint32_t)strlen(s);
+    memcpy(a->data + a->len, &n, sizeof(n));
+    memcpy(a->data + a->len + sizeof(n), s, n);
+    a->len += sizeof(n) + n;
+    a->types[a->num_args++] = ARG_TYPE_STRING;
+}
+
+static int render(const char* format, const args_t* a, char* out, size_t out_size) {
+    fmt_program_t* program = fmt_program_compile_format(format, a->num_args, a->types);
+    if (program == NULL) {
+        return -1;
+    }
+    fmt_program_render(program, a->data, a->len, out, out_size);
+    fmt_program_free(program);
+    return 0;
+}
+
+#define CHECK_RENDER(args, fmt, expected) do { \
+    char got[512]; \
+    if (render(fmt, args, got, sizeof(got)) != 0) TEST_FAIL("compile failed"); \
+    if (strcmp(got, expected) != 0) { \
+        printf("    format \"%s\": got \"%s\", expected \"%s\"\n", fmt, got, expected); \
+        TEST_FAIL("render mismatch"); \
+    } \
+} while(0)
+
+int test_integer_specs() {
+    const int32_t values[] = { 0, 7, -42, 123456, -2147483647 - 1 };
+    const char* specs[] = { "%d", "%5d", "%-5d|", "%05d", "%+d", "% d", "%.3d",
+                            "%8.3d", "%x", "%#x", "%08X", "%o", "%#o", "%u", "%.0d" };
+
+    for (size_t v = 0; v < sizeof(values) / sizeof(values[0]); v++) {
+        for (size_t s = 0; s < sizeof(specs) / sizeof(specs[0]); s++) {
+            args_t a = {0};
+            add_i32(&a, values[v]);
+            char expected[64];
+            snprintf(expected, sizeof(expected), specs[s], values[v]);
+            CHECK_RENDER(&a, specs[s], expected);
+        }
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_double_specs() {
+    const double values[] = { 0.0, 3.14159, -2.5, 1234567.891, 1e-7, 1e15, -1e25, 1e300 };
+    const char* specs[] = { "%f", "%.2f", "%10.3f", "%-10.1f|", "%+f", "%012.4f",
+                            "%g", "%.3g", "%e", "%.12f", "%G" };
+
+    for (size_t v = 0; v < sizeof(values) / sizeof(values[0]); v++) {
+        for (size_t s = 0; s < sizeof(specs) / sizeof(specs[0]); s++) {
+            args_t a = {0};
+            add_double(&a, values[v]);
+            char expected[512];
+            snprintf(expected, sizeof(expected), specs[s], values[v]);
+            if (strlen(expected) >= 511) continue;
+            CHECK_RENDER(&a, specs[s], expected);
+        }
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_string_and_star() {
+    args_t a = {0};
+    add_string(&a, "hello");
+    CHECK_RENDER(&a, "[%s]", "[hello]");
+    CHECK_RENDER(&a, "[%8s]", "[   hello]");
+    CHECK_RENDER(&a, "[%-8s]", "[hello   ]");
+    CHECK_RENDER(&a, "[%.3s]", "[hel]");
+
+    /* '*' width and precision consume their own arguments */
+    args_t b = {0};
+    add_i32(&b, 6);
+    add_i32(&b, 2);
+    add_double(&b, 3.14159);
+    CHECK_RENDER(&b, "%*.*f", "  3.14");
+
+    args_t c = {0};
+    add_i32(&c, -6);
+    add_i32(&c, 42);
+    CHECK_RENDER(&c, "[%*d]", "[42    ]");
+
+    /* Length modifiers are ignored: sizes come from arg types */
+    args_t d = {0};
+    add_u64(&d, 18446744073709551615ULL, ARG_TYPE_UINT64);
+    CHECK_RENDER(&d, "%llu", "18446744073709551615");
+    CHECK_RENDER(&d, "%zx", "ffffffffffffffff");
+
+    args_t e = {0};
+    add_u64(&e, 0, ARG_TYPE_POINTER);
+    CHECK_RENDER(&e, "%p", "(nil)");
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_literals_and_missing_args() {
+    args_t a = {0};
+    add_i32(&a, 85);
+    CHECK_RENDER(&a, "usage %d%%", "usage 85%");
+    CHECK_RENDER(&a, "%d then %d", "85 then %d");
+    CHECK_RENDER(&a, "trailing %", "trailing %");
+
+    /* Truncated argument data stops rendering cleanly */
+    args_t b = {0};
+    add_i32(&b, 1);
+    b.types[b.num_args++] = ARG_TYPE_INT64;  /* Declared but not packed */
+    CHECK_RENDER(&b, "%d %lld", "1 ");
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_long_literal() {
+    /* Literal runs beyond an op's 16-bit length span several ops */
+    const size_t head = 70000, tail = 140000;
+    size_t fmt_len = head + 2 + tail;
+    char* format = (char*)malloc(fmt_len + 1);
+    memset(format, 'x', head);
+    memcpy(format + head, "%d", 2);
+    memset(format + head + 2, 'y', tail);
+    format[fmt_len] = '\0';
+
+    args_t a = {0};
+    add_i32(&a, 7);
+    size_t out_size = head + 1 + tail + 1;
+    char* out = (char*)malloc(out_size);
+    int failed = render(format, &a, out, out_size) != 0 ||
+                 strlen(out) != head + 1 + tail ||
+                 out[head - 1] != 'x' || out[head] != '7' ||
+                 out[head + 1] != 'y' || out[head + tail] != 'y';
+    free(format);
+    free(out);
+    if (failed) TEST_FAIL("literal longer than 64KB not rendered in full");
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_pattern_compile() {
+    fmt_program_t* p = fmt_program_compile_pattern("[%t] %% [%l] %m");
+    if (p == NULL) TEST_FAIL("compile failed");
+
+    /* "[", t, "] % [", l, "] ", m */
+    const char expected_kinds[] = { FMT_OP_LITERAL, FMT_OP_TOKEN, FMT_OP_LITERAL,
+                                    FMT_OP_TOKEN, FMT_OP_LITERAL, FMT_OP_TOKEN };
+    if (p->num_ops != sizeof(expected_kinds)) {
+        fmt_program_free(p);
+        TEST_FAIL("wrong op count");
+    }
+    for (uint32_t i = 0; i < p->num_ops; i++) {
+        if (p->ops[i].kind != expected_kinds[i]) {
+            fmt_program_free(p);
+            TEST_FAIL("wrong op kind");
+        }
+    }
+    if (p->ops[3].conversion != 'l' ||
+        memcmp(p->text + p->ops[2].offset, "] % [", p->ops[2].length) != 0) {
+        fmt_program_free(p);
+        TEST_FAIL("wrong op contents");
+    }
+
+    fmt_program_free(p);
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Format Program Tests\n");
+    printf("=============================\n\n");
+
+    failures += test_integer_specs();
+    failures += test_double_specs();
+    failures += test_string_and_star();
+    failures += test_literals_and_missing_args();
+    failures += test_long_literal();
+    failures += test_pattern_compile();
+
+    printf("\n=============================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
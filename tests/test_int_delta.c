@@ -0,0 +1,198 @@
+/*
+ * Integer delta encoding tests
+ * Verifies that integers encoded against their slot's previous value and
+ * delta round-trip across the full 64-bit range, that steady counters
+ * shrink to a bare nibble, and that the decompressor follows the history
+ * resets at clock sync records.
+ */
+
+#include "../include/cnanolog.h"
+#include "../src/compressor.h"
+#include "../src/packer.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_int_delta.clog";
+static const char* TEXT_PATH = "test_int_delta.txt";
+
+#define NUM_SEQUENCE 1000
+
+int test_round_trip_values() {
+    const int64_t signed_values[] = {
+        0, 0, 1, 2, 3, 4, -1, -128, 127, INT32_MIN, INT32_MAX,
+        INT64_MIN, INT64_MAX, INT64_MIN, 1000000007LL, 1000000008LL, 1000000009LL
+    };
+    const uint64_t unsigned_values[] = {
+        0, UINT64_MAX, 0, 0x7FFFFFFFFFFFFFFFULL, 0x8000000000000000ULL,
+        0x7f00deadbe00ULL, 0x7f00deadbe40ULL, 0x7f00deadbe80ULL, 1, UINT32_MAX
+    };
+    const size_t num_signed = sizeof(signed_values) / sizeof(signed_values[0]);
+    const size_t num_unsigned = sizeof(unsigned_values) / sizeof(unsigned_values[0]);
+
+    char buf[(num_signed + num_unsigned) * sizeof(uint64_t)];
+    uint8_t nibbles[num_signed + num_unsigned];
+    delta_slot_t enc_signed, enc_unsigned;
+    memset(&enc_signed, 0, sizeof(enc_signed));
+    memset(&enc_unsigned, 0, sizeof(enc_unsigned));
+
+    char* write_ptr = buf;
+    for (size_t i = 0; i < num_signed; i++) {
+        nibbles[i] = pack_int_delta(&write_ptr, (uint64_t)signed_values[i], 1, &enc_signed);
+    }
+    for (size_t i = 0; i < num_unsigned; i++) {
+        nibbles[num_signed + i] = pack_int_delta(&write_ptr, unsigned_values[i], 0, &enc_unsigned);
+    }
+
+    delta_slot_t dec_signed, dec_unsigned;
+    memset(&dec_signed, 0, sizeof(dec_signed));
+    memset(&dec_unsigned, 0, sizeof(dec_unsigned));
+    const char* read_ptr = buf;
+    for (size_t i = 0; i < num_signed; i++) {
+        uint64_t out;
+        if (unpack_int_delta(&read_ptr, write_ptr, nibbles[i], 1, &dec_signed, &out) != 0) {
+            TEST_FAIL("signed decode failed");
+        }
+        if ((int64_t)out != signed_values[i]) TEST_FAIL("signed value differs");
+    }
+    for (size_t i = 0; i < num_unsigned; i++) {
+        uint64_t out;
+        if (unpack_int_delta(&read_ptr, write_ptr, nibbles[num_signed + i], 0,
+                             &dec_unsigned, &out) != 0) {
+            TEST_FAIL("unsigned decode failed");
+        }
+        if (out != unsigned_values[i]) TEST_FAIL("unsigned value differs");
+    }
+    if (read_ptr != write_ptr) TEST_FAIL("decoder did not consume the stream");
+
+    /* 2, 3, 4 and the 1000000007 run repeat the previous delta */
+    if (nibbles[3] != DELTA_NIBBLE_REPEAT || nibbles[16] != DELTA_NIBBLE_REPEAT) {
+        TEST_FAIL("steady delta not encoded as a bare nibble");
+    }
+
+    /* Truncated absolute value */
+    char bad[2] = {0, 0};
+    const char* bad_ptr = bad;
+    uint64_t out;
+    if (unpack_int_delta(&bad_ptr, bad + sizeof(bad), 4, 0, &dec_unsigned, &out) == 0) {
+        TEST_FAIL("truncated value accepted");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+int test_sequence_shrinkage() {
+    log_site_t site;
+    memset(&site, 0, sizeof(site));
+    site.log_id = 0;
+    site.num_args = 3;
+    site.arg_types[0] = ARG_TYPE_UINT64;   /* Sequence number */
+    site.arg_types[1] = ARG_TYPE_INT64;    /* Order id, steps by 7 */
+    site.arg_types[2] = ARG_TYPE_INT32;    /* Constant session id */
+
+    compress_history_t history;
+    compress_history_init(&history);
+    arg_slot_t* slots = compress_history_get(&history, &site);
+    if (slots == NULL) TEST_FAIL("no history");
+
+    size_t raw_total = 0;
+    size_t compressed_total = 0;
+    for (int i = 0; i < NUM_SEQUENCE; i++) {
+        char args[sizeof(uint64_t) + sizeof(int64_t) + sizeof(int32_t)];
+        uint64_t seq = 5000000000ULL + (uint64_t)i;
+        int64_t order_id = -900000000000LL + 7LL * i;
+        int32_t session = 77123;
+        memcpy(args, &seq, sizeof(seq));
+        memcpy(args + sizeof(seq), &order_id, sizeof(order_id));
+        memcpy(args + sizeof(seq) + sizeof(order_id), &session, sizeof(session));
+
+        char compressed[64];
+        size_t compressed_len = 0;
+        if (compress_entry_args(args, sizeof(args), compressed,
+                                &compressed_len, &site, slots, &history.strings) != 0) {
+            compress_history_destroy(&history);
+            TEST_FAIL("compress failed");
+        }
+        if (compressed_len > compress_max_size(&site, sizeof(args))) {
+            compress_history_destroy(&history);
+            TEST_FAIL("compress_max_size exceeded");
+        }
+        raw_total += sizeof(args);
+        compressed_total += compressed_len;
+    }
+    compress_history_destroy(&history);
+
+    printf("    %zu raw bytes -> %zu compressed (%.1fx)\n",
+           raw_total, compressed_total, (double)raw_total / (double)compressed_total);
+    /* Steady state is the two nibble bytes alone */
+    if (compressed_total > 3 * NUM_SEQUENCE) TEST_FAIL("counters not reduced to nibbles");
+    TEST_PASS();
+    return 0;
+}
+
+int test_decompressor_round_trip() {
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+    for (int i = 0; i < NUM_SEQUENCE; i++) {
+        LOG_INFO("seq %llu id %lld delta %d", (unsigned long long)(1ULL << 40) + i,
+                 (long long)INT64_MIN + 3LL * i, -i);
+        /* Cross at least one periodic sync record mid-run */
+        if (i == NUM_SEQUENCE / 2) usleep(1200000);
+    }
+    cnanolog_shutdown();
+
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "../tools/decompressor %s %s 2>/dev/null", LOG_PATH, TEXT_PATH);
+    if (system(cmd) != 0) TEST_FAIL("decompressor failed");
+
+    FILE* f = fopen(TEXT_PATH, "r");
+    if (f == NULL) TEST_FAIL("no output");
+    char line[256];
+    int i = 0;
+    int errors = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char expected[96];
+        snprintf(expected, sizeof(expected), "seq %llu id %lld delta %d",
+                 (unsigned long long)(1ULL << 40) + i, (long long)INT64_MIN + 3LL * i, -i);
+        if (strstr(line, expected) == NULL) errors++;
+        i++;
+    }
+    fclose(f);
+
+    if (i != NUM_SEQUENCE) TEST_FAIL("lines missing");
+    if (errors != 0) TEST_FAIL("decoded values differ");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Integer Delta Tests\n");
+    printf("============================\n\n");
+
+    failures += test_round_trip_values();
+    failures += test_sequence_shrinkage();
+    failures += test_decompressor_round_trip();
+
+    unlink(LOG_PATH);
+    unlink(TEXT_PATH);
+
+    printf("\n============================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
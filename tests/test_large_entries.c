@@ -0,0 +1,223 @@
+/*
+ * Large entry tests
+ * Verifies that entries over 64KB are written with an extended varint
+ * length, that text mode caps the rendered line without losing the
+ * entries around it, and that entries over
+ * CNANOLOG_MAX_ENTRY_SIZE are dropped and counted.
+ */
+
+#include "../include/cnanolog.h"
+#include "../include/cnanolog_format.h"
+#include "../src/text_formatter.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* BINARY_PATH = "test_large_entries.clog";
+static const char* TEXT_PATH = "test_large_entries.log";
+
+#define LARGE_STRING_LEN (100 * 1024)
+
+static char* make_string(size_t len) {
+    char* str = malloc(len + 1);
+    if (str == NULL) return NULL;
+    for (size_t i = 0; i < len; i++) {
+        str[i] = (char)('a' + i % 26);
+    }
+    str[len] = '\0';
+    return str;
+}
+
+int test_varint_round_trip() {
+    const uint32_t values[] = {0, 1, 127, 128, 16383, 16384, 0xFFFF, 1u << 20, UINT32_MAX};
+
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); i++) {
+        uint8_t buf[CNANOLOG_VARINT_MAX_BYTES];
+        size_t written = cnanolog_varint_encode(values[i], buf);
+        uint32_t decoded = 0;
+        if (cnanolog_varint_decode(buf, written, &decoded) != written) TEST_FAIL("length mismatch");
+        if (decoded != values[i]) TEST_FAIL("value mismatch");
+        if (written > 1 && cnanolog_varint_decode(buf, written - 1, &decoded) != 0) {
+            TEST_FAIL("truncated varint accepted");
+        }
+    }
+
+    cnanolog_file_header_t header;
+    memset(&header, 0, sizeof(header));
+    cnanolog_header_set_entry_count(&header, 0x123456789ULL);
+    if (header.entry_count != 0x23456789 || header.entry_count_high != 0x1) TEST_FAIL("count split wrong");
+    if (cnanolog_header_entry_count(&header) != 0x123456789ULL) TEST_FAIL("count join wrong");
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_binary_large_entry() {
+    char* big = make_string(LARGE_STRING_LEN);
+    if (big == NULL) TEST_FAIL("allocation failed");
+
+    unlink(BINARY_PATH);
+    if (cnanolog_init(BINARY_PATH) != 0) {
+        free(big);
+        TEST_FAIL("init failed");
+    }
+    LOG_INFO("before %d", 1);
+    LOG_INFO("big %s", big);
+    LOG_INFO("after %d", 2);
+    cnanolog_shutdown();
+    free(big);
+
+    FILE* f = fopen(BINARY_PATH, "rb");
+    if (f == NULL) TEST_FAIL("cannot open log");
+
+    cnanolog_file_header_t header;
+    if (fread(&header, 1, sizeof(header), f) != sizeof(header)) {
+        fclose(f);
+        TEST_FAIL("short header");
+    }
+    if (header.version_minor < 2) {
+        fclose(f);
+        TEST_FAIL("version does not advertise extended lengths");
+    }
+
+    uint64_t offset = sizeof(header);
+    uint64_t entries = 0;
+    int found_large = 0;
+    while (offset < header.dictionary_offset) {
+        cnanolog_entry_header_t entry;
+        if (fseek(f, (long)offset, SEEK_SET) != 0 ||
+            fread(&entry, 1, sizeof(entry), f) != sizeof(entry)) break;
+        offset += sizeof(entry);
+
+        uint32_t length = entry.data_length;
+        if (entry.data_length == CNANOLOG_LENGTH_EXTENDED) {
+            uint8_t varint[CNANOLOG_VARINT_MAX_BYTES];
+            size_t avail = fread(varint, 1, sizeof(varint), f);
+            size_t used = cnanolog_varint_decode(varint, avail, &length);
+            if (used == 0) {
+                fclose(f);
+                TEST_FAIL("bad varint length");
+            }
+            offset += used;
+            /* String tag (a varint) + text */
+            if (length > LARGE_STRING_LEN && length <= CNANOLOG_VARINT_MAX_BYTES + LARGE_STRING_LEN) {
+                found_large = 1;
+            }
+        }
+        offset += length;
+        if (entry.log_id != CNANOLOG_SYNC_LOG_ID) entries++;
+    }
+    fclose(f);
+
+    if (offset != header.dictionary_offset) TEST_FAIL("entries do not end at the dictionary");
+    if (!found_large) TEST_FAIL("large entry missing or not extended");
+    if (entries != 3 || cnanolog_header_entry_count(&header) != 3) TEST_FAIL("entry count wrong");
+
+    TEST_PASS();
+    return 0;
+}
+
+static int run_text_large_entry(uint32_t formatter_threads) {
+    char* big = make_string(LARGE_STRING_LEN);
+    if (big == NULL) return -1;
+
+    unlink(TEXT_PATH);
+    cnanolog_rotation_config_t config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = TEXT_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = "%m",
+        .formatter_threads = formatter_threads
+    };
+    if (cnanolog_init_ex(&config) != 0) {
+        free(big);
+        return -1;
+    }
+    LOG_INFO("big %s", big);
+    LOG_INFO("after %d", 2);
+    cnanolog_shutdown();
+
+    FILE* f = fopen(TEXT_PATH, "r");
+    if (f == NULL) {
+        free(big);
+        return -1;
+    }
+    size_t line_size = LARGE_STRING_LEN + 64;
+    char* line = malloc(line_size);
+    int result = -1;
+    if (line != NULL &&
+        fgets(line, (int)line_size, f) != NULL &&
+        strlen(line) <= TEXT_WRITER_MAX_LINE_SIZE &&
+        strncmp(line, "big ", 4) == 0 &&
+        strncmp(line + 4, big, strlen(line) - 5) == 0 &&
+        line[strlen(line) - 1] == '\n' &&
+        fgets(line, (int)line_size, f) != NULL &&
+        strcmp(line, "after 2\n") == 0) {
+        result = 0;
+    }
+    free(line);
+    fclose(f);
+    free(big);
+    return result;
+}
+
+int test_text_large_entry() {
+    if (run_text_large_entry(0) != 0) TEST_FAIL("inline formatter output wrong");
+    if (run_text_large_entry(2) != 0) TEST_FAIL("formatter pool output wrong");
+    TEST_PASS();
+    return 0;
+}
+
+int test_oversized_entry_dropped() {
+    char* huge = make_string(CNANOLOG_MAX_ENTRY_SIZE);
+    if (huge == NULL) TEST_FAIL("allocation failed");
+
+    unlink(BINARY_PATH);
+    if (cnanolog_init(BINARY_PATH) != 0) {
+        free(huge);
+        TEST_FAIL("init failed");
+    }
+    cnanolog_stats_t before;
+    cnanolog_get_stats(&before);
+    LOG_INFO("huge %s", huge);
+    cnanolog_stats_t after;
+    cnanolog_get_stats(&after);
+    cnanolog_shutdown();
+    free(huge);
+
+    if (after.dropped_logs != before.dropped_logs + 1) TEST_FAIL("oversized entry not counted as dropped");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Large Entry Tests\n");
+    printf("==========================\n\n");
+
+    failures += test_varint_round_trip();
+    failures += test_binary_large_entry();
+    failures += test_text_large_entry();
+    failures += test_oversized_entry_dropped();
+
+    unlink(BINARY_PATH);
+    unlink(TEXT_PATH);
+
+    printf("\n==========================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
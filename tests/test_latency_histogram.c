@@ -0,0 +1,136 @@
+/*
+ * Latency histogram tests
+ * Checks the log-linear buckets (precision across the range, percentiles,
+ * merging) and cnanolog_get_latency_stats() in both builds: with
+ * CNANOLOG_ENABLE_LATENCY_HISTOGRAMS the call cost and staging delay of
+ * real log calls are recorded, without it the query fails.
+ */
+
+#include "../include/cnanolog.h"
+#include "latency_histogram.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_latency_histogram.clog";
+
+static latency_histogram_t g_histogram;
+static latency_histogram_t g_other;
+
+int test_bucket_precision() {
+    /* Exact below 64, then within 1/32 of the value, buckets in order */
+    uint32_t previous = 0;
+    for (uint64_t v = 1; v != 0 && v < (1ULL << 62); v = v + v / 7 + 1) {
+        latency_reset(&g_histogram);
+        latency_record(&g_histogram, v);
+        uint64_t reported = latency_percentile(&g_histogram, 50.0);
+        if (reported != v) TEST_FAIL("single value not reported as the maximum");
+
+        uint32_t bucket = latency_bucket(v);
+        if (bucket < previous || bucket >= LATENCY_BUCKETS) TEST_FAIL("buckets out of order");
+        previous = bucket;
+        if (v < 64 && bucket != v) TEST_FAIL("small values not exact");
+    }
+    if (latency_bucket(UINT64_MAX) != LATENCY_BUCKETS - 1) TEST_FAIL("top bucket wrong");
+
+    /* Two values in a bucket report its upper end: within 1/32 above */
+    latency_reset(&g_histogram);
+    latency_record(&g_histogram, 1000000);
+    latency_record(&g_histogram, 5000000);
+    uint64_t p50 = latency_percentile(&g_histogram, 50.0);
+    if (p50 < 1000000 || p50 > 1000000 + 1000000 / 32) TEST_FAIL("bucket bound too coarse");
+    TEST_PASS();
+    return 0;
+}
+
+int test_percentiles() {
+    latency_reset(&g_histogram);
+    latency_reset(&g_other);
+    for (uint64_t v = 1; v <= 10000; v++) {
+        latency_record(v % 2 ? &g_histogram : &g_other, v);
+    }
+    latency_merge(&g_histogram, &g_other);
+
+    if (latency_count(&g_histogram) != 10000) TEST_FAIL("merged count wrong");
+    uint64_t p50 = latency_percentile(&g_histogram, 50.0);
+    uint64_t p99 = latency_percentile(&g_histogram, 99.0);
+    uint64_t p999 = latency_percentile(&g_histogram, 99.9);
+    printf("    p50 %llu p99 %llu p99.9 %llu max %llu\n", (unsigned long long)p50,
+           (unsigned long long)p99, (unsigned long long)p999,
+           (unsigned long long)g_histogram.max);
+    if (p50 < 5000 || p50 > 5000 + 5000 / 32) TEST_FAIL("p50 wrong");
+    if (p99 < 9900 || p99 > 9900 + 9900 / 32) TEST_FAIL("p99 wrong");
+    if (p999 < 9990 || p999 > 10000) TEST_FAIL("p99.9 wrong");
+    if (g_histogram.max != 10000) TEST_FAIL("max wrong");
+
+    latency_reset(&g_histogram);
+    if (latency_percentile(&g_histogram, 99.0) != 0) TEST_FAIL("empty histogram not 0");
+    TEST_PASS();
+    return 0;
+}
+
+int test_latency_stats() {
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+    for (int i = 0; i < 10000; i++) {
+        LOG_INFO("entry %d of %s", i, "latency");
+    }
+    usleep(300000);  /* Let the writer take them */
+
+    cnanolog_latency_stats_t stats;
+    int rc = cnanolog_get_latency_stats(&stats);
+#if defined(CNANOLOG_LATENCY_HISTOGRAMS) && !defined(CNANOLOG_NO_TIMESTAMPS)
+    if (rc != 0) TEST_FAIL("latency stats not available");
+    printf("    call p50 %llu p99 %llu max %llu; delay p50 %llu p99.9 %llu (ticks, %llu/s)\n",
+           (unsigned long long)stats.call_cost.p50, (unsigned long long)stats.call_cost.p99,
+           (unsigned long long)stats.call_cost.max, (unsigned long long)stats.staging_delay.p50,
+           (unsigned long long)stats.staging_delay.p999,
+           (unsigned long long)stats.ticks_per_second);
+    if (stats.call_cost.count != 10000) TEST_FAIL("call cost not recorded per call");
+    if (stats.staging_delay.count != 10000) TEST_FAIL("staging delay not recorded per entry");
+    if (stats.call_cost.p50 == 0 || stats.call_cost.p50 > stats.call_cost.p99 ||
+        stats.call_cost.p99 > stats.call_cost.p999 || stats.call_cost.p999 > stats.call_cost.max) {
+        TEST_FAIL("call cost percentiles inconsistent");
+    }
+    if (stats.ticks_per_second == 0) TEST_FAIL("no frequency");
+
+    cnanolog_reset_stats();
+    cnanolog_get_latency_stats(&stats);
+    if (stats.call_cost.count != 0 || stats.staging_delay.count != 0) TEST_FAIL("reset kept samples");
+#else
+    if (rc != -1 || stats.call_cost.count != 0) TEST_FAIL("stats reported without histograms");
+    printf("    (built without CNANOLOG_ENABLE_LATENCY_HISTOGRAMS)\n");
+#endif
+    cnanolog_shutdown();
+    unlink(LOG_PATH);
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Latency Histogram Tests\n");
+    printf("================================\n\n");
+
+    failures += test_bucket_precision();
+    failures += test_percentiles();
+    failures += test_latency_stats();
+
+    printf("\n================================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
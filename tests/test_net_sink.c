@@ -0,0 +1,253 @@
+/*
+ * Network sink tests
+ * Streams entries to cnanolog-receiver over a Unix domain socket and TCP,
+ * and starts the collector only after logging began to exercise the
+ * spool and replay. Every entry must decode from the received file.
+ */
+
+#include "../include/cnanolog.h"
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* RECEIVER_PATH = "../tools/cnanolog-receiver";
+static const char* MAIN_PATH = "test_net_sink_main.clog";
+static const char* PREFIX = "test_net_sink_recv";
+static const char* RECEIVED_PATH = "test_net_sink_recv-1.clog";
+static const char* SPOOL_PATH = "test_net_sink.spool";
+static const char* DECODED_PATH = "test_net_sink_decoded.txt";
+
+#define NET_THREADS 2
+#define NET_ENTRIES 20000  /* Per thread */
+
+static char g_socket_path[64];
+
+/* Count lines of a file containing a substring */
+static int count_lines(const char* path, const char* needle) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) return -1;
+    char line[256];
+    int count = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strstr(line, needle) != NULL) count++;
+    }
+    fclose(f);
+    return count;
+}
+
+static int decode(const char* path) {
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "../tools/decompressor %s %s 2>/dev/null", path, DECODED_PATH);
+    return system(cmd) == 0 ? 0 : -1;
+}
+
+static void sleep_ms(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+static pid_t start_receiver(const char* address) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(RECEIVER_PATH, RECEIVER_PATH, address, PREFIX, (char*)NULL);
+        _exit(127);
+    }
+    return pid;
+}
+
+/* SIGTERM: the receiver finishes its files and exits */
+static int stop_receiver(pid_t pid) {
+    int status;
+    if (pid < 0 || kill(pid, SIGTERM) != 0) return -1;
+    if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) return -1;
+    return WEXITSTATUS(status);
+}
+
+static void remove_outputs(void) {
+    unlink(MAIN_PATH);
+    unlink(RECEIVED_PATH);
+    unlink("test_net_sink_recv-2.clog");
+    unlink(SPOOL_PATH);
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void* log_thread(void* arg) {
+    int thread = (int)(intptr_t)arg;
+    for (int i = 0; i < NET_ENTRIES; i++) {
+        LOG_INFO("thread %d entry %d price %f on %s", thread, i, i * 0.25, "XNAS");
+    }
+    return NULL;
+}
+
+static int check_threads(void) {
+    if (decode(RECEIVED_PATH) != 0) return -1;
+    int total = count_lines(DECODED_PATH, " on XNAS");
+    printf("    %d of %d entries received\n", total, NET_THREADS * NET_ENTRIES);
+    if (total != NET_THREADS * NET_ENTRIES) return -1;
+    for (int t = 0; t < NET_THREADS; t++) {
+        char needle[96];
+        snprintf(needle, sizeof(needle), "thread %d entry %d price %f on XNAS", t,
+                 NET_ENTRIES - 1, (NET_ENTRIES - 1) * 0.25);
+        if (count_lines(DECODED_PATH, needle) != 1) return -1;
+    }
+    return 0;
+}
+
+static int stream_threads(const char* address) {
+    cnanolog_sink_config_t collector = {
+        .path = address,
+        .format = CNANOLOG_OUTPUT_BINARY
+    };
+    if (cnanolog_add_sink(&collector) != 0) return -1;
+    if (cnanolog_init(MAIN_PATH) != 0) return -1;
+
+    pthread_t threads[NET_THREADS];
+    for (int t = 0; t < NET_THREADS; t++) {
+        pthread_create(&threads[t], NULL, log_thread, (void*)(intptr_t)t);
+    }
+    for (int t = 0; t < NET_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    cnanolog_shutdown();
+    cnanolog_add_sink(NULL);
+    return 0;
+}
+
+int test_unix_socket() {
+    remove_outputs();
+    char address[80];
+    snprintf(address, sizeof(address), "unix:%s", g_socket_path);
+
+    pid_t receiver = start_receiver(address);
+    struct stat st;
+    for (int i = 0; i < 200 && stat(g_socket_path, &st) != 0; i++) {
+        sleep_ms(10);
+    }
+
+    if (stream_threads(address) != 0) TEST_FAIL("logging failed");
+    if (stop_receiver(receiver) != 0) TEST_FAIL("receiver failed");
+    if (check_threads() != 0) TEST_FAIL("entries lost or wrong");
+    TEST_PASS();
+    return 0;
+}
+
+int test_tcp() {
+    remove_outputs();
+    char address[64];
+    snprintf(address, sizeof(address), "tcp:127.0.0.1:%d", 20000 + (int)(getpid() % 20000));
+
+    /* Up or not, the sink retries until the collector listens */
+    pid_t receiver = start_receiver(address);
+    if (stream_threads(address) != 0) TEST_FAIL("logging failed");
+    if (stop_receiver(receiver) != 0) TEST_FAIL("receiver failed");
+    if (check_threads() != 0) TEST_FAIL("entries lost or wrong");
+    TEST_PASS();
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int test_spool_replay() {
+    remove_outputs();
+    char address[80];
+    snprintf(address, sizeof(address), "unix:%s", g_socket_path);
+    unlink(g_socket_path);
+
+    cnanolog_sink_config_t collector = {
+        .path = address,
+        .format = CNANOLOG_OUTPUT_BINARY,
+        .spool_path = SPOOL_PATH
+    };
+    cnanolog_add_sink(&collector);
+    if (cnanolog_init(MAIN_PATH) != 0) TEST_FAIL("init failed");
+
+    /* Collector down: batches (one per idle flush) fill the queue, then spool */
+    int round = 0;
+    struct stat st;
+    for (; round < 500; round++) {
+        for (int i = 0; i < 100; i++) {
+            LOG_WARN("round %d entry %d of %s", round, i, "spooled");
+        }
+        sleep_ms(2);
+        if (round >= 20 && stat(SPOOL_PATH, &st) == 0 && st.st_size > 0) {
+            round++;
+            break;
+        }
+    }
+    if (stat(SPOOL_PATH, &st) != 0 || st.st_size == 0) TEST_FAIL("nothing spooled");
+
+    /* Collector up: queue and spool are replayed, then live entries follow */
+    pid_t receiver = start_receiver(address);
+    for (int i = 0; i < 1000; i++) {
+        LOG_ERROR("live %d code %d", i, -i);
+    }
+    sleep_ms(200);
+    cnanolog_shutdown();
+    cnanolog_add_sink(NULL);
+    if (stop_receiver(receiver) != 0) TEST_FAIL("receiver failed");
+    if (access(SPOOL_PATH, F_OK) == 0) TEST_FAIL("spool not removed");
+
+    if (decode(RECEIVED_PATH) != 0) TEST_FAIL("received log does not decode");
+    int spooled = count_lines(DECODED_PATH, " of spooled");
+    printf("    %d of %d spooled entries, %d live\n", spooled, round * 100,
+           count_lines(DECODED_PATH, "live "));
+    if (spooled != round * 100) TEST_FAIL("spooled entries lost");
+    if (count_lines(DECODED_PATH, "round 0 entry 0 of spooled") != 1) TEST_FAIL("first entry wrong");
+    if (count_lines(DECODED_PATH, "live ") != 1000) TEST_FAIL("live entries lost");
+    if (count_lines(DECODED_PATH, "live 999 code -999") != 1) TEST_FAIL("last entry wrong");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Network Sink Tests\n");
+    printf("===========================\n\n");
+
+    snprintf(g_socket_path, sizeof(g_socket_path), "/tmp/cnanolog_test_%d.sock", (int)getpid());
+
+    static const uint8_t text_only[] = {LOG_LEVEL_INFO};
+    cnanolog_sink_config_t bad = {
+        .path = "unix:/tmp/x.sock",
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .levels = text_only,
+        .num_levels = 1
+    };
+    if (cnanolog_add_sink(&bad) != -1) {
+        printf("  ✗ text collector sink accepted\n");
+        failures++;
+    }
+
+    failures += test_unix_socket();
+    failures += test_tcp();
+    failures += test_spool_replay();
+
+    remove_outputs();
+    unlink(DECODED_PATH);
+    unlink(g_socket_path);
+
+    printf("\n===========================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
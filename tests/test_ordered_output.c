@@ -0,0 +1,158 @@
+/*
+ * Ordered output tests
+ * Verifies that with a reordering window, lines from several threads are
+ * written in timestamp order and none are lost.
+ */
+
+#include "../include/cnanolog.h"
+#include "../src/platform.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+#define NUM_PRODUCERS 4
+#define LOGS_PER_PRODUCER 50000
+#define TIMESTAMP_LEN 29  /* "YYYY-MM-DD HH:MM:SS.nnnnnnnnn" */
+
+static const char* LOG_PATH = "test_ordered_output.log";
+
+static void* producer_main(void* arg) {
+    int id = (int)(size_t)arg;
+    for (int i = 0; i < LOGS_PER_PRODUCER; i++) {
+        LOG_INFO("producer %d seq %d", id, i);
+    }
+    return NULL;
+}
+
+static int run_ordered_logger(uint32_t formatter_threads) {
+    unlink(LOG_PATH);
+
+    cnanolog_rotation_config_t config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = LOG_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = "%t %m",
+        .formatter_threads = formatter_threads,
+        .reorder_window_us = 50000
+    };
+    if (cnanolog_init_ex(&config) != 0) {
+        return -1;
+    }
+
+    cnanolog_thread_t threads[NUM_PRODUCERS];
+    for (int i = 0; i < NUM_PRODUCERS; i++) {
+        cnanolog_thread_create(&threads[i], producer_main, (void*)(size_t)i);
+    }
+    for (int i = 0; i < NUM_PRODUCERS; i++) {
+        cnanolog_thread_join(threads[i], NULL);
+    }
+
+    cnanolog_shutdown();
+    return 0;
+}
+
+/**
+ * Check that timestamps never go backwards and every line is present.
+ * Fixed-width timestamps compare correctly as strings.
+ */
+static int verify_ordered_log(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) {
+        return -1;
+    }
+
+    char prev[TIMESTAMP_LEN + 1] = "";
+    int next_seq[NUM_PRODUCERS] = {0};
+    char line[256];
+    int errors = 0;
+
+    while (fgets(line, sizeof(line), f) != NULL) {
+        int id, seq;
+        if (strlen(line) <= TIMESTAMP_LEN ||
+            sscanf(line + TIMESTAMP_LEN, " producer %d seq %d", &id, &seq) != 2 ||
+            id < 0 || id >= NUM_PRODUCERS) {
+            errors++;
+            continue;
+        }
+        if (memcmp(line, prev, TIMESTAMP_LEN) < 0) {
+            errors++;
+        }
+        memcpy(prev, line, TIMESTAMP_LEN);
+
+        if (seq != next_seq[id]) {
+            errors++;
+        }
+        next_seq[id] = seq + 1;
+    }
+    fclose(f);
+
+    for (int id = 0; id < NUM_PRODUCERS; id++) {
+        if (next_seq[id] != LOGS_PER_PRODUCER) {
+            errors++;
+        }
+    }
+    return errors;
+}
+
+int test_ordered_inline() {
+    if (run_ordered_logger(0) != 0) TEST_FAIL("init failed");
+    if (verify_ordered_log(LOG_PATH) != 0) {
+        TEST_FAIL("lines out of timestamp order or missing");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+int test_ordered_with_formatter_pool() {
+    if (run_ordered_logger(2) != 0) TEST_FAIL("init failed");
+    if (verify_ordered_log(LOG_PATH) != 0) {
+        TEST_FAIL("lines out of timestamp order or missing");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+int test_rejects_oversized_window() {
+    cnanolog_rotation_config_t config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = LOG_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .reorder_window_us = 5000000
+    };
+    if (cnanolog_init_ex(&config) == 0) {
+        cnanolog_shutdown();
+        TEST_FAIL("accepted a 5 second window");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Ordered Output Tests\n");
+    printf("=============================\n\n");
+
+    failures += test_ordered_inline();
+    failures += test_ordered_with_formatter_pool();
+    failures += test_rejects_oversized_window();
+
+    unlink(LOG_PATH);
+
+    printf("\n=============================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
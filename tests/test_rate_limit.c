@@ -0,0 +1,202 @@
+/*
+ * Rate limiting and sampling tests
+ * Checks the EVERY_N, RATE and SAMPLED macros: how many calls get through,
+ * that limits are per thread, and that every suppressed call is accounted
+ * for by a "(suppressed N)" suffix on the next logged entry.
+ */
+
+#include "../include/cnanolog.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_rate_limit.log";
+
+typedef struct {
+    int lines;                      /* Lines containing the needle */
+    int with_suffix;                /* ... of which report suppressed calls */
+    unsigned long long suppressed;  /* Sum of the reported counts */
+} line_count_t;
+
+static int start(void) {
+    unlink(LOG_PATH);
+    cnanolog_rotation_config_t config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = LOG_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = "%m"
+    };
+    return cnanolog_init_ex(&config);
+}
+
+static line_count_t count_lines(const char* needle) {
+    line_count_t count = {0, 0, 0};
+    FILE* f = fopen(LOG_PATH, "r");
+    if (f == NULL) return count;
+    char line[256];
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strstr(line, needle) == NULL) continue;
+        count.lines++;
+        const char* suffix = strstr(line, "(suppressed ");
+        if (suffix != NULL) {
+            count.with_suffix++;
+            count.suppressed += strtoull(suffix + strlen("(suppressed "), NULL, 10);
+        }
+    }
+    fclose(f);
+    return count;
+}
+
+static int has_line(const char* text) {
+    FILE* f = fopen(LOG_PATH, "r");
+    if (f == NULL) return 0;
+    char line[256];
+    int found = 0;
+    while (!found && fgets(line, sizeof(line), f) != NULL) {
+        line[strcspn(line, "\n")] = '\0';
+        found = strcmp(line, text) == 0;
+    }
+    fclose(f);
+    return found;
+}
+
+static uint64_t now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int test_every_n() {
+    if (start() != 0) TEST_FAIL("init failed");
+    for (int i = 0; i < 1000; i++) {
+        LOG_WARN_EVERY_N(100, "every %d of %s", i, "loop");
+    }
+    cnanolog_shutdown();
+
+    line_count_t count = count_lines(" of loop");
+    if (count.lines != 10) TEST_FAIL("expected 10 entries");
+    if (count.with_suffix != 9 || count.suppressed != 9 * 99) TEST_FAIL("wrong suppressed counts");
+    if (!has_line("every 0 of loop")) TEST_FAIL("first call not logged plainly");
+    if (!has_line("every 900 of loop (suppressed 99)")) TEST_FAIL("last entry wrong");
+    TEST_PASS();
+    return 0;
+}
+
+static void tick(int thread, int i) {
+    LOG_INFO_EVERY_N(100, "thread %d tick %d", thread, i);
+}
+
+static void* tick_thread(void* arg) {
+    int thread = (int)(intptr_t)arg;
+    for (int i = 0; i < 500; i++) {
+        tick(thread, i);
+    }
+    return NULL;
+}
+
+int test_per_thread() {
+    if (start() != 0) TEST_FAIL("init failed");
+    pthread_t threads[2];
+    for (int t = 0; t < 2; t++) {
+        pthread_create(&threads[t], NULL, tick_thread, (void*)(intptr_t)t);
+    }
+    for (int t = 0; t < 2; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    cnanolog_shutdown();
+
+    /* Each thread counts on its own: 5 entries each, first one plain */
+    line_count_t count = count_lines(" tick ");
+    if (count.lines != 10 || count.suppressed != 8 * 99) TEST_FAIL("limit shared between threads");
+    if (!has_line("thread 0 tick 0") || !has_line("thread 1 tick 0")) TEST_FAIL("first calls not logged");
+    TEST_PASS();
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void rate_call(int i) {
+    LOG_ERROR_RATE(100, "rate %d", i);
+}
+
+int test_rate() {
+    if (start() != 0) TEST_FAIL("init failed");
+
+    /* A burst of up to 100, then 100 per second */
+    int calls = 0;
+    uint64_t begin = now_ms();
+    while (now_ms() - begin < 300) {
+        rate_call(calls++);
+    }
+    usleep(1100000);
+    rate_call(calls++);  /* Admitted again, carries the rest of the count */
+    cnanolog_shutdown();
+
+    line_count_t during = count_lines("rate ");
+    printf("    %d calls, %d logged\n", calls, during.lines);
+    if (during.lines < 100 || during.lines > 170) TEST_FAIL("rate not enforced");
+    if (during.suppressed + (unsigned long long)during.lines != (unsigned long long)calls) {
+        TEST_FAIL("suppressed calls not accounted for");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int test_sampled() {
+    if (start() != 0) TEST_FAIL("init failed");
+    for (int i = 0; i < 100000; i++) {
+        LOG_DEBUG_SAMPLED(0.1, "sampled %d", i);
+        LOG_INFO_SAMPLED(0.0, "never %d", i);
+        if (i < 1000) {
+            LOG_WARN_SAMPLED(1.0, "always %d", i);
+        }
+    }
+    cnanolog_shutdown();
+
+    line_count_t sampled = count_lines("sampled ");
+    printf("    %d of 100000 sampled\n", sampled.lines);
+    if (sampled.lines < 9000 || sampled.lines > 11000) TEST_FAIL("sampling rate off");
+    if (sampled.suppressed + (unsigned long long)sampled.lines > 100000) TEST_FAIL("counts too high");
+    if (count_lines("never ").lines != 0) TEST_FAIL("p = 0 logged");
+    line_count_t always = count_lines("always ");
+    if (always.lines != 1000 || always.with_suffix != 0) TEST_FAIL("p = 1 dropped calls");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Rate Limiting Tests\n");
+    printf("============================\n\n");
+
+    failures += test_every_n();
+    failures += test_per_thread();
+    failures += test_rate();
+    failures += test_sampled();
+
+    unlink(LOG_PATH);
+
+    printf("\n============================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
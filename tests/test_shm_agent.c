@@ -0,0 +1,183 @@
+/*
+ * Out-of-process writer tests
+ * Logs through cnanolog_init_shared() with cnanolog-agent writing the file:
+ * a normal run from several threads, and a child that aborts before the
+ * agent is even started. Every committed entry must decode.
+ */
+
+#include "../include/cnanolog.h"
+#include <pthread.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* AGENT_PATH = "../tools/cnanolog-agent";
+static const char* LOG_PATH = "test_shm_agent.clog";
+static const char* DECODED_PATH = "test_shm_agent_decoded.txt";
+
+#define AGENT_THREADS 4
+#define AGENT_ENTRIES 20000  /* Per thread */
+
+static char g_shm_name[64];
+
+/* Count lines of a file containing a substring */
+static int count_lines(const char* path, const char* needle) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) return -1;
+    char line[256];
+    int count = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strstr(line, needle) != NULL) count++;
+    }
+    fclose(f);
+    return count;
+}
+
+static int decode(void) {
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "../tools/decompressor %s %s 2>/dev/null",
+             LOG_PATH, DECODED_PATH);
+    return system(cmd) == 0 ? 0 : -1;
+}
+
+static pid_t start_agent(void) {
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        execl(AGENT_PATH, AGENT_PATH, g_shm_name, LOG_PATH, "5", (char*)NULL);
+        _exit(127);
+    }
+    return pid;
+}
+
+/* Exit status of the agent, -1 if it did not exit normally */
+static int wait_agent(pid_t pid) {
+    int status;
+    if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status)) return -1;
+    return WEXITSTATUS(status);
+}
+
+/* ---------------------------------------------------------------------- */
+
+static const cnanolog_string_t* g_venue;
+
+static void* log_thread(void* arg) {
+    int thread = (int)(intptr_t)arg;
+    for (int i = 0; i < AGENT_ENTRIES; i++) {
+        LOG_INFO("thread %d entry %d price %f on %s via %s", thread, i, i * 0.25,
+                 g_venue, "shm");
+    }
+    return NULL;
+}
+
+int test_agent_writes_log() {
+    unlink(LOG_PATH);
+    g_venue = cnanolog_intern("XNAS");  /* Before init: published by init */
+
+    if (cnanolog_init_shared(g_shm_name, 0) != 0) TEST_FAIL("init_shared failed");
+    pid_t agent = start_agent();
+
+    const cnanolog_string_t* late = cnanolog_intern("late string");
+    pthread_t threads[AGENT_THREADS];
+    for (int t = 0; t < AGENT_THREADS; t++) {
+        pthread_create(&threads[t], NULL, log_thread, (void*)(intptr_t)t);
+    }
+    for (int t = 0; t < AGENT_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    LOG_WARN("interned after init: %s", late);
+    cnanolog_shutdown();
+    if (cnanolog_init("test_shm_agent_other.clog") == 0) TEST_FAIL("init after shared session");
+
+    if (wait_agent(agent) != 0) TEST_FAIL("agent failed");
+    if (decode() != 0) TEST_FAIL("log does not decode");
+
+    int total = count_lines(DECODED_PATH, "on XNAS via shm");
+    printf("    %d of %d entries written\n", total, AGENT_THREADS * AGENT_ENTRIES);
+    if (total != AGENT_THREADS * AGENT_ENTRIES) TEST_FAIL("entries lost");
+    for (int t = 0; t < AGENT_THREADS; t++) {
+        char needle[96];
+        snprintf(needle, sizeof(needle), "thread %d entry %d price %f on XNAS", t,
+                 AGENT_ENTRIES - 1, (AGENT_ENTRIES - 1) * 0.25);
+        if (count_lines(DECODED_PATH, needle) != 1) TEST_FAIL("thread's last entry wrong");
+    }
+    if (count_lines(DECODED_PATH, "interned after init: late string") != 1) {
+        TEST_FAIL("late interned string lost");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void child_abort(void) {
+    if (cnanolog_init_shared(g_shm_name, 2) != 0) _exit(1);
+    for (int i = 0; i < AGENT_ENTRIES; i++) {
+        LOG_ERROR("before crash %d of %s", i, "abort");
+    }
+    abort();
+}
+
+int test_agent_after_crash() {
+    unlink(LOG_PATH);
+
+    /* The application is gone before the agent starts */
+    fflush(stdout);
+    pid_t child = fork();
+    if (child == 0) {
+        struct rlimit no_core = {0, 0};
+        setrlimit(RLIMIT_CORE, &no_core);
+        child_abort();
+    }
+    int status;
+    if (child < 0 || waitpid(child, &status, 0) != child) TEST_FAIL("fork failed");
+    if (!WIFSIGNALED(status) || WTERMSIG(status) != SIGABRT) TEST_FAIL("child did not abort");
+
+    if (wait_agent(start_agent()) != 0) TEST_FAIL("agent failed");
+    if (decode() != 0) TEST_FAIL("log does not decode");
+
+    int saved = count_lines(DECODED_PATH, "before crash");
+    printf("    %d of %d entries written\n", saved, AGENT_ENTRIES);
+    if (saved != AGENT_ENTRIES) TEST_FAIL("entries lost");
+    char last[64];
+    snprintf(last, sizeof(last), "before crash %d of abort", AGENT_ENTRIES - 1);
+    if (count_lines(DECODED_PATH, last) != 1) TEST_FAIL("last entry wrong");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Out-of-Process Writer Tests\n");
+    printf("====================================\n\n");
+
+    snprintf(g_shm_name, sizeof(g_shm_name), "/cnanolog_test_%d", (int)getpid());
+
+    /* Crash first: the normal run maps its segment for good */
+    failures += test_agent_after_crash();
+    failures += test_agent_writes_log();
+
+    unlink(LOG_PATH);
+    unlink(DECODED_PATH);
+
+    printf("\n====================================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
@@ -0,0 +1,226 @@
+/*
+ * Additional sink tests
+ * Routes entries to extra text, JSON and binary outputs by level and
+ * file, and checks every output holds exactly the entries meant for it.
+ */
+
+#include "../include/cnanolog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* MAIN_PATH = "test_sinks_main.clog";
+static const char* MAIN_TEXT_PATH = "test_sinks_main.log";
+static const char* ERROR_PATH = "test_sinks_errors.log";
+static const char* WARN_PATH = "test_sinks_warn.jsonl";
+static const char* COPY_PATH = "test_sinks_copy.clog";
+static const char* OTHER_PATH = "test_sinks_other.log";
+static const char* DECODED_PATH = "test_sinks_decoded.txt";
+
+#define ROUNDS 1000
+
+/* Count lines of a file containing a substring */
+static int count_lines(const char* path, const char* needle) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) return -1;
+    char line[512];
+    int count = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strstr(line, needle) != NULL) count++;
+    }
+    fclose(f);
+    return count;
+}
+
+static int count_decoded(const char* path, const char* needle) {
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "../tools/decompressor %s %s 2>/dev/null", path, DECODED_PATH);
+    if (system(cmd) != 0) return -1;
+    return count_lines(DECODED_PATH, needle);
+}
+
+static void remove_outputs(void) {
+    unlink(MAIN_PATH);
+    unlink(MAIN_TEXT_PATH);
+    unlink(ERROR_PATH);
+    unlink(WARN_PATH);
+    unlink(COPY_PATH);
+    unlink(OTHER_PATH);
+}
+
+static void log_rounds(void) {
+    for (int i = 0; i < ROUNDS; i++) {
+        LOG_INFO("info %d value %f", i, i * 0.5);
+        if (i % 10 == 0) LOG_WARN("warn %d of %s", i, "disk");
+        if (i % 100 == 0) LOG_ERROR("error %d code %d", i, -i);
+    }
+}
+
+/* ---------------------------------------------------------------------- */
+
+int test_level_routing() {
+    remove_outputs();
+
+    static const uint8_t errors[] = {LOG_LEVEL_ERROR};
+    static const uint8_t warnings[] = {LOG_LEVEL_WARN, LOG_LEVEL_ERROR};
+    cnanolog_sink_config_t oncall = {
+        .path = ERROR_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = "%l %m",
+        .levels = errors,
+        .num_levels = 1
+    };
+    cnanolog_sink_config_t collector = {
+        .path = WARN_PATH,
+        .format = CNANOLOG_OUTPUT_JSON,
+        .levels = warnings,
+        .num_levels = 2
+    };
+    cnanolog_sink_config_t copy = {
+        .path = COPY_PATH,
+        .format = CNANOLOG_OUTPUT_BINARY,
+        .levels = warnings,
+        .num_levels = 2
+    };
+    if (cnanolog_add_sink(&oncall) != 0) TEST_FAIL("add text sink failed");
+    if (cnanolog_add_sink(&collector) != 1) TEST_FAIL("add JSON sink failed");
+    if (cnanolog_add_sink(&copy) != 2) TEST_FAIL("add binary sink failed");
+
+    if (cnanolog_init(MAIN_PATH) != 0) TEST_FAIL("init failed");
+    if (cnanolog_add_sink(&oncall) != -1) TEST_FAIL("sink added after init");
+    log_rounds();
+    cnanolog_shutdown();
+
+    /* Main output: everything */
+    if (count_decoded(MAIN_PATH, "info ") != ROUNDS) TEST_FAIL("main log lost INFO");
+    if (count_lines(DECODED_PATH, "warn ") != ROUNDS / 10) TEST_FAIL("main log lost WARN");
+    if (count_lines(DECODED_PATH, "error ") != ROUNDS / 100) TEST_FAIL("main log lost ERROR");
+
+    /* On-call text: ERROR only */
+    if (count_lines(ERROR_PATH, "ERROR error ") != ROUNDS / 100) TEST_FAIL("ERROR sink incomplete");
+    if (count_lines(ERROR_PATH, "ERROR error 900 code -900") != 1) TEST_FAIL("ERROR line wrong");
+    if (count_lines(ERROR_PATH, "info ") != 0 || count_lines(ERROR_PATH, "warn ") != 0) {
+        TEST_FAIL("ERROR sink got other levels");
+    }
+
+    /* Collector JSON: WARN and ERROR */
+    if (count_lines(WARN_PATH, "\"level\":\"WARN\"") != ROUNDS / 10) TEST_FAIL("JSON sink lost WARN");
+    if (count_lines(WARN_PATH, "\"level\":\"ERROR\"") != ROUNDS / 100) TEST_FAIL("JSON sink lost ERROR");
+    if (count_lines(WARN_PATH, "info ") != 0) TEST_FAIL("JSON sink got INFO");
+
+    /* Binary copy: its own history and dictionary */
+    if (count_decoded(COPY_PATH, "warn ") != ROUNDS / 10) TEST_FAIL("binary sink lost WARN");
+    if (count_lines(DECODED_PATH, "warn 990 of disk") != 1) TEST_FAIL("binary sink value wrong");
+    if (count_lines(DECODED_PATH, "error 900 code -900") != 1) TEST_FAIL("binary sink ERROR wrong");
+    if (count_lines(DECODED_PATH, "info ") != 0) TEST_FAIL("binary sink got INFO");
+
+    cnanolog_add_sink(NULL);
+    TEST_PASS();
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int test_file_filter() {
+    remove_outputs();
+
+    cnanolog_sink_config_t mine = {
+        .path = ERROR_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = "%f %m",
+        .file_filter = "test_sinks"
+    };
+    cnanolog_sink_config_t other = {
+        .path = OTHER_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .file_filter = "no_such_module.c"
+    };
+    cnanolog_add_sink(&mine);
+    cnanolog_add_sink(&other);
+
+    /* Text main output, binary sink filtered out: sinks do not depend on it */
+    cnanolog_rotation_config_t config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = MAIN_TEXT_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = "%m"
+    };
+    if (cnanolog_init_ex(&config) != 0) TEST_FAIL("init failed");
+    log_rounds();
+    cnanolog_shutdown();
+
+    int total = ROUNDS + ROUNDS / 10 + ROUNDS / 100;
+    if (count_lines(MAIN_TEXT_PATH, " ") != total) TEST_FAIL("main text log incomplete");
+    if (count_lines(ERROR_PATH, "test_sinks.c ") != total) TEST_FAIL("matching sink incomplete");
+    if (count_lines(OTHER_PATH, " ") != 0) TEST_FAIL("filtered sink got entries");
+
+    cnanolog_add_sink(NULL);
+    TEST_PASS();
+    return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int test_flush_interval() {
+    remove_outputs();
+
+    static const uint8_t errors[] = {LOG_LEVEL_ERROR};
+    cnanolog_sink_config_t oncall = {
+        .path = ERROR_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = "%m",
+        .levels = errors,
+        .num_levels = 1,
+        .flush_interval_ms = 20
+    };
+    cnanolog_add_sink(&oncall);
+    if (cnanolog_init(MAIN_PATH) != 0) TEST_FAIL("init failed");
+
+    LOG_ERROR("paged %d", 1);
+
+    /* Written within the interval, while the logger keeps running */
+    int seen = 0;
+    for (int i = 0; i < 100 && !seen; i++) {
+        struct timespec ts = {0, 10000000};  /* 10ms */
+        nanosleep(&ts, NULL);
+        seen = (count_lines(ERROR_PATH, "paged 1") == 1);
+    }
+    cnanolog_shutdown();
+    if (!seen) TEST_FAIL("ERROR line not flushed while running");
+
+    cnanolog_add_sink(NULL);
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Sink Tests\n");
+    printf("===================\n\n");
+
+    failures += test_level_routing();
+    failures += test_file_filter();
+    failures += test_flush_interval();
+
+    remove_outputs();
+    unlink(DECODED_PATH);
+
+    printf("\n===================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
@@ -0,0 +1,183 @@
+/*
+ * Timing span tests
+ * Records nested spans on several threads, exports them with
+ * "decompressor --trace" and checks the Chrome trace events: pairing per
+ * thread, nesting, and durations.
+ */
+
+#include "../include/cnanolog.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_spans.clog";
+static const char* TRACE_PATH = "test_spans.trace.json";
+static const char* TEXT_PATH = "test_spans.txt";
+
+#define SPAN_THREADS 4
+#define SPAN_ROUNDS 1000
+#define MAX_TRACE_THREADS 64
+
+static void sleep_ms(long ms) {
+    struct timespec ts = {ms / 1000, (ms % 1000) * 1000000L};
+    nanosleep(&ts, NULL);
+}
+
+/* Count lines of a file containing a substring */
+static int count_lines(const char* path, const char* needle) {
+    FILE* f = fopen(path, "r");
+    if (f == NULL) return -1;
+    char line[512];
+    int count = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strstr(line, needle) != NULL) count++;
+    }
+    fclose(f);
+    return count;
+}
+
+static int decode(const char* options, const char* output) {
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "../tools/decompressor %s %s %s 2>/dev/null",
+             options, LOG_PATH, output);
+    return system(cmd) == 0 ? 0 : -1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+static void* span_thread(void* arg) {
+    (void)arg;
+    for (int i = 0; i < SPAN_ROUNDS; i++) {
+        CNANOLOG_SPAN_BEGIN(outer, "handle order");
+        LOG_INFO("order %d", i);
+        CNANOLOG_SPAN_BEGIN(inner, "match");
+        CNANOLOG_SPAN_END(inner);
+        CNANOLOG_SPAN_END(outer);
+    }
+    return NULL;
+}
+
+/*
+ * Replay the trace: every E must close the latest open B of its thread,
+ * with the same name and a later timestamp.
+ */
+static int check_trace(int* events, double* sleep_us) {
+    FILE* f = fopen(TRACE_PATH, "r");
+    if (f == NULL) return -1;
+
+    char stack_names[MAX_TRACE_THREADS][4][32];
+    double stack_ts[MAX_TRACE_THREADS][4];
+    int depth[MAX_TRACE_THREADS] = {0};
+    char line[512];
+    int result = 0;
+    *events = 0;
+    *sleep_us = 0;
+
+    while (result == 0 && fgets(line, sizeof(line), f) != NULL) {
+        const char* ph = strstr(line, "\"ph\":\"");
+        if (ph == NULL) continue;
+        char name[32] = "";
+        const char* n = strstr(line, "{\"name\":\"");
+        if (n != NULL) sscanf(n + 9, "%31[^\"]", name);
+        double ts = atof(strstr(line, "\"ts\":") + 5);
+        int tid = atoi(strstr(line, "\"tid\":") + 6);
+        if (tid <= 0 || tid >= MAX_TRACE_THREADS) { result = -1; break; }
+        (*events)++;
+
+        if (ph[6] == 'B') {
+            if (depth[tid] == 4) { result = -1; break; }
+            strcpy(stack_names[tid][depth[tid]], name);
+            stack_ts[tid][depth[tid]] = ts;
+            depth[tid]++;
+        } else {
+            if (depth[tid] == 0) { result = -1; break; }
+            depth[tid]--;
+            if (strcmp(stack_names[tid][depth[tid]], name) != 0) result = -1;
+            if (ts < stack_ts[tid][depth[tid]]) result = -1;
+            if (strcmp(name, "sleep") == 0) *sleep_us = ts - stack_ts[tid][depth[tid]];
+        }
+    }
+    fclose(f);
+
+    for (int t = 0; t < MAX_TRACE_THREADS; t++) {
+        if (depth[t] != 0) result = -1;
+    }
+    return result;
+}
+
+int test_trace_export() {
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+
+    pthread_t threads[SPAN_THREADS];
+    for (int t = 0; t < SPAN_THREADS; t++) {
+        pthread_create(&threads[t], NULL, span_thread, NULL);
+    }
+    for (int t = 0; t < SPAN_THREADS; t++) {
+        pthread_join(threads[t], NULL);
+    }
+
+    CNANOLOG_SPAN_BEGIN(sleep, "sleep");
+    sleep_ms(20);
+    CNANOLOG_SPAN_END(sleep);
+    cnanolog_shutdown();
+
+    if (decode("--trace", TRACE_PATH) != 0) TEST_FAIL("trace export failed");
+    if (count_lines(TRACE_PATH, "\"traceEvents\":[") != 1) TEST_FAIL("no trace header");
+    if (count_lines(TRACE_PATH, "order ") != 0) TEST_FAIL("log entries exported as spans");
+
+    int events;
+    double sleep_us;
+    if (check_trace(&events, &sleep_us) != 0) TEST_FAIL("spans not paired per thread");
+    printf("    %d events, sleep span %.1f us\n", events, sleep_us);
+    if (events != SPAN_THREADS * SPAN_ROUNDS * 4 + 2) TEST_FAIL("span events lost");
+    if (sleep_us < 19000 || sleep_us > 1000000) TEST_FAIL("span duration wrong");
+
+    /* Text output shows the records as entries of the span levels */
+    if (decode("-f \"%l %m\"", TEXT_PATH) != 0) TEST_FAIL("decode failed");
+    if (count_lines(TEXT_PATH, "SPAN_BEGIN handle order") != SPAN_THREADS * SPAN_ROUNDS) {
+        TEST_FAIL("text output wrong");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+int test_reserved_levels() {
+    if (cnanolog_register_level("MINE", LOG_LEVEL_SPAN_BEGIN) != -1) TEST_FAIL("span level registered");
+    if (cnanolog_register_level("MINE", LOG_LEVEL_SPAN_END) != -1) TEST_FAIL("span level registered");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Span Tests\n");
+    printf("===================\n\n");
+
+    failures += test_reserved_levels();
+    failures += test_trace_export();
+
+    unlink(LOG_PATH);
+    unlink(TRACE_PATH);
+    unlink(TEXT_PATH);
+
+    printf("\n===================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
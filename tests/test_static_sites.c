@@ -0,0 +1,152 @@
+/*
+ * Static log site tests
+ * Verifies that log sites placed in the "cnanolog_sites" section get their
+ * ids at init, including sites that have never run, and keep them across
+ * re-init and failed init.
+ */
+
+#include "../include/cnanolog.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_static_sites.clog";
+static const char* DECODED_PATH = "test_static_sites.txt";
+
+/* Never called: its site must still be registered */
+void never_called(int value) {
+    LOG_WARN("never logged %d", value);
+}
+
+#if CNANOLOG_STATIC_SITES
+
+static const cnanolog_site_t* find_site(const char* format) {
+    for (const cnanolog_site_t* site = __start_cnanolog_sites;
+         site < __stop_cnanolog_sites; site++) {
+        if (strcmp(site->format, format) == 0) {
+            return site;
+        }
+    }
+    return NULL;
+}
+
+int test_ids_assigned_at_init() {
+    const cnanolog_site_t* site = find_site("never logged %d");
+    if (site == NULL) TEST_FAIL("site not in section");
+    if (site->log_id != UINT32_MAX) TEST_FAIL("id assigned before init");
+    if (site->num_args != 1 || site->arg_types[0] != ARG_TYPE_INT32) {
+        TEST_FAIL("wrong argument metadata");
+    }
+
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+
+    if (site->log_id == UINT32_MAX) {
+        cnanolog_shutdown();
+        TEST_FAIL("never-called site has no id");
+    }
+
+    /* Every site gets a distinct id */
+    size_t count = (size_t)(__stop_cnanolog_sites - __start_cnanolog_sites);
+    for (size_t i = 0; i < count; i++) {
+        for (size_t j = i + 1; j < count; j++) {
+            if (__start_cnanolog_sites[i].log_id == __start_cnanolog_sites[j].log_id) {
+                cnanolog_shutdown();
+                TEST_FAIL("duplicate site ids");
+            }
+        }
+    }
+
+    LOG_INFO("static site %d", 1);
+    cnanolog_shutdown();
+    TEST_PASS();
+    return 0;
+}
+
+int test_ids_stable_across_reinit() {
+    const cnanolog_site_t* site = find_site("never logged %d");
+    uint32_t first_id = site->log_id;
+
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("re-init failed");
+    never_called(7);
+    cnanolog_shutdown();
+
+    if (site->log_id != first_id) TEST_FAIL("id changed on re-init");
+    TEST_PASS();
+    return 0;
+}
+
+static int count_decoded(const char* needle) {
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "../tools/decompressor %s %s 2>/dev/null",
+             LOG_PATH, DECODED_PATH);
+    if (system(cmd) != 0) return -1;
+    FILE* f = fopen(DECODED_PATH, "r");
+    if (f == NULL) return -1;
+    char line[256];
+    int count = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        if (strstr(line, needle) != NULL) count++;
+    }
+    fclose(f);
+    return count;
+}
+
+int test_ids_kept_after_failed_init() {
+    const cnanolog_site_t* site = find_site("never logged %d");
+    uint32_t first_id = site->log_id;
+
+    /* A failed init must not drop the sites the section ids refer to */
+    if (cnanolog_init("/nonexistent_dir/test_static_sites.clog") == 0) {
+        cnanolog_shutdown();
+        TEST_FAIL("init into a missing directory succeeded");
+    }
+    if (site->log_id != first_id) TEST_FAIL("id changed by failed init");
+
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("retried init failed");
+    never_called(7);
+    LOG_INFO("value %d", 42);
+    cnanolog_shutdown();
+
+    if (count_decoded("never logged 7") != 1) TEST_FAIL("static site missing from dictionary");
+    if (count_decoded("value 42") != 1) TEST_FAIL("lazy site not decoded");
+    unlink(DECODED_PATH);
+    TEST_PASS();
+    return 0;
+}
+
+#endif
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Static Site Tests\n");
+    printf("==========================\n\n");
+
+#if CNANOLOG_STATIC_SITES
+    failures += test_ids_assigned_at_init();
+    failures += test_ids_stable_across_reinit();
+    failures += test_ids_kept_after_failed_init();
+#else
+    printf("  (linker sections unavailable, skipped)\n");
+#endif
+
+    unlink(LOG_PATH);
+
+    printf("\n==========================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
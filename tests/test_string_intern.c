@@ -0,0 +1,269 @@
+/*
+ * String interning tests
+ * Verifies that repeated strings are written as intern table ids, that the
+ * decoder's table follows the writer's through LRU eviction, that
+ * pre-interned handles log like strings in text and binary output, and
+ * that the decompressor keeps the table in step across filtered entries.
+ */
+
+#include "../include/cnanolog.h"
+#include "../src/compressor.h"
+#include "../src/string_intern.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_string_intern.clog";
+static const char* TEXT_PATH = "test_string_intern.txt";
+
+#define NUM_SYMBOLS 40
+#define NUM_ENTRIES 2000
+
+static const char* symbol_at(int i) {
+    static char symbols[NUM_SYMBOLS][8];
+    static int ready = 0;
+    if (!ready) {
+        for (int k = 0; k < NUM_SYMBOLS; k++) {
+            snprintf(symbols[k], sizeof(symbols[k]), "SYM%02d", k);
+        }
+        ready = 1;
+    }
+    return symbols[(i * 7) % NUM_SYMBOLS];
+}
+
+static string_intern_t enc_table;
+static string_intern_t dec_table;
+
+/* Encode then decode one string, checking the text survives */
+static int round_trip(const char* str, size_t* encoded_len) {
+    char buf[CNANOLOG_VARINT_MAX_BYTES + 256];
+    char* write_ptr = buf;
+    *encoded_len = pack_string_interned(&write_ptr, str, (uint32_t)strlen(str), &enc_table);
+
+    const char* read_ptr = buf;
+    const char* out;
+    uint32_t out_len;
+    if (unpack_string_interned(&read_ptr, write_ptr, &dec_table, &out, &out_len) != 0) return -1;
+    if (read_ptr != write_ptr) return -1;
+    if (out_len != strlen(str) || memcmp(out, str, out_len) != 0) return -1;
+    return 0;
+}
+
+int test_table_round_trip() {
+    string_intern_reset(&enc_table);
+    string_intern_reset(&dec_table);
+
+    size_t len;
+    if (round_trip("XNAS", &len) != 0 || len != 1 + 4) TEST_FAIL("first use not written as text");
+    if (round_trip("XNAS", &len) != 0 || len != 1) TEST_FAIL("repeat not written as an id");
+    if (round_trip("", &len) != 0 || len != 1) TEST_FAIL("empty string");
+
+    /* Too long to intern: always text */
+    char long_str[CNANOLOG_INTERN_MAX_LEN + 2];
+    memset(long_str, 'x', sizeof(long_str) - 1);
+    long_str[sizeof(long_str) - 1] = '\0';
+    if (round_trip(long_str, &len) != 0 || round_trip(long_str, &len) != 0 ||
+        len != 2 + sizeof(long_str) - 1) {
+        TEST_FAIL("long string interned");
+    }
+
+    /* Overflow the table: the decoder must evict the same entries */
+    char str[32];
+    for (int i = 0; i < STRING_INTERN_CAPACITY + 100; i++) {
+        snprintf(str, sizeof(str), "s%d", i);
+        if (round_trip(str, &len) != 0) TEST_FAIL("round trip during fill");
+        if (i % 3 == 0 && round_trip("XNAS", &len) != 0) TEST_FAIL("hot string lost");
+    }
+    if (round_trip("XNAS", &len) != 0 || len > 2) TEST_FAIL("hot string evicted");
+    for (int i = 0; i < STRING_INTERN_CAPACITY + 100; i += 37) {
+        snprintf(str, sizeof(str), "s%d", i);
+        if (round_trip(str, &len) != 0) TEST_FAIL("round trip after eviction");
+    }
+
+    /* Reference to an id that was never defined */
+    char bad[1] = {(char)((5 << 1) | 1)};
+    const char* bad_ptr = bad;
+    const char* out;
+    uint32_t out_len;
+    string_intern_reset(&dec_table);
+    if (unpack_string_interned(&bad_ptr, bad + 1, &dec_table, &out, &out_len) == 0) {
+        TEST_FAIL("undefined id accepted");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+int test_symbol_shrinkage() {
+    log_site_t site;
+    memset(&site, 0, sizeof(site));
+    site.log_id = 0;
+    site.num_args = 2;
+    site.arg_types[0] = ARG_TYPE_STRING;
+    site.arg_types[1] = ARG_TYPE_STRING;
+
+    compress_history_t* history = malloc(sizeof(compress_history_t));
+    if (history == NULL) TEST_FAIL("allocation failed");
+    compress_history_init(history);
+    arg_slot_t* slots = compress_history_get(history, &site);
+    if (slots == NULL) {
+        free(history);
+        TEST_FAIL("no history");
+    }
+
+    size_t raw_total = 0;
+    size_t compressed_total = 0;
+    for (int i = 0; i < NUM_ENTRIES; i++) {
+        const char* strs[2] = {symbol_at(i), (i % 2) ? "XNAS" : "ARCX"};
+        char args[64];
+        char* p = args;
+        for (int k = 0; k < 2; k++) {
+            uint32_t len = (uint32_t)strlen(strs[k]);
+            memcpy(p, &len, sizeof(len));
+            memcpy(p + sizeof(len), strs[k], len);
+            p += sizeof(len) + len;
+        }
+
+        char compressed[64];
+        size_t compressed_len = 0;
+        size_t args_len = (size_t)(p - args);
+        if (compress_entry_args(args, args_len, compressed, &compressed_len,
+                                &site, slots, &history->strings) != 0 ||
+            compressed_len > compress_max_size(&site, args_len)) {
+            compress_history_destroy(history);
+            free(history);
+            TEST_FAIL("compress failed");
+        }
+        raw_total += args_len;
+        compressed_total += compressed_len;
+    }
+    compress_history_destroy(history);
+    free(history);
+
+    printf("    %zu raw bytes -> %zu compressed (%.1fx)\n",
+           raw_total, compressed_total, (double)raw_total / (double)compressed_total);
+    if (compressed_total * 5 > raw_total) TEST_FAIL("symbols shrank less than 5x");
+    TEST_PASS();
+    return 0;
+}
+
+int test_intern_handles() {
+    const cnanolog_string_t* a = cnanolog_intern("XNAS");
+    const cnanolog_string_t* b = cnanolog_intern("XNAS");
+    const cnanolog_string_t* c = cnanolog_intern("ARCX");
+    if (a == NULL || c == NULL) TEST_FAIL("intern failed");
+    if (a != b) TEST_FAIL("same text, different handles");
+    if (a == c) TEST_FAIL("different text, same handle");
+    if (a->len != 4 || strcmp(a->str, "XNAS") != 0) TEST_FAIL("handle text wrong");
+
+    char long_str[CNANOLOG_INTERN_MAX_LEN + 2];
+    memset(long_str, 'x', sizeof(long_str) - 1);
+    long_str[sizeof(long_str) - 1] = '\0';
+    if (cnanolog_intern(long_str) != NULL) TEST_FAIL("too long string interned");
+    if (cnanolog_intern(NULL) != NULL) TEST_FAIL("NULL interned");
+    TEST_PASS();
+    return 0;
+}
+
+int test_text_handles() {
+    const cnanolog_string_t* venue = cnanolog_intern("XNAS");
+    const cnanolog_string_t* none = NULL;
+
+    unlink(TEXT_PATH);
+    cnanolog_rotation_config_t config = {
+        .policy = CNANOLOG_ROTATE_NONE,
+        .base_path = TEXT_PATH,
+        .format = CNANOLOG_OUTPUT_TEXT,
+        .text_pattern = "%m"
+    };
+    if (cnanolog_init_ex(&config) != 0) TEST_FAIL("init failed");
+    LOG_INFO("fill on %s qty %d", venue, 100);
+    LOG_INFO("[%6s] [%.2s] [%s]", venue, venue, none);
+    cnanolog_shutdown();
+
+    FILE* f = fopen(TEXT_PATH, "r");
+    if (f == NULL) TEST_FAIL("no output");
+    char line1[128] = {0}, line2[128] = {0};
+    int ok = fgets(line1, sizeof(line1), f) != NULL && fgets(line2, sizeof(line2), f) != NULL;
+    fclose(f);
+
+    if (!ok) TEST_FAIL("lines missing");
+    if (strcmp(line1, "fill on XNAS qty 100\n") != 0) TEST_FAIL("handle not rendered");
+    if (strcmp(line2, "[  XNAS] [XN] []\n") != 0) TEST_FAIL("width/precision/NULL wrong");
+    TEST_PASS();
+    return 0;
+}
+
+int test_decompressor_round_trip() {
+    const cnanolog_string_t* venues[3] = {
+        cnanolog_intern("XNAS"), cnanolog_intern("ARCX"), cnanolog_intern("BATS")
+    };
+
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+    for (int i = 0; i < NUM_ENTRIES; i++) {
+        if (i % 2 == 0) {
+            /* Filtered below, but defines strings the INFO entries reuse */
+            LOG_DEBUG("quote %s on %s", symbol_at(i), venues[i % 3]);
+        } else {
+            LOG_INFO("fill %s on %s", symbol_at(i - 1), venues[(i - 1) % 3]);
+        }
+    }
+    cnanolog_shutdown();
+
+    char cmd[256];
+    snprintf(cmd, sizeof(cmd), "../tools/decompressor -l INFO %s %s 2>/dev/null",
+             LOG_PATH, TEXT_PATH);
+    if (system(cmd) != 0) TEST_FAIL("decompressor failed");
+
+    FILE* f = fopen(TEXT_PATH, "r");
+    if (f == NULL) TEST_FAIL("no output");
+    char line[256];
+    int i = 1;
+    int errors = 0;
+    while (fgets(line, sizeof(line), f) != NULL) {
+        char expected[64];
+        snprintf(expected, sizeof(expected), "fill %s on %s",
+                 symbol_at(i - 1), venues[(i - 1) % 3]->str);
+        if (strstr(line, expected) == NULL) errors++;
+        i += 2;
+    }
+    fclose(f);
+
+    if (i != NUM_ENTRIES + 1) TEST_FAIL("lines missing");
+    if (errors != 0) TEST_FAIL("decoded strings differ");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog String Interning Tests\n");
+    printf("===============================\n\n");
+
+    failures += test_table_round_trip();
+    failures += test_symbol_shrinkage();
+    failures += test_intern_handles();
+    failures += test_text_handles();
+    failures += test_decompressor_round_trip();
+
+    unlink(LOG_PATH);
+    unlink(TEXT_PATH);
+
+    printf("\n===============================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
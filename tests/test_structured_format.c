@@ -0,0 +1,250 @@
+/*
+ * Structured output tests
+ * Verifies JSON/logfmt escaping, field naming and typing, and that
+ * truncated records stay well-formed.
+ */
+
+#include "../src/structured_format.h"
+#include "../src/fast_format.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+/* Minimal packer for uncompressed staging-buffer argument layout */
+typedef struct {
+    char data[512];
+    size_t len;
+    uint8_t types[CNANOLOG_MAX_ARGS];
+    uint8_t num_args;
+} args_t;
+
+static void add_i32(args_t* a, int32_t v) {
+    memcpy(a->data + a->len, &v, sizeof(v));
+    a->len += sizeof(v);
+    a->types[a->num_args++] = ARG_TYPE_INT32;
+}
+
+static void add_double(args_t* a, double v) {
+    memcpy(a->data + a->len, &v, sizeof(v));
+    a->len += sizeof(v);
+    a->types[a->num_args++] = ARG_TYPE_DOUBLE;
+}
+
+static void add_string(args_t* a, const char* s) {
+    uint32_t n = (uint32_t)strlen(s);
+    memcpy(a->data + a->len, &n, sizeof(n));
+    memcpy(a->data + a->len + sizeof(n), s, n);
+    a->len += sizeof(n) + n;
+    a->types[a->num_args++] = ARG_TYPE_STRING;
+}
+
+/**
+ * Encode a record for format/args; the timestamp is a fixed full stamp.
+ */
+static size_t encode(int style, const char* format, const args_t* a,
+                     char* out, size_t out_size) {
+    fmt_program_t* program = fmt_program_compile_format(format, a->num_args, a->types);
+    char message[256];
+    size_t message_len = fmt_program_render(program, a->data, a->len,
+                                            message, sizeof(message));
+    sfmt_record_t record = {
+        .timestamp = "2025-11-02 10:30:45.123456789",
+        .timestamp_len = FMT_TIMESTAMP_CHARS,
+        .level = "INFO",
+        .file = "main.c",
+        .line = 42,
+        .message = message,
+        .message_len = message_len,
+        .format = program,
+        .arg_data = a->data,
+        .arg_len = a->len
+    };
+    size_t len = sfmt_encode(style, &record, out, out_size - 1);
+    out[len] = '\0';
+    fmt_program_free(program);
+    return len;
+}
+
+#define CHECK_EQ(got, expected) do { \
+    if (strcmp(got, expected) != 0) { \
+        printf("    got      %s\n    expected %s\n", got, expected); \
+        TEST_FAIL("output mismatch"); \
+    } \
+} while(0)
+
+int test_json_fields() {
+    args_t a = {0};
+    add_i32(&a, 7);
+    add_string(&a, "bob");
+    add_double(&a, 2.5);
+    add_i32(&a, -3);
+
+    char out[512];
+    encode(SFMT_JSON, "order id=%d user: %s took %.1f ms, %d left", &a, out, sizeof(out));
+    CHECK_EQ(out, "{\"time\":\"2025-11-02T10:30:45.123456789\",\"level\":\"INFO\","
+                  "\"file\":\"main.c\",\"line\":42,"
+                  "\"msg\":\"order id=7 user: bob took 2.5 ms, -3 left\","
+                  "\"id\":7,\"user\":\"bob\",\"arg2\":2.5,\"arg3\":-3}");
+
+    /* Reserved names fall back to positional keys */
+    args_t b = {0};
+    add_i32(&b, 1);
+    encode(SFMT_JSON, "line=%d", &b, out, sizeof(out));
+    if (strstr(out, ",\"arg0\":1}") == NULL) TEST_FAIL("reserved key not renamed");
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_json_escaping() {
+    const char* input = "quote\" back\\slash\nnew\ttab\x01 end of a longer clean run";
+    const char* expected = "\"quote\\\" back\\\\slash\\nnew\\ttab\\u0001 end of a longer clean run\"";
+
+    char out[256];
+    char* end = sfmt_json_string(out, out + sizeof(out), input, strlen(input));
+    *end = '\0';
+    CHECK_EQ(out, expected);
+
+    /* Truncation never splits an escape and always closes the string */
+    for (size_t size = 2; size < strlen(expected); size++) {
+        end = sfmt_json_string(out, out + size, input, strlen(input));
+        size_t len = (size_t)(end - out);
+        if (len > size || len < 2 || out[0] != '"' || out[len - 1] != '"') {
+            TEST_FAIL("truncated string not closed");
+        }
+        /* Count trailing backslashes before the closing quote: must be even */
+        size_t slashes = 0;
+        while (len - 2 - slashes > 0 && out[len - 2 - slashes] == '\\') slashes++;
+        if (slashes % 2 != 0) TEST_FAIL("escape split by truncation");
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_utf8_truncation() {
+    const char* input = "ab\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9";  /* "abéééé" */
+    char out[64];
+
+    /* Well-formed multibyte text is copied as-is */
+    char* end = sfmt_json_string(out, out + sizeof(out), input, strlen(input));
+    *end = '\0';
+    CHECK_EQ(out, "\"ab\xc3\xa9\xc3\xa9\xc3\xa9\xc3\xa9\"");
+
+    /* A 7-byte content budget ends before the é it would split */
+    end = sfmt_json_string(out, out + 9, input, strlen(input));
+    *end = '\0';
+    CHECK_EQ(out, "\"ab\xc3\xa9\xc3\xa9\"");
+
+    /* No budget leaves a dangling lead byte */
+    for (size_t size = 2; size < 12; size++) {
+        end = sfmt_json_string(out, out + size, input, strlen(input));
+        size_t len = (size_t)(end - out);
+        if (len < 2 || out[len - 1] != '"' || (unsigned char)out[len - 2] == 0xc3) {
+            TEST_FAIL("truncation split a UTF-8 character");
+        }
+    }
+
+    /* Quoted logfmt values truncate the same way */
+    end = sfmt_logfmt_value(out, out + 9, input, strlen(input));
+    *end = '\0';
+    CHECK_EQ(out, "\"ab\xc3\xa9\xc3\xa9\"");
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_invalid_utf8() {
+    char out[128];
+    char* end;
+
+    end = sfmt_json_string(out, out + sizeof(out), "x\xffy", 3);
+    *end = '\0';
+    CHECK_EQ(out, "\"x\\ufffdy\"");
+
+    /* Stray continuation, overlong, surrogate, truncated sequence */
+    const char* bad = "\x80|\xc0\xaf|\xed\xa0\x80|\xe2\x82";
+    end = sfmt_json_string(out, out + sizeof(out), bad, strlen(bad));
+    *end = '\0';
+    CHECK_EQ(out, "\"\\ufffd|\\ufffd\\ufffd|\\ufffd\\ufffd\\ufffd|\\ufffd\\ufffd\"");
+
+    /* Invalid bytes in a long otherwise-clean run (fast path) */
+    const char* mixed = "clean run of ascii\xfe and more clean ascii";
+    end = sfmt_logfmt_value(out, out + sizeof(out), mixed, strlen(mixed));
+    *end = '\0';
+    CHECK_EQ(out, "\"clean run of ascii\\ufffd and more clean ascii\"");
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_logfmt() {
+    args_t a = {0};
+    add_string(&a, "two words");
+    add_string(&a, "plain");
+    add_string(&a, "");
+    add_double(&a, 0.1);
+
+    char out[512];
+    encode(SFMT_LOGFMT, "user=%s host=%s tag=%s ratio=%f", &a, out, sizeof(out));
+    CHECK_EQ(out, "time=2025-11-02T10:30:45.123456789 level=INFO file=main.c line=42 "
+                  "msg=\"user=two words host=plain tag= ratio=0.100000\" "
+                  "user=\"two words\" host=plain tag=\"\" ratio=0.1");
+
+    TEST_PASS();
+    return 0;
+}
+
+int test_truncated_record_is_valid() {
+    args_t a = {0};
+    add_string(&a, "a fairly long string argument that will not fit");
+    add_i32(&a, 99);
+
+    for (size_t size = 8; size < 300; size++) {
+        char out[512];
+        size_t len = encode(SFMT_JSON, "value=%s count=%d", &a, out, size + 1);
+        if (len > size || out[0] != '{' || out[len - 1] != '}') {
+            printf("    size %zu: %s\n", size, out);
+            TEST_FAIL("truncated JSON not closed");
+        }
+        /* Quotes must balance (escaped quotes cannot appear in this input) */
+        int quotes = 0;
+        for (size_t i = 0; i < len; i++) quotes += (out[i] == '"');
+        if (quotes % 2 != 0) {
+            printf("    size %zu: %s\n", size, out);
+            TEST_FAIL("unbalanced quotes");
+        }
+    }
+
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Structured Output Tests\n");
+    printf("================================\n\n");
+
+    failures += test_json_fields();
+    failures += test_json_escaping();
+    failures += test_utf8_truncation();
+    failures += test_invalid_utf8();
+    failures += test_logfmt();
+    failures += test_truncated_record_is_valid();
+
+    printf("\n================================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
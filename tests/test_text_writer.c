@@ -0,0 +1,178 @@
+/*
+ * Text writer output tests
+ * Checks the bytes the text writer leaves in its file through the async
+ * writer: a short AIO write finished synchronously, appends to an
+ * existing file, and rotation while both output buffers hold data.
+ */
+
+#include "text_formatter.h"
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* TEXT_PATH = "test_text_writer.txt";
+static const char* ROTATED_PATH = "test_text_writer_rotated.txt";
+
+/* Lines "line 0000000\n", "line 0000001\n", ... starting at first */
+static char* make_lines(size_t first, size_t count, size_t* len) {
+    char* data = (char*)malloc(count * 13 + 1);
+    for (size_t i = 0; i < count; i++) {
+        snprintf(data + i * 13, 14, "line %07zu\n", first + i);
+    }
+    *len = count * 13;
+    return data;
+}
+
+/* 1 if the file holds exactly these bytes */
+static int file_equals(const char* path, const char* expected, size_t len) {
+    FILE* f = fopen(path, "rb");
+    if (f == NULL) return 0;
+    char* data = (char*)malloc(len + 1);
+    size_t got = fread(data, 1, len + 1, f);
+    fclose(f);
+    int equal = (got == len && memcmp(data, expected, len) == 0);
+    free(data);
+    return equal;
+}
+
+static long file_size(const char* path) {
+    struct stat st;
+    return stat(path, &st) == 0 ? (long)st.st_size : -1;
+}
+
+/* ---------------------------------------------------------------------- */
+
+int test_short_write() {
+    unlink(TEXT_PATH);
+    text_writer_t* writer = text_writer_create(TEXT_PATH);
+    if (writer == NULL) TEST_FAIL("create failed");
+
+    size_t len;
+    char* data = make_lines(0, 80000, &len);  /* ~1MB */
+    if (text_writer_write_block(writer, data, len) != 0) TEST_FAIL("write failed");
+
+    /* A file size limit makes the AIO write stop at 256KB */
+    struct rlimit saved, limited;
+    getrlimit(RLIMIT_FSIZE, &saved);
+    limited = saved;
+    limited.rlim_cur = 256 * 1024;
+    signal(SIGXFSZ, SIG_IGN);
+    setrlimit(RLIMIT_FSIZE, &limited);
+    text_writer_flush(writer);
+
+    for (int i = 0; i < 5000 && file_size(TEXT_PATH) < 256 * 1024; i++) {
+        usleep(1000);
+    }
+    setrlimit(RLIMIT_FSIZE, &saved);
+    if (file_size(TEXT_PATH) != 256 * 1024) TEST_FAIL("AIO write not cut short");
+
+    /* Close waits for the AIO and writes the remainder itself */
+    text_writer_close(writer);
+    int ok = file_equals(TEXT_PATH, data, len);
+    free(data);
+    if (!ok) TEST_FAIL("remainder of the short write missing or misplaced");
+    TEST_PASS();
+    return 0;
+}
+
+int test_append_existing() {
+    unlink(TEXT_PATH);
+    const char* existing = "written before the logger\n";
+    FILE* f = fopen(TEXT_PATH, "w");
+    fputs(existing, f);
+    fclose(f);
+
+    size_t len1, len2;
+    char* first = make_lines(0, 1000, &len1);
+    char* second = make_lines(1000, 1000, &len2);
+
+    /* Two sessions, each appending after what is there */
+    text_writer_t* writer = text_writer_create(TEXT_PATH);
+    if (writer == NULL) TEST_FAIL("create failed");
+    text_writer_write_block(writer, first, len1);
+    text_writer_close(writer);
+
+    writer = text_writer_create(TEXT_PATH);
+    if (writer == NULL) TEST_FAIL("second create failed");
+    text_writer_write_block(writer, second, len2);
+    text_writer_close(writer);
+
+    size_t total = strlen(existing) + len1 + len2;
+    char* expected = (char*)malloc(total);
+    memcpy(expected, existing, strlen(existing));
+    memcpy(expected + strlen(existing), first, len1);
+    memcpy(expected + strlen(existing) + len1, second, len2);
+    int ok = file_equals(TEXT_PATH, expected, total);
+    free(expected);
+    free(first);
+    free(second);
+    if (!ok) TEST_FAIL("existing content or appends wrong");
+    TEST_PASS();
+    return 0;
+}
+
+int test_rotate_full_buffers() {
+    unlink(TEXT_PATH);
+    unlink(ROTATED_PATH);
+    text_writer_t* writer = text_writer_create(TEXT_PATH);
+    if (writer == NULL) TEST_FAIL("create failed");
+
+    /* Fill both buffers: the first is submitted, the second is full */
+    size_t len;
+    size_t count = 2 * TEXT_WRITER_BUFFER_SIZE / 13;
+    char* data = make_lines(0, count, &len);
+    for (size_t off = 0; off < len; off += 13 * 300) {
+        size_t n = (len - off < 13 * 300) ? len - off : 13 * 300;
+        if (text_writer_write_block(writer, data + off, n) != 0) TEST_FAIL("write failed");
+    }
+
+    if (text_writer_rotate(writer, ROTATED_PATH) != 0) TEST_FAIL("rotate failed");
+    size_t tail_len;
+    char* tail = make_lines(count, 100, &tail_len);
+    text_writer_write_block(writer, tail, tail_len);
+    text_writer_close(writer);
+
+    int first_ok = file_equals(TEXT_PATH, data, len);
+    int second_ok = file_equals(ROTATED_PATH, tail, tail_len);
+    free(data);
+    free(tail);
+    if (!first_ok) TEST_FAIL("rotated-out file incomplete");
+    if (!second_ok) TEST_FAIL("new file wrong");
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog Text Writer Tests\n");
+    printf("==========================\n\n");
+
+    failures += test_short_write();
+    failures += test_append_existing();
+    failures += test_rotate_full_buffers();
+
+    unlink(TEXT_PATH);
+    unlink(ROTATED_PATH);
+
+    printf("\n==========================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
@@ -0,0 +1,132 @@
+/*
+ * Timestamp calibration tests
+ * Verifies that init no longer sleeps, that the provisional frequency is
+ * close to a long measurement, and that the refined frequency and its
+ * uncertainty land in the file header.
+ */
+
+#include "../include/cnanolog.h"
+#include "../include/cnanolog_format.h"
+#include "../src/tsc_calibration.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define TEST_PASS() printf("  ✓ %s\n", __func__)
+#define TEST_FAIL(msg) do { \
+    printf("  ✗ %s: %s\n", __func__, msg); \
+    return 1; \
+} while(0)
+
+static const char* LOG_PATH = "test_tsc_calibration.clog";
+
+static double elapsed_ms(const struct timespec* a, const struct timespec* b) {
+    return (b->tv_sec - a->tv_sec) * 1e3 + (b->tv_nsec - a->tv_nsec) / 1e6;
+}
+
+static double relative_error(uint64_t a, uint64_t b) {
+    double d = (double)a - (double)b;
+    return (d < 0 ? -d : d) / (double)b;
+}
+
+/* Reference frequency measured over 200ms */
+static uint64_t reference_frequency(void) {
+    tsc_sample_t start, end;
+    tsc_sample(&start);
+    struct timespec pause = {0, 200000000};
+    nanosleep(&pause, NULL);
+    tsc_sample(&end);
+    return tsc_measure_frequency(&start, &end, NULL);
+}
+
+int test_env_override() {
+    setenv("CNANOLOG_TSC_HZ", "2500000000", 1);
+    uint64_t hz = tsc_known_frequency();
+    unsetenv("CNANOLOG_TSC_HZ");
+    if (hz != 2500000000ULL) TEST_FAIL("CNANOLOG_TSC_HZ ignored");
+    TEST_PASS();
+    return 0;
+}
+
+int test_quick_calibration_accuracy() {
+    uint64_t reference = reference_frequency();
+    if (reference == 0) TEST_FAIL("reference measurement failed");
+
+    tsc_sample_t start;
+    uint32_t uncertainty_ppb;
+    uint64_t hz = tsc_calibrate_quick(&start, &uncertainty_ppb);
+
+    /* Nominal CPU values and a 2ms spin are both well within 1% */
+    if (relative_error(hz, reference) > 0.01) TEST_FAIL("provisional frequency off by > 1%");
+    TEST_PASS();
+    return 0;
+}
+
+int test_init_is_fast() {
+    unlink(LOG_PATH);
+
+    struct timespec t0, t1;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    cnanolog_shutdown();
+
+    /* The old calibration slept 100ms */
+    if (elapsed_ms(&t0, &t1) > 50.0) TEST_FAIL("init took more than 50ms");
+    TEST_PASS();
+    return 0;
+}
+
+int test_refined_frequency_in_header() {
+    unlink(LOG_PATH);
+    if (cnanolog_init(LOG_PATH) != 0) TEST_FAIL("init failed");
+
+    LOG_INFO("calibration %d", 1);
+    struct timespec pause = {0, 250000000};  /* Long enough for the shutdown refine */
+    nanosleep(&pause, NULL);
+    cnanolog_shutdown();
+
+    uint64_t reference = reference_frequency();
+
+    FILE* f = fopen(LOG_PATH, "rb");
+    if (f == NULL) TEST_FAIL("log file missing");
+    cnanolog_file_header_t header;
+    size_t n = fread(&header, 1, sizeof(header), f);
+    fclose(f);
+    if (n != sizeof(header)) TEST_FAIL("short header");
+
+    if (header.frequency_uncertainty_ppb == 0) TEST_FAIL("frequency was not refined");
+    /* 250ms of monotonic time bounds the error to a few ppm */
+    if (header.frequency_uncertainty_ppb > 100000) TEST_FAIL("uncertainty too large");
+    if (relative_error(header.timestamp_frequency, reference) > 0.001) {
+        TEST_FAIL("refined frequency off by > 0.1%");
+    }
+    TEST_PASS();
+    return 0;
+}
+
+/* Main test runner */
+int main() {
+    int failures = 0;
+
+    printf("CNanoLog TSC Calibration Tests\n");
+    printf("==============================\n\n");
+
+    failures += test_env_override();
+    failures += test_quick_calibration_accuracy();
+    failures += test_init_is_fast();
+    failures += test_refined_frequency_in_header();
+
+    unlink(LOG_PATH);
+
+    printf("\n==============================\n");
+    if (failures == 0) {
+        printf("All tests PASSED ✓\n");
+        return 0;
+    } else {
+        printf("%d test(s) FAILED ✗\n", failures);
+        return 1;
+    }
+}
@@ -0,0 +1,389 @@
+/* Copyright (c) 2025
+ * CNanoLog Agent
+ *
+ * Out-of-process writer for applications started with cnanolog_init_shared().
+ * Attaches to the application's shared memory segment, drains its staging
+ * buffers, compresses the entries and writes the binary log file.
+ *
+ * Usage: cnanolog-agent <shm-name> <output.clog> [wait-seconds]
+ *
+ * The agent exits after the application calls cnanolog_shutdown() or dies,
+ * once everything it committed is written. It can be started before the
+ * application (it waits up to wait-seconds, default 10, for the segment)
+ * and niced or pinned like any other process.
+ */
+
+#include "../include/cnanolog_format.h"
+#include "../src/binary_writer.h"
+#include "../src/compressor.h"
+#include "../src/shm_segment.h"
+#include "../src/staging_buffer.h"
+#include "../src/tsc_calibration.h"
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define DEFAULT_WAIT_SEC 10
+#define SYNC_INTERVAL_NS 1000000000ULL   /* Clock sync record, as in-process */
+#define MIN_REFINE_NS 100000000ULL       /* Shortest run to re-measure the frequency */
+#define BATCH_PROCESS_SIZE 1024          /* Entries per buffer per round */
+
+/* Interned handles (application addresses) to local copies */
+#define INTERNED_TABLE_SIZE (2 * SHM_MAX_INTERNED)  /* Power of two */
+
+typedef struct {
+    uint64_t handle;  /* 0 = empty */
+    cnanolog_string_t local;
+} interned_slot_t;
+
+typedef struct {
+    shm_header_t* shm;
+    binary_writer_t* writer;
+    compress_history_t history;
+
+    log_site_t sites[SHM_MAX_SITES];  /* Strings point into the segment */
+    uint32_t num_sites;
+
+    interned_slot_t interned[INTERNED_TABLE_SIZE];
+    uint32_t num_interned;
+
+    uint64_t entries_written;
+    uint64_t entries_skipped;
+} agent_t;
+
+static volatile sig_atomic_t g_stop = 0;
+
+static char g_entry_buf[STAGING_MAX_ENTRY_SIZE];
+static char g_compressed_buf[CNANOLOG_MAX_COMPRESSED_SIZE];
+
+static void handle_stop(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+/* ============================================================================
+ * Published Tables
+ * ============================================================================ */
+
+static void refresh_sites(agent_t* agent) {
+    uint32_t published = __atomic_load_n(&agent->shm->num_sites, __ATOMIC_ACQUIRE);
+    for (uint32_t i = agent->num_sites; i < published; i++) {
+        const shm_site_t* in = &agent->shm->sites[i];
+        log_site_t* site = &agent->sites[i];
+
+        memset(site, 0, sizeof(*site));
+        site->log_id = i;
+        site->log_level = (cnanolog_level_t)in->log_level;
+        site->filename = agent->shm->strings + in->filename_offset;
+        site->format = agent->shm->strings + in->format_offset;
+        site->line_number = in->line_number;
+        site->num_args = in->num_args;
+        for (uint8_t a = 0; a < in->num_args && a < CNANOLOG_MAX_ARGS; a++) {
+            site->arg_types[a] = (cnanolog_arg_type_t)in->arg_types[a];
+        }
+    }
+    agent->num_sites = published;
+}
+
+static uint32_t interned_hash(uint64_t handle) {
+    return (uint32_t)((handle * 0x9E3779B97F4A7C15ULL) >> 40) & (INTERNED_TABLE_SIZE - 1);
+}
+
+static void refresh_interned(agent_t* agent) {
+    uint32_t published = __atomic_load_n(&agent->shm->num_interned, __ATOMIC_ACQUIRE);
+    for (uint32_t i = agent->num_interned; i < published; i++) {
+        const shm_interned_t* in = &agent->shm->interned[i];
+        uint32_t slot = interned_hash(in->handle);
+        while (agent->interned[slot].handle != 0) {
+            slot = (slot + 1) & (INTERNED_TABLE_SIZE - 1);
+        }
+        agent->interned[slot].handle = in->handle;
+        agent->interned[slot].local.str = agent->shm->strings + in->text_offset;
+        agent->interned[slot].local.len = in->len;
+    }
+    agent->num_interned = published;
+}
+
+static const cnanolog_string_t* lookup_interned(agent_t* agent, uint64_t handle) {
+    for (int pass = 0; pass < 2; pass++) {
+        uint32_t slot = interned_hash(handle);
+        while (agent->interned[slot].handle != 0) {
+            if (agent->interned[slot].handle == handle) {
+                return &agent->interned[slot].local;
+            }
+            slot = (slot + 1) & (INTERNED_TABLE_SIZE - 1);
+        }
+        refresh_interned(agent);  /* Published after the last refresh */
+    }
+    return NULL;
+}
+
+/**
+ * Interned arguments are staged as handle addresses in the application:
+ * point them at the agent's copies (unknown handles write an empty string).
+ */
+static void translate_interned(agent_t* agent, const log_site_t* site, char* args) {
+    char* p = args;
+    for (uint8_t i = 0; i < site->num_args; i++) {
+        switch (site->arg_types[i]) {
+            case ARG_TYPE_CHAR:   p += sizeof(char); break;
+            case ARG_TYPE_INT32:  p += sizeof(int32_t); break;
+            case ARG_TYPE_INT64:  p += sizeof(int64_t); break;
+            case ARG_TYPE_UINT32: p += sizeof(uint32_t); break;
+            case ARG_TYPE_UINT64: p += sizeof(uint64_t); break;
+            case ARG_TYPE_DOUBLE: p += sizeof(double); break;
+            case ARG_TYPE_POINTER: p += sizeof(uint64_t); break;
+            case ARG_TYPE_STRING: {
+                uint32_t len;
+                memcpy(&len, p, sizeof(uint32_t));
+                p += sizeof(uint32_t) + len;
+                break;
+            }
+            case ARG_TYPE_INTERNED: {
+                uint64_t bits;
+                memcpy(&bits, p, sizeof(uint64_t));
+                bits = (uint64_t)(uintptr_t)lookup_interned(agent, bits);
+                memcpy(p, &bits, sizeof(uint64_t));
+                p += sizeof(uint64_t);
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
+
+/* ============================================================================
+ * Writer Loop
+ * ============================================================================ */
+
+/**
+ * Compress and write one staged entry (in g_entry_buf).
+ */
+static void write_entry(agent_t* agent) {
+    const cnanolog_entry_header_t* header = (const cnanolog_entry_header_t*)g_entry_buf;
+    if (header->log_id >= agent->num_sites) {
+        refresh_sites(agent);
+    }
+    if (header->log_id >= agent->num_sites) {
+        /* Site table of the segment was full */
+        agent->entries_skipped++;
+        return;
+    }
+    const log_site_t* site = &agent->sites[header->log_id];
+
+    size_t arg_data_len;
+    char* arg_data = (char*)staging_entry_data(g_entry_buf, &arg_data_len);
+    const char* data = arg_data;
+    size_t data_len = arg_data_len;
+
+    if (site->num_args > 0) {
+        arg_slot_t* history = compress_history_get(&agent->history, site);
+        if (history == NULL) {
+            agent->entries_skipped++;
+            return;
+        }
+        translate_interned(agent, site, arg_data);
+        size_t compressed_len = 0;
+        if (compress_entry_args(arg_data, arg_data_len, g_compressed_buf, &compressed_len,
+                                site, history, &agent->history.strings) == 0) {
+            data = g_compressed_buf;
+            data_len = compressed_len;
+        }
+    }
+
+    binwriter_write_entry(agent->writer, header->log_id,
+#ifndef CNANOLOG_NO_TIMESTAMPS
+                          header->timestamp,
+#else
+                          0,
+#endif
+                          data, data_len);
+    agent->entries_written++;
+}
+
+/**
+ * One round over all staging buffers.
+ *
+ * @return Entries written
+ */
+static size_t drain_round(agent_t* agent) {
+    size_t written = 0;
+    uint32_t num_buffers = __atomic_load_n(&agent->shm->num_buffers, __ATOMIC_ACQUIRE);
+    uint64_t now_ns = tsc_monotonic_ns();
+
+    for (uint32_t i = 0; i < num_buffers; i++) {
+        staging_buffer_t* sb = shm_segment_buffer(agent->shm, i);
+        cnanolog_entry_header_t header;
+        size_t entry_size;
+
+        if (staging_available(sb) == 0) {
+            continue;
+        }
+        staging_begin_drain(sb, now_ns);
+
+        for (size_t n = 0; n < BATCH_PROCESS_SIZE &&
+                           staging_peek_entry(sb, &header, &entry_size) &&
+                           staging_read(sb, g_entry_buf, entry_size) == entry_size; n++) {
+            write_entry(agent);
+            staging_consume(sb, entry_size);
+            written++;
+        }
+    }
+    return written;
+}
+
+#ifndef CNANOLOG_NO_TIMESTAMPS
+/**
+ * Sync record against the application's start sample (same clock source,
+ * same machine), with the frequency re-measured over the whole run.
+ */
+static void clock_sync(agent_t* agent, const tsc_sample_t* start) {
+    tsc_sample_t now;
+    tsc_sample(&now);
+
+    if (agent->shm->clock_source == TSC_SOURCE_CYCLES &&
+        now.mono_ns - start->mono_ns >= MIN_REFINE_NS) {
+        uint32_t uncertainty_ppb;
+        uint64_t frequency = tsc_measure_frequency(start, &now, &uncertainty_ppb);
+        if (frequency != 0) {
+            binwriter_set_timestamp_frequency(agent->writer, frequency, uncertainty_ppb);
+        }
+    }
+
+    if (binwriter_write_sync(agent->writer, now.tsc, now.real_sec, now.real_nsec,
+                             now.mono_ns) == 0) {
+        compress_history_reset(&agent->history);
+    }
+}
+#endif
+
+static int app_gone(const shm_header_t* shm) {
+    if (__atomic_load_n(&shm->app_state, __ATOMIC_ACQUIRE) == SHM_APP_CLOSED) {
+        return 1;
+    }
+    return kill((pid_t)shm->app_pid, 0) != 0 && errno == ESRCH;
+}
+
+static shm_header_t* attach_with_retry(const char* name, int wait_sec) {
+    uint64_t deadline = tsc_monotonic_ns() + (uint64_t)wait_sec * 1000000000ULL;
+    for (;;) {
+        shm_header_t* shm = shm_segment_attach(name);
+        if (shm != NULL || g_stop || tsc_monotonic_ns() >= deadline) {
+            return shm;
+        }
+        struct timespec ts = {0, 10000000};  /* 10ms */
+        nanosleep(&ts, NULL);
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3 || argc > 4) {
+        fprintf(stderr, "Usage: %s <shm-name> <output.clog> [wait-seconds]\n", argv[0]);
+        return 1;
+    }
+    const char* shm_name = argv[1];
+    const char* output_path = argv[2];
+    int wait_sec = (argc == 4) ? atoi(argv[3]) : DEFAULT_WAIT_SEC;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_stop;
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+
+    shm_header_t* shm = attach_with_retry(shm_name, wait_sec);
+    if (shm == NULL) {
+        fprintf(stderr, "cnanolog-agent: No segment %s\n", shm_name);
+        return 1;
+    }
+    /* Mapped now: the name is not needed any more */
+    shm_unlink(shm_name);
+    shm->agent_pid = (uint32_t)getpid();
+
+    static agent_t agent;
+    agent.shm = shm;
+    compress_history_init(&agent.history);
+
+    agent.writer = binwriter_create(output_path);
+    if (agent.writer == NULL) {
+        fprintf(stderr, "cnanolog-agent: Cannot create %s\n", output_path);
+        shm_segment_detach(shm);
+        return 1;
+    }
+
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    /* Entry timestamps count in the application's clock source */
+    tsc_set_source((tsc_source_t)shm->clock_source);
+    tsc_sample_t start = {
+        .tsc = shm->start_tsc,
+        .mono_ns = shm->start_mono_ns,
+        .real_sec = shm->start_real_sec,
+        .real_nsec = shm->start_real_nsec,
+        .error_ns = 0
+    };
+    binwriter_set_timestamp_frequency(agent.writer, shm->timestamp_frequency,
+                                      shm->frequency_uncertainty_ppb);
+    binwriter_write_header(agent.writer, shm->timestamp_frequency, shm->start_tsc,
+                           (time_t)shm->start_real_sec, shm->start_real_nsec);
+    binwriter_write_sync(agent.writer, start.tsc, start.real_sec, start.real_nsec,
+                         start.mono_ns);
+    uint64_t last_sync_ns = tsc_monotonic_ns();
+#else
+    binwriter_write_header(agent.writer, 0, 0, (time_t)shm->start_real_sec,
+                           shm->start_real_nsec);
+#endif
+
+    refresh_sites(&agent);
+    refresh_interned(&agent);
+
+    for (;;) {
+        /* Checked before draining: whatever was committed before is written */
+        int last_round = g_stop || app_gone(shm);
+
+        size_t written;
+        while ((written = drain_round(&agent)) > 0) {
+            if (!last_round) {
+                break;
+            }
+        }
+
+#ifndef CNANOLOG_NO_TIMESTAMPS
+        uint64_t now_ns = tsc_monotonic_ns();
+        if (now_ns - last_sync_ns >= SYNC_INTERVAL_NS) {
+            clock_sync(&agent, &start);
+            last_sync_ns = now_ns;
+        }
+#endif
+
+        if (last_round) {
+            break;
+        }
+        if (written == 0) {
+            binwriter_flush(agent.writer);
+            struct timespec ts = {0, 100000};  /* 100us */
+            nanosleep(&ts, NULL);
+        }
+    }
+
+#ifndef CNANOLOG_NO_TIMESTAMPS
+    clock_sync(&agent, &start);
+#endif
+
+    refresh_sites(&agent);
+    uint32_t num_levels = __atomic_load_n(&shm->num_levels, __ATOMIC_ACQUIRE);
+    int result = binwriter_close(agent.writer, agent.sites, agent.num_sites,
+                                 num_levels > 0 ? shm->levels : NULL, num_levels);
+
+    if (agent.entries_skipped > 0) {
+        fprintf(stderr, "cnanolog-agent: %llu entries skipped\n",
+                (unsigned long long)agent.entries_skipped);
+    }
+    compress_history_destroy(&agent.history);
+    shm_segment_detach(shm);
+    return result == 0 ? 0 : 1;
+}
@@ -0,0 +1,530 @@
+/* Copyright (c) 2025
+ * CNanoLog Receiver
+ *
+ * Reference collector for network sinks (cnanolog_add_sink() with a
+ * unix: or tcp: path). Accepts connections and writes each one to its own
+ * binary log file: the stream's header and entries as they arrive, the
+ * dictionaries built from the in-band site and level records at the end.
+ *
+ * Usage: cnanolog-receiver <unix:/path | tcp:[host:]port> <output-prefix>
+ *
+ * Connection n (from 1) is written to <output-prefix>-<n>.clog and
+ * finished when the sender closes it; a record cut off by a disconnect is
+ * dropped. SIGINT/SIGTERM: read what has arrived, finish the files, exit.
+ */
+
+#include "../include/cnanolog_format.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define MAX_CLIENTS 64
+#define READ_CHUNK (1024 * 1024)
+#define MAX_RECORD_SIZE (CNANOLOG_MAX_COMPRESSED_SIZE + 64)
+
+typedef struct {
+    char* data;        /* Dictionary entry and strings (NULL = not received) */
+    uint32_t len;
+} site_def_t;
+
+typedef struct {
+    int fd;            /* -1 = free slot */
+    FILE* out;
+    char path[1024];
+
+    char* in;          /* Received, not yet parsed */
+    size_t in_len;
+    size_t in_capacity;
+
+    int have_header;
+    cnanolog_file_header_t header;
+    size_t entry_header_size;
+    uint64_t offset;   /* Bytes written to the file */
+    uint64_t entries;
+
+    site_def_t* sites; /* Indexed by log_id */
+    uint32_t num_sites;
+    uint32_t sites_capacity;
+
+    char* levels;      /* Level dictionary entries and names */
+    size_t levels_len;
+    uint32_t num_levels;
+
+    int ended;         /* End record received */
+    cnanolog_stream_end_t end;
+} client_t;
+
+static volatile sig_atomic_t g_stop = 0;
+
+static client_t g_clients[MAX_CLIENTS];
+static uint32_t g_connections = 0;
+
+static void handle_stop(int sig) {
+    (void)sig;
+    g_stop = 1;
+}
+
+/* ============================================================================
+ * Stream Records
+ * ============================================================================ */
+
+static int store_site(client_t* client, const char* data, uint32_t len) {
+    cnanolog_dict_entry_t entry;
+    if (len < sizeof(entry)) {
+        return -1;
+    }
+    memcpy(&entry, data, sizeof(entry));
+    if (len != sizeof(entry) + entry.filename_length + entry.format_length ||
+        entry.log_id >= (1u << 24)) {
+        return -1;
+    }
+
+    if (entry.log_id >= client->sites_capacity) {
+        uint32_t capacity = client->sites_capacity ? client->sites_capacity : 256;
+        while (capacity <= entry.log_id) {
+            capacity *= 2;
+        }
+        site_def_t* grown = (site_def_t*)realloc(client->sites, capacity * sizeof(site_def_t));
+        if (grown == NULL) {
+            return -1;
+        }
+        memset(grown + client->sites_capacity, 0,
+               (capacity - client->sites_capacity) * sizeof(site_def_t));
+        client->sites = grown;
+        client->sites_capacity = capacity;
+    }
+
+    /* Sent again after every reconnect: keep the first copy */
+    site_def_t* site = &client->sites[entry.log_id];
+    if (site->data == NULL) {
+        site->data = (char*)malloc(len);
+        if (site->data == NULL) {
+            return -1;
+        }
+        memcpy(site->data, data, len);
+        site->len = len;
+    }
+    if (entry.log_id >= client->num_sites) {
+        client->num_sites = entry.log_id + 1;
+    }
+    return 0;
+}
+
+static int store_level(client_t* client, const char* data, uint32_t len) {
+    char* grown = (char*)realloc(client->levels, client->levels_len + len);
+    if (grown == NULL) {
+        return -1;
+    }
+    memcpy(grown + client->levels_len, data, len);
+    client->levels = grown;
+    client->levels_len += len;
+    client->num_levels++;
+    return 0;
+}
+
+/**
+ * Write or collect every complete record in the input buffer.
+ * Returns 0 on success, -1 on a malformed stream or write error.
+ */
+static int process_input(client_t* client) {
+    size_t pos = 0;
+
+    if (!client->have_header) {
+        if (client->in_len < sizeof(cnanolog_file_header_t)) {
+            return 0;
+        }
+        memcpy(&client->header, client->in, sizeof(client->header));
+        if (cnanolog_validate_file_header(&client->header) != 0 ||
+            cnanolog_check_endianness(client->header.endianness) != 0) {
+            fprintf(stderr, "cnanolog-receiver: %s: Not a CNanoLog stream\n", client->path);
+            return -1;
+        }
+        client->entry_header_size =
+            (client->header.flags & CNANOLOG_FLAG_HAS_TIMESTAMPS) ? 14 : 6;
+        if (fwrite(&client->header, 1, sizeof(client->header), client->out) !=
+            sizeof(client->header)) {
+            return -1;
+        }
+        client->offset = sizeof(client->header);
+        client->have_header = 1;
+        pos = sizeof(client->header);
+    }
+
+    while (client->in_len - pos >= client->entry_header_size) {
+        const char* record = client->in + pos;
+        size_t avail = client->in_len - pos;
+
+        uint32_t log_id;
+        uint16_t inline_length;
+        memcpy(&log_id, record, sizeof(log_id));
+        memcpy(&inline_length, record + client->entry_header_size - sizeof(inline_length),
+               sizeof(inline_length));
+
+        size_t header_len = client->entry_header_size;
+        uint32_t data_length = inline_length;
+        if (inline_length == CNANOLOG_LENGTH_EXTENDED) {
+            size_t used = cnanolog_varint_decode((const uint8_t*)record + header_len,
+                                                 avail - header_len, &data_length);
+            if (used == 0) {
+                if (avail - header_len >= CNANOLOG_VARINT_MAX_BYTES) {
+                    return -1;
+                }
+                break;  /* Rest of the length still in flight */
+            }
+            header_len += used;
+        }
+        if (data_length > MAX_RECORD_SIZE) {
+            return -1;
+        }
+        if (avail < header_len + data_length) {
+            break;
+        }
+
+        const char* data = record + header_len;
+        int result = 0;
+        if (log_id == CNANOLOG_STREAM_SITE_LOG_ID) {
+            result = store_site(client, data, data_length);
+        } else if (log_id == CNANOLOG_STREAM_LEVEL_LOG_ID) {
+            result = store_level(client, data, data_length);
+        } else if (log_id == CNANOLOG_STREAM_END_LOG_ID) {
+            if (data_length == sizeof(client->end)) {
+                memcpy(&client->end, data, sizeof(client->end));
+                client->ended = 1;
+            }
+        } else {
+            size_t total = header_len + data_length;
+            if (fwrite(record, 1, total, client->out) != total) {
+                return -1;
+            }
+            client->offset += total;
+            if (log_id != CNANOLOG_SYNC_LOG_ID) {
+                client->entries++;
+            }
+        }
+        if (result != 0) {
+            return -1;
+        }
+        pos += header_len + data_length;
+    }
+
+    memmove(client->in, client->in + pos, client->in_len - pos);
+    client->in_len -= pos;
+    return 0;
+}
+
+/* ============================================================================
+ * Output Files
+ * ============================================================================ */
+
+/**
+ * Append the dictionaries and patch the header.
+ */
+static int finish_file(client_t* client) {
+    if (!client->have_header) {
+        return -1;
+    }
+    uint64_t dict_offset = client->offset;
+
+    if (client->num_levels > 0) {
+        cnanolog_level_dict_header_t level_header;
+        level_header.magic = CNANOLOG_LEVEL_DICT_MAGIC;
+        level_header.num_levels = client->num_levels;
+        level_header.total_size = (uint32_t)(sizeof(level_header) + client->levels_len);
+        level_header.reserved = 0;
+        fwrite(&level_header, 1, sizeof(level_header), client->out);
+        fwrite(client->levels, 1, client->levels_len, client->out);
+    }
+
+    /* Sites are numbered densely; a gap (never announced) gets a stub */
+    static const char unknown[] = "(unknown site)";
+    cnanolog_dict_header_t dict_header;
+    dict_header.magic = CNANOLOG_DICT_MAGIC;
+    dict_header.num_entries = client->num_sites;
+    dict_header.total_size = sizeof(dict_header);
+    dict_header.reserved = 0;
+    for (uint32_t i = 0; i < client->num_sites; i++) {
+        dict_header.total_size += client->sites[i].data != NULL
+                                      ? client->sites[i].len
+                                      : (uint32_t)(sizeof(cnanolog_dict_entry_t) +
+                                                   sizeof(unknown) - 1);
+    }
+    fwrite(&dict_header, 1, sizeof(dict_header), client->out);
+    for (uint32_t i = 0; i < client->num_sites; i++) {
+        if (client->sites[i].data != NULL) {
+            fwrite(client->sites[i].data, 1, client->sites[i].len, client->out);
+            continue;
+        }
+        cnanolog_dict_entry_t stub;
+        memset(&stub, 0, sizeof(stub));
+        stub.log_id = i;
+        stub.format_length = sizeof(unknown) - 1;
+        fwrite(&stub, 1, sizeof(stub), client->out);
+        fwrite(unknown, 1, sizeof(unknown) - 1, client->out);
+    }
+
+    client->header.dictionary_offset = dict_offset;
+    cnanolog_header_set_entry_count(&client->header, client->entries);
+    if (client->ended) {
+        client->header.timestamp_frequency = client->end.timestamp_frequency;
+        client->header.frequency_uncertainty_ppb = client->end.frequency_uncertainty_ppb;
+    }
+    if (fseek(client->out, 0, SEEK_SET) != 0 ||
+        fwrite(&client->header, 1, sizeof(client->header), client->out) !=
+            sizeof(client->header)) {
+        return -1;
+    }
+    return fflush(client->out) == 0 ? 0 : -1;
+}
+
+static void close_client(client_t* client) {
+    int result = finish_file(client);
+    fclose(client->out);
+    if (result == 0) {
+        fprintf(stderr, "cnanolog-receiver: %s: %llu entries%s\n", client->path,
+                (unsigned long long)client->entries,
+                client->ended ? "" : " (stream cut off)");
+    } else {
+        fprintf(stderr, "cnanolog-receiver: %s: incomplete stream\n", client->path);
+    }
+
+    close(client->fd);
+    client->fd = -1;
+    free(client->in);
+    for (uint32_t i = 0; i < client->num_sites; i++) {
+        free(client->sites[i].data);
+    }
+    free(client->sites);
+    free(client->levels);
+}
+
+static void accept_client(int listen_fd, const char* prefix) {
+    int fd = accept(listen_fd, NULL, NULL);
+    if (fd < 0) {
+        return;
+    }
+
+    client_t* client = NULL;
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (g_clients[i].fd < 0) {
+            client = &g_clients[i];
+            break;
+        }
+    }
+    if (client == NULL) {
+        fprintf(stderr, "cnanolog-receiver: Too many connections\n");
+        close(fd);
+        return;
+    }
+
+    memset(client, 0, sizeof(*client));
+    snprintf(client->path, sizeof(client->path), "%s-%u.clog", prefix, ++g_connections);
+    client->out = fopen(client->path, "w+b");
+    if (client->out == NULL) {
+        fprintf(stderr, "cnanolog-receiver: Cannot create %s: %s\n", client->path,
+                strerror(errno));
+        client->fd = -1;
+        close(fd);
+        return;
+    }
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    client->fd = fd;
+}
+
+/**
+ * Read what is available. Returns 1 at end of stream, 0 otherwise.
+ */
+static int read_client(client_t* client) {
+    for (;;) {
+        if (client->in_capacity - client->in_len < READ_CHUNK) {
+            size_t capacity = client->in_len + READ_CHUNK;
+            char* grown = (char*)realloc(client->in, capacity);
+            if (grown == NULL) {
+                return 1;
+            }
+            client->in = grown;
+            client->in_capacity = capacity;
+        }
+
+        ssize_t got = read(client->fd, client->in + client->in_len, READ_CHUNK);
+        if (got > 0) {
+            client->in_len += (size_t)got;
+            if (process_input(client) != 0) {
+                return 1;
+            }
+            continue;
+        }
+        if (got < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            return 0;
+        }
+        if (got < 0 && errno == EINTR) {
+            continue;
+        }
+        return 1;  /* EOF or error */
+    }
+}
+
+/* ============================================================================
+ * Listening Socket
+ * ============================================================================ */
+
+static int listen_on(const char* address) {
+    int fd = -1;
+
+    if (strncmp(address, "unix:", 5) == 0) {
+        struct sockaddr_un un;
+        memset(&un, 0, sizeof(un));
+        un.sun_family = AF_UNIX;
+        if (strlen(address + 5) == 0 || strlen(address + 5) >= sizeof(un.sun_path)) {
+            return -1;
+        }
+        strcpy(un.sun_path, address + 5);
+        unlink(un.sun_path);
+        fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd < 0 || bind(fd, (struct sockaddr*)&un, sizeof(un)) != 0) {
+            goto fail;
+        }
+    } else if (strncmp(address, "tcp:", 4) == 0) {
+        char host[256] = "127.0.0.1";
+        const char* spec = address + 4;
+        const char* port = strrchr(spec, ':');
+        if (port != NULL) {
+            size_t host_len = (size_t)(port - spec);
+            if (host_len >= 2 && spec[0] == '[' && spec[host_len - 1] == ']') {
+                spec++;
+                host_len -= 2;
+            }
+            if (host_len == 0 || host_len >= sizeof(host)) {
+                return -1;
+            }
+            memcpy(host, spec, host_len);
+            host[host_len] = '\0';
+            port++;
+        } else {
+            port = spec;
+        }
+
+        struct addrinfo hints;
+        memset(&hints, 0, sizeof(hints));
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_STREAM;
+        hints.ai_flags = AI_PASSIVE | AI_NUMERICSERV;
+        struct addrinfo* result = NULL;
+        if (getaddrinfo(host, port, &hints, &result) != 0 || result == NULL) {
+            return -1;
+        }
+        fd = socket(result->ai_family, SOCK_STREAM, 0);
+        int one = 1;
+        if (fd >= 0) {
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        }
+        if (fd < 0 || bind(fd, result->ai_addr, result->ai_addrlen) != 0) {
+            freeaddrinfo(result);
+            goto fail;
+        }
+        freeaddrinfo(result);
+    } else {
+        return -1;
+    }
+
+    if (listen(fd, 16) != 0) {
+        goto fail;
+    }
+    return fd;
+
+fail:
+    fprintf(stderr, "cnanolog-receiver: Cannot listen on %s: %s\n", address, strerror(errno));
+    if (fd >= 0) {
+        close(fd);
+    }
+    return -1;
+}
+
+/* ============================================================================
+ * Main
+ * ============================================================================ */
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <unix:/path | tcp:[host:]port> <output-prefix>\n", argv[0]);
+        return 2;
+    }
+    const char* address = argv[1];
+    const char* prefix = argv[2];
+
+    int listen_fd = listen_on(address);
+    if (listen_fd < 0) {
+        return 1;
+    }
+
+    /* No SA_RESTART: poll() returns on the signal */
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_stop;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+    sigaction(SIGTERM, &sa, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        g_clients[i].fd = -1;
+    }
+
+    while (!g_stop) {
+        struct pollfd fds[1 + MAX_CLIENTS];
+        client_t* owners[1 + MAX_CLIENTS];
+        nfds_t count = 0;
+        fds[count].fd = listen_fd;
+        fds[count].events = POLLIN;
+        owners[count++] = NULL;
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (g_clients[i].fd >= 0) {
+                fds[count].fd = g_clients[i].fd;
+                fds[count].events = POLLIN;
+                owners[count++] = &g_clients[i];
+            }
+        }
+
+        if (poll(fds, count, 1000) < 0) {
+            continue;  /* EINTR: checks g_stop */
+        }
+        for (nfds_t i = 1; i < count; i++) {
+            if (fds[i].revents != 0 && read_client(owners[i])) {
+                close_client(owners[i]);
+            }
+        }
+        if (fds[0].revents & POLLIN) {
+            accept_client(listen_fd, prefix);
+        }
+    }
+
+    /* Stopping: take what has already arrived, on new connections too */
+    fcntl(listen_fd, F_SETFL, fcntl(listen_fd, F_GETFL) | O_NONBLOCK);
+    struct pollfd pending = {listen_fd, POLLIN, 0};
+    while (poll(&pending, 1, 0) > 0 && (pending.revents & POLLIN)) {
+        uint32_t before = g_connections;
+        accept_client(listen_fd, prefix);
+        if (g_connections == before) {
+            break;
+        }
+    }
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        if (g_clients[i].fd >= 0) {
+            read_client(&g_clients[i]);
+            close_client(&g_clients[i]);
+        }
+    }
+    close(listen_fd);
+    if (strncmp(address, "unix:", 5) == 0) {
+        unlink(address + 5);
+    }
+    return 0;
+}
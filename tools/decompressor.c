@@ -8,6 +8,10 @@
 
 #include "../include/cnanolog_format.h"
 #include "../src/packer.h"
+#include "../src/string_intern.h"
+#include "../src/format_program.h"
+#include "../src/fast_format.h"
+#include "../src/structured_format.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -20,6 +24,15 @@
 /* Maximum level filters */
 #define MAX_LEVEL_FILTERS 64
 
+/* Output style: pattern text (default), span trace or a structured encoder */
+#define STYLE_TEXT -1
+#define STYLE_TRACE -2
+
+/* Rendered message and line buffers: room for a full-size entry whose
+ * arguments expand when formatted (numbers, escaping) */
+#define MESSAGE_BUFFER_SIZE (4 * CNANOLOG_MAX_ENTRY_SIZE)
+#define LINE_BUFFER_SIZE (2 * MESSAGE_BUFFER_SIZE + 4096)
+
 /* ============================================================================
  * Dictionary Management
  * ============================================================================ */
@@ -37,8 +50,17 @@ typedef struct {
     char* filename;
     char* format;
     uint8_t arg_types[CNANOLOG_MAX_ARGS];
+    fmt_program_t* program;  /* Compiled format string */
+    arg_slot_t* history;  /* Previous arguments (delta / XOR decoding) */
 } dict_entry_t;
 
+typedef struct {
+    uint64_t timestamp;
+    int64_t real_sec;
+    int32_t real_nsec;
+    uint64_t mono_ns;
+} sync_point_t;
+
 typedef struct {
     dict_entry_t* entries;
     uint32_t num_entries;
@@ -49,6 +71,12 @@ typedef struct {
     time_t start_time_sec;
     int32_t start_time_nsec;
     int has_timestamps;  /* Flag: 1 if file contains timestamps, 0 otherwise */
+    int extended_lengths;  /* Flag: data_length 0xFFFF means a varint follows (v1.2+) */
+    int double_xor;  /* Flag: doubles are XOR-encoded against the site's previous value */
+    int int_delta;   /* Flag: integers are delta-encoded; history resets at sync records */
+    string_intern_t* strings;  /* Intern table (v1.5+), NULL if strings are plain text */
+    sync_point_t* sync_points;  /* Clock sync records, in timestamp order */
+    uint32_t num_sync_points;
 } decompressor_ctx_t;
 
 /* ============================================================================
@@ -62,6 +90,8 @@ static const char* level_to_string(decompressor_ctx_t* ctx, uint8_t level) {
         case 1: return "WARN";
         case 2: return "ERROR";
         case 3: return "DEBUG";
+        case CNANOLOG_LEVEL_SPAN_BEGIN: return "SPAN_BEGIN";
+        case CNANOLOG_LEVEL_SPAN_END: return "SPAN_END";
         default: break;
     }
 
@@ -80,24 +110,187 @@ static const char* level_to_string(decompressor_ctx_t* ctx, uint8_t level) {
     return buf;
 }
 
+/**
+ * Convert rdtsc timestamp to wall-clock time.
+ * With sync records the mapping is piecewise: anchored at the last sync
+ * point before the timestamp, at the rate measured to the next one.
+ * Otherwise (or past the last one) the header calibration applies.
+ */
+static void timestamp_to_wall(const decompressor_ctx_t* ctx, uint64_t timestamp,
+                              int64_t* wall_sec, uint32_t* wall_nsec) {
+    uint64_t frequency = ctx->timestamp_frequency;
+    uint64_t anchor = ctx->start_timestamp;
+    int64_t anchor_sec = (int64_t)ctx->start_time_sec;
+    int32_t anchor_nsec = ctx->start_time_nsec;
+
+    if (ctx->num_sync_points > 0) {
+        /* Last sync point at or before the timestamp (the first one if none) */
+        uint32_t lo = 0;
+        uint32_t hi = ctx->num_sync_points;
+        while (hi - lo > 1) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (ctx->sync_points[mid].timestamp <= timestamp) {
+                lo = mid;
+            } else {
+                hi = mid;
+            }
+        }
+
+        const sync_point_t* p = &ctx->sync_points[lo];
+        anchor = p->timestamp;
+        anchor_sec = p->real_sec;
+        anchor_nsec = p->real_nsec;
+
+        if (lo + 1 < ctx->num_sync_points) {
+            const sync_point_t* q = &ctx->sync_points[lo + 1];
+            uint64_t segment_hz = (uint64_t)((double)(q->timestamp - p->timestamp) * 1e9 /
+                                             (double)(q->mono_ns - p->mono_ns) + 0.5);
+            if (segment_hz > 0) {
+                frequency = segment_hz;
+            }
+        }
+    }
+
+    fmt_ticks_to_wall(timestamp, frequency, anchor, anchor_sec, anchor_nsec,
+                      wall_sec, wall_nsec);
+}
+
 /**
  * Convert rdtsc timestamp to human-readable time string.
  */
 static void format_timestamp(decompressor_ctx_t* ctx, uint64_t timestamp, char* buf, size_t len) {
-    /* Calculate elapsed time since start */
-    uint64_t elapsed_ticks = timestamp - ctx->start_timestamp;
-    double elapsed_seconds = (double)elapsed_ticks / ctx->timestamp_frequency;
-
-    /* Calculate wall-clock time */
-    time_t wall_time = ctx->start_time_sec + (time_t)elapsed_seconds;
-    uint64_t nanos = (uint64_t)((elapsed_seconds - (time_t)elapsed_seconds) * 1000000000.0);
+    int64_t wall_sec;
+    uint32_t wall_nsec;
+    timestamp_to_wall(ctx, timestamp, &wall_sec, &wall_nsec);
 
     /* Format: YYYY-MM-DD HH:MM:SS.nnnnnnnnn */
+    time_t wall_time = (time_t)wall_sec;
     struct tm* tm = localtime(&wall_time);
-    snprintf(buf, len, "%04d-%02d-%02d %02d:%02d:%02d.%09llu",
+    snprintf(buf, len, "%04d-%02d-%02d %02d:%02d:%02d.%09u",
              tm->tm_year + 1900, tm->tm_mon + 1, tm->tm_mday,
              tm->tm_hour, tm->tm_min, tm->tm_sec,
-             (unsigned long long)nanos);
+             wall_nsec);
+}
+
+/**
+ * Read one entry header, including the varint length of long entries.
+ * Advances *offset past the header (not the data).
+ * Returns 1 on success, 0 at end of file, -1 on error.
+ */
+static int read_entry_header(FILE* fp, const decompressor_ctx_t* ctx,
+                             uint32_t* log_id, uint64_t* timestamp,
+                             uint32_t* data_length, uint64_t* offset) {
+    /* Read log_id (always 4 bytes) */
+    if (fread(log_id, 1, sizeof(*log_id), fp) != sizeof(*log_id)) {
+        if (feof(fp)) return 0;  /* EOF */
+        fprintf(stderr, "Error: Failed to read entry log_id\n");
+        return -1;
+    }
+    *offset += sizeof(*log_id);
+
+    /* Read timestamp (8 bytes) if enabled */
+    if (ctx->has_timestamps) {
+        if (fread(timestamp, 1, sizeof(*timestamp), fp) != sizeof(*timestamp)) {
+            fprintf(stderr, "Error: Failed to read entry timestamp\n");
+            return -1;
+        }
+        *offset += sizeof(*timestamp);
+    }
+
+    /* Read data_length (always 2 bytes) */
+    uint16_t short_length;
+    if (fread(&short_length, 1, sizeof(short_length), fp) != sizeof(short_length)) {
+        fprintf(stderr, "Error: Failed to read entry data_length\n");
+        return -1;
+    }
+    *offset += sizeof(short_length);
+    *data_length = short_length;
+
+    /* Long entry: LEB128 length follows */
+    if (ctx->extended_lengths && short_length == CNANOLOG_LENGTH_EXTENDED) {
+        uint8_t varint[CNANOLOG_VARINT_MAX_BYTES];
+        size_t n = 0;
+        int c;
+        do {
+            if (n == sizeof(varint) || (c = fgetc(fp)) == EOF) {
+                fprintf(stderr, "Error: Bad extended entry length\n");
+                return -1;
+            }
+            varint[n++] = (uint8_t)c;
+        } while (c & 0x80);
+
+        if (cnanolog_varint_decode(varint, n, data_length) != n) {
+            fprintf(stderr, "Error: Bad extended entry length\n");
+            return -1;
+        }
+        *offset += n;
+    }
+
+    return 1;
+}
+
+/**
+ * Collect clock sync records from the entry section.
+ * Returns 0 on success, -1 on failure.
+ */
+static int load_sync_points(FILE* fp, decompressor_ctx_t* ctx, uint64_t dict_offset) {
+    if (fseek(fp, sizeof(cnanolog_file_header_t), SEEK_SET) != 0) {
+        return -1;
+    }
+
+    uint64_t offset = sizeof(cnanolog_file_header_t);
+    uint32_t capacity = 0;
+
+    while (offset < dict_offset) {
+        uint32_t log_id;
+        uint64_t timestamp;
+        uint32_t data_length;
+        int rc = read_entry_header(fp, ctx, &log_id, &timestamp, &data_length, &offset);
+        if (rc <= 0) {
+            return rc;
+        }
+        offset += data_length;
+
+        if (log_id != CNANOLOG_SYNC_LOG_ID || data_length != sizeof(cnanolog_sync_record_t)) {
+            if (fseek(fp, data_length, SEEK_CUR) != 0) {
+                return -1;
+            }
+            continue;
+        }
+
+        cnanolog_sync_record_t record;
+        if (fread(&record, 1, sizeof(record), fp) != sizeof(record)) {
+            fprintf(stderr, "Error: Failed to read sync record\n");
+            return -1;
+        }
+
+        /* Records are written in clock order; ignore anything that is not */
+        if (ctx->num_sync_points > 0) {
+            const sync_point_t* last = &ctx->sync_points[ctx->num_sync_points - 1];
+            if (timestamp <= last->timestamp || record.mono_ns <= last->mono_ns) {
+                continue;
+            }
+        }
+
+        if (ctx->num_sync_points == capacity) {
+            capacity = capacity ? capacity * 2 : 64;
+            sync_point_t* grown = (sync_point_t*)realloc(ctx->sync_points,
+                                                         capacity * sizeof(sync_point_t));
+            if (grown == NULL) {
+                fprintf(stderr, "Error: Failed to allocate sync points\n");
+                return -1;
+            }
+            ctx->sync_points = grown;
+        }
+
+        sync_point_t* point = &ctx->sync_points[ctx->num_sync_points++];
+        point->timestamp = timestamp;
+        point->real_sec = record.real_sec;
+        point->real_nsec = record.real_nsec;
+        point->mono_ns = record.mono_ns;
+    }
+
+    return 0;
 }
 
 /* ============================================================================
@@ -237,6 +430,23 @@ static int load_dictionary(FILE* fp, decompressor_ctx_t* ctx, uint64_t dict_offs
             return -1;
         }
         ctx->entries[i].format[entry.format_length] = '\0';
+
+        /* Compile once; entries are rendered by the interpreter */
+        ctx->entries[i].program = fmt_program_compile_format(ctx->entries[i].format,
+                                                             entry.num_args,
+                                                             entry.arg_types);
+        if (ctx->entries[i].program == NULL) {
+            fprintf(stderr, "Error: Failed to compile format string\n");
+            return -1;
+        }
+
+        /* Zeroed, like the writer's history at the start of the file */
+        ctx->entries[i].history = (arg_slot_t*)calloc(
+            entry.num_args ? entry.num_args : 1, sizeof(arg_slot_t));
+        if (ctx->entries[i].history == NULL) {
+            fprintf(stderr, "Error: Failed to allocate argument history\n");
+            return -1;
+        }
     }
 
     return 0;
@@ -259,15 +469,56 @@ static int count_non_string_args(const dict_entry_t* dict) {
     return count;
 }
 
+/**
+ * Forget all previous argument values and interned strings (at clock sync
+ * records in files with CNANOLOG_FLAG_INT_DELTA, matching the writer).
+ */
+static void reset_history(decompressor_ctx_t* ctx) {
+    for (uint32_t i = 0; i < ctx->num_entries; i++) {
+        dict_entry_t* dict = &ctx->entries[i];
+        memset(dict->history, 0, (dict->num_args ? dict->num_args : 1) * sizeof(arg_slot_t));
+    }
+    if (ctx->strings != NULL) {
+        string_intern_reset(ctx->strings);
+    }
+}
+
+/**
+ * Unpack one integer argument: delta-encoded (v1.4+) or sign + magnitude.
+ * Returns 0 on success, -1 if the encoding is invalid or truncated.
+ */
+static int unpack_int_arg(const char** read_ptr, const char* end_ptr, uint8_t nibble,
+                          int is_signed, uint8_t max_bytes, arg_slot_t* slot,
+                          int int_delta, uint64_t* val) {
+    if (int_delta) {
+        return unpack_int_delta(read_ptr, end_ptr, nibble, is_signed, &slot->num, val);
+    }
+
+    uint8_t num_bytes = is_signed ? (nibble & 0x07) : nibble;
+    if (num_bytes == 0 || num_bytes > max_bytes || *read_ptr + num_bytes > end_ptr) {
+        return -1;
+    }
+    *val = is_signed ? (uint64_t)unpack_int64(read_ptr, num_bytes, (nibble & 0x08) != 0)
+                     : unpack_uint64(read_ptr, num_bytes);
+    return 0;
+}
+
 /**
  * Decompress compressed argument data back to uncompressed format.
+ * With double_xor or int_delta set, updates the site's argument history,
+ * so every entry of a site must pass through here in file order. With
+ * strings set, updates the intern table shared by all sites, so every
+ * entry must.
  * Returns number of uncompressed bytes written, or -1 on error.
  */
 static int decompress_entry_args(const char* compressed,
                                   size_t compressed_len,
                                   char* uncompressed,
                                   size_t uncompressed_size,
-                                  const dict_entry_t* dict) {
+                                  dict_entry_t* dict,
+                                  int double_xor,
+                                  int int_delta,
+                                  string_intern_t* strings) {
     const char* read_ptr = compressed;
     char* write_ptr = uncompressed;
     const char* end_ptr = compressed + compressed_len;
@@ -309,85 +560,46 @@ static int decompress_entry_args(const char* compressed,
                 break;
             }
 
-            case ARG_TYPE_INT32: {
-                if (read_ptr >= end_ptr) return -1;
-
-                uint8_t nibble = get_nibble(nibbles, nibble_idx++);
-                uint8_t num_bytes = nibble & 0x07;
-                int is_negative = (nibble & 0x08) ? 1 : 0;
-
-                if (num_bytes == 0 || num_bytes > 4) return -1;
-
-                int32_t val = unpack_int32(&read_ptr, num_bytes, is_negative);
-                int_values[int_arg_idx++] = (uint64_t)(uint32_t)val;  /* Store as uint64 */
-                break;
-            }
-
-            case ARG_TYPE_INT64: {
-                if (read_ptr >= end_ptr) return -1;
-
-                uint8_t nibble = get_nibble(nibbles, nibble_idx++);
-                uint8_t num_bytes = nibble & 0x07;
-                int is_negative = (nibble & 0x08) ? 1 : 0;
-
-                if (num_bytes == 0 || num_bytes > 8) return -1;
-
-                int64_t val = unpack_int64(&read_ptr, num_bytes, is_negative);
-                int_values[int_arg_idx++] = (uint64_t)val;
-                break;
-            }
-
-            case ARG_TYPE_UINT32: {
-                if (read_ptr >= end_ptr) return -1;
-
-                uint8_t nibble = get_nibble(nibbles, nibble_idx++);
-                uint8_t num_bytes = nibble & 0x0F;
-
-                if (num_bytes == 0 || num_bytes > 4) return -1;
-
-                uint32_t val = unpack_uint32(&read_ptr, num_bytes);
-                int_values[int_arg_idx++] = (uint64_t)val;
-                break;
-            }
-
-            case ARG_TYPE_UINT64: {
-                if (read_ptr >= end_ptr) return -1;
-
+            case ARG_TYPE_INT32:
+            case ARG_TYPE_INT64:
+            case ARG_TYPE_UINT32:
+            case ARG_TYPE_UINT64:
+            case ARG_TYPE_POINTER: {
+                uint8_t type = dict->arg_types[i];
+                int is_signed = (type == ARG_TYPE_INT32 || type == ARG_TYPE_INT64);
+                uint8_t max_bytes = (type == ARG_TYPE_INT32 || type == ARG_TYPE_UINT32) ? 4 : 8;
                 uint8_t nibble = get_nibble(nibbles, nibble_idx++);
-                uint8_t num_bytes = nibble & 0x0F;
 
-                if (num_bytes == 0 || num_bytes > 8) return -1;
-
-                uint64_t val = unpack_uint64(&read_ptr, num_bytes);
+                /* Stored as uint64; pass 2 truncates to the argument width */
+                uint64_t val;
+                if (unpack_int_arg(&read_ptr, end_ptr, nibble, is_signed, max_bytes,
+                                   &dict->history[i], int_delta, &val) != 0) {
+                    return -1;
+                }
                 int_values[int_arg_idx++] = val;
                 break;
             }
 
             case ARG_TYPE_DOUBLE: {
-                if (read_ptr + sizeof(double) > end_ptr) return -1;
+                uint8_t nibble = get_nibble(nibbles, nibble_idx++);
+                double d_val;
 
-                nibble_idx++;
+                if (double_xor) {
+                    if (unpack_double_xor(&read_ptr, end_ptr, nibble,
+                                          &dict->history[i].dbl, &d_val) != 0) {
+                        return -1;
+                    }
+                } else {
+                    /* Before v1.3: 8 raw bytes */
+                    if (read_ptr + sizeof(double) > end_ptr) return -1;
+                    memcpy(&d_val, read_ptr, sizeof(double));
+                    read_ptr += sizeof(double);
+                }
 
                 /* Store double bits as uint64 */
-                double d_val;
-                memcpy(&d_val, read_ptr, sizeof(double));
                 uint64_t bits;
                 memcpy(&bits, &d_val, sizeof(uint64_t));
                 int_values[int_arg_idx++] = bits;
-                read_ptr += sizeof(double);
-                break;
-            }
-
-            case ARG_TYPE_POINTER: {
-                if (read_ptr >= end_ptr) return -1;
-
-                uint8_t nibble = get_nibble(nibbles, nibble_idx++);
-                uint8_t num_bytes = nibble & 0x0F;
-
-                if (num_bytes == 0 || num_bytes > 8) return -1;
-
-                uint64_t val = unpack_uint64(&read_ptr, num_bytes);
-                int_values[int_arg_idx++] = val;
                 break;
             }
 
@@ -467,22 +679,28 @@ static int decompress_entry_args(const char* compressed,
             }
 
             case ARG_TYPE_STRING: {
-                if (read_ptr + sizeof(uint32_t) > end_ptr) return -1;
-
+                const char* str;
                 uint32_t str_len;
-                memcpy(&str_len, read_ptr, sizeof(uint32_t));
-                read_ptr += sizeof(uint32_t);
+                if (strings != NULL) {
+                    /* v1.5+: intern id or text */
+                    if (unpack_string_interned(&read_ptr, end_ptr, strings,
+                                               &str, &str_len) != 0) {
+                        return -1;
+                    }
+                } else {
+                    if (read_ptr + sizeof(uint32_t) > end_ptr) return -1;
+                    memcpy(&str_len, read_ptr, sizeof(uint32_t));
+                    read_ptr += sizeof(uint32_t);
+                    if (str_len > (size_t)(end_ptr - read_ptr)) return -1;
+                    str = read_ptr;
+                    read_ptr += str_len;
+                }
 
-                if (write_ptr + sizeof(uint32_t) > write_end) return -1;
+                if (write_ptr + sizeof(uint32_t) + str_len > write_end) return -1;
                 memcpy(write_ptr, &str_len, sizeof(uint32_t));
                 write_ptr += sizeof(uint32_t);
-
                 if (str_len > 0) {
-                    if (read_ptr + str_len > end_ptr) return -1;
-                    if (write_ptr + str_len > write_end) return -1;
-
-                    memcpy(write_ptr, read_ptr, str_len);
-                    read_ptr += str_len;
+                    memcpy(write_ptr, str, str_len);
                     write_ptr += str_len;
                 }
                 break;
@@ -501,137 +719,6 @@ static int decompress_entry_args(const char* compressed,
     return (int)(write_ptr - uncompressed);
 }
 
-/**
- * Extract arguments from binary data and format the log message.
- */
-static void format_log_message(decompressor_ctx_t* ctx, dict_entry_t* dict,
-                                const char* arg_data, char* output, size_t output_size) {
-    const char* read_ptr = arg_data;
-    char formatted[2048];
-    char* write_ptr = formatted;
-    const char* fmt_ptr = dict->format;
-    int arg_index = 0;
-
-    /* Process format string */
-    while (*fmt_ptr && (write_ptr - formatted) < (int)sizeof(formatted) - 1) {
-        if (*fmt_ptr == '%' && *(fmt_ptr + 1) != '%') {
-            /* Found format specifier - extract argument */
-            if (arg_index >= dict->num_args) {
-                /* No more arguments */
-                *write_ptr++ = *fmt_ptr++;
-                continue;
-            }
-
-            cnanolog_arg_type_t arg_type = (cnanolog_arg_type_t)dict->arg_types[arg_index];
-            arg_index++;
-
-            /* Skip the % and any flags/width/precision */
-            fmt_ptr++;
-            while (*fmt_ptr && strchr("-+ #0123456789.*", *fmt_ptr)) {
-                fmt_ptr++;
-            }
-
-            /* Skip the conversion specifier */
-            if (*fmt_ptr) fmt_ptr++;
-
-            /* Extract and format argument based on type */
-            switch (arg_type) {
-                case ARG_TYPE_CHAR: {
-                    char val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    write_ptr += snprintf(write_ptr,
-                                         sizeof(formatted) - (write_ptr - formatted),
-                                         "%c", (int)val);
-                    break;
-                }
-                case ARG_TYPE_INT32: {
-                    int32_t val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    write_ptr += snprintf(write_ptr,
-                                         sizeof(formatted) - (write_ptr - formatted),
-                                         "%d", val);
-                    break;
-                }
-                case ARG_TYPE_INT64: {
-                    int64_t val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    write_ptr += snprintf(write_ptr,
-                                         sizeof(formatted) - (write_ptr - formatted),
-                                         "%lld", (long long)val);
-                    break;
-                }
-                case ARG_TYPE_UINT32: {
-                    uint32_t val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    write_ptr += snprintf(write_ptr,
-                                         sizeof(formatted) - (write_ptr - formatted),
-                                         "%u", val);
-                    break;
-                }
-                case ARG_TYPE_UINT64: {
-                    uint64_t val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    write_ptr += snprintf(write_ptr,
-                                         sizeof(formatted) - (write_ptr - formatted),
-                                         "%llu", (unsigned long long)val);
-                    break;
-                }
-                case ARG_TYPE_DOUBLE: {
-                    double val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    write_ptr += snprintf(write_ptr,
-                                         sizeof(formatted) - (write_ptr - formatted),
-                                         "%f", val);
-                    break;
-                }
-                case ARG_TYPE_STRING: {
-                    uint32_t str_len;
-                    memcpy(&str_len, read_ptr, sizeof(str_len));
-                    read_ptr += sizeof(str_len);
-
-                    /* Copy string (it's not null-terminated in binary) */
-                    int copy_len = str_len;
-                    if (write_ptr + copy_len >= formatted + sizeof(formatted)) {
-                        copy_len = (formatted + sizeof(formatted) - 1) - write_ptr;
-                    }
-                    memcpy(write_ptr, read_ptr, copy_len);
-                    write_ptr += copy_len;
-                    read_ptr += str_len;
-                    break;
-                }
-                case ARG_TYPE_POINTER: {
-                    uint64_t val;
-                    memcpy(&val, read_ptr, sizeof(val));
-                    read_ptr += sizeof(val);
-                    write_ptr += snprintf(write_ptr,
-                                         sizeof(formatted) - (write_ptr - formatted),
-                                         "%p", (void*)val);
-                    break;
-                }
-                default:
-                    /* Unknown type, skip */
-                    break;
-            }
-        } else {
-            /* Regular character or %% */
-            *write_ptr++ = *fmt_ptr++;
-            if (*(fmt_ptr - 1) == '%' && *fmt_ptr == '%') {
-                fmt_ptr++; /* Skip second % */
-            }
-        }
-    }
-    *write_ptr = '\0';
-
-    /* Copy to output */
-    snprintf(output, output_size, "%s", formatted);
-}
-
 /* ============================================================================
  * Output Formatting
  * ============================================================================ */
@@ -649,92 +736,129 @@ static void format_log_message(decompressor_ctx_t* ctx, dict_entry_t* dict,
  *   %m - formatted message
  *   %% - literal %
  */
-static void format_output(const char* format,
+static void format_output(const fmt_program_t* format,
                           const char* timestamp_str,
                           uint64_t timestamp_raw,
                           decompressor_ctx_t* ctx,
                           dict_entry_t* dict,
                           const char* message,
+                          size_t message_len,
                           char* output,
                           size_t output_size) {
-    const char* fmt_ptr = format;
     char* out_ptr = output;
     char* out_end = output + output_size - 1;
+    char num_buf[64];
 
-    while (*fmt_ptr && out_ptr < out_end) {
-        if (*fmt_ptr == '%') {
-            fmt_ptr++;
-            switch (*fmt_ptr) {
-                case 't': {  /* Human-readable timestamp */
-                    int written = snprintf(out_ptr, out_end - out_ptr, "%s", timestamp_str);
-                    out_ptr += (written > 0) ? written : 0;
-                    fmt_ptr++;
-                    break;
-                }
-                case 'T': {  /* Raw timestamp ticks */
-                    int written = snprintf(out_ptr, out_end - out_ptr, "%llu",
-                                          (unsigned long long)timestamp_raw);
-                    out_ptr += (written > 0) ? written : 0;
-                    fmt_ptr++;
-                    break;
-                }
-                case 'r': {  /* Relative time in seconds */
-                    uint64_t elapsed_ticks = timestamp_raw - ctx->start_timestamp;
-                    double elapsed_seconds = (double)elapsed_ticks / ctx->timestamp_frequency;
-                    int written = snprintf(out_ptr, out_end - out_ptr, "%.9f", elapsed_seconds);
-                    out_ptr += (written > 0) ? written : 0;
-                    fmt_ptr++;
-                    break;
-                }
-                case 'l': {  /* Log level */
-                    int written = snprintf(out_ptr, out_end - out_ptr, "%s",
-                                          level_to_string(ctx, dict->log_level));
-                    out_ptr += (written > 0) ? written : 0;
-                    fmt_ptr++;
-                    break;
-                }
-                case 'f': {  /* Filename */
-                    int written = snprintf(out_ptr, out_end - out_ptr, "%s", dict->filename);
-                    out_ptr += (written > 0) ? written : 0;
-                    fmt_ptr++;
-                    break;
-                }
-                case 'L': {  /* Line number */
-                    int written = snprintf(out_ptr, out_end - out_ptr, "%u", dict->line_number);
-                    out_ptr += (written > 0) ? written : 0;
-                    fmt_ptr++;
-                    break;
-                }
-                case 'm': {  /* Message */
-                    int written = snprintf(out_ptr, out_end - out_ptr, "%s", message);
-                    out_ptr += (written > 0) ? written : 0;
-                    fmt_ptr++;
-                    break;
-                }
-                case '%': {  /* Literal % */
-                    if (out_ptr < out_end) {
-                        *out_ptr++ = '%';
-                    }
-                    fmt_ptr++;
-                    break;
-                }
-                default: {  /* Unknown format, copy as-is */
-                    if (out_ptr < out_end) {
-                        *out_ptr++ = '%';
-                    }
-                    if (out_ptr < out_end && *fmt_ptr) {
-                        *out_ptr++ = *fmt_ptr++;
-                    }
-                    break;
-                }
+    for (uint32_t i = 0; i < format->num_ops && out_ptr < out_end; i++) {
+        const fmt_op_t* op = &format->ops[i];
+
+        if (op->kind == FMT_OP_LITERAL) {
+            out_ptr = fmt_append(out_ptr, out_end, format->text + op->offset, op->length);
+            continue;
+        }
+
+        switch (op->conversion) {
+            case 't':  /* Human-readable timestamp */
+                out_ptr = fmt_append(out_ptr, out_end, timestamp_str, strlen(timestamp_str));
+                break;
+
+            case 'T':  /* Raw timestamp ticks */
+                out_ptr = fmt_append(out_ptr, out_end, num_buf,
+                                     fmt_u64(num_buf, timestamp_raw));
+                break;
+
+            case 'r': {  /* Relative time in seconds */
+                uint64_t elapsed_ticks = timestamp_raw - ctx->start_timestamp;
+                double elapsed_seconds = (double)elapsed_ticks / ctx->timestamp_frequency;
+                out_ptr = fmt_append(out_ptr, out_end, num_buf,
+                                     fmt_double_fixed(num_buf, elapsed_seconds, 9));
+                break;
             }
-        } else {
-            *out_ptr++ = *fmt_ptr++;
+
+            case 'l': {  /* Log level */
+                const char* level = level_to_string(ctx, dict->log_level);
+                out_ptr = fmt_append(out_ptr, out_end, level, strlen(level));
+                break;
+            }
+
+            case 'f':  /* Filename */
+                out_ptr = fmt_append(out_ptr, out_end, dict->filename, strlen(dict->filename));
+                break;
+
+            case 'L':  /* Line number */
+                out_ptr = fmt_append(out_ptr, out_end, num_buf,
+                                     fmt_u64(num_buf, dict->line_number));
+                break;
+
+            case 'm':  /* Message */
+                out_ptr = fmt_append(out_ptr, out_end, message, message_len);
+                break;
+
+            default:  /* Unknown format, copy as-is */
+                *out_ptr++ = '%';
+                if (out_ptr < out_end) {
+                    *out_ptr++ = (char)op->conversion;
+                }
+                break;
         }
     }
     *out_ptr = '\0';
 }
 
+/* ============================================================================
+ * Span Trace Output
+ * ============================================================================ */
+
+/**
+ * Write one span record as a Chrome trace event ("B"/"E", timestamps in
+ * microseconds since the start of the log). Threads are CNanoLog thread
+ * ids; B/E events nest per thread, as spans do.
+ */
+static void format_trace_event(const decompressor_ctx_t* ctx, const dict_entry_t* dict,
+                               uint64_t timestamp, const char* arg_data, size_t arg_len,
+                               char* output, size_t output_size) {
+    char* out_ptr = output;
+    char* out_end = output + output_size - 1;
+    char num_buf[64];
+
+    uint32_t thread_id = 0;
+    if (arg_len >= sizeof(uint32_t)) {
+        memcpy(&thread_id, arg_data, sizeof(uint32_t));
+    }
+
+    int64_t wall_sec;
+    uint32_t wall_nsec;
+    timestamp_to_wall(ctx, timestamp, &wall_sec, &wall_nsec);
+    int64_t elapsed_ns = (wall_sec - (int64_t)ctx->start_time_sec) * 1000000000LL +
+                         (int64_t)wall_nsec - ctx->start_time_nsec;
+    if (elapsed_ns < 0) {
+        elapsed_ns = 0;
+    }
+
+    out_ptr = fmt_append(out_ptr, out_end, "{\"name\":", 8);
+    out_ptr = sfmt_json_string(out_ptr, out_end, dict->format, strlen(dict->format));
+    if (dict->log_level == CNANOLOG_LEVEL_SPAN_BEGIN) {
+        out_ptr = fmt_append(out_ptr, out_end, ",\"cat\":\"cnanolog\",\"ph\":\"B\",\"ts\":", 32);
+    } else {
+        out_ptr = fmt_append(out_ptr, out_end, ",\"cat\":\"cnanolog\",\"ph\":\"E\",\"ts\":", 32);
+    }
+    out_ptr = fmt_append(out_ptr, out_end, num_buf, fmt_u64(num_buf, (uint64_t)elapsed_ns / 1000));
+    num_buf[0] = '.';
+    fmt_u64_padded(num_buf + 1, (uint64_t)elapsed_ns % 1000, 3);
+    out_ptr = fmt_append(out_ptr, out_end, num_buf, 4);
+    out_ptr = fmt_append(out_ptr, out_end, ",\"pid\":1,\"tid\":", 15);
+    out_ptr = fmt_append(out_ptr, out_end, num_buf, fmt_u64(num_buf, thread_id));
+    if (dict->log_level == CNANOLOG_LEVEL_SPAN_BEGIN) {
+        out_ptr = fmt_append(out_ptr, out_end, ",\"args\":{\"file\":", 16);
+        out_ptr = sfmt_json_string(out_ptr, out_end, dict->filename, strlen(dict->filename));
+        out_ptr = fmt_append(out_ptr, out_end, ",\"line\":", 8);
+        out_ptr = fmt_append(out_ptr, out_end, num_buf, fmt_u64(num_buf, dict->line_number));
+        out_ptr = fmt_append(out_ptr, out_end, "}", 1);
+    }
+    out_ptr = fmt_append(out_ptr, out_end, "}", 1);
+    *out_ptr = '\0';
+}
+
 /* ============================================================================
  * Level Filtering
  * ============================================================================ */
@@ -775,6 +899,10 @@ static int parse_level_filters(const char* filter_str, decompressor_ctx_t* ctx,
             level = 2;
         } else if (strcasecmp(token, "DEBUG") == 0) {
             level = 3;
+        } else if (strcasecmp(token, "SPAN_BEGIN") == 0) {
+            level = CNANOLOG_LEVEL_SPAN_BEGIN;
+        } else if (strcasecmp(token, "SPAN_END") == 0) {
+            level = CNANOLOG_LEVEL_SPAN_END;
         } else {
             /* Try to match custom levels */
             if (ctx->custom_levels != NULL) {
@@ -827,6 +955,9 @@ static void print_help(const char* program_name) {
     fprintf(stderr, "Options:\n");
     fprintf(stderr, "  -f, --format <fmt>   Specify output format (default: \"[%%t] [%%l] [%%f:%%L] %%m\")\n");
     fprintf(stderr, "  -l, --level <levels> Filter by log level (comma-separated, e.g., \"METRIC,AUDIT\")\n");
+    fprintf(stderr, "      --json           Write one JSON object per line (arguments as typed fields)\n");
+    fprintf(stderr, "      --logfmt         Write logfmt key=value lines (arguments as typed fields)\n");
+    fprintf(stderr, "      --trace          Write spans as Chrome trace event JSON (Perfetto, chrome://tracing)\n");
     fprintf(stderr, "  -h, --help           Show this help message\n\n");
     fprintf(stderr, "Format tokens:\n");
     fprintf(stderr, "  %%t   Human-readable timestamp (YYYY-MM-DD HH:MM:SS.nnnnnnnnn)\n");
@@ -844,8 +975,10 @@ static void print_help(const char* program_name) {
     fprintf(stderr, "  %s -f \"%%t: %%m\" app.clog\n\n", program_name);
     fprintf(stderr, "  # CSV format\n");
     fprintf(stderr, "  %s -f \"%%t,%%l,%%f,%%L,%%m\" app.clog app.csv\n\n", program_name);
-    fprintf(stderr, "  # JSON-like format\n");
-    fprintf(stderr, "  %s -f '{\"time\":\"%%t\",\"level\":\"%%l\",\"msg\":\"%%m\"}' app.clog\n\n", program_name);
+    fprintf(stderr, "  # JSON lines for log shippers (-f is ignored)\n");
+    fprintf(stderr, "  %s --json app.clog app.jsonl\n\n", program_name);
+    fprintf(stderr, "  # Spans for ui.perfetto.dev (other entries are skipped)\n");
+    fprintf(stderr, "  %s --trace app.clog app.trace.json\n\n", program_name);
     fprintf(stderr, "If output file is not specified, writes to stdout.\n");
 }
 
@@ -854,14 +987,25 @@ static void print_help(const char* program_name) {
  * ============================================================================ */
 
 static int decompress_file(const char* input_path, FILE* output_fp, const char* output_format,
-                          const char* level_filter_str) {
+                          int output_style, const char* level_filter_str) {
     FILE* input_fp = NULL;
     decompressor_ctx_t ctx;
     memset(&ctx, 0, sizeof(ctx));
+    char* arg_buffer = NULL;
+    char* uncompressed_buffer = NULL;
+    char* message = NULL;
+    char* formatted_line = NULL;
     uint8_t filter_levels[MAX_LEVEL_FILTERS];
     int num_filter_levels = 0;
     int ret = -1;
 
+    /* Compile the output pattern once for all entries */
+    fmt_program_t* output_program = fmt_program_compile_pattern(output_format);
+    if (output_program == NULL) {
+        fprintf(stderr, "Error: Failed to compile output format\n");
+        return -1;
+    }
+
     /* Open input file */
     input_fp = fopen(input_path, "rb");
     if (input_fp == NULL) {
@@ -902,6 +1046,17 @@ static int decompress_file(const char* input_path, FILE* output_fp, const char*
 
     /* Check if file has timestamps */
     ctx.has_timestamps = (header.flags & CNANOLOG_FLAG_HAS_TIMESTAMPS) != 0;
+    ctx.extended_lengths = header.version_minor >= 2;
+    ctx.double_xor = (header.flags & CNANOLOG_FLAG_DOUBLE_XOR) != 0;
+    ctx.int_delta = (header.flags & CNANOLOG_FLAG_INT_DELTA) != 0;
+    if (header.flags & CNANOLOG_FLAG_STRING_INTERN) {
+        ctx.strings = (string_intern_t*)malloc(sizeof(string_intern_t));
+        if (ctx.strings == NULL) {
+            fprintf(stderr, "Error: Failed to allocate string table\n");
+            goto cleanup;
+        }
+        string_intern_reset(ctx.strings);
+    }
 
     /* Determine dictionary offset */
     uint64_t dict_offset;
@@ -919,6 +1074,19 @@ static int decompress_file(const char* input_path, FILE* output_fp, const char*
         goto cleanup;
     }
 
+    /* Clock sync records (piecewise timestamp mapping) */
+    if (ctx.has_timestamps && (header.flags & CNANOLOG_FLAG_HAS_SYNC_RECORDS)) {
+        if (load_sync_points(input_fp, &ctx, dict_offset) != 0) {
+            fprintf(stderr, "Error: Failed to read clock sync records\n");
+            goto cleanup;
+        }
+    }
+
+    if (output_style == STYLE_TRACE && !ctx.has_timestamps) {
+        fprintf(stderr, "Error: --trace needs a log written with timestamps\n");
+        goto cleanup;
+    }
+
     /* Parse level filters (now that we have custom levels loaded) */
     if (level_filter_str != NULL) {
         num_filter_levels = parse_level_filters(level_filter_str, &ctx,
@@ -939,35 +1107,48 @@ static int decompress_file(const char* input_path, FILE* output_fp, const char*
     }
 
     /* Decompress entries */
-    uint32_t entries_processed = 0;
-    char arg_buffer[CNANOLOG_MAX_ENTRY_SIZE];
-    char uncompressed_buffer[CNANOLOG_MAX_ENTRY_SIZE];
+    arg_buffer = (char*)malloc(CNANOLOG_MAX_COMPRESSED_SIZE);
+    uncompressed_buffer = (char*)malloc(CNANOLOG_MAX_COMPRESSED_SIZE);
+    message = (char*)malloc(MESSAGE_BUFFER_SIZE);
+    formatted_line = (char*)malloc(LINE_BUFFER_SIZE);
+    if (arg_buffer == NULL || uncompressed_buffer == NULL ||
+        message == NULL || formatted_line == NULL) {
+        fprintf(stderr, "Error: Failed to allocate entry buffers\n");
+        goto cleanup;
+    }
+
+    /* Entries run up to the dictionary (entry_count wraps in files before v1.2) */
+    uint64_t entries_processed = 0;
+    uint64_t offset = sizeof(header);
+    uint64_t trace_events = 0;
+
+    if (output_style == STYLE_TRACE) {
+        fprintf(output_fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    }
 
-    while (entries_processed < header.entry_count) {
-        /* Read entry header - format depends on whether timestamps are enabled */
+    while (offset < dict_offset) {
         uint32_t log_id;
         uint64_t timestamp = 0;
-        uint16_t data_length;
+        uint32_t data_length;
 
-        /* Read log_id (always 4 bytes) */
-        if (fread(&log_id, 1, sizeof(log_id), input_fp) != sizeof(log_id)) {
-            if (feof(input_fp)) break;  /* EOF */
-            fprintf(stderr, "Error: Failed to read entry log_id\n");
+        int rc = read_entry_header(input_fp, &ctx, &log_id, &timestamp, &data_length, &offset);
+        if (rc == 0) break;  /* EOF */
+        if (rc < 0) {
             goto cleanup;
         }
+        offset += data_length;
 
-        /* Read timestamp (8 bytes) if enabled */
-        if (ctx.has_timestamps) {
-            if (fread(&timestamp, 1, sizeof(timestamp), input_fp) != sizeof(timestamp)) {
-                fprintf(stderr, "Error: Failed to read entry timestamp\n");
+        /* Clock sync records were collected up front; they also mark
+         * where argument history restarts */
+        if (log_id == CNANOLOG_SYNC_LOG_ID) {
+            if (ctx.int_delta) {
+                reset_history(&ctx);
+            }
+            if (fseek(input_fp, data_length, SEEK_CUR) != 0) {
+                fprintf(stderr, "Error: Failed to skip sync record\n");
                 goto cleanup;
             }
-        }
-
-        /* Read data_length (always 2 bytes) */
-        if (fread(&data_length, 1, sizeof(data_length), input_fp) != sizeof(data_length)) {
-            fprintf(stderr, "Error: Failed to read entry data_length\n");
-            goto cleanup;
+            continue;
         }
 
         /* Validate log_id */
@@ -978,6 +1159,10 @@ static int decompress_file(const char* input_path, FILE* output_fp, const char*
         }
 
         /* Read argument data (compressed) */
+        if (data_length > CNANOLOG_MAX_COMPRESSED_SIZE) {
+            fprintf(stderr, "Error: Entry data too large (%u bytes)\n", data_length);
+            goto cleanup;
+        }
         if (data_length > 0) {
             if (fread(arg_buffer, 1, data_length, input_fp) != data_length) {
                 fprintf(stderr, "Error: Failed to read entry data\n");
@@ -996,43 +1181,96 @@ static int decompress_file(const char* input_path, FILE* output_fp, const char*
         /* Get dictionary entry */
         dict_entry_t* dict = &ctx.entries[log_id];
 
-        /* Apply level filter */
-        if (!should_include_level(dict->log_level, filter_levels, num_filter_levels)) {
+        /* Apply level filter (levels are per site, so skipped entries never
+         * share argument history with printed ones - but they do share the
+         * string table, which has to see them) */
+        int include = should_include_level(dict->log_level, filter_levels, num_filter_levels);
+        if (output_style == STYLE_TRACE) {
+            include = dict->log_level == CNANOLOG_LEVEL_SPAN_BEGIN ||
+                      dict->log_level == CNANOLOG_LEVEL_SPAN_END;
+        }
+        if (!include && ctx.strings == NULL) {
             entries_processed++;
             continue;  /* Skip this entry */
         }
 
         /* Decompress argument data */
         const char* data_to_format = arg_buffer;
+        size_t data_to_format_len = data_length;
         if (data_length > 0) {
             int decompressed_len = decompress_entry_args(
                 arg_buffer,
                 data_length,
                 uncompressed_buffer,
-                sizeof(uncompressed_buffer),
-                dict);
+                CNANOLOG_MAX_COMPRESSED_SIZE,
+                dict,
+                ctx.double_xor,
+                ctx.int_delta,
+                ctx.strings);
 
             if (decompressed_len > 0) {
                 /* Use decompressed data */
                 data_to_format = uncompressed_buffer;
+                data_to_format_len = (size_t)decompressed_len;
             }
             /* If decompression fails, fall back to treating as uncompressed */
         }
 
+        if (!include) {
+            entries_processed++;
+            continue;  /* Skip this entry */
+        }
+
+        if (output_style == STYLE_TRACE) {
+            format_trace_event(&ctx, dict, timestamp, data_to_format, data_to_format_len,
+                               formatted_line, LINE_BUFFER_SIZE);
+            fprintf(output_fp, "%s\n%s", trace_events == 0 ? "" : ",", formatted_line);
+            trace_events++;
+            entries_processed++;
+            continue;
+        }
+
         /* Format message */
-        char message[2048];
-        format_log_message(&ctx, dict, data_to_format, message, sizeof(message));
+        size_t message_len = fmt_program_render(dict->program,
+                                                data_to_format, data_to_format_len,
+                                                message, MESSAGE_BUFFER_SIZE);
 
         /* Format and output log line according to output format */
-        char formatted_line[4096];
-        format_output(output_format, timestamp_str, timestamp, &ctx, dict, message,
-                     formatted_line, sizeof(formatted_line));
+        if (output_style != STYLE_TEXT) {
+            sfmt_record_t record = {
+                .timestamp = timestamp_str,
+                .timestamp_len = strlen(timestamp_str),
+                .level = level_to_string(&ctx, dict->log_level),
+                .file = dict->filename,
+                .line = dict->line_number,
+                .message = message,
+                .message_len = message_len,
+                .format = dict->program,
+                .arg_data = data_to_format,
+                .arg_len = data_to_format_len
+            };
+            size_t line_len = sfmt_encode(output_style, &record,
+                                          formatted_line, LINE_BUFFER_SIZE - 1);
+            formatted_line[line_len] = '\0';
+        } else {
+            format_output(output_program, timestamp_str, timestamp, &ctx, dict,
+                          message, message_len, formatted_line, LINE_BUFFER_SIZE);
+        }
         fprintf(output_fp, "%s\n", formatted_line);
 
         entries_processed++;
     }
 
-    fprintf(stderr, "Decompressed %u entries\n", entries_processed);
+    if (output_style == STYLE_TRACE) {
+        fprintf(output_fp, "\n]}\n");
+        fprintf(stderr, "Exported %llu span events\n", (unsigned long long)trace_events);
+    }
+
+    fprintf(stderr, "Decompressed %llu entries\n", (unsigned long long)entries_processed);
+    if (entries_processed != cnanolog_header_entry_count(&header) && header.version_minor >= 2) {
+        fprintf(stderr, "Warning: Header records %llu entries\n",
+                (unsigned long long)cnanolog_header_entry_count(&header));
+    }
     ret = 0;
 
 cleanup:
@@ -1041,6 +1279,8 @@ cleanup:
         for (uint32_t i = 0; i < ctx.num_entries; i++) {
             free(ctx.entries[i].filename);
             free(ctx.entries[i].format);
+            fmt_program_free(ctx.entries[i].program);
+            free(ctx.entries[i].history);
         }
         free(ctx.entries);
     }
@@ -1050,10 +1290,18 @@ cleanup:
         free(ctx.custom_levels);
     }
 
+    free(ctx.sync_points);
+    free(ctx.strings);
+    free(arg_buffer);
+    free(uncompressed_buffer);
+    free(message);
+    free(formatted_line);
+
     if (input_fp != NULL) {
         fclose(input_fp);
     }
 
+    fmt_program_free(output_program);
     return ret;
 }
 
@@ -1066,6 +1314,7 @@ int main(int argc, char** argv) {
     const char* output_path = NULL;
     const char* output_format = DEFAULT_FORMAT;
     const char* level_filter_str = NULL;
+    int output_style = STYLE_TEXT;
     FILE* output_fp = stdout;
 
     /* Parse command-line arguments */
@@ -1090,6 +1339,15 @@ int main(int argc, char** argv) {
             }
             level_filter_str = argv[i + 1];
             i += 2;
+        } else if (strcmp(argv[i], "--json") == 0) {
+            output_style = SFMT_JSON;
+            i++;
+        } else if (strcmp(argv[i], "--logfmt") == 0) {
+            output_style = SFMT_LOGFMT;
+            i++;
+        } else if (strcmp(argv[i], "--trace") == 0) {
+            output_style = STYLE_TRACE;
+            i++;
         } else if (argv[i][0] == '-') {
             fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
             fprintf(stderr, "Try '%s --help' for more information.\n", argv[0]);
@@ -1127,7 +1385,8 @@ int main(int argc, char** argv) {
     }
 
     /* Decompress */
-    int ret = decompress_file(input_path, output_fp, output_format, level_filter_str);
+    int ret = decompress_file(input_path, output_fp, output_format, output_style,
+                              level_filter_str);
 
     /* Close output file */
     if (output_fp != stdout) {
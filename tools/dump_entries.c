@@ -60,27 +60,49 @@ int main(int argc, char** argv) {
             break;  /* End of file */
         }
 
-        printf("Entry #%d:\n", entry_num);
+        if (entry_header.log_id == CNANOLOG_SYNC_LOG_ID) {
+            printf("Clock sync record:\n");
+        } else {
+            printf("Entry #%d:\n", entry_num);
+        }
+        /* v1.2+: long entries carry a varint length after the header */
+        uint32_t data_length = entry_header.data_length;
+        if (data_length == CNANOLOG_LENGTH_EXTENDED && header.version_minor >= 2) {
+            uint8_t varint[CNANOLOG_VARINT_MAX_BYTES];
+            size_t n = 0;
+            int c;
+            do {
+                c = fgetc(fp);
+                varint[n++] = (uint8_t)c;
+            } while (c != EOF && (c & 0x80) && n < sizeof(varint));
+            if (c == EOF || cnanolog_varint_decode(varint, n, &data_length) != n) {
+                fprintf(stderr, "Bad extended entry length\n");
+                break;
+            }
+        }
+
         printf("  log_id: %u\n", entry_header.log_id);
         printf("  timestamp: %llu\n", entry_header.timestamp);
-        printf("  data_length: %u bytes\n", entry_header.data_length);
+        printf("  data_length: %u bytes\n", data_length);
 
-        if (entry_header.data_length > 0) {
-            uint8_t* data = malloc(entry_header.data_length);
-            if (fread(data, 1, entry_header.data_length, fp) != entry_header.data_length) {
+        if (data_length > 0) {
+            uint8_t* data = malloc(data_length);
+            if (fread(data, 1, data_length, fp) != data_length) {
                 fprintf(stderr, "Failed to read entry data\n");
                 free(data);
                 break;
             }
 
             printf("  data (hex): ");
-            dump_hex(data, entry_header.data_length);
+            dump_hex(data, data_length);
             printf("\n");
             free(data);
         }
 
         printf("\n");
-        entry_num++;
+        if (entry_header.log_id != CNANOLOG_SYNC_LOG_ID) {
+            entry_num++;
+        }
     }
 
     fclose(fp);
@@ -48,6 +48,7 @@ cat >> "$OUTPUT_FILE" << 'HEADER_GUARD'
 #include <string.h>
 #include <time.h>
 #include <errno.h>
+#include <signal.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -97,7 +98,7 @@ echo "" >> "$OUTPUT_FILE"
 
 echo "/* Internal headers */" >> "$OUTPUT_FILE"
 # Note: log_registry must come first because it defines log_site_t used by others
-for header in log_registry cycles arg_packing packer compressor binary_writer staging_buffer; do
+for header in fast_format format_program structured_format log_registry cycles tsc_calibration arg_packing packer string_intern compressor async_writer binary_writer staging_buffer flight_recorder latency_histogram shm_segment net_writer text_formatter format_pool sink; do
     if [ -f "$PROJECT_ROOT/src/${header}.h" ]; then
         echo "/* ${header}.h */" >> "$OUTPUT_FILE"
         strip_includes_header "$PROJECT_ROOT/src/${header}.h" >> "$OUTPUT_FILE"
@@ -119,7 +120,7 @@ IMPL_START
 echo "Adding implementation files..."
 
 # Add all implementation files
-for impl in platform compressor packer binary_writer log_registry staging_buffer cnanolog; do
+for impl in platform tsc_calibration compressor packer string_intern async_writer binary_writer log_registry staging_buffer flight_recorder latency_histogram shm_segment net_writer fast_format format_program structured_format text_formatter format_pool sink cnanolog; do
     if [ -f "$PROJECT_ROOT/src/${impl}.c" ]; then
         echo "" >> "$OUTPUT_FILE"
         echo "/* ============================================================================" >> "$OUTPUT_FILE"